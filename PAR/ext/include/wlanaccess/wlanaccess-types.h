@@ -10,6 +10,7 @@
 #define LIBWLANACCESS_WLANACCESS_TYPES_H
 
 
+#include <stdbool.h>
 #include <stdint.h>
 
 
@@ -133,14 +134,23 @@ enum eAlErrorCode {
 /// @copydoc eAlErrorCode
 typedef int AlErrorCode;
 
-/// @brief 송신통계정보
+/// @brief 송신통계정보 (인터페이스/TimeSlot 별, 카운터는 마지막 Al_ClearTxStatistics() 호출 이후 누적값)
 struct AlTxStatstics {
-
+  uint32_t tx_req_cnt;          /// 하드웨어로 송신요청된 패킷 수
+  uint32_t tx_fail_cnt;         /// 하드웨어에서 폐기된 패킷 수
+  uint32_t tx_cnf_cnt;          /// 송신 성공 패킷 수 (재전송 제외)
+  uint32_t tx_err_cnt;          /// 송신 실패 패킷 수 (재전송 제외)
 };
 
-/// @brief 수신통계정보
+/// @brief 수신통계정보 (인터페이스/TimeSlot 별, 카운터는 마지막 Al_ClearRxStatistics() 호출 이후 누적값)
 struct AlRxStatstics {
-
+  uint32_t rx_cnt;              /// 수신 패킷 수
+  uint32_t rx_fail_cnt;         /// 수신 실패 패킷 수 (CRC 오류 등)
+  uint32_t rx_dup_cnt;          /// 중복 수신 패킷 수 (유니캐스트)
+  uint32_t medium_busy_time;    /// 마지막 측정주기 동안 매체가 busy 였던 시간 (usec)
+  uint8_t channel_busy_ratio;   /// 마지막 측정주기의 Channel Busy Ratio (255 = 100%)
+  int8_t avg_idle_power;        /// 마지막 측정주기의 평균 idle 파워 (dBm)
+  bool cbr_valid;               /// 하드웨어로부터 CBR 측정값이 수신되었는지 여부
 };
 
 #endif //LIBWLANACCESS_WLANACCESS_TYPES_H
@@ -122,10 +122,13 @@ int Al_GetIfMacAddress(const AlIfIndex ifindex, AlMacAddress addr);
 /**
  * @brief 특정 인터페이스에 대한 송신통계정보를 확인한다.
  * @param ifindex 인터페이스 식별번호
+ * @param timeslot 통계정보를 확인할 TimeSlot (kAlTimeSlot_0 또는 kAlTimeSlot_1)
  * @param stats 송신통계정보가 저장되어 반환된다.
  * @return 성공시 0, 실패시 음수(-AlResultCode)
+ *
+ * 통계정보는 하드웨어의 통계 Notification 수신 시(SAF5100의 경우 50msec 주기)에 갱신된다.
  */
-int Al_GetTxStatistics(const AlIfIndex ifindex, struct AlTxStatstics *const stats);
+int Al_GetTxStatistics(const AlIfIndex ifindex, const AlTimeSlot timeslot, struct AlTxStatstics *const stats);
 
 /**
  * @brief 특정 인터페이스의 송신통계정보를 초기화한다.
@@ -137,10 +140,14 @@ int Al_ClearTxStatistics(const AlIfIndex ifindex);
 /**
  * @brief 특정 인터페이스에 대한 수신통계정보를 확인한다.
  * @param ifindex 인터페이스 식별번호
+ * @param timeslot 통계정보를 확인할 TimeSlot (kAlTimeSlot_0 또는 kAlTimeSlot_1)
  * @param stats 수신통계정보가 저장되어 반환된다.
  * @return 성공시 0, 실패시 음수(-AlResultCode)
+ *
+ * 통계정보는 하드웨어의 통계 Notification 수신 시(SAF5100의 경우 50msec 주기)에 갱신된다.
+ * Channel Busy Ratio 등 측정주기 단위 값은 누적되지 않고 마지막 측정값이 반환된다.
  */
-int Al_GetRxStatistics(const AlIfIndex ifindex, struct AlRxStatstics *const stats);
+int Al_GetRxStatistics(const AlIfIndex ifindex, const AlTimeSlot timeslot, struct AlRxStatstics *const stats);
 
 /**
  * @brief 특정 인터페이스의 수신통계정보를 초기화한다.
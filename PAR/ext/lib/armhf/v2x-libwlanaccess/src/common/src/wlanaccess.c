@@ -39,6 +39,7 @@ extern int INTERNAL al_PlatformInit(struct AlPlatform *const platform, const boo
 int OPEN_API Al_Init(const AlLogLevel log_level)
 {
   memset(&g_al_platform, 0, sizeof(g_al_platform));
+  pthread_mutex_init(&g_al_platform.stats_mtx, NULL);
   g_al_log = log_level;
 
   /*
@@ -54,6 +55,7 @@ int OPEN_API Al_Init(const AlLogLevel log_level)
 int OPEN_API Al_Open(const AlLogLevel log_level)
 {
   memset(&g_al_platform, 0, sizeof(g_al_platform));
+  pthread_mutex_init(&g_al_platform.stats_mtx, NULL);
   g_al_log = log_level;
 
   /*
@@ -146,6 +148,90 @@ int OPEN_API Al_PollEvent(void)
 }
 
 
+/**
+ * @copydoc Al_GetTxStatistics
+ */
+int OPEN_API Al_GetTxStatistics(const AlIfIndex ifindex, const AlTimeSlot timeslot, struct AlTxStatstics *const stats)
+{
+  if (stats == NULL) {
+    return -kAlResult_NullParameters;
+  }
+  if (ifindex >= _V2X_IF_NUM_) {
+    return -kAlResult_InvalidIfIndex;
+  }
+  if (timeslot > kAlTimeSlot_1) {
+    return -kAlResult_InvalidTimeSlot;
+  }
+
+  pthread_mutex_lock(&g_al_platform.stats_mtx);
+  const struct AlTxStatstics *cur = &g_al_platform.txstats[ifindex][timeslot];
+  const struct AlTxStatstics *base = &g_al_platform.txstats_base[ifindex][timeslot];
+  stats->tx_req_cnt = cur->tx_req_cnt - base->tx_req_cnt;
+  stats->tx_fail_cnt = cur->tx_fail_cnt - base->tx_fail_cnt;
+  stats->tx_cnf_cnt = cur->tx_cnf_cnt - base->tx_cnf_cnt;
+  stats->tx_err_cnt = cur->tx_err_cnt - base->tx_err_cnt;
+  pthread_mutex_unlock(&g_al_platform.stats_mtx);
+  return kAlResult_Success;
+}
+
+
+/**
+ * @copydoc Al_ClearTxStatistics
+ */
+int OPEN_API Al_ClearTxStatistics(const AlIfIndex ifindex)
+{
+  if (ifindex >= _V2X_IF_NUM_) {
+    return -kAlResult_InvalidIfIndex;
+  }
+  pthread_mutex_lock(&g_al_platform.stats_mtx);
+  memcpy(g_al_platform.txstats_base[ifindex], g_al_platform.txstats[ifindex], sizeof(g_al_platform.txstats[ifindex]));
+  pthread_mutex_unlock(&g_al_platform.stats_mtx);
+  return kAlResult_Success;
+}
+
+
+/**
+ * @copydoc Al_GetRxStatistics
+ */
+int OPEN_API Al_GetRxStatistics(const AlIfIndex ifindex, const AlTimeSlot timeslot, struct AlRxStatstics *const stats)
+{
+  if (stats == NULL) {
+    return -kAlResult_NullParameters;
+  }
+  if (ifindex >= _V2X_IF_NUM_) {
+    return -kAlResult_InvalidIfIndex;
+  }
+  if (timeslot > kAlTimeSlot_1) {
+    return -kAlResult_InvalidTimeSlot;
+  }
+
+  pthread_mutex_lock(&g_al_platform.stats_mtx);
+  const struct AlRxStatstics *cur = &g_al_platform.rxstats[ifindex][timeslot];
+  const struct AlRxStatstics *base = &g_al_platform.rxstats_base[ifindex][timeslot];
+  *stats = *cur;
+  stats->rx_cnt = cur->rx_cnt - base->rx_cnt;
+  stats->rx_fail_cnt = cur->rx_fail_cnt - base->rx_fail_cnt;
+  stats->rx_dup_cnt = cur->rx_dup_cnt - base->rx_dup_cnt;
+  pthread_mutex_unlock(&g_al_platform.stats_mtx);
+  return kAlResult_Success;
+}
+
+
+/**
+ * @copydoc Al_ClearRxStatistics
+ */
+int OPEN_API Al_ClearRxStatistics(const AlIfIndex ifindex)
+{
+  if (ifindex >= _V2X_IF_NUM_) {
+    return -kAlResult_InvalidIfIndex;
+  }
+  pthread_mutex_lock(&g_al_platform.stats_mtx);
+  memcpy(g_al_platform.rxstats_base[ifindex], g_al_platform.rxstats[ifindex], sizeof(g_al_platform.rxstats[ifindex]));
+  pthread_mutex_unlock(&g_al_platform.stats_mtx);
+  return kAlResult_Success;
+}
+
+
 /**
  * @copydoc Al_RegisterCallbackAccessChannelResult
  */
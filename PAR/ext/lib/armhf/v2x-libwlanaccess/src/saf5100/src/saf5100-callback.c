@@ -237,6 +237,47 @@ tMKxStatus INTERNAL al_SAF5100_RxInd(struct MKx *pMKx, tMKxRxPacket *pRxPkt, voi
   return MKXSTATUS_SUCCESS;
 }
 
+/**
+ * @brief LLC가 갱신한 라디오 통계정보를 공통 플랫폼 통계정보에 복사한다.
+ * @param saf5100_dev SAF5100 디바이스 정보
+ * @param platform 공통 플랫폼 정보
+ * @param radio 라디오 식별번호 (MKX_RADIO_A/B)
+ *
+ * 라디오의 채널0/채널1 컨텍스트는 각각 TimeSlot0/TimeSlot1 에 대응된다.
+ */
+static void al_SAF5100_UpdateStats(
+  const struct SAF5100Device *const saf5100_dev,
+  struct AlPlatform *const platform,
+  const tMKxRadio radio)
+{
+  AlIfIndex ifindex = (saf5100_dev->dev_index * SAF5100_IF_NUM_IN_DEV) + radio;
+  if (ifindex >= _V2X_IF_NUM_) {
+    return;
+  }
+
+  const tMKxRadioStats *radio_stats = &(saf5100_dev->mkx->State.Stats[radio]);
+  pthread_mutex_lock(&platform->stats_mtx);
+  for (int ch = 0; ch < MKX_CHANNEL_COUNT; ch++) {
+    tMKxChannelStats chan_stats = radio_stats->RadioStatsData.Chan[ch]; // packed 구조체이므로 복사하여 사용한다.
+    const tMKxChannelStats *chan = &chan_stats;
+    struct AlTxStatstics *txstats = &(platform->txstats[ifindex][ch]);
+    struct AlRxStatstics *rxstats = &(platform->rxstats[ifindex][ch]);
+    txstats->tx_req_cnt = chan->TxReq;
+    txstats->tx_fail_cnt = chan->TxFail;
+    txstats->tx_cnf_cnt = chan->TxCnf;
+    txstats->tx_err_cnt = chan->TxErr;
+    rxstats->rx_cnt = chan->RxInd;
+    rxstats->rx_fail_cnt = chan->RxFail;
+    rxstats->rx_dup_cnt = chan->RxDup;
+    rxstats->medium_busy_time = chan->MediumBusyTime;
+    rxstats->channel_busy_ratio = chan->ChannelBusyRatio;
+    rxstats->avg_idle_power = chan->AverageIdlePower;
+    rxstats->cbr_valid = true;
+  }
+  pthread_mutex_unlock(&platform->stats_mtx);
+}
+
+
 /**
  * @brief SAF5100 플랫폼 NotifInd() 콜백함수 구현부
  * @param pMKx MKx 핸들
@@ -257,6 +298,18 @@ tMKxStatus INTERNAL al_SAF5100_NotifInd(struct MKx *pMKx, tMKxNotif Notif)
   struct SAF5100Device *saf5100_dev = (struct SAF5100Device *)(pMKx->pPriv);
   struct AlPlatform *platform = g_al_saf5100_platform.parent;
 
+  // 통계정보 갱신 Notification (50msec 주기). 라디오가 지정되지 않은 경우 모든 라디오를 갱신한다.
+  if (Notif & MKX_NOTIF_MASK_STATS) {
+    bool all = !(Notif & (MKX_NOTIF_MASK_RADIOA | MKX_NOTIF_MASK_RADIOB));
+    if (all || (Notif & MKX_NOTIF_MASK_RADIOA)) {
+      al_SAF5100_UpdateStats(saf5100_dev, platform, MKX_RADIO_A);
+    }
+    if (all || (Notif & MKX_NOTIF_MASK_RADIOB)) {
+      al_SAF5100_UpdateStats(saf5100_dev, platform, MKX_RADIO_B);
+    }
+    return MKXSTATUS_SUCCESS;
+  }
+
   if (Notif & MKX_NOTIF_MASK_RADIOA) {
 
     // 채널접속 또는 MAC주소설정 요청에 대한 Notification
@@ -298,4 +351,34 @@ tMKxStatus INTERNAL al_SAF5100_NotifInd(struct MKx *pMKx, tMKxNotif Notif)
   // TODO::
 
   return MKXSTATUS_SUCCESS;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief SAF5100 플랫폼 GetTSFInd() 콜백함수 구현부
+ * @param pMKx MKx 핸들
+ * @param TSF GetTSFReq() 요청에 대한 현재 TSF 값 (마이크로초)
+ * @return tMKxStatus
+ *
+ * GetTSFReq()에 대한 응답이며, 이벤트폴링 함수인 MKx_Recv() 에서 호출된다.
+ * 수신된 TSF를 수신 시점의 시스템 단조시간과 함께 저장하여, 송신 시 패킷 만료시각(Expiry) 계산에 사용한다.
+ */
+tMKxStatus INTERNAL al_SAF5100_GetTSFInd(struct MKx *pMKx, tMKxTSF TSF)
+{
+  /*
+   * 파라미터 유효성 체크
+   */
+  if (pMKx == NULL) {
+    return MKXSTATUS_FAILURE_INVALID_HANDLE;
+  }
+
+  struct SAF5100Device *saf5100_dev = (struct SAF5100Device *)(pMKx->pPriv);
+
+  pthread_mutex_lock(&saf5100_dev->tsf_mtx);
+  saf5100_dev->tsf = TSF;
+  saf5100_dev->tsf_mono = al_SAF5100_GetMonotonicTime();
+  saf5100_dev->tsf_valid = true;
+  pthread_mutex_unlock(&saf5100_dev->tsf_mtx);
+
+  Log(kAlLogLevel_all, "TSF indication - dev_index: %u, TSF: %"PRIu64"\n", saf5100_dev->dev_index, TSF);
+  return MKXSTATUS_SUCCESS;
+}
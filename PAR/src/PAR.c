@@ -56,6 +56,8 @@ int main(int argc, char *argv[]){
 	memset(&g_rsu, 0, sizeof(struct rsuInfo_t));
 	memset(&g_obu, 0, sizeof(struct obuInfo_t));
 	memset(&g_Packet, 0, sizeof(struct parPacket_t));
+	g_mib.priority = MSGQ_PRIORITY_DEFAULT;
+	g_mib.ifindex = MSGQ_IFINDEX_DEFAULT;
 	
 
 	/* 사용자가 입력한 파라미터들을 MIB에 저장한다. */
@@ -68,11 +70,17 @@ int main(int argc, char *argv[]){
 	/* 파라미터 출력 */
 	PrintOptions();
 
+	/* 바이너리 로그 초기화 - 디버그 모드면 LOG_DEBUG까지 기록한다. (실패 시 V2XLOG는 syslog로 기록) */
+	v2xlog_Init("PAR", NULL, g_mib.dbg ? LOG_DEBUG : LOG_INFO);
+
+	/* 공유메모리 통계 초기화 (v2xtop으로 조회) */
+	v2xstat_Init("PAR");
+
 	/* 프로그램 종료 위한 시그널 등록 Ctrl+C */
 	signal(SIGINT, sigint_handler);
 
-	/* MsgQ Open */
-	if(initMQ() == -1)	
+	/* MsgQ Open (재생 모드에서는 캡처 파일을 입력으로 사용) */
+	if(g_mib.replayFile[0] == '\0' && initMQ() == -1)	
 		return -1;
 
 	/* 송신 동작 */
@@ -86,7 +94,11 @@ int main(int argc, char *argv[]){
 	/*수신 동작 */
 	else if(g_mib.op == opRX){
 		printf("Running PAR RX Operation..\n");
-		par_InitRXoperation();
+		if(par_InitRXoperation() < 0){
+			if(g_mib.replayFile[0] == '\0')
+				releaseMQ();
+			return -1;
+		}
 		par_RXoperation();
 
 	}
@@ -96,7 +108,12 @@ int main(int argc, char *argv[]){
 	//freeAllNode();
 	
 	/* MQ 해제 */
-	releaseMQ();
+	if(g_mib.replayFile[0] == '\0')
+		releaseMQ();
+
+	/* 통계, 바이너리 로그 닫기 */
+	v2xstat_Close();
+	v2xlog_Close();
 	return 0;
 }
 
@@ -19,11 +19,42 @@
 #include <errno.h>
 #include <gps.h>
 #include <stdint.h>
+#include <stddef.h>
 #include "dot3/dot3.h"
+#include "v2xtimer.h"
+#include "v2xlog.h"
+#include "v2xstat.h"
 
 #define RSU_SLOT 101
+#define RSU_TABLE_MAX 1024 //RSU 테이블 최대 노드(링크) 수 (시작 시 슬랩으로 할당)
+#define RSU_HASH_BITS 11
+#define RSU_HASH_SIZE (1 << RSU_HASH_BITS) //RSU 해시 슬롯 수 (RSU_TABLE_MAX의 2배, 2의 거듭제곱)
+#define RSU_HISTORY_MAX 256 //보관하는 퇴출 RSU 이력 수 (오래된 것부터 덮어씀)
+#define PAR_RSU_AGE_DEFAULT 60 //RSU 퇴출 기본값 - 연속 미수신 보고 구간 수 (-A 0이면 퇴출하지 않음)
+#define PAR_WIN_GUARD 20000 //보고 구간 끝 이후 늦게 처리되는 패킷을 기다리는 시간 (usec, 최대 보고주기의 1/2)
+#define PAR_WIN_BACKLOG_MAX 8 //밀린 보고 구간이 이보다 많으면 시각이 바뀐 것으로 보고 빈 구간을 건너뛴다.
 #define BUFSIZE 1024
 #define MAX_ZERO_COUNT 5
+#define PAR_HIST_BIN 256 //RXPOWER/RCPI 백분위수 히스토그램 구간 수 (1단위)
+#define PAR_HIST_RXPOWER_OFFSET (-200) //RXPOWER 히스토그램 0번 구간 값(dBm), -200~55
+#define PAR_HIST_RCPI_OFFSET 0 //RCPI 히스토그램 0번 구간 값, 0~255
+#define PAR_HIST_LAT_OFFSET (-4000) //지연시간 히스토그램 0번 구간 값(usec)
+#define PAR_HIST_LAT_WIDTH 250 //지연시간 히스토그램 구간 폭(usec), -4~60msec (범위를 넘은 샘플의 백분위수는 min/max로 보고)
+
+/* calculateData 인덱스 - 각 4개씩 (min, max, avg, last) / (std, p50, p90, p99) */
+#define PAR_CALC_RXPOWER 0
+#define PAR_CALC_RCPI 4
+#define PAR_CALC_RXPOWER_EXT 8
+#define PAR_CALC_RCPI_EXT 12
+#define PAR_CALC_LAT 16 //단방향 지연시간(usec)
+#define PAR_CALC_LAT_EXT 20
+#define PAR_CALC_JITTER 24 //지연 지터(usec, RFC 3550)
+#define PAR_CALC_NUM 25
+#define PAR_SEQ_WIN 1024 //순서바뀜/중복 판정에 사용하는 최근 일련번호 수 (2의 거듭제곱)
+#define PAR_SEQ_MAP_WORDS (PAR_SEQ_WIN / 32)
+#define PAR_GEO_DEFAULT_TILE 50 //커버리지 지도 타일 크기 기본값 (m)
+#define PAR_GEO_DEFAULT_TILES 4096 //커버리지 지도 최대 타일 수 기본값 ((RSU 링크, 타일) 쌍, 초과 시 LRU 타일을 내보냄)
+#define PAR_GEO_DEFAULT_PERIOD 10 //커버리지 지도 내보내기 주기 기본값 (sec)
 //#define MSIZE(ptr) malloc_usable_size((void*)ptr)
 
 
@@ -40,21 +71,41 @@ typedef enum
   구조체
  ****************************************************************************************/
 
-/* Linkedlist 정보 */
+/* RSU 테이블 정보
+ * 노드는 (rsuID, 수신 채널, 수신 인터페이스) 링크 별로 하나이며,
+ * 시작 시 할당된 슬랩의 빈 노드 스택에서 할당되고, 링크 해시(open addressing)로 검색된다.
+ * 슬랩/해시는 수신 루프만, head/next 보고 리스트는 보고 쓰레드만 변경한다.
+ * 새 노드는 newRing으로 보고 쓰레드에 넘겨 리스트 끝에 붙이고,
+ * 퇴출한 노드는 리스트에서 뺀 후 retireRing으로 수신 루프에 돌려주어 해시에서 빼고 재사용한다. (각각 단일 생산자/단일 소비자) */
 typedef struct list_t {
 	struct parInfo_t *cur;
 	struct parInfo_t *head;
 	struct parInfo_t *tail;
-	int numOfList;
+	int numOfList; //보고 리스트 노드 수 (보고 쓰레드)
+	struct parInfo_t *slab; //노드 슬랩 (RSU_TABLE_MAX 개)
+	int16_t *hash; //링크 해시 슬롯 (RSU_HASH_SIZE 개), 슬랩 인덱스 저장, -1이면 빈 슬롯
+	int16_t *freeSlot; //빈 노드 슬랩 인덱스 스택 (수신 루프)
+	int numOfFree;
+	int numOfNode; //할당된 노드 수 (수신 루프)
+	int evictPending; //최대 RSU 수 초과로 퇴출 요청 후 아직 돌아오지 않은 노드 수 (수신 루프)
+	struct parInfo_t **newRing; //수신 루프 -> 보고 쓰레드 (RSU_TABLE_MAX 개)
+	uint32_t newHead;
+	uint32_t newTail;
+	struct parInfo_t **retireRing; //보고 쓰레드 -> 수신 루프 (RSU_TABLE_MAX 개)
+	uint32_t retireHead;
+	uint32_t retireTail;
 }linkedList;
 
 
-/* RSU 정보 */
+/* RSU 정보 (송신 프로브 메시지) */
 struct rsuInfo_t{
 	int32_t rsuID;
 	int32_t rsuLatitude;
 	int32_t rsuLongitude;
+	uint32_t seq; //프로브 일련번호 (전송 성공 시 1씩 증가)
+	uint64_t txTime; //프로브 송신시각 (usec, CLOCK_REALTIME)
 };
+#define RSU_INFO_LEGACY_LEN offsetof(struct rsuInfo_t, seq) //일련번호가 없는 이전 버전 메시지의 RSU 정보 길이
 
 /* OBU 정보 */
 struct obuInfo_t{
@@ -73,32 +124,117 @@ struct parPacket_t{
 	int32_t rsuLongitude;//prcsWSM으로부터 받은 경도
 	int16_t rxPower; //prcsWSM으로부터 받은 RXPOWER int16_t short int 2Byte
 	uint8_t rcpi; // prcsWSM으로부터 받은 rcpi uint8_t unsigned char 1Byte
+	bool hasSeq; //일련번호/송신시각 포함 여부 (이전 버전 송신기는 포함하지 않음)
+	uint32_t seq; //프로브 일련번호
+	uint64_t txTime; //프로브 송신시각 (usec)
+	uint64_t rxTime; //prcsWSM으로부터 받은 수신시각 (usec, prcsWSM 수신 콜백 시점의 CLOCK_REALTIME)
+	uint64_t time; //보고 구간/위치 추정에 쓰는 수신시각 (usec, par_TimeCorrect()로 보정, 수신시각이 없으면 처리시각)
+	uint8_t ifIdx; //수신 인터페이스 (이전 버전 prcsWSM은 0)
+	uint8_t channel; //수신 채널번호 (이전 버전 prcsWSM은 0)
 
 };
 
-/* 통신성능 측정 프로그램에 사용될 정보 */
+/* 스트리밍 통계 - 모든 수신 패킷에 대해 고정 메모리, 패킷 당 O(1)로 갱신된다. */
+struct parStat_t{
+	uint32_t n; //샘플 수
+	int32_t min;
+	int32_t max;
+	int32_t last;
+	double mean; //Welford 평균
+	double m2; //Welford 편차 제곱합
+	uint32_t hist[PAR_HIST_BIN]; //백분위수 계산용 히스토그램 (샘플 수(n)와 같은 폭이므로 넘치지 않는다)
+	uint32_t under; //히스토그램 범위보다 작아 0번 구간에 누적된 샘플 수
+	uint32_t over; //히스토그램 범위보다 커서 마지막 구간에 누적된 샘플 수
+};
+
+/* 보고 구간 별 일련번호 통계 */
+struct parSeqWin_t{
+	uint32_t rcv; //순서대로 수신된 수 (최대 일련번호 갱신)
+	int32_t lost; //일련번호 공백으로 판정한 손실 수 (이전 구간 손실이 늦게 도착하면 감소)
+	uint32_t reorder; //늦게 도착한(순서가 바뀐) 수
+	uint32_t dup; //중복 수신 수
+	uint32_t burst; //연속 손실 구간(버스트) 수
+};
+
+/* 보고 구간(에포크) 별 수신 통계 - 수신 쓰레드만 기록하고, 에포크 교체 후 보고 쓰레드만 읽는다. */
+struct parWindow_t{
+	uint32_t cnt; //수신 수
+	struct parStat_t rxpower; //RXPOWER 통계
+	struct parStat_t rcpi; //RCPI 통계
+	struct parSeqWin_t seq; //일련번호 통계
+	struct parStat_t latency; //단방향 지연시간 통계 (usec)
+	double jitter; //구간 마지막 지연 지터 추정값 (usec)
+};
+
+/* 마지막 보고 구간의 손실/순서 통계
+ * Gilbert-Elliott 2상태 모델 (Good 상태 손실률 0, Bad 상태 손실률 1)
+ * p : Good -> Bad 전이확률, r : Bad -> Good 전이확률 */
+struct parSeqReport_t{
+	uint32_t rcv; //수신 수 (순서대로 + 늦게 도착)
+	uint32_t lost; //손실 수
+	uint32_t reorder;
+	uint32_t dup;
+	uint32_t burst;
+	double lossRate; //손실률 (%)
+	double geP;
+	double geR;
+	double burstLen; //평균 버스트 길이 (1/r)
+};
+
+/* 통신성능 측정 프로그램에 사용될 정보 - (RSU, 채널, 인터페이스) 링크 별 */
 struct parInfo_t{
 	/*uint32_t*/ bool check;// 이벤트 번호
 	int rsuID;//prcsWSM으로부터 받은 RSU_ID
+	uint8_t channel; //수신 채널번호
+	uint8_t ifIdx; //수신 인터페이스
 	int32_t rsuLatitude; //prcsWSM으로부터 받은 위도 int32_t int; 4Byte
 	int32_t rsuLongitude;//prcsWSM으로부터 받은 경도
-	int16_t rxpower[10]; //prcsWSM으로부터 받은 RXPOWER int16_t short int 2Byte
-	//int16_t rxpower2;
-	//uint8_t rcpi2;
-	uint8_t rcpi[10]; // prcsWSM으로부터 받은 rcpi uint8_t unsigned char 1Byte
-	int arrayIdx;
+	struct parWindow_t win[2]; //에포크 별 수신 통계 (RXPOWER, RCPI, COUNT)
 	int32_t obuLatitude; //OBU 위도
 	int32_t obuLongitude; //OBU 경도
 	double obuHeading; //방면
 	double obuSpeed; //속도
 	uint32_t interval; //수신주기
 	double distance; //거리
-	uint32_t cnt; //COUNT
 	uint32_t maxPAR; //최대PAR
 	uint32_t curPAR; //현재 PAR
 	struct parInfo_t *next;
-	int pastArrayidx;
-	double calculateData[8]; //min, max avr, last <- rxpower, rcpi
+	double calculateData[PAR_CALC_NUM]; //마지막 보고 구간의 통계 (PAR_CALC_* 인덱스 참조)
+	bool seqValid; //일련번호 수신 여부
+	uint32_t seqHigh; //수신한 최대 일련번호
+	uint32_t seqMap[PAR_SEQ_MAP_WORDS]; //seqHigh 이하 최근 PAR_SEQ_WIN 개 일련번호의 수신 비트맵
+	struct parSeqReport_t seqReport; //마지막 보고 구간의 손실/순서 통계
+	bool latValid; //이전 지연(transit) 유효 여부
+	int64_t latTransit; //이전 패킷의 수신시각 - 송신시각 (usec)
+	double latJitter; //지연 지터 추정값 (RFC 3550, 수신 쓰레드만 갱신)
+	uint32_t latCnt; //마지막 보고 구간의 지연시간 샘플 수
+	uint32_t latOver; //마지막 보고 구간에서 지연시간 히스토그램 범위(PAR_HIST_LAT_*)를 넘은 샘플 수
+	bool inUse; //슬랩에서 할당됨 (수신 루프)
+	uint32_t heard; //마지막 수신 시의 보고 번호 (수신 루프, 최대 RSU 수 초과 시 가장 오래 수신하지 않은 노드 선택)
+	bool evictReq; //최대 RSU 수 초과로 퇴출 요청 (수신 루프가 설정, 보고 쓰레드가 퇴출)
+	uint32_t idle; //연속 미수신 보고 구간 수 (보고 쓰레드)
+	uint64_t firstHeard; //처음 수신한 보고시각 (usec)
+	uint64_t lastHeard; //마지막 수신한 보고시각 (usec)
+	uint64_t totalCnt; //누적 수신 수
+	uint64_t totalLost; //누적 손실 수
+	uint32_t heardWin; //수신이 있었던 보고 구간 수
+	uint32_t bestPAR; //보고 구간 최대 PAR
+};
+
+/* 퇴출 RSU 이력 - 퇴출 시 노드 대신 남기는 요약 */
+struct parHistory_t{
+	int rsuID;
+	uint8_t channel;
+	uint8_t ifIdx;
+	int32_t rsuLatitude;
+	int32_t rsuLongitude;
+	uint64_t firstHeard; //usec
+	uint64_t lastHeard; //usec
+	uint64_t totalCnt;
+	uint64_t totalLost;
+	uint32_t heardWin;
+	uint32_t bestPAR;
+	bool evicted; //최대 RSU 수 초과로 퇴출 (아니면 미수신 퇴출)
 };
 
 /* 통신성능측정 프로그램에 사용될 인자 값 및 변수들 */
@@ -110,22 +246,49 @@ struct parMib
 
 	/* 송신 인자값 */
 	int rsuID;
+	uint8_t priority; //prcsWSM 송신 우선순위
+	uint32_t lifetime; //prcsWSM 송신 유효기간(msec)
+	uint8_t ifindex; //prcsWSM 송신 인터페이스
 	
 	/* 수신 인자값 */
 	uint32_t cycle; //ms 주기
 	uint32_t Information; //Information 쓰레드 사용 여부
 	//uint32_t rsuNum; //RSU 개수
+	uint32_t rsuAge; //연속 미수신 보고 구간 수가 이 값이 되면 RSU 퇴출 (0이면 퇴출하지 않음)
+	uint32_t rsuMax; //최대 RSU 수 (초과 시 가장 오래 수신하지 않은 RSU 퇴출)
 	
 	/* 송수신 인자값 */
 	int32_t Latitude; //위도
 	int32_t Longitude; //경도
+	bool gpsTime; //송수신 시각을 GPS 시각으로 보정
+	int32_t latOffset; //단방향 지연시간 고정 보정값(usec) - 같은 호스트에서 보정모드로 측정
+	bool latCalib; //단방향 지연시간 보정모드 (보정값을 적용하지 않고 최소 지연을 출력)
+
+	/* 바이너리 로그 인자값 (-w dir[:size[:files]]) */
+	char logDir[128]; //로그 디렉터리, 비어 있으면 사용하지 않음
+	uint32_t logSize; //파일 최대 크기 (MByte)
+	uint32_t logFiles; //유지할 파일 수
+
+	/* 커버리지 지도 인자값 (-m file[:tile[:tiles[:period]]]) */
+	char geoFile[128]; //지도 CSV 파일, 비어 있으면 사용하지 않음
+	uint32_t geoTile; //타일 크기 (m)
+	uint32_t geoTiles; //최대 타일 수
+	uint32_t geoPeriod; //변경 타일 내보내기 주기 (sec)
+
+	/* 실시간 조회 인자값 (-q path) */
+	char qrySock[108]; //조회 UNIX 소켓 경로, 비어 있으면 사용하지 않음
+
+	/* 캡처/재생 인자값 (-C file, -R file[:speed]) */
+	char capFile[128]; //캡처 파일, 비어 있으면 사용하지 않음
+	char replayFile[128]; //재생 파일, 비어 있으면 메시지 큐와 gpsd를 사용
+	double replaySpeed; //재생 배속 (1 : 실시간, 0 : 제한 없음)
+
+	/* 차량군 보고 인자값 (-F host:port[:obuID] 또는 /path[:obuID]) */
+	char fleetDest[128]; //집계 서버 주소, 비어 있으면 사용하지 않음
 
 
 	/* 타이머 변수 */
 	uint32_t    interval;
-	timer_t     timer;
-	pthread_mutex_t txMtx;
-	pthread_cond_t txCond;
 
 	/*디버그 변수 */
 	uint32_t    dbg;
@@ -170,15 +333,14 @@ static void* gpsdThread(void *notused);
 /* PAR-RX.c */
 int par_InitRXoperation();
 void par_RXoperation();
-void createNode(/*linkedList *L*/);
+struct parInfo_t* createNode(int rsuID, uint8_t channel, uint8_t ifIdx);
 void freeAllNode();
 void par_Report(void);
-long double ldCaldistance(uint32_t rlo, uint32_t rla, uint32_t olo, uint32_t ola);
+long double ldCaldistance(int32_t rlo, int32_t rla, int32_t olo, int32_t ola);
 static void* rxThread(void *notused);
 static void* userSelectThread(void *notused);
-struct parInfo_t* getNode(int index);
-void getCalDataRcpi(uint8_t* array, int arrayIdx, double* saveArray); //int mode);
-void getCalDataRxpower(int16_t* array, int arrayIdx, double* saveArray); //int mode);
+struct parInfo_t* getNode(int rsuID, uint8_t channel, uint8_t ifIdx);
+void getCalData(const struct parStat_t *stat, int32_t offset, int32_t width, double *basic, double *ext);
 bool isThereRSUID(int rsuID);
 void setZeroParInfo(struct parInfo_t* ptr);
 
@@ -186,13 +348,63 @@ void setZeroParInfo(struct parInfo_t* ptr);
 int initMQ(void);
 void releaseMQ(void);
 int recvMQ(char *pkt);
-void sendMQ(uint8_t *pPkt, uint32_t len);
+int sendMQ(uint8_t *pPkt, uint32_t len);
+
+/* PAR_LOG.c */
+int par_LogInit(void);
+void par_LogPut(const struct parInfo_t *node, uint32_t cnt, uint64_t start, uint64_t end);
+void par_LogFlush(void);
+void par_LogClose(void);
+
+/* PAR_GEO.c */
+int par_GeoInit(void);
+void par_GeoUpdate(const struct parInfo_t *node, const struct parPacket_t *pkt, int32_t lost);
+void par_GeoClose(void);
+
+/* PAR_QRY.c */
+int par_QueryInit(void);
+void par_QueryBegin(uint64_t start, uint64_t end);
+void par_QueryPut(const struct parInfo_t *node, uint32_t cnt);
+void par_QueryPublish(void);
+void par_QueryClose(void);
+
+/* PAR_TIME.c */
+void par_TimeUpdateGps(const struct gps_data_t *gps);
+uint64_t par_TimeNow(void);
+uint64_t par_TimeCorrect(uint64_t usec);
+void par_TimeReplay(uint64_t now, int64_t offset);
+
+/* PAR_GNSS.c */
+int par_GnssInit(void);
+int par_GnssPosition(uint64_t time, struct obuInfo_t *obu);
+void par_GnssFeed(const struct gps_fix_t *fix);
+void par_GnssClose(void);
+
+/* PAR_FLEET.c */
+int par_FleetInit(void);
+void par_FleetBegin(uint64_t start, uint64_t end);
+void par_FleetPut(const struct parInfo_t *node, uint32_t cnt);
+void par_FleetFlush(void);
+void par_FleetClose(void);
+
+/* PAR_CAP.c */
+int par_CapInit(void);
+void par_CapPacket(const uint8_t *buf, uint32_t len);
+void par_CapFix(const struct gps_fix_t *fix);
+void par_CapClose(void);
+int par_ReplayInit(void);
+int par_ReplayRecv(uint8_t *buf);
+void par_ReplayClose(void);
+
+/* PAR_DIST.c */
+void par_DistanceBatch(int32_t obuLat, int32_t obuLon, const int32_t *rsuLat, const int32_t *rsuLon, double *dist, int n);
+
+/* PAR_SEQ.c */
+void par_SeqUpdate(struct parInfo_t *node, struct parSeqWin_t *win, uint32_t seq);
+void par_SeqReport(struct parInfo_t *node, const struct parSeqWin_t *win);
 
 /* shm.c */
 int32_t InitShm(int* shmid, char **shmPtr);
 int32_t ReleaseShm(char *shmPtr);
 
-/* timer.c */
-static void TxTimerExpired(union sigval arg);
-int InitTxTimer(const uint32_t interval);
 #endif //PAR_PAR_H
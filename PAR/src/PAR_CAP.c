@@ -0,0 +1,399 @@
+/**********************************************************
+  [입력 캡처 / 재생]
+  캡처(-C file) : 수신 루프가 받은 메시지(prcsWSM -> PAR 원본)와 GNSS 쓰레드가 받은 fix를 받은 시각 순서대로 파일에 기록한다.
+  재생(-R file[:speed]) : 메시지 큐와 gpsd 대신 캡처 파일을 입력으로 사용한다.
+    수신 루프는 recvMQ() 대신 par_ReplayRecv()로 메시지를 받아 같은 경로(par_ParsePacket() 이후)로 처리하고,
+    fix는 GNSS 이력에 넣는다. (par_GnssFeed())
+    시각(par_TimeNow(), par_TimeCorrect())은 캡처 시각으로 대체되며, 보고(par_Report())는 보고 쓰레드 대신
+    재생 시각이 보고 구간 끝을 지날 때 수신 루프에서 호출한다. 따라서 배속과 무관하게 같은 결과가 나온다.
+    speed 1 : 실시간, N : N배속, 0 : 제한 없음 (수신/보고 처리 성능 측정)
+
+  [파일]
+  헤더(parCapHdr_t) + 레코드(parCapRec_t + 내용) 배열
+  레코드 시각은 캡처 시 par_TimeNow() 값이며, 보정값(offset)은 캡처 시 par_TimeCorrect()가 더하던 값이다.
+ ************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <PAR.h>
+
+#define PAR_CAP_MAGIC "PARCAP1" //파일 식별자 (8Byte, NULL 포함)
+#define PAR_CAP_VERSION 1
+#define PAR_CAP_BUF (1024 * 1024) //캡처 파일 stdio 버퍼 크기
+
+enum{
+	PAR_CAP_PKT = 1, //수신 메시지 (recvMQ() 원본)
+	PAR_CAP_FIX = 2, //GNSS fix (parCapFix_t)
+};
+
+/* 파일 헤더 */
+struct parCapHdr_t{
+	char magic[8]; //PAR_CAP_MAGIC
+	uint32_t version; //PAR_CAP_VERSION
+	uint32_t interval; //캡처 시 보고주기 (usec, 참고용)
+	uint64_t startTime; //캡처 시작시각 (usec)
+} __attribute__((__packed__));
+
+/* 레코드 헤더 - 뒤에 len Byte 내용이 붙는다. */
+struct parCapRec_t{
+	uint8_t type; //PAR_CAP_PKT, PAR_CAP_FIX
+	uint8_t reserved;
+	uint16_t len; //내용 길이
+	uint64_t time; //받은 시각 (usec, par_TimeNow())
+	int64_t offset; //GPS 시각 보정값 (usec)
+} __attribute__((__packed__));
+
+/* GNSS fix 내용 */
+struct parCapFix_t{
+	double time; //fix 시각 (sec)
+	double latitude;
+	double longitude;
+	double speed; //m/s
+	double track; //도
+} __attribute__((__packed__));
+
+/* 캡처 - 수신 쓰레드와 GNSS 쓰레드가 기록한다. */
+struct parCap_t{
+	FILE *fp;
+	char *buf;
+	pthread_mutex_t mtx;
+	uint64_t pktNum;
+	uint64_t fixNum;
+};
+
+/* 재생 - 수신 쓰레드 전용 */
+struct parReplay_t{
+	FILE *fp;
+	double speed; //배속 (0이면 제한 없음)
+	uint64_t firstTime; //첫 레코드 시각
+	uint64_t lastTime; //마지막 레코드 시각
+	struct timespec wallStart; //재생 시작 (CLOCK_MONOTONIC)
+	uint64_t pktNum;
+	uint64_t fixNum;
+};
+
+static struct parCap_t *g_parCap;
+static struct parReplay_t *g_parReplay;
+
+
+/**
+ * par_CapInit()
+ * 캡처 파일을 생성한다. (-C 옵션이 없으면 아무것도 하지 않는다)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int par_CapInit(void)
+{
+	struct parCap_t *g;
+	struct parCapHdr_t hdr;
+
+	if(g_mib.capFile[0] == '\0')
+		return 0;
+
+	g = (struct parCap_t*)calloc(1, sizeof(struct parCap_t));
+	if(g == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_CAP] Fail to allocate capture buffer\n");
+		return -1;
+	}
+	g->fp = fopen(g_mib.capFile, "wb");
+	if(g->fp == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_CAP] Fail to open %s : %s\n", g_mib.capFile, strerror(errno));
+		free(g);
+		return -1;
+	}
+	g->buf = malloc(PAR_CAP_BUF);
+	if(g->buf != NULL)
+		setvbuf(g->fp, g->buf, _IOFBF, PAR_CAP_BUF);
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, PAR_CAP_MAGIC, sizeof(hdr.magic));
+	hdr.version = PAR_CAP_VERSION;
+	hdr.interval = g_mib.interval;
+	hdr.startTime = par_TimeNow();
+	if(fwrite(&hdr, sizeof(hdr), 1, g->fp) != 1)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_CAP] Fail to write %s : %s\n", g_mib.capFile, strerror(errno));
+		fclose(g->fp);
+		free(g->buf);
+		free(g);
+		return -1;
+	}
+	pthread_mutex_init(&g->mtx, NULL);
+	g_parCap = g;
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_CAP] Capture to %s\n", g_mib.capFile);
+	return 0;
+}
+
+/**
+ * par_CapWrite()
+ * 레코드 하나를 기록한다.
+ */
+static void par_CapWrite(struct parCap_t *g, uint8_t type, const void *data, uint16_t len)
+{
+	struct parCapRec_t rec;
+
+	rec.type = type;
+	rec.reserved = 0;
+	rec.len = len;
+	rec.time = par_TimeNow();
+	rec.offset = (int64_t)par_TimeCorrect(0);
+
+	pthread_mutex_lock(&g->mtx);
+	if(g->fp != NULL)
+	{
+		fwrite(&rec, sizeof(rec), 1, g->fp);
+		fwrite(data, len, 1, g->fp);
+	}
+	pthread_mutex_unlock(&g->mtx);
+}
+
+/**
+ * par_CapPacket()
+ * 수신 메시지를 기록한다. (수신 쓰레드, recvMQ() 직후)
+ */
+void par_CapPacket(const uint8_t *buf, uint32_t len)
+{
+	struct parCap_t *g = g_parCap;
+
+	if(g == NULL || len > UINT16_MAX)
+		return;
+	par_CapWrite(g, PAR_CAP_PKT, buf, (uint16_t)len);
+	g->pktNum++;
+}
+
+/**
+ * par_CapFix()
+ * GNSS fix를 기록한다. (GNSS 쓰레드, 새 fix를 이력에 넣을 때)
+ */
+void par_CapFix(const struct gps_fix_t *fix)
+{
+	struct parCap_t *g = g_parCap;
+	struct parCapFix_t f;
+
+	if(g == NULL)
+		return;
+	f.time = fix->time;
+	f.latitude = fix->latitude;
+	f.longitude = fix->longitude;
+	f.speed = fix->speed;
+	f.track = fix->track;
+	par_CapWrite(g, PAR_CAP_FIX, &f, sizeof(f));
+	g->fixNum++;
+}
+
+/**
+ * par_CapClose()
+ * 캡처 파일을 닫는다. (GNSS 쓰레드 종료 후)
+ */
+void par_CapClose(void)
+{
+	struct parCap_t *g = g_parCap;
+
+	if(g == NULL)
+		return;
+	g_parCap = NULL;
+	fclose(g->fp);
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_CAP] Captured %llu packets, %llu fixes\n",
+			(unsigned long long)g->pktNum, (unsigned long long)g->fixNum);
+	pthread_mutex_destroy(&g->mtx);
+	free(g->buf);
+	free(g);
+}
+
+/**
+ * par_ReplayReadRec()
+ * 다음 레코드 헤더를 읽는다.
+ * @return 성공 시 0, 파일 끝 또는 잘못된 레코드이면 -1
+ */
+static int par_ReplayReadRec(struct parReplay_t *g, struct parCapRec_t *rec)
+{
+	if(fread(rec, sizeof(*rec), 1, g->fp) != 1)
+		return -1;
+	if((rec->type == PAR_CAP_PKT && rec->len > BUFSIZE) ||
+			(rec->type == PAR_CAP_FIX && rec->len != sizeof(struct parCapFix_t)))
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_CAP] Invalid record (type %u, len %u)\n", rec->type, rec->len);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * par_ReplayInit()
+ * 재생 파일을 열고 재생 시각을 캡처 시작시각으로 맞춘다. (-R 옵션이 없으면 아무것도 하지 않는다)
+ * 보고 구간 초기화 전에 호출해야 한다. 캡처 시작시각은 캡처 시 보고 구간 초기화 직전 시각이므로,
+ * 첫 보고 구간(시작 시점의 부분 구간은 보고하지 않음)이 캡처 때와 같아진다.
+ * @return 성공 시 0, 실패 시 -1
+ */
+int par_ReplayInit(void)
+{
+	struct parReplay_t *g;
+	struct parCapHdr_t hdr;
+	struct parCapRec_t rec;
+
+	if(g_mib.replayFile[0] == '\0')
+		return 0;
+
+	g = (struct parReplay_t*)calloc(1, sizeof(struct parReplay_t));
+	if(g == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_CAP] Fail to allocate replay buffer\n");
+		return -1;
+	}
+	g->fp = fopen(g_mib.replayFile, "rb");
+	if(g->fp == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_CAP] Fail to open %s : %s\n", g_mib.replayFile, strerror(errno));
+		free(g);
+		return -1;
+	}
+	if(fread(&hdr, sizeof(hdr), 1, g->fp) != 1 || memcmp(hdr.magic, PAR_CAP_MAGIC, sizeof(hdr.magic)) != 0 ||
+			hdr.version != PAR_CAP_VERSION)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_CAP] %s is not a capture file\n", g_mib.replayFile);
+		fclose(g->fp);
+		free(g);
+		return -1;
+	}
+
+	/* 캡처 시작시각으로 재생 시각 설정 (보정값은 첫 레코드 값) */
+	if(par_ReplayReadRec(g, &rec) < 0)
+		rec.time = hdr.startTime, rec.offset = 0;
+	fseek(g->fp, sizeof(hdr), SEEK_SET);
+	if(hdr.startTime > rec.time)
+		hdr.startTime = rec.time;
+	g->firstTime = g->lastTime = hdr.startTime;
+	g->speed = g_mib.replaySpeed;
+	par_TimeReplay(hdr.startTime, rec.offset);
+	clock_gettime(CLOCK_MONOTONIC, &g->wallStart);
+	g_parReplay = g;
+
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_CAP] Replay %s (speed %.2f, captured with %u usec window)\n",
+			g_mib.replayFile, g->speed, hdr.interval);
+	return 0;
+}
+
+/**
+ * par_ReplayWait()
+ * 배속에 맞춰 레코드 시각까지 대기한다.
+ */
+static void par_ReplayWait(struct parReplay_t *g, uint64_t time)
+{
+	struct timespec ts;
+	uint64_t usec;
+
+	if(g->speed <= 0 || time <= g->firstTime)
+		return;
+	usec = (uint64_t)((double)(time - g->firstTime) / g->speed);
+	ts.tv_sec = g->wallStart.tv_sec + usec / 1000000;
+	ts.tv_nsec = g->wallStart.tv_nsec + (usec % 1000000) * 1000;
+	if(ts.tv_nsec >= 1000000000)
+	{
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !ending)
+		;
+}
+
+/**
+ * par_ReplayEnd()
+ * 마지막 보고 구간까지 보고하고 재생 결과를 출력한 후 종료를 요청한다.
+ */
+static void par_ReplayEnd(struct parReplay_t *g)
+{
+	struct timespec now;
+	double wall, span;
+
+	par_TimeReplay((g->lastTime / g_mib.interval + 1) * g_mib.interval + PAR_WIN_GUARD, (int64_t)par_TimeCorrect(0));
+	par_Report();
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	wall = (now.tv_sec - g->wallStart.tv_sec) + (now.tv_nsec - g->wallStart.tv_nsec) / 1e9;
+	span = (g->lastTime - g->firstTime) / 1e6;
+	printf("Replay done : %llu packets, %llu fixes, %.3f sec captured, %.3f sec elapsed (x%.1f, %.0f packets/sec)\n",
+			(unsigned long long)g->pktNum, (unsigned long long)g->fixNum, span, wall,
+			wall > 0 ? span / wall : 0.0, wall > 0 ? g->pktNum / wall : 0.0);
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_CAP] Replay done : %llu packets, %llu fixes, %.3f sec captured, %.3f sec elapsed\n",
+			(unsigned long long)g->pktNum, (unsigned long long)g->fixNum, span, wall);
+	ending = 1;
+}
+
+/**
+ * par_ReplayRecv()
+ * recvMQ() 대신 캡처 파일에서 다음 수신 메시지를 읽는다. (수신 쓰레드)
+ * 그 사이의 fix는 GNSS 이력에 넣고, 재생 시각이 지난 보고 구간은 보고한다.
+ * @param buf 메시지 버퍼 (BUFSIZE)
+ * @return 메시지 길이, 파일 끝이면 -1 (종료 요청)
+ */
+int par_ReplayRecv(uint8_t *buf)
+{
+	struct parReplay_t *g = g_parReplay;
+	struct parCapRec_t rec;
+	struct parCapFix_t f;
+	struct gps_fix_t fix;
+
+	if(g == NULL)
+		return -1;
+
+	while(!ending)
+	{
+		if(par_ReplayReadRec(g, &rec) < 0)
+		{
+			par_ReplayEnd(g);
+			return -1;
+		}
+		if(rec.time < g->lastTime)
+			rec.time = g->lastTime;
+		par_ReplayWait(g, rec.time);
+
+		/* 재생 시각 진행 - 끝난 보고 구간 보고 */
+		par_TimeReplay(rec.time, rec.offset);
+		g->lastTime = rec.time;
+		par_Report();
+
+		if(rec.type == PAR_CAP_PKT)
+		{
+			if(fread(buf, 1, rec.len, g->fp) != rec.len)
+				continue;
+			g->pktNum++;
+			return rec.len;
+		}
+		else if(rec.type == PAR_CAP_FIX)
+		{
+			if(fread(&f, sizeof(f), 1, g->fp) != 1)
+				continue;
+			memset(&fix, 0, sizeof(fix));
+			fix.mode = MODE_2D;
+			fix.time = f.time;
+			fix.latitude = f.latitude;
+			fix.longitude = f.longitude;
+			fix.speed = f.speed;
+			fix.track = f.track;
+			par_GnssFeed(&fix);
+			g->fixNum++;
+		}
+		else
+			fseek(g->fp, rec.len, SEEK_CUR);
+	}
+	return -1;
+}
+
+/**
+ * par_ReplayClose()
+ * 재생 파일을 닫는다.
+ */
+void par_ReplayClose(void)
+{
+	struct parReplay_t *g = g_parReplay;
+
+	if(g == NULL)
+		return;
+	g_parReplay = NULL;
+	fclose(g->fp);
+	free(g);
+}
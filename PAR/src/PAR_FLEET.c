@@ -0,0 +1,245 @@
+/**********************************************************
+  [차량군 보고]
+  보고 구간마다 수신이 있었던 RSU의 통계를 집계 서버(tools/parfleet)로 보낸다. (-F 옵션)
+  형식은 PAR_FLEET.h 참조. 데이터그램 하나에 최대 PAR_FLEET_ENTRY_MAX 개 RSU를 담는다.
+
+  보고 쓰레드가 직접 보내며, 소켓은 논블로킹이므로 송신 버퍼가 가득 차면 보내지 않고 센다.
+  (집계 서버가 없거나 느려도 보고가 늦어지지 않는다)
+
+  목적지
+    host:port[:obuID]  : UDP
+    /path[:obuID]      : UNIX 데이터그램 소켓
+  obuID를 주지 않으면 gethostid() 값을 사용한다.
+ ************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <PAR.h>
+#include <PAR_FLEET.h>
+
+struct parFleet_t{
+	int fd;
+	struct sockaddr_storage addr;
+	socklen_t addrLen;
+	uint32_t obuID;
+	uint32_t seq; //보낸 데이터그램 수
+	uint32_t drop; //보내지 못한 데이터그램 수
+	uint32_t dropReported;
+
+	/* 작성 중인 데이터그램 (보고 쓰레드) */
+	uint8_t buf[PAR_FLEET_DGRAM_MAX];
+	struct parFleetHdr_t *hdr;
+	struct parFleetEntry_t *entry;
+};
+
+static struct parFleet_t *g_parFleet;
+
+
+/**
+ * par_FleetAddr()
+ * -F 목적지 문자열을 주소와 obuID로 변환한다.
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int par_FleetAddr(struct parFleet_t *g, const char *dest)
+{
+	char str[sizeof(g_mib.fleetDest)];
+	char *host, *port, *id;
+	struct addrinfo hints, *res;
+	int ret;
+
+	strncpy(str, dest, sizeof(str) - 1);
+	str[sizeof(str) - 1] = '\0';
+
+	/* UNIX 데이터그램 소켓 */
+	if(str[0] == '/')
+	{
+		struct sockaddr_un *un = (struct sockaddr_un*)&g->addr;
+
+		id = strrchr(str, ':');
+		if(id != NULL)
+			*id++ = '\0';
+		if(strlen(str) >= sizeof(un->sun_path))
+			return -1;
+		un->sun_family = AF_UNIX;
+		strcpy(un->sun_path, str);
+		g->addrLen = sizeof(struct sockaddr_un);
+	}
+	/* UDP */
+	else
+	{
+		host = str;
+		port = strchr(str, ':');
+		if(port == NULL)
+			return -1;
+		*port++ = '\0';
+		id = strchr(port, ':');
+		if(id != NULL)
+			*id++ = '\0';
+
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_DGRAM;
+		ret = getaddrinfo(host, port, &hints, &res);
+		if(ret != 0)
+		{
+			syslog(LOG_ERR | LOG_LOCAL5, "[PAR_FLEET] Fail to resolve %s:%s : %s\n", host, port, gai_strerror(ret));
+			return -1;
+		}
+		memcpy(&g->addr, res->ai_addr, res->ai_addrlen);
+		g->addrLen = res->ai_addrlen;
+		freeaddrinfo(res);
+	}
+
+	g->obuID = (id != NULL && *id != '\0') ? (uint32_t)strtoul(id, NULL, 10) : (uint32_t)gethostid();
+	return 0;
+}
+
+/**
+ * par_FleetInit()
+ * 차량군 보고 소켓을 생성한다. (-F 옵션이 없으면 아무것도 하지 않는다)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int par_FleetInit(void)
+{
+	struct parFleet_t *g;
+
+	if(g_mib.fleetDest[0] == '\0')
+		return 0;
+
+	g = (struct parFleet_t*)calloc(1, sizeof(struct parFleet_t));
+	if(g == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_FLEET] Fail to allocate fleet buffer\n");
+		return -1;
+	}
+	if(par_FleetAddr(g, g_mib.fleetDest) < 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_FLEET] Invalid fleet destination %s\n", g_mib.fleetDest);
+		free(g);
+		return -1;
+	}
+	g->fd = socket(g->addr.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(g->fd < 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_FLEET] Fail to create socket : %s\n", strerror(errno));
+		free(g);
+		return -1;
+	}
+	g->hdr = (struct parFleetHdr_t*)g->buf;
+	g->entry = (struct parFleetEntry_t*)(g->buf + sizeof(struct parFleetHdr_t));
+	g_parFleet = g;
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_FLEET] Report to %s (obuID %u)\n", g_mib.fleetDest, g->obuID);
+	return 0;
+}
+
+/**
+ * par_FleetSend()
+ * 작성한 데이터그램을 보내고 항목 수를 0으로 되돌린다.
+ */
+static void par_FleetSend(struct parFleet_t *g)
+{
+	size_t len = sizeof(struct parFleetHdr_t) + g->hdr->num * sizeof(struct parFleetEntry_t);
+
+	g->hdr->seq = g->seq++;
+	if(sendto(g->fd, g->buf, len, 0, (struct sockaddr*)&g->addr, g->addrLen) < 0)
+		g->drop++;
+	g->hdr->num = 0;
+}
+
+/**
+ * par_FleetBegin()
+ * 보고 구간의 데이터그램 작성을 시작한다. (par_Report() 시작 시)
+ * @param start, end 보고 구간 시작/끝시각 (usec)
+ */
+void par_FleetBegin(uint64_t start, uint64_t end)
+{
+	struct parFleet_t *g = g_parFleet;
+
+	if(g == NULL)
+		return;
+	g->hdr->magic = PAR_FLEET_MAGIC;
+	g->hdr->version = PAR_FLEET_VERSION;
+	g->hdr->num = 0;
+	g->hdr->obuID = g->obuID;
+	g->hdr->start = start;
+	g->hdr->end = end;
+}
+
+/**
+ * par_FleetPut()
+ * RSU 보고 구간 통계를 항목으로 추가한다. 데이터그램이 가득 차면 보낸다. (보고 쓰레드)
+ * @param cnt 보고 구간 수신 수
+ */
+void par_FleetPut(const struct parInfo_t *node, uint32_t cnt)
+{
+	struct parFleet_t *g = g_parFleet;
+	struct parFleetEntry_t *e;
+	const double *c = node->calculateData;
+
+	if(g == NULL)
+		return;
+
+	e = &g->entry[g->hdr->num];
+	e->rsuID = node->rsuID;
+	e->channel = node->channel;
+	e->ifIdx = node->ifIdx;
+	e->rsv = 0;
+	e->rsuLatitude = node->rsuLatitude;
+	e->rsuLongitude = node->rsuLongitude;
+	e->obuLatitude = node->obuLatitude;
+	e->obuLongitude = node->obuLongitude;
+	e->distance = (float)node->distance;
+	e->cnt = cnt;
+	e->expected = (node->interval != 0) ? g_mib.interval / (node->interval * 1000) : 0;
+	e->seqRcv = node->seqReport.rcv;
+	e->seqLost = node->seqReport.lost;
+	e->rxpowerMin = (float)c[PAR_CALC_RXPOWER];
+	e->rxpowerMax = (float)c[PAR_CALC_RXPOWER + 1];
+	e->rxpowerAvg = (float)c[PAR_CALC_RXPOWER + 2];
+	e->rcpiAvg = (float)c[PAR_CALC_RCPI + 2];
+	e->latCnt = node->latCnt;
+	e->latAvg = (float)c[PAR_CALC_LAT + 2];
+	if(++g->hdr->num == PAR_FLEET_ENTRY_MAX)
+		par_FleetSend(g);
+}
+
+/**
+ * par_FleetFlush()
+ * 남은 항목을 보낸다. (par_Report() 끝, 블로킹하지 않음)
+ */
+void par_FleetFlush(void)
+{
+	struct parFleet_t *g = g_parFleet;
+
+	if(g == NULL)
+		return;
+	if(g->hdr->num != 0)
+		par_FleetSend(g);
+	if(g->drop != g->dropReported)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_FLEET] Fail to send %u datagrams\n", g->drop - g->dropReported);
+		g->dropReported = g->drop;
+	}
+}
+
+/**
+ * par_FleetClose()
+ * 차량군 보고 소켓을 닫는다. (보고 쓰레드 종료 후)
+ */
+void par_FleetClose(void)
+{
+	struct parFleet_t *g = g_parFleet;
+
+	if(g == NULL)
+		return;
+	g_parFleet = NULL;
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_FLEET] Sent %u datagrams (%u failed)\n", g->seq, g->drop);
+	close(g->fd);
+	free(g);
+}
@@ -0,0 +1,53 @@
+//
+// PAR 차량군(fleet) 보고 형식
+//  - PAR 수신(par_Report(), -F 옵션)이 보고 구간마다 RSU 별 통계를 데이터그램으로 보내고,
+//    집계 도구(tools/parfleet.c)와 모의 송신 도구(tools/parfleet_sim.c)가 함께 사용한다.
+//  - 데이터그램 하나 = 헤더 + 항목 num 개 (UDP 또는 UNIX 데이터그램 소켓), 리틀엔디언
+//
+
+#ifndef PAR_PAR_FLEET_H
+#define PAR_PAR_FLEET_H
+
+#include <stdint.h>
+
+#define PAR_FLEET_MAGIC 0x544c4650 //"PFLT"
+#define PAR_FLEET_VERSION 2
+#define PAR_FLEET_ENTRY_MAX 32 //데이터그램 당 최대 항목 수 (RSU가 더 많으면 여러 데이터그램으로 나눈다)
+
+/* 데이터그램 헤더 */
+struct parFleetHdr_t{
+	uint32_t magic; //PAR_FLEET_MAGIC
+	uint16_t version; //PAR_FLEET_VERSION
+	uint16_t num; //항목 수
+	uint32_t obuID; //보고 차량 ID
+	uint32_t seq; //차량 별 데이터그램 일련번호
+	uint64_t start; //보고 구간 시작시각 (usec, GPS/UTC 보고주기 경계)
+	uint64_t end; //보고 구간 끝시각 (usec)
+} __attribute__((__packed__));
+
+/* 항목 - (RSU, 채널, 인터페이스) 링크 하나의 보고 구간 통계 */
+struct parFleetEntry_t{
+	int32_t rsuID;
+	uint8_t channel; //수신 채널번호
+	uint8_t ifIdx; //수신 인터페이스
+	uint16_t rsv;
+	int32_t rsuLatitude;
+	int32_t rsuLongitude;
+	int32_t obuLatitude;
+	int32_t obuLongitude;
+	float distance; //m
+	uint32_t cnt; //보고 구간 수신 수
+	uint32_t expected; //보고 구간 기대 수신 수 (보고주기 / 수신주기)
+	uint32_t seqRcv; //일련번호 기준 수신 수
+	uint32_t seqLost; //일련번호 기준 손실 수
+	float rxpowerMin;
+	float rxpowerMax;
+	float rxpowerAvg;
+	float rcpiAvg;
+	uint32_t latCnt; //지연시간 샘플 수
+	float latAvg; //단방향 지연시간 평균 (usec)
+} __attribute__((__packed__));
+
+#define PAR_FLEET_DGRAM_MAX (sizeof(struct parFleetHdr_t) + PAR_FLEET_ENTRY_MAX * sizeof(struct parFleetEntry_t))
+
+#endif //PAR_PAR_FLEET_H
@@ -0,0 +1,544 @@
+/**********************************************************
+  [커버리지 지도 (지리 타일 집계)]
+  수신 패킷마다 OBU 위치가 속한 타일을 찾아 (RSU 링크, 타일) 별 통계를 누적한다.
+  RSU 링크는 수신 노드(PAR_RX.c)와 같은 (rsuID, 채널, 인터페이스)이며, 다중 무선 수신 시 링크 별로 따로 집계한다.
+  드라이브 테스트 시 원시 로그 없이 RSU 링크 별 커버리지 지도(PAR, RXPOWER, RCPI, 손실)를 만들기 위한 것이다.
+
+  [타일]
+  남북 방향 타일 크기(-m 의 tile, 미터)를 위도 간격으로 고정하고,
+  동서 방향은 타일 행 중심 위도의 cos 값으로 경도 간격을 넓혀 타일이 대략 정사각형이 되도록 한다.
+  타일 번호 (tileLat, tileLon) = (floor(위도 / 위도간격), floor(경도 / 행의 경도간격))
+
+  [메모리/갱신]
+  타일은 시작 시 할당한 고정 개수(tiles)의 슬랩에서 할당하며, 체인 해시로 검색한다.
+  사용한 타일은 LRU 리스트 맨 앞으로 옮기고, 슬랩이 가득 차면 가장 오래 사용하지 않은 타일을 내보낸 후 재사용한다.
+  패킷 당 갱신은 해시 검색 + 리스트 이동으로 O(1)이며, 수신 쓰레드만 타일 테이블을 사용한다.
+
+  [내보내기]
+  주기(period)마다 변경된 타일(dirty 리스트)만 내보내기 버퍼로 복사하고, 지도 쓰레드가 CSV 파일에 추가 기록한다.
+  각 줄은 타일이 생성된 후(since)의 누적값이므로 같은 (RSU 링크, 타일, since)는 마지막 줄이 최신값이다.
+  LRU로 내보낸 타일이 다시 사용되면 새 since로 누적을 다시 시작한다. (합산하면 전체값)
+ ************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <PAR.h>
+
+#define PAR_GEO_NONE (-1)
+#define PAR_GEO_LAT_DEG_M 111320.0 //위도 1도 거리(m)
+#define PAR_GEO_INVALID_LAT 900000001 //GPS 무효 시 OBU 위도
+
+/* 타일 누적 통계 - 내보내기 레코드로도 사용한다. */
+struct parGeoStat_t{
+	int32_t rsuID;
+	uint8_t channel; //수신 채널번호
+	uint8_t ifIdx; //수신 인터페이스
+	int32_t tileLat; //타일 번호 (위도 방향)
+	int32_t tileLon; //타일 번호 (경도 방향)
+	uint32_t cnt; //수신 수
+	uint32_t seqCnt; //일련번호가 있는 수신 수
+	int32_t lost; //일련번호 공백으로 판정한 손실 수
+	int64_t rxpowerSum;
+	int16_t rxpowerMin;
+	int16_t rxpowerMax;
+	uint64_t rcpiSum;
+	uint8_t rcpiMin;
+	uint8_t rcpiMax;
+	uint64_t since; //타일 생성시각 (usec)
+	uint64_t last; //마지막 수신시각 (usec)
+};
+
+struct parGeoTile_t{
+	struct parGeoStat_t stat;
+	int32_t hashNext; //해시 체인 (슬랩 인덱스)
+	int32_t lruPrev; //LRU 리스트 (앞쪽이 최근)
+	int32_t lruNext; //LRU 리스트, 빈 타일은 빈 리스트
+	int32_t dirtyNext; //변경 리스트
+	bool dirty; //내보낸 후 변경됨
+	bool inDirty; //변경 리스트에 들어 있음 (LRU로 내보낸 후 재사용된 타일도 리스트에 남아 있을 수 있다)
+};
+
+struct parGeo_t{
+	/* 수신 쓰레드 전용 */
+	struct parGeoTile_t *tiles; //타일 슬랩 (g_mib.geoTiles 개)
+	int32_t *bucket; //해시 버킷 (슬랩 인덱스)
+	uint32_t bucketMask;
+	int32_t lruHead;
+	int32_t lruTail;
+	int32_t freeHead;
+	int32_t dirtyHead;
+	double latStep; //타일 위도 간격 (1e-7도)
+	int32_t lonRow; //경도 간격을 계산한 타일 행
+	double lonStep; //lonRow 행의 타일 경도 간격 (1e-7도)
+	struct timespec nextExport; //다음 내보내기 시각 (CLOCK_MONOTONIC)
+	struct parGeoStat_t *pend; //내보낼 레코드 (수신 쓰레드가 채운다)
+	uint32_t pendNum;
+	uint32_t used; //사용 중인 타일 수
+	uint32_t evict; //LRU로 내보낸 타일 수
+	uint32_t drop; //내보내기 버퍼가 가득 차 버린 타일 수
+
+	/* 지도 쓰레드에 넘긴 레코드 (mtx로 보호) */
+	struct parGeoStat_t *out;
+	uint32_t outNum; //0이 아니면 지도 쓰레드가 기록 중
+	pthread_t thread;
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+	bool running;
+	FILE *fp;
+};
+
+static struct parGeo_t *g_parGeo;
+
+static void* par_GeoThread(void *notused);
+
+
+/**
+ * par_GeoInit()
+ * 커버리지 지도 타일 테이블을 할당하고 지도 쓰레드를 생성한다. (-m 옵션이 없으면 아무것도 하지 않는다)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int par_GeoInit(void)
+{
+	int ret;
+	uint32_t nb;
+	struct parGeo_t *g;
+
+	if(g_mib.geoFile[0] == '\0')
+		return 0;
+
+	if(g_mib.geoTile == 0)
+		g_mib.geoTile = PAR_GEO_DEFAULT_TILE;
+	if(g_mib.geoTiles == 0)
+		g_mib.geoTiles = PAR_GEO_DEFAULT_TILES;
+	if(g_mib.geoPeriod == 0)
+		g_mib.geoPeriod = PAR_GEO_DEFAULT_PERIOD;
+
+	for(nb = 1; nb < g_mib.geoTiles * 2; nb <<= 1)
+		;
+
+	g = (struct parGeo_t*)calloc(1, sizeof(struct parGeo_t));
+	if(g == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_GEO] Fail to allocate tile table\n");
+		return -1;
+	}
+	g->tiles = (struct parGeoTile_t*)calloc(g_mib.geoTiles, sizeof(struct parGeoTile_t));
+	g->bucket = (int32_t*)malloc(sizeof(int32_t) * nb);
+	g->pend = (struct parGeoStat_t*)calloc(g_mib.geoTiles, sizeof(struct parGeoStat_t));
+	g->out = (struct parGeoStat_t*)calloc(g_mib.geoTiles, sizeof(struct parGeoStat_t));
+	g->fp = fopen(g_mib.geoFile, "a");
+	if(g->tiles == NULL || g->bucket == NULL || g->pend == NULL || g->out == NULL || g->fp == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_GEO] Fail to initialize coverage map %s : %s\n", g_mib.geoFile, strerror(errno));
+		goto fail;
+	}
+
+	memset(g->bucket, 0xff, sizeof(int32_t) * nb);
+	g->bucketMask = nb - 1;
+	for(uint32_t i = 0; i < g_mib.geoTiles; i++)
+		g->tiles[i].lruNext = (i + 1 < g_mib.geoTiles) ? (int32_t)(i + 1) : PAR_GEO_NONE;
+	g->freeHead = 0;
+	g->lruHead = g->lruTail = PAR_GEO_NONE;
+	g->dirtyHead = PAR_GEO_NONE;
+	g->latStep = (double)g_mib.geoTile * 1e7 / PAR_GEO_LAT_DEG_M;
+	g->lonRow = INT32_MIN;
+	clock_gettime(CLOCK_MONOTONIC, &g->nextExport);
+	g->nextExport.tv_sec += g_mib.geoPeriod;
+
+	if(ftell(g->fp) == 0)
+	{
+		fprintf(g->fp, "Time, RSUID, Channel, If, TileLat, TileLon, CenterLatitude, CenterLongitude, CNT, SeqCnt, Lost, PAR, Avr_rxpower, Min_rxpower, Max_rxpower, Avr_rcpi, Min_rcpi, Max_rcpi, Since, Last\n");
+		fflush(g->fp);
+	}
+
+	g->running = true;
+	pthread_mutex_init(&g->mtx, NULL);
+	pthread_cond_init(&g->cond, NULL);
+	ret = pthread_create(&g->thread, NULL, par_GeoThread, g);
+	if(ret != 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_GEO] Fail to create map thread() : %s\n", strerror(ret));
+		goto fail;
+	}
+	g_parGeo = g;
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_GEO] Coverage map to %s (tile %u m, %u tiles, every %u sec)\n",
+			g_mib.geoFile, g_mib.geoTile, g_mib.geoTiles, g_mib.geoPeriod);
+	return 0;
+
+fail:
+	if(g->fp != NULL)
+		fclose(g->fp);
+	free(g->tiles);
+	free(g->bucket);
+	free(g->pend);
+	free(g->out);
+	free(g);
+	return -1;
+}
+
+/**
+ * par_GeoHash()
+ * (RSU 링크, 타일) 해시 버킷 인덱스 계산
+ */
+static uint32_t par_GeoHash(const struct parGeo_t *g, const struct parGeoStat_t *key)
+{
+	uint32_t h = (uint32_t)key->rsuID * 2654435761u;
+
+	h ^= ((uint32_t)key->channel << 8 | key->ifIdx) * 0x27d4eb2fu;
+	h ^= (uint32_t)key->tileLat * 0x85ebca77u;
+	h ^= (uint32_t)key->tileLon * 0xc2b2ae3du;
+	h ^= h >> 15;
+	return h & g->bucketMask;
+}
+
+/**
+ * par_GeoLonStep()
+ * 타일 행의 경도 간격 (1e-7도)
+ */
+static double par_GeoLonStep(double latStep, int32_t row)
+{
+	double c = cos(((row + 0.5) * latStep / 1e7) * M_PI / 180.0);
+
+	if(c < 0.01)
+		c = 0.01;
+	return latStep / c;
+}
+
+/**
+ * par_GeoLruUnlink()
+ * 타일을 LRU 리스트에서 뺀다.
+ */
+static void par_GeoLruUnlink(struct parGeo_t *g, int32_t i)
+{
+	struct parGeoTile_t *t = &g->tiles[i];
+
+	if(t->lruPrev != PAR_GEO_NONE)
+		g->tiles[t->lruPrev].lruNext = t->lruNext;
+	else
+		g->lruHead = t->lruNext;
+	if(t->lruNext != PAR_GEO_NONE)
+		g->tiles[t->lruNext].lruPrev = t->lruPrev;
+	else
+		g->lruTail = t->lruPrev;
+}
+
+/**
+ * par_GeoLruPush()
+ * 타일을 LRU 리스트 맨 앞(최근)에 넣는다.
+ */
+static void par_GeoLruPush(struct parGeo_t *g, int32_t i)
+{
+	struct parGeoTile_t *t = &g->tiles[i];
+
+	t->lruPrev = PAR_GEO_NONE;
+	t->lruNext = g->lruHead;
+	if(g->lruHead != PAR_GEO_NONE)
+		g->tiles[g->lruHead].lruPrev = i;
+	else
+		g->lruTail = i;
+	g->lruHead = i;
+}
+
+/**
+ * par_GeoPend()
+ * 타일 통계를 내보낼 레코드에 추가한다.
+ * @return 성공 시 0, 버퍼가 가득 차면 -1
+ */
+static int par_GeoPend(struct parGeo_t *g, const struct parGeoStat_t *stat)
+{
+	if(g->pendNum >= g_mib.geoTiles)
+		return -1;
+	g->pend[g->pendNum++] = *stat;
+	return 0;
+}
+
+/**
+ * par_GeoEvict()
+ * 가장 오래 사용하지 않은 타일을 해시에서 빼고 반환한다. 변경된 타일이면 먼저 내보낼 레코드에 추가한다.
+ * 변경 리스트에서는 빼지 않으므로 dirty 플래그만 해제하고, 변경 리스트 순회 시 건너뛴다. (inDirty 유지)
+ */
+static int32_t par_GeoEvict(struct parGeo_t *g)
+{
+	int32_t i = g->lruTail;
+	struct parGeoTile_t *t = &g->tiles[i];
+	int32_t *pp;
+
+	par_GeoLruUnlink(g, i);
+	pp = &g->bucket[par_GeoHash(g, &t->stat)];
+	while(*pp != i)
+		pp = &g->tiles[*pp].hashNext;
+	*pp = t->hashNext;
+
+	if(t->dirty)
+	{
+		if(par_GeoPend(g, &t->stat) < 0)
+			g->drop++;
+		t->dirty = false;
+	}
+	g->evict++;
+	g->used--;
+	return i;
+}
+
+/**
+ * par_GeoGetTile()
+ * (RSU 링크, 타일)의 타일을 찾고, 없으면 할당한다. 찾은 타일은 LRU 리스트 맨 앞으로 옮긴다.
+ * @param key 찾을 타일 (rsuID, channel, ifIdx, tileLat, tileLon)
+ */
+static struct parGeoTile_t* par_GeoGetTile(struct parGeo_t *g, const struct parGeoStat_t *key, uint64_t now)
+{
+	uint32_t h = par_GeoHash(g, key);
+	struct parGeoTile_t *t;
+	int32_t i;
+
+	for(i = g->bucket[h]; i != PAR_GEO_NONE; i = g->tiles[i].hashNext)
+	{
+		t = &g->tiles[i];
+		if(t->stat.rsuID == key->rsuID && t->stat.channel == key->channel && t->stat.ifIdx == key->ifIdx &&
+				t->stat.tileLat == key->tileLat && t->stat.tileLon == key->tileLon)
+		{
+			if(g->lruHead != i)
+			{
+				par_GeoLruUnlink(g, i);
+				par_GeoLruPush(g, i);
+			}
+			return t;
+		}
+	}
+
+	/* 새 타일 - 빈 타일이 없으면 LRU 타일을 재사용 */
+	if(g->freeHead != PAR_GEO_NONE)
+	{
+		i = g->freeHead;
+		g->freeHead = g->tiles[i].lruNext;
+	}
+	else
+		i = par_GeoEvict(g);
+
+	t = &g->tiles[i];
+	memset(&t->stat, 0, sizeof(struct parGeoStat_t));
+	t->stat.rsuID = key->rsuID;
+	t->stat.channel = key->channel;
+	t->stat.ifIdx = key->ifIdx;
+	t->stat.tileLat = key->tileLat;
+	t->stat.tileLon = key->tileLon;
+	t->stat.rxpowerMin = INT16_MAX;
+	t->stat.rxpowerMax = INT16_MIN;
+	t->stat.rcpiMin = UINT8_MAX;
+	t->stat.since = now;
+	t->hashNext = g->bucket[h];
+	g->bucket[h] = i;
+	par_GeoLruPush(g, i);
+	g->used++;
+	return t;
+}
+
+/**
+ * par_GeoCollect()
+ * 변경된 타일을 내보낼 레코드로 복사하고, 지도 쓰레드가 쉬고 있으면 넘긴다. (수신 쓰레드)
+ * 버퍼가 가득 차 복사하지 못한 타일은 변경 상태로 남겨 다음 주기에 내보낸다.
+ */
+static void par_GeoCollect(struct parGeo_t *g)
+{
+	int32_t i, next, keep = PAR_GEO_NONE;
+	struct parGeoStat_t *tmp;
+
+	for(i = g->dirtyHead; i != PAR_GEO_NONE; i = next)
+	{
+		next = g->tiles[i].dirtyNext;
+		g->tiles[i].inDirty = false;
+		if(!g->tiles[i].dirty)
+			continue;
+		if(par_GeoPend(g, &g->tiles[i].stat) < 0)
+		{
+			g->tiles[i].dirtyNext = keep;
+			g->tiles[i].inDirty = true;
+			keep = i;
+			continue;
+		}
+		g->tiles[i].dirty = false;
+	}
+	g->dirtyHead = keep;
+
+	if(g->pendNum == 0)
+		return;
+
+	pthread_mutex_lock(&g->mtx);
+	if(g->outNum == 0)
+	{
+		tmp = g->out;
+		g->out = g->pend;
+		g->outNum = g->pendNum;
+		g->pend = tmp;
+		g->pendNum = 0;
+		pthread_cond_signal(&g->cond);
+	}
+	pthread_mutex_unlock(&g->mtx);
+}
+
+/**
+ * par_GeoUpdate()
+ * 수신 패킷을 OBU 위치 타일의 RSU 링크 통계에 반영한다. (수신 쓰레드, 패킷 당 O(1))
+ * 내보내기 주기가 지났으면 변경된 타일을 지도 쓰레드에 넘긴다.
+ * @param lost 이 패킷으로 변한 손실 수 (늦게 도착한 패킷이면 음수)
+ */
+void par_GeoUpdate(const struct parInfo_t *node, const struct parPacket_t *pkt, int32_t lost)
+{
+	struct parGeo_t *g = g_parGeo;
+	struct parGeoTile_t *t;
+	struct timespec ts;
+	struct parGeoStat_t key;
+	uint64_t now;
+
+	if(g == NULL)
+		return;
+
+	if(node->obuLatitude != PAR_GEO_INVALID_LAT)
+	{
+		now = par_TimeNow();
+		key.rsuID = node->rsuID;
+		key.channel = node->channel;
+		key.ifIdx = node->ifIdx;
+		key.tileLat = (int32_t)floor(node->obuLatitude / g->latStep);
+		if(key.tileLat != g->lonRow)
+		{
+			g->lonRow = key.tileLat;
+			g->lonStep = par_GeoLonStep(g->latStep, key.tileLat);
+		}
+		key.tileLon = (int32_t)floor(node->obuLongitude / g->lonStep);
+
+		t = par_GeoGetTile(g, &key, now);
+		t->stat.cnt++;
+		if(pkt->hasSeq)
+		{
+			t->stat.seqCnt++;
+			t->stat.lost += lost;
+		}
+		t->stat.rxpowerSum += pkt->rxPower;
+		if(pkt->rxPower < t->stat.rxpowerMin)
+			t->stat.rxpowerMin = pkt->rxPower;
+		if(pkt->rxPower > t->stat.rxpowerMax)
+			t->stat.rxpowerMax = pkt->rxPower;
+		t->stat.rcpiSum += pkt->rcpi;
+		if(pkt->rcpi < t->stat.rcpiMin)
+			t->stat.rcpiMin = pkt->rcpi;
+		if(pkt->rcpi > t->stat.rcpiMax)
+			t->stat.rcpiMax = pkt->rcpi;
+		t->stat.last = now;
+		t->dirty = true;
+		if(!t->inDirty)
+		{
+			t->inDirty = true;
+			t->dirtyNext = g->dirtyHead;
+			g->dirtyHead = (int32_t)(t - g->tiles);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	if(ts.tv_sec > g->nextExport.tv_sec ||
+			(ts.tv_sec == g->nextExport.tv_sec && ts.tv_nsec >= g->nextExport.tv_nsec))
+	{
+		g->nextExport.tv_sec = ts.tv_sec + g_mib.geoPeriod;
+		g->nextExport.tv_nsec = ts.tv_nsec;
+		par_GeoCollect(g);
+	}
+}
+
+/**
+ * par_GeoWrite()
+ * 내보낼 레코드를 CSV로 기록한다. (지도 쓰레드)
+ */
+static void par_GeoWrite(struct parGeo_t *g, const struct parGeoStat_t *stat, uint32_t num)
+{
+	uint64_t now = par_TimeNow();
+	double latStep = g->latStep;
+	int32_t lost;
+
+	for(uint32_t i = 0; i < num; i++, stat++)
+	{
+		lost = (stat->lost > 0) ? stat->lost : 0;
+		fprintf(g->fp, "%llu, %d, %u, %u, %d, %d, %.0f, %.0f, %u, %u, %d, ",
+				(unsigned long long)now, stat->rsuID, stat->channel, stat->ifIdx, stat->tileLat, stat->tileLon,
+				(stat->tileLat + 0.5) * latStep,
+				(stat->tileLon + 0.5) * par_GeoLonStep(latStep, stat->tileLat),
+				stat->cnt, stat->seqCnt, lost);
+		/* PAR - 일련번호가 있는 수신만 (이전 버전 송신기는 공란) */
+		if(stat->seqCnt > 0)
+			fprintf(g->fp, "%.2f, ", (double)stat->seqCnt * 100.0 / (stat->seqCnt + lost));
+		else
+			fprintf(g->fp, ", ");
+		fprintf(g->fp, "%.1f, %d, %d, %.1f, %u, %u, %llu, %llu\n",
+				(double)stat->rxpowerSum / stat->cnt, stat->rxpowerMin, stat->rxpowerMax,
+				(double)stat->rcpiSum / stat->cnt, stat->rcpiMin, stat->rcpiMax,
+				(unsigned long long)stat->since, (unsigned long long)stat->last);
+	}
+	fflush(g->fp);
+}
+
+/**
+ * par_GeoThread()
+ * 수신 쓰레드가 넘긴 타일 레코드를 파일에 기록하는 쓰레드
+ */
+static void* par_GeoThread(void *arg)
+{
+	struct parGeo_t *g = (struct parGeo_t*)arg;
+
+	pthread_mutex_lock(&g->mtx);
+	while(1)
+	{
+		while(g->outNum == 0 && g->running)
+			pthread_cond_wait(&g->cond, &g->mtx);
+		if(g->outNum == 0)
+			break;
+		pthread_mutex_unlock(&g->mtx);
+
+		par_GeoWrite(g, g->out, g->outNum);
+
+		pthread_mutex_lock(&g->mtx);
+		g->outNum = 0;
+		pthread_cond_signal(&g->cond);
+	}
+	pthread_mutex_unlock(&g->mtx);
+	return NULL;
+}
+
+/**
+ * par_GeoClose()
+ * 남은 변경 타일을 모두 기록하고 지도 쓰레드를 종료한다. (수신 루프 종료 후)
+ */
+void par_GeoClose(void)
+{
+	struct parGeo_t *g = g_parGeo;
+
+	if(g == NULL)
+		return;
+
+	/* 지도 쓰레드가 기록을 끝낼 때까지 기다리며 남은 타일을 넘긴다. */
+	do{
+		pthread_mutex_lock(&g->mtx);
+		while(g->outNum != 0)
+			pthread_cond_wait(&g->cond, &g->mtx);
+		pthread_mutex_unlock(&g->mtx);
+		par_GeoCollect(g);
+	}while(g->pendNum != 0 || g->dirtyHead != PAR_GEO_NONE);
+
+	pthread_mutex_lock(&g->mtx);
+	g->running = false;
+	pthread_cond_signal(&g->cond);
+	pthread_mutex_unlock(&g->mtx);
+	pthread_join(g->thread, NULL);
+
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_GEO] Coverage map closed (tiles %u, evicted %u, dropped %u)\n", g->used, g->evict, g->drop);
+	g_parGeo = NULL;
+	fclose(g->fp);
+	pthread_mutex_destroy(&g->mtx);
+	pthread_cond_destroy(&g->cond);
+	free(g->tiles);
+	free(g->bucket);
+	free(g->pend);
+	free(g->out);
+	free(g);
+}
@@ -0,0 +1,305 @@
+/**********************************************************
+  [OBU 위치 이력]
+  GNSS 쓰레드가 gpsd(공유메모리)를 주기적으로 읽어 새 fix(시각, 위도/경도, 속도, 방위)를 이력 링버퍼에 넣는다.
+  수신 쓰레드는 gpsd를 읽지 않고, 패킷 수신시각으로 par_GnssPosition()을 호출하여 그 시각의 위치를 구한다.
+
+  [위치 추정]
+  수신시각이 두 fix 사이이면 선형 보간한다. (방위는 짧은 쪽 호로 보간)
+  가장 최근 fix 이후이면 그 fix의 속도/방위로 추측항법(dead reckoning)한다. (최대 PAR_GNSS_DR_MAX 까지, 이후는 그 위치에 정지)
+  가장 오래된 fix 이전이면 가장 오래된 fix를 사용한다.
+  fix 시각은 GPS 시각(fix.time)이고, 수신시각은 par_TimeCorrect()로 보정한 시각이므로
+  -g 옵션 사용 시 같은 시간축이며, 그렇지 않으면 시스템 시각이 GPS에 동기되어 있다고 가정한다.
+
+  재생 모드(-R)에서는 gpsd를 열지 않고, 재생 파일의 fix를 par_GnssFeed()로 받는다.
+
+  [동기화]
+  이력은 단일 기록자(GNSS 쓰레드)의 seqlock으로 보호한다.
+  읽는 쪽은 seq가 짝수이고 복사 전후로 같을 때까지 다시 복사하므로 잠금이 없다.
+ ************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <PAR.h>
+
+#define PAR_GNSS_HIST 16 //fix 이력 수 (1Hz 기준 약 16초)
+#define PAR_GNSS_POLL_USEC 50000 //gpsd 읽기 주기 (usec)
+#define PAR_GNSS_RETRY_USEC 1000000 //gps_open() 실패 시 재시도 주기 (usec)
+#define PAR_GNSS_DR_MAX 2000000 //추측항법 최대 시간 (usec)
+#define PAR_GNSS_EARTH_RADIUS 6371009.0 //지구 평균 반지름(m)
+#define PAR_GNSS_DEG_TO_RAD (M_PI / 180.0)
+
+/* fix 하나 */
+struct parGnssFix_t{
+	uint64_t time; //fix 시각 (usec, GPS 시각)
+	double lat; //위도 (도)
+	double lon; //경도 (도)
+	double speed; //속도 (m/s, 없으면 NAN)
+	double track; //방위 (도, 진북 기준, 없으면 NAN)
+};
+
+struct parGnss_t{
+	/* seqlock으로 보호되는 이력 (GNSS 쓰레드만 기록) */
+	uint32_t seq; //기록 중이면 홀수
+	uint32_t head; //다음 기록 위치
+	uint32_t num; //이력 수 (최대 PAR_GNSS_HIST)
+	struct parGnssFix_t hist[PAR_GNSS_HIST];
+
+	/* GNSS 쓰레드 전용 */
+	struct gps_data_t gps;
+	bool opened;
+	double lastFix; //마지막으로 넣은 fix.time
+
+	pthread_t thread;
+	bool running;
+};
+
+static struct parGnss_t g_parGnss;
+
+static void* par_GnssThread(void *arg);
+
+
+/**
+ * par_GnssInit()
+ * gpsd를 열고 GNSS 쓰레드를 생성한다.
+ * gps_open() 실패 시에는 GNSS 쓰레드가 재시도한다.
+ * @return 성공 시 0, 실패 시 -1
+ */
+int par_GnssInit(void)
+{
+	struct parGnss_t *g = &g_parGnss;
+	int ret;
+
+	memset(g, 0, sizeof(struct parGnss_t));
+	if(g_mib.replayFile[0] != '\0')
+		return 0;
+	ret = gps_open(GPSD_SHARED_MEMORY, 0, &g->gps);
+	if(ret < 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] gps_open() fail(%s)\n", gps_errstr(ret));
+	}
+	else
+	{
+		syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Success gps_open()\n");
+		g->opened = true;
+	}
+
+	g->running = true;
+	ret = pthread_create(&g->thread, NULL, par_GnssThread, g);
+	if(ret != 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] Fail to create GNSS thread() : %s\n", strerror(ret));
+		g->running = false;
+		if(g->opened)
+			gps_close(&g->gps);
+		g->opened = false;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * par_GnssPush()
+ * 새 fix를 이력에 넣는다. (GNSS 쓰레드)
+ */
+static void par_GnssPush(struct parGnss_t *g, const struct gps_fix_t *fix)
+{
+	struct parGnssFix_t *f = &g->hist[g->head];
+
+	__atomic_store_n(&g->seq, g->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	f->time = (uint64_t)(fix->time * 1000000.0);
+	f->lat = fix->latitude;
+	f->lon = fix->longitude;
+	f->speed = fix->speed;
+	f->track = fix->track;
+	g->head = (g->head + 1) % PAR_GNSS_HIST;
+	if(g->num < PAR_GNSS_HIST)
+		g->num++;
+
+	__atomic_store_n(&g->seq, g->seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * par_GnssThread()
+ * gpsd를 주기적으로 읽어 GPS 시각 보정값을 갱신하고, 새 fix를 이력에 넣는다.
+ * 읽기 실패 시 다시 연결한다.
+ */
+static void* par_GnssThread(void *arg)
+{
+	struct parGnss_t *g = (struct parGnss_t*)arg;
+	int ret;
+
+	while(!ending && __atomic_load_n(&g->running, __ATOMIC_RELAXED))
+	{
+		/* Connection Check */
+		if(!g->opened)
+		{
+			syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Re connection to GPSD\n");
+			ret = gps_open(GPSD_SHARED_MEMORY, 0, &g->gps);
+			if(ret < 0)
+			{
+				syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] gps_open() fail(%s)\n", gps_errstr(ret));
+				usleep(PAR_GNSS_RETRY_USEC);
+				continue;
+			}
+			g->opened = true;
+		}
+
+		/* GPS Read */
+		ret = gps_read(&g->gps);
+		if(ret < 0)
+		{
+			syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] gps_read() fail( %s)\n", gps_errstr(ret));
+			gps_close(&g->gps);
+			g->opened = false;
+			continue;
+		}
+		par_TimeUpdateGps(&g->gps);
+
+		if(g->gps.set && g->gps.fix.mode >= MODE_2D && !isnan(g->gps.fix.time) &&
+				!isnan(g->gps.fix.latitude) && !isnan(g->gps.fix.longitude) && g->gps.fix.time != g->lastFix)
+		{
+			g->lastFix = g->gps.fix.time;
+			par_GnssPush(g, &g->gps.fix);
+			par_CapFix(&g->gps.fix);
+		}
+
+		usleep(PAR_GNSS_POLL_USEC);
+	}
+	pthread_exit((void *)0);
+}
+
+/**
+ * par_GnssFeed()
+ * 재생 파일의 fix를 이력에 넣는다. (재생 모드, 수신 쓰레드)
+ */
+void par_GnssFeed(const struct gps_fix_t *fix)
+{
+	par_GnssPush(&g_parGnss, fix);
+}
+
+/**
+ * par_GnssOffset()
+ * 위치를 방위/거리만큼 이동한다. (짧은 거리 평면 근사)
+ */
+static void par_GnssOffset(double *lat, double *lon, double track, double meter)
+{
+	double rad = track * PAR_GNSS_DEG_TO_RAD;
+	double c = cos(*lat * PAR_GNSS_DEG_TO_RAD);
+
+	*lat += meter * cos(rad) / PAR_GNSS_EARTH_RADIUS / PAR_GNSS_DEG_TO_RAD;
+	if(c > 1e-6)
+		*lon += meter * sin(rad) / (PAR_GNSS_EARTH_RADIUS * c) / PAR_GNSS_DEG_TO_RAD;
+	if(*lon > 180.0)
+		*lon -= 360.0;
+	else if(*lon < -180.0)
+		*lon += 360.0;
+}
+
+/**
+ * par_GnssPosition()
+ * 주어진 시각의 OBU 위치를 이력으로부터 추정한다. (보간 또는 추측항법)
+ * @param time 시각 (usec, par_TimeCorrect()로 보정한 시각)
+ * @param obu 추정 위치 (위도/경도 1e-7도, 속도 km/h, 방위 도)
+ * @return 성공 시 0, fix 이력이 없으면 -1
+ */
+int par_GnssPosition(uint64_t time, struct obuInfo_t *obu)
+{
+	const struct parGnss_t *g = &g_parGnss;
+	struct parGnssFix_t hist[PAR_GNSS_HIST];
+	const struct parGnssFix_t *a, *b;
+	uint32_t seq, head, num, i;
+	double lat, lon, speed, track;
+
+	/* 이력 복사 (seqlock) */
+	do{
+		seq = __atomic_load_n(&g->seq, __ATOMIC_ACQUIRE);
+		if(seq & 1)
+			continue;
+		head = g->head;
+		num = g->num;
+		memcpy(hist, g->hist, sizeof(hist));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	}while((seq & 1) || seq != __atomic_load_n(&g->seq, __ATOMIC_RELAXED));
+
+	if(num == 0)
+		return -1;
+
+	/* 가장 최근 fix부터 수신시각 이전의 fix를 찾는다 */
+	b = NULL;
+	a = &hist[(head + PAR_GNSS_HIST - 1) % PAR_GNSS_HIST];
+	for(i = 1; i < num && a->time > time; i++)
+	{
+		b = a;
+		a = &hist[(head + PAR_GNSS_HIST - 1 - i) % PAR_GNSS_HIST];
+	}
+
+	lat = a->lat;
+	lon = a->lon;
+	speed = a->speed;
+	track = a->track;
+	if(a->time > time)
+	{
+		/* 가장 오래된 fix 이전 - 그대로 사용 */
+	}
+	else if(b != NULL)
+	{
+		/* 두 fix 사이 - 선형 보간 */
+		double r = (double)(time - a->time) / (double)(b->time - a->time);
+		double dlon = b->lon - a->lon;
+		double dtrack;
+
+		if(dlon > 180.0)
+			dlon -= 360.0;
+		else if(dlon < -180.0)
+			dlon += 360.0;
+		lat += (b->lat - a->lat) * r;
+		lon += dlon * r;
+		if(lon > 180.0)
+			lon -= 360.0;
+		else if(lon < -180.0)
+			lon += 360.0;
+		if(!isnan(speed) && !isnan(b->speed))
+			speed += (b->speed - speed) * r;
+		if(!isnan(track) && !isnan(b->track))
+		{
+			dtrack = fmod(b->track - track + 540.0, 360.0) - 180.0;
+			track = fmod(track + dtrack * r + 360.0, 360.0);
+		}
+	}
+	else if(!isnan(speed) && !isnan(track))
+	{
+		/* 가장 최근 fix 이후 - 추측항법 */
+		uint64_t dt = time - a->time;
+
+		if(dt > PAR_GNSS_DR_MAX)
+			dt = PAR_GNSS_DR_MAX;
+		par_GnssOffset(&lat, &lon, track, speed * dt / 1000000.0);
+	}
+
+	obu->obuLatitude = (int32_t)lround(lat * 1e7);
+	obu->obuLongitude = (int32_t)lround(lon * 1e7);
+	obu->obuSpeed = isnan(speed) ? 0 : speed * 3.6;
+	obu->obuHeading = isnan(track) ? 0 : track;
+	return 0;
+}
+
+/**
+ * par_GnssClose()
+ * GNSS 쓰레드를 종료하고 gpsd를 닫는다.
+ */
+void par_GnssClose(void)
+{
+	struct parGnss_t *g = &g_parGnss;
+
+	if(!g->running)
+		return;
+	__atomic_store_n(&g->running, false, __ATOMIC_RELAXED);
+	pthread_join(g->thread, NULL);
+	if(g->opened)
+		gps_close(&g->gps);
+	g->opened = false;
+}
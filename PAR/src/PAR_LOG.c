@@ -0,0 +1,402 @@
+/**********************************************************
+  [바이너리 측정 로그]
+  par_Report()가 RSU 별 보고 구간 통계를 고정 크기 레코드(parLogRec_t)로 만들어 링버퍼에 넣으면,
+  로그 쓰레드가 파일에 기록한다. (보고 쓰레드는 파일 I/O를 하지 않으며, 링버퍼가 가득 차면 레코드를 버리고 센다)
+
+  링버퍼는 단일 생산자(보고 쓰레드)/단일 소비자(로그 쓰레드)이며 head/tail 원자변수로 동기화한다.
+
+  [파일]
+  <dir>/PAR_<시작시각>_<번호>.bin
+  헤더(parLogHdr_t, 시간 인덱스 포함) + 레코드 배열
+  보고 구간(시작시각)이 바뀔 때마다 인덱스를 추가하고, 기록 후 헤더를 갱신한다.
+  파일 크기가 최대값을 넘거나 인덱스가 가득 차면 새 파일로 교체하고, 유지 파일 수를 넘으면 가장 오래된 파일을 삭제한다.
+ ************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <PAR.h>
+#include <PAR_LOG.h>
+
+#if PAR_CALC_NUM != PAR_LOG_CALC_NUM
+#error "PAR_LOG_CALC_NUM must match PAR_CALC_NUM"
+#endif
+
+#define PAR_LOG_RING 8192 //링버퍼 레코드 수 (2의 거듭제곱)
+#define PAR_LOG_PATH_MAX 256
+
+struct parLog_t{
+	struct parLogRec_t ring[PAR_LOG_RING];
+	uint32_t head; //생산자(보고 쓰레드)만 증가
+	uint32_t tail; //소비자(로그 쓰레드)만 증가
+	uint32_t drop; //링버퍼가 가득 차 버린 레코드 수 (보고 쓰레드만 갱신)
+	uint32_t dropReported;
+
+	pthread_t thread;
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+	bool running;
+
+	/* 로그 쓰레드 전용 */
+	int fd;
+	uint32_t fileSeq; //생성한 파일 수
+	uint32_t recMax; //파일 당 최대 레코드 수
+	uint32_t idxSynced; //헤더에 기록된 인덱스 수
+	struct parLogHdr_t hdr;
+	char (*paths)[PAR_LOG_PATH_MAX]; //생성한 파일 경로 (g_mib.logFiles 개 순환)
+};
+
+static struct parLog_t *g_parLog;
+
+static void* par_LogThread(void *notused);
+
+
+/**
+ * par_LogInit()
+ * 바이너리 로그를 초기화하고 로그 쓰레드를 생성한다. (-w 옵션이 없으면 아무것도 하지 않는다)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int par_LogInit(void)
+{
+	int ret;
+	struct parLog_t *g;
+
+	if(g_mib.logDir[0] == '\0')
+		return 0;
+
+	if(g_mib.logSize == 0)
+		g_mib.logSize = PAR_LOG_DEFAULT_SIZE;
+	if(g_mib.logFiles == 0)
+		g_mib.logFiles = PAR_LOG_DEFAULT_FILES;
+
+	g = (struct parLog_t*)calloc(1, sizeof(struct parLog_t));
+	if(g == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Fail to allocate log buffer\n");
+		return -1;
+	}
+	g->paths = calloc(g_mib.logFiles, PAR_LOG_PATH_MAX);
+	if(g->paths == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Fail to allocate log buffer\n");
+		free(g);
+		return -1;
+	}
+	g->fd = -1;
+	g->recMax = (uint32_t)(((uint64_t)g_mib.logSize * 1024 * 1024 - sizeof(struct parLogHdr_t)) / sizeof(struct parLogRec_t));
+	g->running = true;
+	pthread_mutex_init(&g->mtx, NULL);
+	pthread_cond_init(&g->cond, NULL);
+	g_parLog = g;
+
+	ret = pthread_create(&g->thread, NULL, par_LogThread, NULL);
+	if(ret != 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Fail to create log thread() : %s\n", strerror(ret));
+		g_parLog = NULL;
+		free(g->paths);
+		free(g);
+		return -1;
+	}
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_LOG] Binary log to %s (%u MByte x %u files, %u records per file)\n",
+			g_mib.logDir, g_mib.logSize, g_mib.logFiles, g->recMax);
+	return 0;
+}
+
+/**
+ * par_LogPut()
+ * RSU 보고 구간 통계를 레코드로 만들어 링버퍼에 넣는다. (보고 쓰레드, 블로킹하지 않음)
+ * @param cnt 보고 구간 수신 수
+ * @param start, end 보고 구간 시작/끝시각 (usec)
+ */
+void par_LogPut(const struct parInfo_t *node, uint32_t cnt, uint64_t start, uint64_t end)
+{
+	struct parLog_t *g = g_parLog;
+	struct parLogRec_t *rec;
+	uint32_t h;
+
+	if(g == NULL)
+		return;
+
+	h = g->head;
+	if(h - __atomic_load_n(&g->tail, __ATOMIC_ACQUIRE) >= PAR_LOG_RING)
+	{
+		g->drop++;
+		return;
+	}
+
+	rec = &g->ring[h & (PAR_LOG_RING - 1)];
+	rec->time = start;
+	rec->timeEnd = end;
+	rec->rsuID = node->rsuID;
+	rec->channel = node->channel;
+	rec->ifIdx = node->ifIdx;
+	rec->rsv = 0;
+	rec->rsuLatitude = node->rsuLatitude;
+	rec->rsuLongitude = node->rsuLongitude;
+	rec->obuLatitude = node->obuLatitude;
+	rec->obuLongitude = node->obuLongitude;
+	rec->distance = (float)node->distance;
+	rec->obuSpeed = (float)node->obuSpeed;
+	rec->obuHeading = (float)node->obuHeading;
+	rec->cnt = cnt;
+	rec->par = node->maxPAR;
+	for(int i = 0; i < PAR_CALC_NUM; i++)
+		rec->calc[i] = (float)node->calculateData[i];
+	rec->seqRcv = node->seqReport.rcv;
+	rec->seqLost = node->seqReport.lost;
+	rec->seqReorder = node->seqReport.reorder;
+	rec->seqDup = node->seqReport.dup;
+	rec->seqBurst = node->seqReport.burst;
+	rec->lossRate = (float)node->seqReport.lossRate;
+	rec->geP = (float)node->seqReport.geP;
+	rec->geR = (float)node->seqReport.geR;
+	rec->burstLen = (float)node->seqReport.burstLen;
+
+	__atomic_store_n(&g->head, h + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * par_LogFlush()
+ * 보고 주기의 레코드를 모두 넣은 후 호출하여 로그 쓰레드를 깨운다.
+ */
+void par_LogFlush(void)
+{
+	struct parLog_t *g = g_parLog;
+
+	if(g == NULL)
+		return;
+
+	if(g->drop != g->dropReported)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Log buffer full - %u records dropped\n", g->drop - g->dropReported);
+		g->dropReported = g->drop;
+	}
+	pthread_mutex_lock(&g->mtx);
+	pthread_cond_signal(&g->cond);
+	pthread_mutex_unlock(&g->mtx);
+}
+
+/**
+ * par_LogSyncHdr()
+ * 헤더의 고정부와 변경된 인덱스를 파일에 기록한다.
+ */
+static void par_LogSyncHdr(struct parLog_t *g)
+{
+	uint32_t from;
+
+	if(g->fd < 0)
+		return;
+
+	from = (g->idxSynced > 0) ? g->idxSynced - 1 : 0; //마지막 인덱스는 레코드 수가 늘었을 수 있다.
+	if(g->hdr.indexNum > from)
+	{
+		if(pwrite(g->fd, &g->hdr.idx[from], sizeof(struct parLogIdx_t) * (g->hdr.indexNum - from),
+					offsetof(struct parLogHdr_t, idx) + sizeof(struct parLogIdx_t) * from) < 0)
+			syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Fail to write index : %s\n", strerror(errno));
+		g->idxSynced = g->hdr.indexNum;
+	}
+	if(pwrite(g->fd, &g->hdr, offsetof(struct parLogHdr_t, idx), 0) < 0)
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Fail to write header : %s\n", strerror(errno));
+}
+
+/**
+ * par_LogCloseFile()
+ * 현재 파일의 헤더를 갱신하고 닫는다.
+ */
+static void par_LogCloseFile(struct parLog_t *g)
+{
+	if(g->fd < 0)
+		return;
+	par_LogSyncHdr(g);
+	close(g->fd);
+	g->fd = -1;
+}
+
+/**
+ * par_LogOpen()
+ * 새 로그 파일을 생성한다. 유지 파일 수를 넘으면 가장 오래된 파일을 삭제한다.
+ * @param time 첫 레코드 보고시각 (파일 이름에 사용)
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int par_LogOpen(struct parLog_t *g, uint64_t time)
+{
+	char stamp[32];
+	time_t sec = (time_t)(time / 1000000ULL);
+	struct tm tm;
+	char *path = g->paths[g->fileSeq % g_mib.logFiles];
+
+	par_LogCloseFile(g);
+
+	if(path[0] != '\0')
+	{
+		if(unlink(path) < 0 && errno != ENOENT)
+			syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Fail to remove %s : %s\n", path, strerror(errno));
+	}
+
+	localtime_r(&sec, &tm);
+	strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+	snprintf(path, PAR_LOG_PATH_MAX, "%s/PAR_%s_%u.bin", g_mib.logDir, stamp, g->fileSeq);
+	g->fileSeq++;
+
+	g->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(g->fd < 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Fail to open %s : %s\n", path, strerror(errno));
+		path[0] = '\0';
+		return -1;
+	}
+
+	memset(&g->hdr, 0, sizeof(struct parLogHdr_t));
+	memcpy(g->hdr.magic, PAR_LOG_MAGIC, sizeof(g->hdr.magic));
+	g->hdr.version = PAR_LOG_VERSION;
+	g->hdr.recSize = sizeof(struct parLogRec_t);
+	g->hdr.calcNum = PAR_LOG_CALC_NUM;
+	g->hdr.indexMax = PAR_LOG_INDEX_MAX;
+	g->idxSynced = 0;
+
+	/* 헤더 전체(빈 인덱스 포함)를 먼저 기록하여 레코드가 헤더 뒤에 오도록 한다. */
+	if(write(g->fd, &g->hdr, sizeof(struct parLogHdr_t)) != sizeof(struct parLogHdr_t))
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Fail to write header of %s : %s\n", path, strerror(errno));
+		close(g->fd);
+		g->fd = -1;
+		return -1;
+	}
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_LOG] Open %s\n", path);
+	return 0;
+}
+
+/**
+ * par_LogWriteOut()
+ * 연속된 레코드를 파일에 기록한다.
+ */
+static void par_LogWriteOut(struct parLog_t *g, const struct parLogRec_t *rec, uint32_t n)
+{
+	const uint8_t *p = (const uint8_t*)rec;
+	size_t len = (size_t)n * sizeof(struct parLogRec_t);
+	ssize_t ret;
+
+	while(len > 0 && g->fd >= 0)
+	{
+		ret = write(g->fd, p, len);
+		if(ret < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			syslog(LOG_ERR | LOG_LOCAL5, "[PAR_LOG] Fail to write records : %s\n", strerror(errno));
+			return;
+		}
+		p += ret;
+		len -= ret;
+	}
+}
+
+/**
+ * par_LogWriteRecs()
+ * 링버퍼의 연속된 레코드들을 인덱스를 갱신하며 기록한다. 필요하면 파일을 교체한다.
+ */
+static void par_LogWriteRecs(struct parLog_t *g, const struct parLogRec_t *rec, uint32_t n)
+{
+	uint32_t start = 0;
+	bool newBatch;
+
+	for(uint32_t i = 0; i < n; i++)
+	{
+		newBatch = (g->fd < 0) || (g->hdr.indexNum == 0) || (rec[i].time != g->hdr.endTime);
+
+		/* 파일 교체 - 크기 초과 또는 인덱스 가득 참 */
+		if(g->fd < 0 || g->hdr.recNum >= g->recMax || (newBatch && g->hdr.indexNum >= PAR_LOG_INDEX_MAX))
+		{
+			par_LogWriteOut(g, rec + start, i - start);
+			start = i;
+			if(par_LogOpen(g, rec[i].time) < 0)
+				return; //이번 레코드들은 버린다. 다음 보고 주기에 다시 파일 생성을 시도한다.
+			newBatch = true;
+		}
+
+		if(newBatch)
+		{
+			struct parLogIdx_t *idx = &g->hdr.idx[g->hdr.indexNum++];
+			idx->time = rec[i].time;
+			idx->first = g->hdr.recNum;
+			idx->num = 0;
+		}
+		g->hdr.idx[g->hdr.indexNum - 1].num++;
+		if(g->hdr.recNum == 0)
+			g->hdr.startTime = rec[i].time;
+		g->hdr.endTime = rec[i].time;
+		g->hdr.recNum++;
+	}
+	par_LogWriteOut(g, rec + start, n - start);
+}
+
+/**
+ * par_LogThread()
+ * 로그 쓰레드 - 링버퍼의 레코드를 파일에 기록한다.
+ */
+static void* par_LogThread(void *notused)
+{
+	struct parLog_t *g = g_parLog;
+	uint32_t h, t, idx, n;
+	bool stop;
+
+	while(1)
+	{
+		pthread_mutex_lock(&g->mtx);
+		while(g->running && __atomic_load_n(&g->head, __ATOMIC_ACQUIRE) == g->tail)
+			pthread_cond_wait(&g->cond, &g->mtx);
+		stop = !g->running;
+		pthread_mutex_unlock(&g->mtx);
+
+		h = __atomic_load_n(&g->head, __ATOMIC_ACQUIRE);
+		t = g->tail;
+		while(t != h)
+		{
+			/* 링버퍼 끝에서 나누어 연속된 구간 단위로 기록 */
+			idx = t & (PAR_LOG_RING - 1);
+			n = h - t;
+			if(n > PAR_LOG_RING - idx)
+				n = PAR_LOG_RING - idx;
+			par_LogWriteRecs(g, &g->ring[idx], n);
+			t += n;
+			__atomic_store_n(&g->tail, t, __ATOMIC_RELEASE);
+		}
+		par_LogSyncHdr(g);
+
+		if(stop)
+			break;
+	}
+
+	par_LogCloseFile(g);
+	pthread_exit((void *)0);
+}
+
+/**
+ * par_LogClose()
+ * 남은 레코드를 기록하고 로그 쓰레드를 종료한다.
+ */
+void par_LogClose(void)
+{
+	struct parLog_t *g = g_parLog;
+
+	if(g == NULL)
+		return;
+
+	pthread_mutex_lock(&g->mtx);
+	g->running = false;
+	pthread_cond_signal(&g->cond);
+	pthread_mutex_unlock(&g->mtx);
+	pthread_join(g->thread, NULL);
+
+	if(g->drop)
+		syslog(LOG_INFO | LOG_LOCAL4, "[PAR_LOG] Total dropped records : %u\n", g->drop);
+	g_parLog = NULL;
+	pthread_mutex_destroy(&g->mtx);
+	pthread_cond_destroy(&g->cond);
+	free(g->paths);
+	free(g);
+}
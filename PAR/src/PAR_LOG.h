@@ -0,0 +1,68 @@
+//
+// PAR 바이너리 측정 로그 형식
+//  - PAR 수신(par_Report())과 오프라인 변환도구(tools/parlog.c)가 함께 사용한다.
+//
+
+#ifndef PAR_PAR_LOG_H
+#define PAR_PAR_LOG_H
+
+#include <stdint.h>
+
+#define PAR_LOG_MAGIC "PARLOG1" //파일 식별자 (8Byte, NULL 포함)
+#define PAR_LOG_VERSION 3
+#define PAR_LOG_CALC_NUM 25 //calculateData 개수 (PAR_CALC_NUM)
+#define PAR_LOG_INDEX_MAX 4096 //파일 당 시간 인덱스 최대 수 (보고 주기 당 1개), 가득 차면 파일을 교체한다.
+#define PAR_LOG_DEFAULT_SIZE 16 //파일 최대 크기 기본값 (MByte)
+#define PAR_LOG_DEFAULT_FILES 8 //유지할 파일 수 기본값 (오래된 파일부터 삭제)
+
+/* 시간 인덱스 - 같은 보고 구간의 레코드 묶음 */
+struct parLogIdx_t{
+	uint64_t time; //보고 구간 시작시각 (usec)
+	uint32_t first; //첫 레코드 번호
+	uint32_t num; //레코드 수
+} __attribute__((__packed__));
+
+/* 파일 헤더 - 레코드 기록 후 갱신된다. */
+struct parLogHdr_t{
+	char magic[8]; //PAR_LOG_MAGIC
+	uint32_t version; //PAR_LOG_VERSION
+	uint32_t recSize; //레코드 크기 (sizeof(struct parLogRec_t))
+	uint32_t calcNum; //PAR_LOG_CALC_NUM
+	uint32_t indexMax; //PAR_LOG_INDEX_MAX
+	uint32_t indexNum; //유효한 인덱스 수
+	uint32_t recNum; //유효한 레코드 수
+	uint64_t startTime; //첫 레코드 보고시각 (usec)
+	uint64_t endTime; //마지막 레코드 보고시각 (usec)
+	struct parLogIdx_t idx[PAR_LOG_INDEX_MAX];
+} __attribute__((__packed__));
+
+/* 레코드 - 링크 별 보고 구간 1개 (고정 크기, 헤더 뒤에 보고시각 순으로 기록) */
+struct parLogRec_t{
+	uint64_t time; //보고 구간 시작시각 (usec, 보고주기 경계에 정렬)
+	uint64_t timeEnd; //보고 구간 끝시각 (usec, 구간은 [time, timeEnd))
+	int32_t rsuID;
+	uint8_t channel; //수신 채널번호 (레코드는 RSU, 채널, 인터페이스 링크 별)
+	uint8_t ifIdx; //수신 인터페이스
+	uint16_t rsv;
+	int32_t rsuLatitude;
+	int32_t rsuLongitude;
+	int32_t obuLatitude;
+	int32_t obuLongitude;
+	float distance;
+	float obuSpeed;
+	float obuHeading;
+	uint32_t cnt; //보고 구간 수신 수
+	uint32_t par; //PAR
+	float calc[PAR_LOG_CALC_NUM]; //calculateData (PAR_CALC_* 인덱스)
+	uint32_t seqRcv;
+	uint32_t seqLost;
+	uint32_t seqReorder;
+	uint32_t seqDup;
+	uint32_t seqBurst;
+	float lossRate;
+	float geP;
+	float geR;
+	float burstLen;
+} __attribute__((__packed__));
+
+#endif //PAR_PAR_LOG_H
@@ -0,0 +1,529 @@
+/**********************************************************
+  [실시간 조회 인터페이스]
+  UNIX 도메인 소켓(-q 경로)으로 최신 보고 구간의 RSU 별 통계를 JSON(한 줄)으로 제공한다.
+  데몬으로 실행될 때 userSelectThread 메뉴 대신 대시보드/스크립트에서 사용한다.
+
+  명령 (한 줄 단위)
+    get          : 최신 보고 구간 JSON 1줄 응답
+    subscribe    : 이후 보고 구간마다 JSON 1줄씩 전송
+    unsubscribe  : 전송 중지
+
+  [스냅샷]
+  par_Report()(보고 쓰레드)가 보고 구간마다 JSON을 만들어 3중 버퍼로 게시하고, 조회 쓰레드가 가져간다.
+  게시/가져오기는 ready 인덱스의 원자적 교환만 사용하므로 서로 기다리지 않으며,
+  수신 루프는 이 인터페이스와 아무것도 공유하지 않는다. (조회 빈도가 측정에 영향을 주지 않는다)
+  느린 구독자는 보내지 못한 데이터가 남아 있으면 그 사이의 보고 구간을 건너뛴다. (최신값 우선)
+ ************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <PAR.h>
+
+#define PAR_QRY_CLIENT_MAX 16 //동시 접속 클라이언트 수
+#define PAR_QRY_CMD_MAX 64 //명령 한 줄 최대 길이
+#define PAR_QRY_NEW 0x4 //ready 인덱스 - 새 스냅샷 게시됨
+
+/* 스냅샷 버퍼 */
+struct parQrySnap_t{
+	char *data;
+	size_t len;
+	size_t cap;
+};
+
+/* 접속 클라이언트 */
+struct parQryClient_t{
+	int fd; //-1이면 빈 슬롯
+	bool subscribe;
+	char cmd[PAR_QRY_CMD_MAX];
+	size_t cmdLen;
+	char *out; //보내지 못한 데이터
+	size_t outLen;
+	size_t outOff;
+	uint32_t skip; //전송 중이라 건너뛴 보고 구간 수
+};
+
+struct parQry_t{
+	struct parQrySnap_t snap[3]; //3중 버퍼
+	uint32_t ready; //게시된 버퍼 인덱스 | PAR_QRY_NEW (원자적 교환)
+	int w; //보고 쓰레드가 작성 중인 버퍼
+	int r; //조회 쓰레드가 사용 중인 버퍼
+	uint32_t seq; //게시한 보고 구간 수
+	bool first; //작성 중인 스냅샷에 RSU가 아직 없음
+
+	int listenFd;
+	int pipeFd[2]; //게시/종료 알림
+	struct parQryClient_t client[PAR_QRY_CLIENT_MAX];
+	pthread_t thread;
+	bool running;
+};
+
+static struct parQry_t *g_parQry;
+
+static void* par_QueryThread(void *arg);
+
+
+/**
+ * par_QueryInit()
+ * 조회 소켓을 생성하고 조회 쓰레드를 생성한다. (-q 옵션이 없으면 아무것도 하지 않는다)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int par_QueryInit(void)
+{
+	int ret;
+	struct parQry_t *g;
+	struct sockaddr_un addr;
+
+	if(g_mib.qrySock[0] == '\0')
+		return 0;
+
+	g = (struct parQry_t*)calloc(1, sizeof(struct parQry_t));
+	if(g == NULL)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_QRY] Fail to allocate query buffer\n");
+		return -1;
+	}
+	g->listenFd = -1;
+	g->pipeFd[0] = g->pipeFd[1] = -1;
+	for(int i = 0; i < PAR_QRY_CLIENT_MAX; i++)
+		g->client[i].fd = -1;
+	g->w = 0;
+	g->ready = 1;
+	g->r = 2;
+
+	/* 첫 보고 전 조회에 대한 빈 스냅샷 */
+	g->snap[g->r].data = strdup("{\"seq\":0,\"rsu\":[]}\n");
+	if(g->snap[g->r].data == NULL)
+		goto fail;
+	g->snap[g->r].len = g->snap[g->r].cap = strlen(g->snap[g->r].data);
+
+	if(pipe2(g->pipeFd, O_NONBLOCK | O_CLOEXEC) < 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_QRY] Fail to create pipe : %s\n", strerror(errno));
+		goto fail;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, g_mib.qrySock, sizeof(addr.sun_path) - 1);
+	unlink(addr.sun_path);
+	g->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(g->listenFd < 0 || bind(g->listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+			listen(g->listenFd, PAR_QRY_CLIENT_MAX) < 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_QRY] Fail to open query socket %s : %s\n", g_mib.qrySock, strerror(errno));
+		goto fail;
+	}
+
+	g->running = true;
+	ret = pthread_create(&g->thread, NULL, par_QueryThread, g);
+	if(ret != 0)
+	{
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_QRY] Fail to create query thread() : %s\n", strerror(ret));
+		unlink(g_mib.qrySock);
+		goto fail;
+	}
+	g_parQry = g;
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_QRY] Query socket %s\n", g_mib.qrySock);
+	return 0;
+
+fail:
+	if(g->listenFd >= 0)
+		close(g->listenFd);
+	if(g->pipeFd[0] >= 0)
+	{
+		close(g->pipeFd[0]);
+		close(g->pipeFd[1]);
+	}
+	free(g->snap[2].data);
+	free(g);
+	return -1;
+}
+
+/**
+ * par_QueryAppend()
+ * 작성 중인 스냅샷에 문자열을 추가한다. (보고 쓰레드)
+ * 버퍼는 보고 쓰레드 소유이므로 필요하면 늘린다. 할당 실패 시 이번 스냅샷을 잘라낸다.
+ */
+static void par_QueryAppend(struct parQry_t *g, const char *fmt, ...)
+{
+	struct parQrySnap_t *s = &g->snap[g->w];
+	va_list ap;
+	int n;
+	char *p;
+
+	while(1)
+	{
+		va_start(ap, fmt);
+		n = vsnprintf(s->data + s->len, s->cap - s->len, fmt, ap);
+		va_end(ap);
+		if(n < 0)
+			return;
+		if(s->len + n < s->cap)
+			break;
+		p = realloc(s->data, s->cap * 2 + n + 1024);
+		if(p == NULL)
+			return;
+		s->data = p;
+		s->cap = s->cap * 2 + n + 1024;
+	}
+	s->len += n;
+}
+
+/**
+ * par_QueryBegin()
+ * 보고 구간 스냅샷 작성을 시작한다. (par_Report() 시작 시)
+ * @param start, end 보고 구간 시작/끝시각 (usec)
+ */
+void par_QueryBegin(uint64_t start, uint64_t end)
+{
+	struct parQry_t *g = g_parQry;
+
+	if(g == NULL)
+		return;
+	g->snap[g->w].len = 0;
+	if(g->snap[g->w].cap > 0)
+		g->snap[g->w].data[0] = '\0';
+	g->first = true;
+	par_QueryAppend(g, "{\"seq\":%u,\"time\":%llu,\"end\":%llu,\"interval\":%u,\"rsu\":[", g->seq + 1,
+			(unsigned long long)start, (unsigned long long)end, g_mib.interval);
+}
+
+/**
+ * par_QueryPut()
+ * RSU 보고 구간 통계를 스냅샷에 추가한다. (보고 쓰레드)
+ * @param cnt 보고 구간 수신 수
+ */
+void par_QueryPut(const struct parInfo_t *node, uint32_t cnt)
+{
+	struct parQry_t *g = g_parQry;
+	const double *c = node->calculateData;
+	const struct parSeqReport_t *s = &node->seqReport;
+
+	if(g == NULL)
+		return;
+
+	par_QueryAppend(g, "%s{\"rsuID\":%d,\"channel\":%u,\"if\":%u,\"active\":%s,\"rsuLatitude\":%d,\"rsuLongitude\":%d,"
+			"\"obuLatitude\":%d,\"obuLongitude\":%d,\"distance\":%.0f,\"obuSpeed\":%.2f,\"obuHeading\":%.2f,"
+			"\"cnt\":%u,\"par\":%u,",
+			g->first ? "" : ",", node->rsuID, node->channel, node->ifIdx, node->check ? "true" : "false",
+			node->rsuLatitude, node->rsuLongitude, node->obuLatitude, node->obuLongitude,
+			node->distance, node->obuSpeed, node->obuHeading, cnt, node->maxPAR);
+	par_QueryAppend(g, "\"rxpower\":{\"min\":%d,\"max\":%d,\"avg\":%.1f,\"last\":%d,\"std\":%.2f,\"p50\":%d,\"p90\":%d,\"p99\":%d},",
+			(int)c[PAR_CALC_RXPOWER], (int)c[PAR_CALC_RXPOWER + 1], c[PAR_CALC_RXPOWER + 2], (int)c[PAR_CALC_RXPOWER + 3],
+			c[PAR_CALC_RXPOWER_EXT], (int)c[PAR_CALC_RXPOWER_EXT + 1], (int)c[PAR_CALC_RXPOWER_EXT + 2], (int)c[PAR_CALC_RXPOWER_EXT + 3]);
+	par_QueryAppend(g, "\"rcpi\":{\"min\":%d,\"max\":%d,\"avg\":%.1f,\"last\":%d,\"std\":%.2f,\"p50\":%d,\"p90\":%d,\"p99\":%d},",
+			(int)c[PAR_CALC_RCPI], (int)c[PAR_CALC_RCPI + 1], c[PAR_CALC_RCPI + 2], (int)c[PAR_CALC_RCPI + 3],
+			c[PAR_CALC_RCPI_EXT], (int)c[PAR_CALC_RCPI_EXT + 1], (int)c[PAR_CALC_RCPI_EXT + 2], (int)c[PAR_CALC_RCPI_EXT + 3]);
+	par_QueryAppend(g, "\"latency\":{\"n\":%u,\"min\":%d,\"max\":%d,\"avg\":%.1f,\"std\":%.1f,\"p50\":%d,\"p90\":%d,\"p99\":%d,\"jitter\":%.1f,\"over\":%u},",
+			node->latCnt, (int)c[PAR_CALC_LAT], (int)c[PAR_CALC_LAT + 1], c[PAR_CALC_LAT + 2],
+			c[PAR_CALC_LAT_EXT], (int)c[PAR_CALC_LAT_EXT + 1], (int)c[PAR_CALC_LAT_EXT + 2], (int)c[PAR_CALC_LAT_EXT + 3],
+			c[PAR_CALC_JITTER], node->latOver);
+	par_QueryAppend(g, "\"seq\":{\"rcv\":%u,\"lost\":%u,\"lossRate\":%.2f,\"reorder\":%u,\"dup\":%u,\"burst\":%u,\"geP\":%.4f,\"geR\":%.4f,\"burstLen\":%.2f}}",
+			s->rcv, s->lost, s->lossRate, s->reorder, s->dup, s->burst, s->geP, s->geR, s->burstLen);
+	g->first = false;
+}
+
+/**
+ * par_QueryPublish()
+ * 작성한 스냅샷을 게시하고 조회 쓰레드에 알린다. (par_Report() 끝, 블로킹하지 않음)
+ */
+void par_QueryPublish(void)
+{
+	struct parQry_t *g = g_parQry;
+	uint32_t old;
+	char c = 0;
+
+	if(g == NULL)
+		return;
+
+	par_QueryAppend(g, "]}\n");
+	g->seq++;
+	old = __atomic_exchange_n(&g->ready, (uint32_t)g->w | PAR_QRY_NEW, __ATOMIC_ACQ_REL);
+	g->w = old & 3;
+	/* 파이프가 가득 차 있으면(EAGAIN) 이미 알림이 있다. */
+	if(write(g->pipeFd[1], &c, 1) < 0 && errno != EAGAIN)
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_QRY] Fail to notify query thread : %s\n", strerror(errno));
+}
+
+/**
+ * par_QuerySnapshot()
+ * 새로 게시된 스냅샷이 있으면 가져온다. (조회 쓰레드)
+ * @return 새 스냅샷을 가져왔으면 true
+ */
+static bool par_QuerySnapshot(struct parQry_t *g)
+{
+	uint32_t old;
+
+	if(!(__atomic_load_n(&g->ready, __ATOMIC_ACQUIRE) & PAR_QRY_NEW))
+		return false;
+	old = __atomic_exchange_n(&g->ready, (uint32_t)g->r, __ATOMIC_ACQ_REL);
+	g->r = old & 3;
+	return true;
+}
+
+/**
+ * par_QueryClientClose()
+ * 클라이언트 연결을 닫는다.
+ */
+static void par_QueryClientClose(struct parQryClient_t *cl)
+{
+	close(cl->fd);
+	free(cl->out);
+	memset(cl, 0, sizeof(struct parQryClient_t));
+	cl->fd = -1;
+}
+
+/**
+ * par_QuerySend()
+ * 클라이언트에 데이터를 보낸다. 보내지 못한 나머지는 클라이언트 버퍼에 복사하여 POLLOUT 시 마저 보낸다.
+ * @return 성공 시 0, 연결 오류 시 -1
+ */
+static int par_QuerySend(struct parQryClient_t *cl, const char *data, size_t len)
+{
+	ssize_t n;
+
+	n = send(cl->fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+	if(n < 0)
+	{
+		if(errno != EAGAIN && errno != EWOULDBLOCK)
+			return -1;
+		n = 0;
+	}
+	if((size_t)n < len)
+	{
+		cl->out = malloc(len - n);
+		if(cl->out == NULL)
+			return -1;
+		memcpy(cl->out, data + n, len - n);
+		cl->outLen = len - n;
+		cl->outOff = 0;
+	}
+	return 0;
+}
+
+/**
+ * par_QueryFlush()
+ * 보내지 못한 데이터를 마저 보낸다.
+ * @return 성공 시 0, 연결 오류 시 -1
+ */
+static int par_QueryFlush(struct parQryClient_t *cl)
+{
+	ssize_t n;
+
+	n = send(cl->fd, cl->out + cl->outOff, cl->outLen - cl->outOff, MSG_DONTWAIT | MSG_NOSIGNAL);
+	if(n < 0)
+		return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+	cl->outOff += n;
+	if(cl->outOff == cl->outLen)
+	{
+		free(cl->out);
+		cl->out = NULL;
+		cl->outLen = cl->outOff = 0;
+	}
+	return 0;
+}
+
+/**
+ * par_QueryReply()
+ * 스냅샷(또는 응답 문자열)을 클라이언트에 보낸다. 이전 데이터를 아직 보내는 중이면 건너뛴다.
+ * @return 성공 시 0, 연결 오류 시 -1
+ */
+static int par_QueryReply(struct parQryClient_t *cl, const char *data, size_t len)
+{
+	if(cl->out != NULL)
+	{
+		cl->skip++;
+		return 0;
+	}
+	return par_QuerySend(cl, data, len);
+}
+
+/**
+ * par_QueryCommand()
+ * 클라이언트 명령 한 줄을 처리한다.
+ * @return 성공 시 0, 연결 오류 시 -1
+ */
+static int par_QueryCommand(struct parQry_t *g, struct parQryClient_t *cl, const char *cmd)
+{
+	static const char ok[] = "{\"result\":\"ok\"}\n";
+	static const char err[] = "{\"error\":\"unknown command\"}\n";
+
+	if(strcmp(cmd, "get") == 0)
+		return par_QueryReply(cl, g->snap[g->r].data, g->snap[g->r].len);
+	if(strcmp(cmd, "subscribe") == 0)
+	{
+		cl->subscribe = true;
+		return par_QueryReply(cl, ok, sizeof(ok) - 1);
+	}
+	if(strcmp(cmd, "unsubscribe") == 0)
+	{
+		cl->subscribe = false;
+		return par_QueryReply(cl, ok, sizeof(ok) - 1);
+	}
+	if(cmd[0] == '\0')
+		return 0;
+	return par_QueryReply(cl, err, sizeof(err) - 1);
+}
+
+/**
+ * par_QueryRead()
+ * 클라이언트가 보낸 명령을 읽어 줄 단위로 처리한다.
+ * @return 성공 시 0, 연결 종료/오류 시 -1
+ */
+static int par_QueryRead(struct parQry_t *g, struct parQryClient_t *cl)
+{
+	char buf[256];
+	ssize_t n;
+
+	n = recv(cl->fd, buf, sizeof(buf), MSG_DONTWAIT);
+	if(n == 0)
+		return -1;
+	if(n < 0)
+		return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+	for(ssize_t i = 0; i < n; i++)
+	{
+		if(buf[i] == '\n')
+		{
+			if(cl->cmdLen > 0 && cl->cmd[cl->cmdLen - 1] == '\r')
+				cl->cmdLen--;
+			cl->cmd[cl->cmdLen] = '\0';
+			cl->cmdLen = 0;
+			if(par_QueryCommand(g, cl, cl->cmd) < 0)
+				return -1;
+		}
+		else if(cl->cmdLen < PAR_QRY_CMD_MAX - 1)
+			cl->cmd[cl->cmdLen++] = buf[i];
+	}
+	return 0;
+}
+
+/**
+ * par_QueryThread()
+ * 조회 소켓의 접속/명령을 처리하고, 새 스냅샷이 게시되면 구독 클라이언트에 보내는 쓰레드
+ */
+static void* par_QueryThread(void *arg)
+{
+	struct parQry_t *g = (struct parQry_t*)arg;
+	struct pollfd pfd[PAR_QRY_CLIENT_MAX + 2];
+	int map[PAR_QRY_CLIENT_MAX + 2];
+	char drain[64];
+	int n, fd;
+
+	while(__atomic_load_n(&g->running, __ATOMIC_ACQUIRE))
+	{
+		pfd[0].fd = g->pipeFd[0];
+		pfd[0].events = POLLIN;
+		pfd[1].fd = g->listenFd;
+		pfd[1].events = POLLIN;
+		n = 2;
+		for(int i = 0; i < PAR_QRY_CLIENT_MAX; i++)
+		{
+			if(g->client[i].fd < 0)
+				continue;
+			pfd[n].fd = g->client[i].fd;
+			pfd[n].events = POLLIN | (g->client[i].out != NULL ? POLLOUT : 0);
+			map[n++] = i;
+		}
+
+		if(poll(pfd, n, -1) < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			syslog(LOG_ERR | LOG_LOCAL5, "[PAR_QRY] poll() fail : %s\n", strerror(errno));
+			break;
+		}
+
+		/* 새 스냅샷 - 구독 클라이언트에 전송 */
+		if(pfd[0].revents & POLLIN)
+		{
+			while(read(g->pipeFd[0], drain, sizeof(drain)) > 0)
+				;
+			if(par_QuerySnapshot(g))
+			{
+				for(int i = 0; i < PAR_QRY_CLIENT_MAX; i++)
+				{
+					struct parQryClient_t *cl = &g->client[i];
+					if(cl->fd >= 0 && cl->subscribe &&
+							par_QueryReply(cl, g->snap[g->r].data, g->snap[g->r].len) < 0)
+						par_QueryClientClose(cl);
+				}
+			}
+		}
+
+		/* 새 접속 */
+		if(pfd[1].revents & POLLIN)
+		{
+			while((fd = accept4(g->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+			{
+				int i;
+				for(i = 0; i < PAR_QRY_CLIENT_MAX && g->client[i].fd >= 0; i++)
+					;
+				if(i == PAR_QRY_CLIENT_MAX)
+				{
+					syslog(LOG_ERR | LOG_LOCAL5, "[PAR_QRY] Too many clients(%d)\n", PAR_QRY_CLIENT_MAX);
+					close(fd);
+					continue;
+				}
+				g->client[i].fd = fd;
+			}
+		}
+
+		/* 클라이언트 명령/전송 */
+		for(int k = 2; k < n; k++)
+		{
+			struct parQryClient_t *cl = &g->client[map[k]];
+
+			if(cl->fd != pfd[k].fd)
+				continue; /* 이번 루프에서 닫힘 */
+			if((pfd[k].revents & (POLLERR | POLLHUP | POLLNVAL)) ||
+					((pfd[k].revents & POLLOUT) && cl->out != NULL && par_QueryFlush(cl) < 0) ||
+					((pfd[k].revents & POLLIN) && par_QueryRead(g, cl) < 0))
+				par_QueryClientClose(cl);
+		}
+	}
+
+	for(int i = 0; i < PAR_QRY_CLIENT_MAX; i++)
+	{
+		if(g->client[i].fd >= 0)
+			par_QueryClientClose(&g->client[i]);
+	}
+	return NULL;
+}
+
+/**
+ * par_QueryClose()
+ * 조회 쓰레드를 종료하고 소켓을 삭제한다.
+ */
+void par_QueryClose(void)
+{
+	struct parQry_t *g = g_parQry;
+	char c = 0;
+
+	if(g == NULL)
+		return;
+
+	__atomic_store_n(&g->running, false, __ATOMIC_RELEASE);
+	if(write(g->pipeFd[1], &c, 1) < 0 && errno != EAGAIN)
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_QRY] Fail to notify query thread : %s\n", strerror(errno));
+	pthread_join(g->thread, NULL);
+	g_parQry = NULL;
+
+	close(g->listenFd);
+	close(g->pipeFd[0]);
+	close(g->pipeFd[1]);
+	unlink(g_mib.qrySock);
+	for(int i = 0; i < 3; i++)
+		free(g->snap[i].data);
+	free(g);
+}
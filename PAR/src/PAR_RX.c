@@ -9,6 +9,7 @@
 #include <sys/ipc.h>
 #include <signal.h>
 #include <malloc.h>
+#include <sched.h>
 #include <PAR.h>
 
 
@@ -19,36 +20,91 @@
 int par_InitRXoperation();
 void par_RXoperation();
 void par_Report(void);
-long double ldCaldistance(uint32_t rlo, uint32_t rla, uint32_t olo, uint32_t ola);
+static void par_ReportWindow(uint64_t win);
+long double ldCaldistance(int32_t rlo, int32_t rla, int32_t olo, int32_t ola);
 static void* rxThread(void *notused);
 static void* userSelectThread(void *notused);
-void createNode();
+struct parInfo_t* createNode(int rsuID, uint8_t channel, uint8_t ifIdx);
 void freeAllNode();
-struct parInfo_t* getNode(int index);
-void getCalDataRcpi(uint8_t* array, int arrayIdx, double* saveArray); // int mode);
-void getCalDataRxpower(int16_t* array, int arrayIdx, double* saveArray); //int mode);
+struct parInfo_t* getNode(int rsuID, uint8_t channel, uint8_t ifIdx);
+void getCalData(const struct parStat_t *stat, int32_t offset, int32_t width, double *basic, double *ext);
+static void par_StatAdd(struct parStat_t *stat, int32_t value, int32_t offset, int32_t width);
+static void par_UpdateLatency(struct parInfo_t *node, struct parWindow_t *w, const struct parPacket_t *pkt);
 bool isThereRSUID(int rsuID);
+static void par_UpdateWindow(struct parInfo_t *node, const struct parPacket_t *pkt);
+static int par_ParsePacket(const uint8_t *buf, uint32_t len, struct parPacket_t *pkt);
+static void par_RecycleNodes(void);
+static void par_ObuPosition(const struct parPacket_t *pkt);
+static void par_CompareLinks(int num);
 bool debugModeFirstCheck;
+static uint64_t g_parWinClosed; //마감된 마지막 보고 구간 번호 (이하 구간의 패킷은 늦은 패킷으로 버린다)
+static uint64_t g_parWinDrained; //보고를 마친 마지막 보고 구간 번호
+static uint32_t g_parWinLate; //마감된 구간에 속하거나 너무 앞선 패킷 수 (수신 쓰레드만 증가)
+static uint32_t g_parWriters[2]; //에포크(구간 번호 & 1) 별 기록 중인 수신 쓰레드 수
+static uint32_t g_parReportSeq; //par_Report() 횟수 (노드 수신 시각 비교용)
+static struct parHistory_t g_parHistory[RSU_HISTORY_MAX]; //퇴출 RSU 이력 (보고 쓰레드)
+static uint32_t g_parHistoryNum; //누적 퇴출 수
+static int32_t g_parRsuLat[RSU_TABLE_MAX]; //보고 리스트 순서의 RSU 위도 (거리 일괄 계산용)
+static int32_t g_parRsuLon[RSU_TABLE_MAX]; //보고 리스트 순서의 RSU 경도
+static double g_parDist[RSU_TABLE_MAX]; //보고 리스트 순서의 RSU 거리(m)
+/* 보고 구간에 수신이 있었던 링크 - 같은 RSU의 채널/인터페이스 별 비교용 */
+struct parLink_t{
+	struct parInfo_t *node;
+	uint32_t cnt; //보고 구간 수신 수
+};
+static struct parLink_t g_parLinks[RSU_TABLE_MAX];
+/* 공유메모리 통계 (v2xtop) */
+static struct {
+	const struct v2xstatDesc_t *rx; //수신 패킷
+	const struct v2xstatDesc_t *parseFail; //해석 실패
+	const struct v2xstatDesc_t *noNode; //RSU 테이블 부족
+	const struct v2xstatDesc_t *late; //늦은 패킷
+	const struct v2xstatDesc_t *latOver; //지연시간 히스토그램 범위를 넘은 샘플
+	const struct v2xstatDesc_t *links; //보고 구간에 수신이 있었던 링크 수
+	const struct v2xstatDesc_t *report; //보고 구간 수
+	const struct v2xstatDesc_t *reportTime; //보고 구간 처리시간
+} g_parStat;
+static void par_InitStat(void);
 /**
  * par_InitRXoperation() 
  * PAR 수신동작을 초기화한다.
- * 수신 타이머 관련 뮤텍스, 컨디션시그널 초기화
- * 타이머 생성 및 RX 쓰레드 생성
- * GPSD OPEN 
+ * 보고 구간 초기화 및 RX 쓰레드 생성
+ * GNSS 쓰레드 생성 (gpsd 읽기)
  * @return   성공 시 0, 실패 시 -1
  */
 int par_InitRXoperation(){
 
 	int32_t ret;
 	int status;
-	/* 링크드리스트 구조체 동적할당 */
+	/* RSU 테이블 동적할당 - 노드 슬랩과 해시 슬롯을 미리 할당하여 수신 시 malloc()을 하지 않는다. */
 	if (ListPtr == NULL) {
 		ListPtr = (linkedList*)malloc(sizeof(linkedList));
 		ListPtr->cur = NULL;
 		ListPtr->head = NULL;
 		ListPtr->tail = NULL;
 		ListPtr->numOfList = 0;
+		ListPtr->slab = (struct parInfo_t*)calloc(RSU_TABLE_MAX, sizeof(struct parInfo_t));
+		ListPtr->hash = (int16_t*)malloc(sizeof(int16_t) * RSU_HASH_SIZE);
+		ListPtr->freeSlot = (int16_t*)malloc(sizeof(int16_t) * RSU_TABLE_MAX);
+		ListPtr->newRing = (struct parInfo_t**)calloc(RSU_TABLE_MAX, sizeof(struct parInfo_t*));
+		ListPtr->retireRing = (struct parInfo_t**)calloc(RSU_TABLE_MAX, sizeof(struct parInfo_t*));
+		if(ListPtr->slab == NULL || ListPtr->hash == NULL || ListPtr->freeSlot == NULL ||
+				ListPtr->newRing == NULL || ListPtr->retireRing == NULL){
+			syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] Fail to allocate RSU table\n");
+			return -1;
+		}
+		memset(ListPtr->hash, 0xff, sizeof(int16_t) * RSU_HASH_SIZE);
+		/* 빈 노드 스택 - 슬랩 앞쪽부터 할당 */
+		for(int i = 0; i < RSU_TABLE_MAX; i++)
+			ListPtr->freeSlot[i] = (int16_t)(RSU_TABLE_MAX - 1 - i);
+		ListPtr->numOfFree = RSU_TABLE_MAX;
+		ListPtr->numOfNode = 0;
+		ListPtr->evictPending = 0;
+		ListPtr->newHead = ListPtr->newTail = 0;
+		ListPtr->retireHead = ListPtr->retireTail = 0;
 	}
+	if(g_mib.rsuMax == 0 || g_mib.rsuMax > RSU_TABLE_MAX)
+		g_mib.rsuMax = RSU_TABLE_MAX;
 	debugModeFirstCheck = false;
 
 	/* 구조체 동적할당 */
@@ -74,17 +130,39 @@ int par_InitRXoperation(){
 		g_mib.cycle = 10;  /* 10msec 수신 주기 */
 	}
 
-	/* 수신 타이머 관련 뮤텍스, 컨디션시그널 초기화*/
-	pthread_mutex_init(&g_mib.txMtx, NULL);
-	pthread_cond_init(&g_mib.txCond, NULL);
+	/* 공유메모리 통계 등록 - 쓰레드 생성 전에 등록한다. */
+	par_InitStat();
 
+	/* 입력 캡처 파일 생성 (-C 옵션) / 재생 파일 열기 (-R 옵션, 재생 시각 설정) */
+	if(par_CapInit() < 0 || par_ReplayInit() < 0)
+		return -1;
 
-	/* 타이머 생성 */
-	InitTxTimer(g_mib.interval); //1초
+	/* 바이너리 로그 쓰레드 생성 (-w 옵션) */
+	if(par_LogInit() < 0)
+		return -1;
+
+	/* 커버리지 지도 초기화 (-m 옵션) */
+	if(par_GeoInit() < 0)
+		return -1;
+
+	/* 실시간 조회 소켓 생성 (-q 옵션) */
+	if(par_QueryInit() < 0)
+		return -1;
+
+	/* 차량군 보고 소켓 생성 (-F 옵션) */
+	if(par_FleetInit() < 0)
+		return -1;
 
-	/* RX쓰레드 생성 */
-	ret = pthread_create(&rx_thread, NULL, rxThread, NULL);
-	if(ret <0){
+	/* 보고 구간 - GPS/UTC 시각을 보고주기(-t)로 나눈 경계에 맞춘다. 시작 시점의 부분 구간은 보고하지 않는다. */
+	g_parWinDrained = g_parWinClosed = par_TimeNow() / g_mib.interval;
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Report window %u usec, first window starts at %llu\n",
+			g_mib.interval, (unsigned long long)((g_parWinDrained + 1) * g_mib.interval));
+
+	/* RX쓰레드 생성 - 재생 모드에서는 수신 루프가 재생 시각에 맞춰 보고한다. */
+	if(g_mib.replayFile[0] != '\0'){
+		syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Replay mode - report from receive loop\n");
+	}
+	else if((ret = pthread_create(&rx_thread, NULL, rxThread, NULL)) != 0){
 		//perror("[PAR] Fail to create RX thread() ");
 		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] Fail to create RX thread()\n");
 		return -1;
@@ -107,15 +185,9 @@ int par_InitRXoperation(){
 	}
 
 
-	/* GPSD 오픈 */
-	ret = gps_open(GPSD_SHARED_MEMORY, 0, &gpsData);
-	if(ret <0){
-		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] gps_open() fail(%s)\n", gps_errstr(ret));
-		shmCheck = true;
-	}
-	else{
-		syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Success gps_open()\n");
-	}
+	/* GNSS 쓰레드 생성 - gpsd 읽기와 위치 이력은 GNSS 쓰레드가 담당한다. */
+	if(par_GnssInit() < 0)
+		return -1;
 
 
 	return 0;
@@ -124,15 +196,15 @@ int par_InitRXoperation(){
 /**
  * par_RXoperation() 
  * PAR 수신동작을 수행한다.
- * GPSD 읽기
  * MQ receive
  * Packet 구조체에 정보 복사
+ * 수신시각의 OBU 위치 추정 (GNSS 이력 보간/추측항법)
  * stPARInfo 구조체에 정보 저장
  */
 void par_RXoperation(){
 
 	int32_t ret;
-	uint32_t len;
+	int32_t len;
 	uint8_t outBuf[BUFSIZE];
 	//int status;
 	void* status;
@@ -146,124 +218,48 @@ void par_RXoperation(){
 
 	while(!ending){
 
-		/* Connection Check */
-		if(shmCheck == true)
-		{
-			gps_close(&gpsData);
-			syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Re connection to GPSD\n");
-			ret = gps_open(GPSD_SHARED_MEMORY, 0, &gpsData);
-
-			if(ret < 0)
-			{
-				syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] gps_open() fail(%s)\n", gps_errstr(ret));
-			}
-			shmCheck = false;
-
-		}
-
-		/* GPS Read */
-		ret = gps_read(&gpsData);
-		if(ret < 0){
-			//printf("[PAR_RX] gps_read() fail( %s)\n", gps_errstr(ret));
-			syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] gps_read() fail( %s)\n", gps_errstr(ret));
-			shmCheck = true;
-		}
-
-		//printf("g_mib_Lati : %u  g_mib_ Longi : %u \n",g_mib.Latitude, g_mib.Longitude);
-
-		/* 차량 위도 경도 인자값으로 받음 */
-		if( g_mib.Latitude != 0 && g_mib.Longitude != 0)
-		{
-			g_obu.obuLatitude = g_mib.Latitude;
-			g_obu.obuLongitude = g_mib.Longitude;
-			//printf("OBULati : %d   OBULongi : %d \n",g_obu.obuLatitude, g_obu.obuLongitude);
-			syslog(LOG_INFO | LOG_LOCAL4,"Success INPUT LATI and LONGI\n");
-#if 0 
-			if(g_mib.dbg)
-			{
-				syslog(LOG_INFO | LOG_LOCAL2,"OBULati : %d   OBULongi : %d \n",g_obu.obuLatitude, g_obu.obuLongitude);
-			}
-#endif
-		}
-
+		/* 기지국 정보 수신 (재생 모드에서는 캡처 파일) */
+		if(g_mib.replayFile[0] != '\0')
+			len = par_ReplayRecv(outBuf);
 		else
-		{
-			/* gpsd로 부터 받음 */
-			if(gpsData.set)
-			{
-				//printf("[PAR_RX] GPSData.set Success\n");
-				//syslog(LOG_INFO | LOG_LOCAL2,"[PAR_RX] GPSData.set Success\n");
-				g_obu.obuLatitude = (int) pow(10,7)*gpsData.fix.latitude;
-				g_obu.obuLongitude = (int) pow(10,7)*gpsData.fix.longitude;
-				g_obu.obuSpeed = gpsData.fix.speed*3.6;
-				g_obu.obuHeading = gpsData.fix.track;
-				//printf("OBULatitude : %d  OBULongitude : %d OBUSpeed : %f OBUHeading : %f \n", g_obu.obuLatitude, g_obu.obuLongitude, g_obu.obuSpeed, g_obu.obuHeading);
-#if 0 
-				if(g_mib.dbg)
-				{
-					syslog(LOG_INFO | LOG_LOCAL2,"OBULatitude : %d  OBULongitude : %d OBUSpeed : %f OBUHeading : %f \n", g_obu.obuLatitude, g_obu.obuLongitude, g_obu.obuSpeed, g_obu.obuHeading);
-				}
-#endif
-			}
-
-			else {
-				/* 인자 값과 gpsd로부터 받지 않음 */
-				//printf("GPS Invalid\n");
-				syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] GPS Invalid\n");
-				g_obu.obuLatitude = 900000001;
-				g_obu.obuLongitude = 1800000001;
-				g_obu.obuSpeed = 8191;
-				g_obu.obuHeading = 28800;
-				//printf("OBULatitude : %d  OBULongitude : %d OBUSpeed : %f OBUHeading : %f \n",g_obu.obuLatitude, g_obu.obuLongitude, g_obu.obuSpeed, g_obu.obuHeading);
-#if 0 
-				if(g_mib.dbg)
-				{
-					syslog(LOG_INFO | LOG_LOCAL4,"OBULatitude : %d  OBULongitude : %d OBUSpeed : %f OBUHeading : %f \n", g_obu.obuLatitude, g_obu.obuLongitude, g_obu.obuSpeed, g_obu.obuHeading);
-				}
-#endif				
-			}
-
-		}
-
-		/* 기지국 정보 수신 */
-		len = recvMQ(outBuf);
+			len = recvMQ(outBuf);
 		if(len<0)
 			continue;
 
 		/* 통신성능 측정프로그램에 필요한 정보 저장 */
 		else if(len >0 && !ending)
 		{
-			memcpy(&g_Packet,outBuf,len);
+			par_CapPacket(outBuf, len);
+			v2xstat_Inc(g_parStat.rx);
+			if(par_ParsePacket(outBuf, len, &g_Packet) < 0){
+				v2xstat_Inc(g_parStat.parseFail);
+				continue;
+			}
+			par_ObuPosition(&g_Packet);
 			//if(g_Packet.rsuID >0 && g_Packet.rsuID <= g_mib.rsuNum)
 			//{
 #if 1
-			/* CreateNode */
-			if(!isThereRSUID(g_Packet.rsuID))
-				createNode();
-			else
-				/* getNode */
-				ListPtr->cur = getNode(g_Packet.rsuID);
-
-			/* arrayIdx 초기화 */
-			if(ListPtr->cur->arrayIdx == 10)
-				ListPtr->cur->arrayIdx = 0;
-
-			ListPtr->cur->check =1;
+			/* 퇴출된 노드 재사용 후 getNode - 없으면 CreateNode (RSU, 채널, 인터페이스 링크 별) */
+			par_RecycleNodes();
+			ListPtr->cur = getNode(g_Packet.rsuID, g_Packet.channel, g_Packet.ifIdx);
+			if(ListPtr->cur == NULL)
+				ListPtr->cur = createNode(g_Packet.rsuID, g_Packet.channel, g_Packet.ifIdx);
+			if(ListPtr->cur == NULL){
+				v2xstat_Inc(g_parStat.noNode);
+				continue;
+			}
+			ListPtr->cur->heard = __atomic_load_n(&g_parReportSeq, __ATOMIC_RELAXED);
+
 			ListPtr->cur->rsuID = g_Packet.rsuID;
 			ListPtr->cur->rsuLongitude = g_Packet.rsuLongitude;
 			ListPtr->cur->rsuLatitude = g_Packet.rsuLatitude;
 			ListPtr->cur->obuSpeed = g_obu.obuSpeed;
 			ListPtr->cur->obuHeading = g_obu.obuHeading;
 			ListPtr->cur->interval = g_mib.cycle;
-			ListPtr->cur->rxpower[ListPtr->cur->arrayIdx] = g_Packet.rxPower;
-			ListPtr->cur->rcpi[ListPtr->cur->arrayIdx] = g_Packet.rcpi;
-			//ListPtr->cur->rcpi2 = g_Packet.rcpi;
-			//ListPtr->cur->rxpower2 = g_Packet.rxPower;
 			ListPtr->cur->obuLongitude = g_obu.obuLongitude;
 			ListPtr->cur->obuLatitude = g_obu.obuLatitude;
-			ListPtr->cur->cnt++;
-			ListPtr->cur->pastArrayidx = ListPtr->cur->arrayIdx;
-			ListPtr->cur->arrayIdx++;
+			/* 수신 수/RXPOWER/RCPI/일련번호는 현재 에포크 통계에 기록 */
+			par_UpdateWindow(ListPtr->cur, &g_Packet);
 #else
 			stPARInfo[g_Packet.rsuID].check =1;
 			stPARInfo[g_Packet.rsuID].rsuID = g_Packet.rsuID;
@@ -295,9 +291,10 @@ void par_RXoperation(){
 	// free(stPARInfo);
 
 
-	/* RX쓰레드 종료 */
+	/* RX쓰레드 종료 (재생 모드에서는 생성하지 않음) */
 	//ret = pthread_join(rx_thread, (void **)status);
-	ret = pthread_join(rx_thread, &status);
+	status = NULL;
+	ret = (g_mib.replayFile[0] != '\0') ? 0 : pthread_join(rx_thread, &status);
 	if( ret == 0 )
 	{
 		//printf("[PAR_RX] Completed join with rxThread status = %s\n", (char*)status);
@@ -325,160 +322,462 @@ void par_RXoperation(){
 		}	
 
 	}
-	/* gpsd close */
-	gps_close(&gpsData);
+	/* GNSS 쓰레드 종료 및 gpsd close */
+	par_GnssClose();
+
+	/* 캡처/재생 파일 닫기 */
+	par_CapClose();
+	par_ReplayClose();
+
+	/* 바이너리 로그 종료 */
+	par_LogClose();
+
+	/* 커버리지 지도 - 남은 변경 타일 기록 */
+	par_GeoClose();
 
+	/* 실시간 조회 종료 (보고 쓰레드 종료 후) */
+	par_QueryClose();
 
-	/* 뮤텍스 및 컨디션시그널 해제 */
-	pthread_mutex_destroy(&g_mib.txMtx);
-	pthread_cond_destroy(&g_mib.txCond);
+	/* 차량군 보고 종료 */
+	par_FleetClose();
 
 	/* 동적할당 해제 */
 	freeAllNode();
 }
 
+/**
+ * par_ObuPosition()
+ * 패킷 수신시각의 OBU 위치를 g_obu에 기록한다.
+ * 위도/경도 인자(-l/-L)가 있으면 그 값을, 없으면 GNSS 이력으로 보간/추측항법한 값을 사용한다.
+ */
+static void par_ObuPosition(const struct parPacket_t *pkt){
+	static bool invalid;
+
+	/* 차량 위도 경도 인자값으로 받음 */
+	if( g_mib.Latitude != 0 && g_mib.Longitude != 0)
+	{
+		g_obu.obuLatitude = g_mib.Latitude;
+		g_obu.obuLongitude = g_mib.Longitude;
+		return;
+	}
+
+	if(par_GnssPosition(pkt->time, &g_obu) == 0)
+	{
+		invalid = false;
+		return;
+	}
+
+	/* 인자 값과 gpsd로부터 받지 않음 */
+	if(!invalid)
+		syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] GPS Invalid\n");
+	invalid = true;
+	g_obu.obuLatitude = 900000001;
+	g_obu.obuLongitude = 1800000001;
+	g_obu.obuSpeed = 8191;
+	g_obu.obuHeading = 28800;
+}
+
+/**
+ * par_ParsePacket()
+ * prcsWSM으로부터 받은 메시지를 패킷 구조체로 변환한다.
+ * 메시지는 RSU 정보(rsuInfo_t, 이전 버전 송신기는 일련번호/송신시각 없음) 뒤에 RXPOWER(2Byte), RCPI(1Byte), 수신시각(8Byte),
+ * 수신 인터페이스(1Byte), 수신 채널번호(1Byte)가 붙은 형태이다.
+ * 이전 버전 prcsWSM(및 그 캡처 파일)은 인터페이스/채널이 없으며, RSU 정보 길이로 구분한다.
+ * @return 성공 시 0, 길이가 맞지 않으면 -1
+ */
+static int par_ParsePacket(const uint8_t *buf, uint32_t len, struct parPacket_t *pkt){
+	const uint32_t tailLen = sizeof(int16_t) + sizeof(uint8_t) + sizeof(uint64_t);
+	const uint32_t linkLen = 2 * sizeof(uint8_t);
+	struct rsuInfo_t rsu;
+	uint32_t infoLen;
+
+	if(len < RSU_INFO_LEGACY_LEN + tailLen){
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_RX] Invalid message length %u\n", len);
+		return -1;
+	}
+	infoLen = len - tailLen;
+	pkt->ifIdx = 0;
+	pkt->channel = 0;
+	if(infoLen - linkLen == RSU_INFO_LEGACY_LEN || infoLen - linkLen == sizeof(struct rsuInfo_t)){
+		infoLen -= linkLen;
+		pkt->ifIdx = buf[infoLen + tailLen];
+		pkt->channel = buf[infoLen + tailLen + 1];
+	}
+
+	memset(&rsu, 0, sizeof(rsu));
+	memcpy(&rsu, buf, (infoLen < sizeof(rsu)) ? infoLen : sizeof(rsu));
+	pkt->rsuID = rsu.rsuID;
+	pkt->rsuLatitude = rsu.rsuLatitude;
+	pkt->rsuLongitude = rsu.rsuLongitude;
+	pkt->hasSeq = (infoLen >= sizeof(struct rsuInfo_t));
+	pkt->seq = rsu.seq;
+	pkt->txTime = rsu.txTime;
+	memcpy(&pkt->rxPower, buf + infoLen, sizeof(int16_t));
+	pkt->rcpi = buf[infoLen + sizeof(int16_t)];
+	memcpy(&pkt->rxTime, buf + infoLen + sizeof(int16_t) + sizeof(uint8_t), sizeof(uint64_t));
+	pkt->time = (pkt->rxTime != 0) ? par_TimeCorrect(pkt->rxTime) : par_TimeNow();
+	return 0;
+}
+
+/**
+ * par_CloseWindow()
+ * 보고 구간을 마감한다.
+ * 마감 후 그 구간의 에포크에 기록 중인 수신 쓰레드가 없을 때까지 대기하므로,
+ * 리턴 후에는 그 구간의 통계를 잠금 없이 일관되게 읽을 수 있다.
+ */
+static void par_CloseWindow(uint64_t win){
+	if(__atomic_load_n(&g_parWinClosed, __ATOMIC_SEQ_CST) < win)
+		__atomic_store_n(&g_parWinClosed, win, __ATOMIC_SEQ_CST);
+	while(__atomic_load_n(&g_parWriters[win & 1], __ATOMIC_SEQ_CST) != 0)
+		sched_yield();
+}
+
+/**
+ * par_UpdateWindow()
+ * 수신 패킷을 수신시각이 속한 보고 구간의 에포크(구간 번호 & 1) 통계에 반영한다. (수신 경로, 블로킹하지 않음)
+ * 에포크는 보고를 마친 구간 다음 두 구간이 번갈아 사용하므로, 이미 마감된 구간이나 그보다 앞선 구간의 패킷은 버리고 센다.
+ * 기록자 수를 증가시킨 후 그 사이 구간이 마감되었으면 기록하지 않는다.
+ * RXPOWER/RCPI 스트리밍 통계는 노드 당 기록자가 하나(수신 루프)임을 전제로 한다.
+ * 같은 패킷을 OBU 위치의 커버리지 지도 타일에도 반영한다.
+ */
+static void par_UpdateWindow(struct parInfo_t *node, const struct parPacket_t *pkt){
+	int e;
+	struct parWindow_t *w;
+	int32_t lost;
+	uint64_t win = pkt->time / g_mib.interval;
+
+	if(win > __atomic_load_n(&g_parWinDrained, __ATOMIC_SEQ_CST) + 2){
+		g_parWinLate++;
+		v2xstat_Inc(g_parStat.late);
+		return;
+	}
+	e = (int)(win & 1);
+	__atomic_fetch_add(&g_parWriters[e], 1, __ATOMIC_SEQ_CST);
+	if(win <= __atomic_load_n(&g_parWinClosed, __ATOMIC_SEQ_CST)){
+		__atomic_fetch_sub(&g_parWriters[e], 1, __ATOMIC_SEQ_CST);
+		g_parWinLate++;
+		v2xstat_Inc(g_parStat.late);
+		return;
+	}
+
+	w = &node->win[e];
+	__atomic_fetch_add(&w->cnt, 1, __ATOMIC_RELAXED);
+	par_StatAdd(&w->rxpower, pkt->rxPower, PAR_HIST_RXPOWER_OFFSET, 1);
+	par_StatAdd(&w->rcpi, pkt->rcpi, PAR_HIST_RCPI_OFFSET, 1);
+	lost = w->seq.lost;
+	if(pkt->hasSeq){
+		par_SeqUpdate(node, &w->seq, pkt->seq);
+		par_UpdateLatency(node, w, pkt);
+	}
+	par_GeoUpdate(node, pkt, w->seq.lost - lost);
+
+	__atomic_fetch_sub(&g_parWriters[e], 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * par_UpdateLatency()
+ * 프로브의 단방향 지연시간(수신시각 - 송신시각)과 지터를 현재 에포크 통계에 반영한다.
+ * 지터는 RFC 3550 방식(J += (|D| - J) / 16)으로 추정하며, 노드에 유지되어 보고 구간과 무관하게 이어진다.
+ * 보정모드가 아니면 고정 보정값(-k)을 뺀다.
+ */
+static void par_UpdateLatency(struct parInfo_t *node, struct parWindow_t *w, const struct parPacket_t *pkt){
+	int64_t transit, d;
+
+	if(pkt->txTime == 0 || pkt->rxTime == 0)
+		return;
+
+	transit = (int64_t)(par_TimeCorrect(pkt->rxTime) - pkt->txTime);
+	if(!g_mib.latCalib)
+		transit -= g_mib.latOffset;
+	if(transit > INT32_MAX)
+		transit = INT32_MAX;
+	else if(transit < INT32_MIN)
+		transit = INT32_MIN;
+
+	if(node->latValid){
+		d = transit - node->latTransit;
+		node->latJitter += ((double)(d < 0 ? -d : d) - node->latJitter) / 16.0;
+	}
+	node->latTransit = transit;
+	node->latValid = true;
+
+	par_StatAdd(&w->latency, (int32_t)transit, PAR_HIST_LAT_OFFSET, PAR_HIST_LAT_WIDTH);
+	w->jitter = node->latJitter;
+}
+
+/**
+ * par_DrainWindow()
+ * 보고 대상 에포크의 통계를 읽어 노드의 보고값(calculateData)을 계산하고, 다음 사용을 위해 초기화한다.
+ * @return 보고 구간 동안의 수신 수
+ */
+static uint32_t par_DrainWindow(struct parInfo_t *node, int epoch){
+	struct parWindow_t *w = &node->win[epoch];
+	uint32_t n = w->cnt;
+
+	getCalData(&w->rxpower, PAR_HIST_RXPOWER_OFFSET, 1, &node->calculateData[PAR_CALC_RXPOWER], &node->calculateData[PAR_CALC_RXPOWER_EXT]);
+	getCalData(&w->rcpi, PAR_HIST_RCPI_OFFSET, 1, &node->calculateData[PAR_CALC_RCPI], &node->calculateData[PAR_CALC_RCPI_EXT]);
+	getCalData(&w->latency, PAR_HIST_LAT_OFFSET, PAR_HIST_LAT_WIDTH, &node->calculateData[PAR_CALC_LAT], &node->calculateData[PAR_CALC_LAT_EXT]);
+	node->calculateData[PAR_CALC_JITTER] = (w->latency.n > 0) ? w->jitter : 0.0;
+	node->latCnt = w->latency.n;
+	node->latOver = w->latency.over;
+	if(w->latency.over > 0)
+		v2xstat_Add(g_parStat.latOver, w->latency.over);
+	par_SeqReport(node, &w->seq);
+
+	memset(w, 0, sizeof(struct parWindow_t));
+	return n;
+}
+
+/**
+ * par_AdoptNodes()
+ * 수신 루프가 새로 만든(또는 되살린) 노드를 보고 리스트 끝에 붙인다. (보고 쓰레드)
+ */
+static void par_AdoptNodes(void){
+	struct parInfo_t *node;
+	uint32_t t = ListPtr->newTail;
+
+	while(t != __atomic_load_n(&ListPtr->newHead, __ATOMIC_ACQUIRE)){
+		node = ListPtr->newRing[t % RSU_TABLE_MAX];
+		t++;
+		node->next = NULL;
+		node->idle = 0;
+		if(ListPtr->tail == NULL)
+			__atomic_store_n(&ListPtr->head, node, __ATOMIC_RELEASE);
+		else
+			__atomic_store_n(&ListPtr->tail->next, node, __ATOMIC_RELEASE);
+		ListPtr->tail = node;
+		ListPtr->numOfList++;
+	}
+	__atomic_store_n(&ListPtr->newTail, t, __ATOMIC_RELEASE);
+}
+
+/**
+ * par_CalcDistance()
+ * 보고 리스트의 RSU 위치를 배열로 모아 현재 OBU 위치로부터의 거리를 일괄 계산한다. (보고 쓰레드)
+ * 결과는 리스트 순서(par_Report()의 idx - 1)로 g_parDist에 저장된다.
+ */
+static void par_CalcDistance(void){
+	struct parInfo_t *node;
+	int n = 0;
+
+	for(node = ListPtr->head; node != NULL && n < RSU_TABLE_MAX; node = node->next){
+		g_parRsuLat[n] = node->rsuLatitude;
+		g_parRsuLon[n] = node->rsuLongitude;
+		n++;
+	}
+	par_DistanceBatch(g_obu.obuLatitude, g_obu.obuLongitude, g_parRsuLat, g_parRsuLon, g_parDist, n);
+}
+
+/**
+ * par_AgeNode()
+ * 보고 구간 수신 수로 노드의 누적 통계와 미수신 구간 수를 갱신한다. (보고 쓰레드)
+ * @return 퇴출할 노드이면 true (미수신 구간 수가 -A 값 이상 또는 최대 RSU 수 초과로 퇴출 요청됨)
+ */
+static bool par_AgeNode(struct parInfo_t *node, uint32_t cnt, uint64_t now){
+	if(cnt != 0){
+		node->idle = 0;
+		if(node->firstHeard == 0)
+			node->firstHeard = now;
+		node->lastHeard = now;
+		node->totalCnt += cnt;
+		node->totalLost += node->seqReport.lost;
+		node->heardWin++;
+	}
+	else
+		node->idle++;
+
+	if(__atomic_load_n(&node->evictReq, __ATOMIC_ACQUIRE))
+		return true;
+	return g_mib.rsuAge != 0 && node->idle >= g_mib.rsuAge;
+}
+
+/**
+ * par_RetireNode()
+ * 노드를 이력으로 남기고 보고 리스트에서 뺀 후 수신 루프에 돌려준다. (보고 쓰레드)
+ * 리스트를 순회 중인 다른 쓰레드(메뉴)를 위해 퇴출 노드의 next는 그대로 둔다.
+ * @param prev 리스트의 이전 노드 (첫 노드이면 NULL)
+ */
+static void par_RetireNode(struct parInfo_t *prev, struct parInfo_t *node){
+	struct parHistory_t *h = &g_parHistory[g_parHistoryNum % RSU_HISTORY_MAX];
+
+	h->rsuID = node->rsuID;
+	h->channel = node->channel;
+	h->ifIdx = node->ifIdx;
+	h->rsuLatitude = node->rsuLatitude;
+	h->rsuLongitude = node->rsuLongitude;
+	h->firstHeard = node->firstHeard;
+	h->lastHeard = node->lastHeard;
+	h->totalCnt = node->totalCnt;
+	h->totalLost = node->totalLost;
+	h->heardWin = node->heardWin;
+	h->bestPAR = node->bestPAR;
+	h->evicted = node->evictReq;
+	g_parHistoryNum++;
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Retire RSUID %d ch%u/if%u (%s) : heard %u windows, total %llu, lost %llu, best PAR %u, first %llu, last %llu\n",
+			h->rsuID, h->channel, h->ifIdx, h->evicted ? "table full" : "unheard", h->heardWin,
+			(unsigned long long)h->totalCnt, (unsigned long long)h->totalLost, h->bestPAR,
+			(unsigned long long)h->firstHeard, (unsigned long long)h->lastHeard);
+
+	if(prev == NULL)
+		__atomic_store_n(&ListPtr->head, node->next, __ATOMIC_RELEASE);
+	else
+		__atomic_store_n(&prev->next, node->next, __ATOMIC_RELEASE);
+	if(ListPtr->tail == node)
+		ListPtr->tail = prev;
+	ListPtr->numOfList--;
+
+	ListPtr->retireRing[ListPtr->retireHead % RSU_TABLE_MAX] = node;
+	__atomic_store_n(&ListPtr->retireHead, ListPtr->retireHead + 1, __ATOMIC_RELEASE);
+}
+
 /**
  * par_Report()
+ * 끝난 보고 구간을 순서대로 보고한다. (보고 쓰레드)
+ * 구간 끝 이후 PAR_WIN_GUARD 동안은 늦게 처리되는 패킷을 기다린다.
+ * 시각이 크게 앞으로 바뀌어 밀린 구간이 PAR_WIN_BACKLOG_MAX 보다 많으면,
+ * 데이터가 있을 수 있는 두 구간만 보고하고 나머지 빈 구간은 건너뛴다.
+ */
+void par_Report(void){
+	uint64_t now = par_TimeNow();
+	uint64_t guard = (g_mib.interval / 2 < PAR_WIN_GUARD) ? g_mib.interval / 2 : PAR_WIN_GUARD;
+	uint64_t last, win;
+	uint32_t late;
+	static uint32_t lateReported;
+
+	if(now < guard + g_mib.interval)
+		return;
+	last = (now - guard) / g_mib.interval - 1; //끝난 마지막 구간
+	win = g_parWinDrained;
+
+	if(last > win + PAR_WIN_BACKLOG_MAX){
+		par_CloseWindow(last - 2);
+		par_ReportWindow(win + 1);
+		par_ReportWindow(win + 2);
+		syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Time jump - skip report window %llu ~ %llu\n",
+				(unsigned long long)(win + 3), (unsigned long long)(last - 2));
+		__atomic_store_n(&g_parWinDrained, last - 2, __ATOMIC_SEQ_CST);
+	}
+	while(g_parWinDrained < last)
+		par_ReportWindow(g_parWinDrained + 1);
+
+	late = __atomic_load_n(&g_parWinLate, __ATOMIC_RELAXED);
+	if(late != lateReported){
+		syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Late or out of window packets : %u\n", late - lateReported);
+		lateReported = late;
+	}
+}
+
+/**
+ * par_ReportWindow()
+ * 보고 구간 하나를 마감하고,
  * 해당 각 기지국에 대하여 거리계산
  * 및 
  * PAR 계산을 수행하고
  * 해당 각 기지국에 대한 정보들 출력
+ * @param win 보고 구간 번호 ([win * 보고주기, (win + 1) * 보고주기) usec)
  */
-void par_Report(void){
+static void par_ReportWindow(uint64_t win){
 
 	int idx = 0;
-	//uint32_t cnt[g_mib.rsuNum];
-	uint32_t cnt[ListPtr->numOfList];
-	//uint32_t maxPAR = 0;
-	//uint32_t curPAR = 0;
-	//printf("[PAR_INFO] Running Timer \n");
-	//syslog(LOG_INFO | LOG_LOCAL4,"[PAR_INFO] Running Timer \n");
+	int epoch = (int)(win & 1);
+	int links = 0;
+	uint32_t cnt;
+	static int32_t calibMin = INT32_MAX; //보정모드 - 측정 시작 후 최소 지연(usec)
+	uint64_t start = win * g_mib.interval;
+	uint64_t end = start + g_mib.interval;
+	struct timespec t0, t1;
 
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+
+	/* 구간 마감 - 이후 이 구간에 속하는 패킷은 늦은 패킷으로 버린다. */
+	par_CloseWindow(win);
+	par_QueryBegin(start, end);
+	par_FleetBegin(start, end);
+	__atomic_store_n(&g_parReportSeq, g_parReportSeq + 1, __ATOMIC_RELAXED);
+
+	/* 새 RSU를 보고 리스트에 추가 */
+	par_AdoptNodes();
+
+	/* 현재 OBU 위치에서 모든 RSU까지의 거리 일괄 계산 */
+	par_CalcDistance();
 
 	struct parInfo_t *ptrTemp = ListPtr->head;
+	struct parInfo_t *prev = NULL;
+	struct parInfo_t *next;
 	/* RSU 갯수 만큼 반복 */
-	//for(idx=0;idx<=g_mib.rsuNum;idx++)
-	for(idx=1;idx<=ListPtr->numOfList;idx++)
+	for(idx=1; ptrTemp != NULL; idx++)
 	{
-		//syslog(LOG_INFO | LOG_LOCAL4, "Report function Test : %d\n",idx);
-		if(ptrTemp == NULL)
-			break;
-
-		//패킷 카운트버퍼 초기화
-		cnt[idx]=0;
 		//curPAR, maxPAR 초기화
-		//stPARInfo[idx].curPAR = 0;
-		//stPARInfo[idx].maxPAR = 0;
-
 		ptrTemp->curPAR = 0;
 		ptrTemp->maxPAR = 0;
 
-
-		/* RSUID 일치 여부 */
-		//if(ptrTemp->rsuID >0 && ptrTemp->rsuID <=RSU_SLOT)
-		//{
-		//printf("RSUID : %d RSUNUM : %d 일치여부\n",ptrTemp->rsuID, g_mib.rsuNum);
-		//printf("--------------------------------------------------------------------------------------------------\n");
+		/* 보고 구간 통계 수집 */
+		cnt = par_DrainWindow(ptrTemp, epoch);
 
 		//기존 들어오던 기지국 정보가 수신되지 않기 시작함
-		if(/*ptrTemp->check >0 &&*/ ptrTemp->cnt==0)
-		{
-			ptrTemp->check = false;
-
-		}
-		else
-			ptrTemp->check = true;
+		ptrTemp->check = (cnt != 0);
 
-		/*
-		// 5초 동안 연속적으로 수신되지 않음
-		if(ptrTemp->check > MAX_ZERO_COUNT && ptrTemp->cnt==0)
+		/* 누적 통계 갱신, 오래 수신되지 않은 RSU는 이력만 남기고 퇴출 */
+		next = ptrTemp->next;
+		if(par_AgeNode(ptrTemp, cnt, end))
 		{
-			// 다음 수신 정보가 있을때까지 통신성능측정프로그램으로 정보전달하지 않음.
-			ptrTemp->check=0;
+			par_RetireNode(prev, ptrTemp);
+			ptrTemp = next;
+			continue;
 		}
-		*/
 
-		// 체크되어 있지 않은 기지국의 정보는 통신성능측정프로그램으로 정보전달하지 않음.
+		// 체크되어 있지 않은 기지국의 정보는 0으로 초기화
 		if(!ptrTemp->check)
 		{
-//			ptrTemp->arrayIdx =0;
-//			ptrTemp = ptrTemp->next;
-//			continue;
 			setZeroParInfo(ptrTemp);
 		}
 		else
 		{
-			/* 거리 계산 */
-			ptrTemp->distance = ldCaldistance(ptrTemp->rsuLongitude, ptrTemp->rsuLatitude, ptrTemp->obuLongitude, ptrTemp->obuLatitude);
-	
-			/* 해당 기지국 받은 CNT 갯수 저장 */
-			cnt[idx] = ptrTemp->cnt;
+			/* 거리 (par_CalcDistance()에서 리스트 순서로 계산) */
+			ptrTemp->distance = g_parDist[idx - 1];
 
-			/* 해당 기지국 CNT 초기화 */
-			ptrTemp->cnt = 0;
-
-		// 현재 측정지점에서 최대 PAR 갱신
-		//curPAR = (cnt[idx]*100)/(1000/stPARInfo[idx].interval);
-		//if( curPAR > maxPAR )
-		//	maxPAR = curPAR;
-
-#if 1 
-
-			/* 현재 PAR 계산 */
-			ptrTemp->curPAR = (cnt[idx]*100)/(1000/ptrTemp->interval);
+			/* 현재 PAR 계산 - 수신 수 / 보고 구간 동안 기대 수신 수 */
+			ptrTemp->curPAR = (int)((uint64_t)cnt * 100 * ptrTemp->interval * 1000 / g_mib.interval);
 	
 			/* PAR최대값 계산 */
 			if(ptrTemp->curPAR > ptrTemp->maxPAR)
 				ptrTemp->maxPAR = ptrTemp->curPAR;
-	
+			if(ptrTemp->curPAR > ptrTemp->bestPAR)
+				ptrTemp->bestPAR = ptrTemp->curPAR;
 		}
 
-		/* dbg모드 */
-		if(g_mib.dbg){
-			//printf("RSU ID : %d  RSUNUM : %d dbg모드\n",ptrTemp->rsuID,g_mib.rsuNum);
-			//printf("--------------------------------------------------------------------------------------------------\n");
-			
-#if 0
-			syslog(LOG_INFO | LOG_LOCAL4, "RSUID : %d, RSULatitude : %d, RSULongitude : %d, OBULatitude : %d, OBULongitude : %d\n", 
-//					ptrTemp->check,
-					ptrTemp->rsuID,
-					ptrTemp->rsuLatitude,
-					ptrTemp->rsuLongitude,
-					ptrTemp->obuLatitude,
-					ptrTemp->obuLongitude);
-
-			syslog(LOG_INFO | LOG_LOCAL4, /*"RXPOWER : %d, rcpi : %d,*/"Distance : %.0f, OBUSpeed : %3.2f, OBUHeading : %3.2f, CNT : %u, PAR : %d\n",
-					//ptrTemp->rxpower2,
-					//ptrTemp->rcpi2,
-					ptrTemp->distance,
-					(double)ptrTemp->obuSpeed,
-					(double)ptrTemp->obuHeading,
-					cnt[idx],
-					ptrTemp->maxPAR);
-			
-#endif
-
-				if(ptrTemp->check && ptrTemp->arrayIdx == 0)
-				{
-					getCalDataRcpi(ptrTemp->rcpi, ptrTemp->pastArrayidx,ptrTemp->calculateData); //0);
-					getCalDataRxpower(ptrTemp->rxpower, ptrTemp->pastArrayidx,ptrTemp->calculateData); //0);
-				}
-				else{
-					getCalDataRcpi(ptrTemp->rcpi, ptrTemp->arrayIdx,ptrTemp->calculateData); //0);
-					getCalDataRxpower(ptrTemp->rxpower, ptrTemp->arrayIdx,ptrTemp->calculateData); //0);
-				}
-			//getCalDataRcpi(ptrTemp->rcpi, ptrTemp->arrayIdx,0);
-			//getCalDataRxpower(ptrTemp->rxpower, ptrTemp->arrayIdx,0);
+		/* 바이너리 로그/차량군 보고 - 수신이 있었던 RSU만 기록 */
+		if(ptrTemp->check){
+			par_LogPut(ptrTemp, cnt, start, end);
+			par_FleetPut(ptrTemp, cnt);
+			g_parLinks[links].node = ptrTemp;
+			g_parLinks[links++].cnt = cnt;
+		}
 
+		/* 실시간 조회 스냅샷 - 모든 RSU (active로 수신 여부 표시) */
+		par_QueryPut(ptrTemp, cnt);
 
+		/* 지연시간 보정모드 - 같은 호스트에서 송수신 시 최소 지연이 고정 보정값(-k)이 된다. */
+		if(g_mib.latCalib && ptrTemp->latCnt > 0)
+		{
+			if(ptrTemp->calculateData[PAR_CALC_LAT] < calibMin)
+				calibMin = (int32_t)ptrTemp->calculateData[PAR_CALC_LAT];
+			syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Latency calibration - RSUID %d : samples %u, min %d usec, p50 %d usec => offset(-k) %d usec\n",
+					ptrTemp->rsuID, ptrTemp->latCnt, (int)ptrTemp->calculateData[PAR_CALC_LAT],
+					(int)ptrTemp->calculateData[PAR_CALC_LAT_EXT + 1], calibMin);
+		}
 
+		/* dbg모드 - RSU마다 매 보고 구간 출력하므로 바이너리 로그(V2XLOG)로 남긴다. (디버그 레벨에서만 기록) */
+		if(V2XLOG_ENABLED(LOG_DEBUG)){
 			if(!debugModeFirstCheck){
-				syslog(LOG_INFO | LOG_LOCAL4, "RSUID, RSULatitude, RSULongitude, OBULatitude, OBULongitude, Distance, OBUSpeed, OBUHeading, CNT, PAR, Min_rxpower, Max_rxpower, Avr_rxpower, Last_rxpower, Min_rcpi, Max_rcpi, Avr_rcpi, Last_rcpi\n"); 
+				V2XLOG(LOG_DEBUG | LOG_LOCAL4, "RSUID, Channel, If, RSULatitude, RSULongitude, OBULatitude, OBULongitude, Distance, OBUSpeed, OBUHeading, CNT, PAR, Min_rxpower, Max_rxpower, Avr_rxpower, Last_rxpower, Min_rcpi, Max_rcpi, Avr_rcpi, Last_rcpi, Std_rxpower, P50_rxpower, P90_rxpower, P99_rxpower, Std_rcpi, P50_rcpi, P90_rcpi, P99_rcpi, SeqRcv, Lost, LossRate, Reorder, Dup, Burst, GE_p, GE_r, BurstLen, Min_latency, Max_latency, Avr_latency, Std_latency, P50_latency, P90_latency, P99_latency, Jitter, Over_latency\n"); 
 				debugModeFirstCheck = true;
 			}
 
-			syslog(LOG_INFO | LOG_LOCAL4, "%d, %d, %d, %d, %d, %.0f, %3.2f, %3.2f, %u, %d, %d, %d, %.1f, %d, %d, %d, %.1f, %d\n",
+			V2XLOG(LOG_DEBUG | LOG_LOCAL4, "%d, %u, %u, %d, %d, %d, %d, %.0f, %3.2f, %3.2f, %u, %d, %d, %d, %.1f, %d, %d, %d, %.1f, %d, %.2f, %d, %d, %d, %.2f, %d, %d, %d, %u, %u, %.2f, %u, %u, %u, %.4f, %.4f, %.2f, %d, %d, %.1f, %.1f, %d, %d, %d, %.1f, %u\n",
 					ptrTemp->rsuID,
+					ptrTemp->channel,
+					ptrTemp->ifIdx,
 					ptrTemp->rsuLatitude,
 					ptrTemp->rsuLongitude,
 					ptrTemp->obuLatitude,
@@ -486,7 +785,7 @@ void par_Report(void){
 					ptrTemp->distance,
 					(double)ptrTemp->obuSpeed,
 					(double)ptrTemp->obuHeading,
-					cnt[idx],
+					cnt,
 					ptrTemp->maxPAR,
 					(int)ptrTemp->calculateData[0],
 					(int)ptrTemp->calculateData[1],
@@ -495,38 +794,102 @@ void par_Report(void){
 					(int)ptrTemp->calculateData[4],
 					(int)ptrTemp->calculateData[5],
 					ptrTemp->calculateData[6],
-					(int)ptrTemp->calculateData[7]);
-
-			syslog(LOG_INFO | LOG_LOCAL4, "------------------------------------------------------------------------------------------------\n");
+					(int)ptrTemp->calculateData[7],
+					ptrTemp->calculateData[8],
+					(int)ptrTemp->calculateData[9],
+					(int)ptrTemp->calculateData[10],
+					(int)ptrTemp->calculateData[11],
+					ptrTemp->calculateData[12],
+					(int)ptrTemp->calculateData[13],
+					(int)ptrTemp->calculateData[14],
+					(int)ptrTemp->calculateData[15],
+					ptrTemp->seqReport.rcv,
+					ptrTemp->seqReport.lost,
+					ptrTemp->seqReport.lossRate,
+					ptrTemp->seqReport.reorder,
+					ptrTemp->seqReport.dup,
+					ptrTemp->seqReport.burst,
+					ptrTemp->seqReport.geP,
+					ptrTemp->seqReport.geR,
+					ptrTemp->seqReport.burstLen,
+					(int)ptrTemp->calculateData[PAR_CALC_LAT],
+					(int)ptrTemp->calculateData[PAR_CALC_LAT + 1],
+					ptrTemp->calculateData[PAR_CALC_LAT + 2],
+					ptrTemp->calculateData[PAR_CALC_LAT_EXT],
+					(int)ptrTemp->calculateData[PAR_CALC_LAT_EXT + 1],
+					(int)ptrTemp->calculateData[PAR_CALC_LAT_EXT + 2],
+					(int)ptrTemp->calculateData[PAR_CALC_LAT_EXT + 3],
+					ptrTemp->calculateData[PAR_CALC_JITTER],
+					ptrTemp->latOver);
+
+			V2XLOG(LOG_DEBUG | LOG_LOCAL4, "------------------------------------------------------------------------------------------------\n");
 		}
-#else
-		printf("CHECK : %u, RSUID : %d, RSU Latitude : %d, RSU Longitude : %d, OBU Latitude : %d, OBU Longitude : %d,  RXPOWER : %d, rcpi : %d, distance : %.0f, OBUSpeed : %3.2f, OBUHeading : %3.2f, CNT : %u, PAR : %d\n",
-				stPARInfo[idx].check,
-				stPARInfo[idx].rsuID,
-				stPARInfo[idx].rsuLatitude,
-				stPARInfo[idx].rsuLongitude,
-				stPARInfo[idx].obuLatitude,
-				stPARInfo[idx].obuLongitude,
-				stPARInfo[idx].rxpower,
-				stPARInfo[idx].rcpi,
-				stPARInfo[idx].distance,
-				(double)stPARInfo[idx].obuSpeed,
-				(double)stPARInfo[idx].obuHeading,
-				cnt[idx],
-				stPARInfo[idx].maxPAR);
-#endif
-		//if(ptrTemp->arrayIdx !=0)
-		//ptrTemp->pastArrayidx = ptrTemp->arrayIdx;
-		ptrTemp->arrayIdx =0;
-		//ptrTemp->check = true;
-		ptrTemp = ptrTemp->next;
-		//}
+		prev = ptrTemp;
+		ptrTemp = next;
+	}
+	par_CompareLinks(links);
+	par_LogFlush();
+	par_QueryPublish();
+	par_FleetFlush();
+	__atomic_store_n(&g_parWinDrained, win, __ATOMIC_SEQ_CST);
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	v2xstat_Inc(g_parStat.report);
+	v2xstat_Set(g_parStat.links, links);
+	v2xstat_Observe(g_parStat.reportTime,
+			(int64_t)(t1.tv_sec - t0.tv_sec) * 1000000 + (t1.tv_nsec - t0.tv_nsec) / 1000);
+}
+
+/**
+ * par_LinkCmp()
+ * 링크 정렬 - rsuID, 채널, 인터페이스 순
+ */
+static int par_LinkCmp(const void *a, const void *b){
+	const struct parInfo_t *x = ((const struct parLink_t*)a)->node;
+	const struct parInfo_t *y = ((const struct parLink_t*)b)->node;
+
+	if(x->rsuID != y->rsuID)
+		return (x->rsuID < y->rsuID) ? -1 : 1;
+	if(x->channel != y->channel)
+		return (int)x->channel - (int)y->channel;
+	return (int)x->ifIdx - (int)y->ifIdx;
+}
+
+/**
+ * par_CompareLinks()
+ * 보고 구간에 둘 이상의 채널/인터페이스로 수신된 RSU에 대해
+ * 링크 별 PAR, 수신 수, RXPOWER/RCPI 평균, 손실률, 지연 p50을 한 줄로 나란히 출력한다. (보고 쓰레드)
+ * @param num g_parLinks 수
+ */
+static void par_CompareLinks(int num){
+	char line[1024];
+	int i, j, len;
+
+	if(num < 2)
+		return;
+	qsort(g_parLinks, num, sizeof(struct parLink_t), par_LinkCmp);
+
+	for(i = 0; i < num; i = j){
+		for(j = i + 1; j < num && g_parLinks[j].node->rsuID == g_parLinks[i].node->rsuID; j++)
+			;
+		if(j - i < 2)
+			continue;
 
+		len = snprintf(line, sizeof(line), "[PAR_RX] Link compare RSUID %d :", g_parLinks[i].node->rsuID);
+		for(int k = i; k < j && len < (int)sizeof(line); k++){
+			const struct parInfo_t *n = g_parLinks[k].node;
+			const double *c = n->calculateData;
+
+			len += snprintf(line + len, sizeof(line) - len, "%s ch%u/if%u PAR %u cnt %u rxpower %.1f rcpi %.1f loss %.2f%% lat %d",
+					(k == i) ? "" : " |", n->channel, n->ifIdx, n->curPAR, g_parLinks[k].cnt,
+					c[PAR_CALC_RXPOWER + 2], c[PAR_CALC_RCPI + 2], n->seqReport.lossRate,
+					(int)c[PAR_CALC_LAT_EXT + 1]);
+		}
+		syslog(LOG_INFO | LOG_LOCAL4, "%s\n", line);
 	}
 }
 
 void setZeroParInfo(struct parInfo_t* ptr){
-	ptr->arrayIdx = 0;
 	ptr->rsuLatitude = 0;
 	ptr->rsuLongitude = 0;
 	ptr->obuLatitude = 0 ;
@@ -538,33 +901,131 @@ void setZeroParInfo(struct parInfo_t* ptr){
 }
 
 /**
- * createNode()
- * 노드 생성
+ * rsuHash()
+ * (rsuID, 채널, 인터페이스) 링크 해시값(해시 슬롯 인덱스) 계산
  */
-void createNode() {
-	//printf("[PAR_RX] createNode\n");
-	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] CreateNode\n");
+static uint32_t rsuHash(int rsuID, uint8_t channel, uint8_t ifIdx){
+	uint32_t h = (uint32_t)rsuID * 2654435761u;
 
-	struct parInfo_t* stPARInfoPtr =(struct parInfo_t *) malloc(sizeof(struct parInfo_t));
-	stPARInfoPtr->next = NULL;
+	h ^= ((uint32_t)channel << 8 | ifIdx) * 0x85ebca77u;
+	return h >> (32 - RSU_HASH_BITS);
+}
+
+/**
+ * rsuHashDelete()
+ * 해시 슬롯에서 슬랩 인덱스를 지운다. (수신 루프)
+ * linear probing 이므로 뒤따르는 항목 중 원래 위치가 빈 슬롯 이전인 항목을 당겨 검색 경로를 유지한다.
+ */
+static void rsuHashDelete(int16_t slot){
+	const struct parInfo_t *node = &ListPtr->slab[slot];
+	uint32_t i = rsuHash(node->rsuID, node->channel, node->ifIdx);
+	uint32_t j, k;
+
+	while(ListPtr->hash[i] != slot)
+		i = (i + 1) & (RSU_HASH_SIZE - 1);
+	ListPtr->hash[i] = -1;
+
+	for(j = (i + 1) & (RSU_HASH_SIZE - 1); ListPtr->hash[j] >= 0; j = (j + 1) & (RSU_HASH_SIZE - 1)){
+		node = &ListPtr->slab[ListPtr->hash[j]];
+		k = rsuHash(node->rsuID, node->channel, node->ifIdx);
+		/* k가 (i, j] 구간 밖이면 i로 옮긴다. */
+		if(((j - k) & (RSU_HASH_SIZE - 1)) >= ((j - i) & (RSU_HASH_SIZE - 1))){
+			ListPtr->hash[i] = ListPtr->hash[j];
+			ListPtr->hash[j] = -1;
+			i = j;
+		}
+	}
+}
+
+/**
+ * par_RequestEvict()
+ * 최대 RSU 수 초과 시 가장 오래 수신하지 않은 노드의 퇴출을 보고 쓰레드에 요청한다. (수신 루프)
+ * 요청한 노드가 돌아올 때까지는 다시 찾지 않는다.
+ */
+static void par_RequestEvict(void){
+	struct parInfo_t *old = NULL;
+
+	if(ListPtr->evictPending > 0)
+		return;
+	for(int i = 0; i < RSU_TABLE_MAX; i++){
+		struct parInfo_t *n = &ListPtr->slab[i];
+		if(!n->inUse || n->evictReq)
+			continue;
+		if(old == NULL || (int32_t)(n->heard - old->heard) < 0)
+			old = n;
+	}
+	if(old == NULL)
+		return;
+	__atomic_store_n(&old->evictReq, true, __ATOMIC_RELEASE);
+	ListPtr->evictPending++;
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] RSU table full(%u) - evict least recently heard RSUID %d (ch%u/if%u)\n",
+			g_mib.rsuMax, old->rsuID, old->channel, old->ifIdx);
+}
+
+/**
+ * par_RecycleNodes()
+ * 보고 쓰레드가 퇴출한 노드를 해시에서 빼고 빈 노드 스택에 넣는다. (수신 루프, 패킷 수신 시)
+ * 퇴출 결정 후 그 사이에 수신이 있었으면(요청 퇴출 제외) 다시 보고 리스트에 넣는다.
+ */
+static void par_RecycleNodes(void){
+	struct parInfo_t *node;
+	uint32_t t = ListPtr->retireTail;
 
-	/* 현재 집어 넣는 노드가 첫 노드일때 */
-	if(ListPtr->head == NULL && ListPtr->tail == NULL)
+	while(t != __atomic_load_n(&ListPtr->retireHead, __ATOMIC_ACQUIRE)){
+		node = ListPtr->retireRing[t % RSU_TABLE_MAX];
+		t++;
 
-		/*head와 tail을 방금 할당한 노드의 주소 값으로 넣어준다 */
-		ListPtr->head = ListPtr->tail = stPARInfoPtr;	
+		if(!node->evictReq && (node->win[0].cnt != 0 || node->win[1].cnt != 0)){
+			ListPtr->newRing[ListPtr->newHead % RSU_TABLE_MAX] = node;
+			__atomic_store_n(&ListPtr->newHead, ListPtr->newHead + 1, __ATOMIC_RELEASE);
+			continue;
+		}
+		if(node->evictReq)
+			ListPtr->evictPending--;
+		rsuHashDelete((int16_t)(node - ListPtr->slab));
+		node->inUse = false;
+		ListPtr->freeSlot[ListPtr->numOfFree++] = (int16_t)(node - ListPtr->slab);
+		ListPtr->numOfNode--;
+	}
+	__atomic_store_n(&ListPtr->retireTail, t, __ATOMIC_RELEASE);
+}
 
-	/* 첫 노드가 아닐때 */
-	else {
+/**
+ * createNode()
+ * 노드 생성 - 빈 노드를 할당하고 해시 슬롯에 등록한 후 보고 쓰레드에 넘긴다. (수신 루프)
+ * 보고 리스트에는 다음 par_Report()에서 추가된다.
+ * @return 생성된 노드, 최대 RSU 수를 넘으면 NULL (가장 오래 수신하지 않은 RSU 퇴출 요청)
+ */
+struct parInfo_t* createNode(int rsuID, uint8_t channel, uint8_t ifIdx) {
+	//printf("[PAR_RX] createNode\n");
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] CreateNode\n");
 
-		/*지금 끝이라고 정의되어있는 노드(tail)의 next에 할당한 노드의 주소 값을 넣어주고 그 끝이라고 정의된 노드에 방금 새롭게 할당한 노드의 주소 값을 넣어주는 것 */
-		ListPtr->tail->next = stPARInfoPtr;
-		ListPtr->tail = stPARInfoPtr; //ListPtr->tail = tail->next;
+	if(ListPtr->numOfNode >= (int)g_mib.rsuMax || ListPtr->numOfFree == 0){
+		par_RequestEvict();
+		return NULL;
 	}
-	ListPtr->cur = ListPtr->tail;
-	ListPtr->tail->cnt = 0;
-	ListPtr->tail->arrayIdx = 0;
-	ListPtr->numOfList++;
+
+	int16_t slot = ListPtr->freeSlot[--ListPtr->numOfFree];
+	struct parInfo_t* stPARInfoPtr = &ListPtr->slab[slot];
+	memset(stPARInfoPtr, 0, sizeof(struct parInfo_t));
+	stPARInfoPtr->rsuID = rsuID;
+	stPARInfoPtr->channel = channel;
+	stPARInfoPtr->ifIdx = ifIdx;
+	stPARInfoPtr->next = NULL;
+	stPARInfoPtr->inUse = true;
+
+	/* 해시 슬롯 등록 (linear probing) */
+	uint32_t h = rsuHash(rsuID, channel, ifIdx);
+	while(ListPtr->hash[h] >= 0)
+		h = (h + 1) & (RSU_HASH_SIZE - 1);
+	ListPtr->hash[h] = slot;
+
+	/* 보고 쓰레드에 넘김 - 초기화가 끝난 노드를 release로 게시한다. */
+	ListPtr->newRing[ListPtr->newHead % RSU_TABLE_MAX] = stPARInfoPtr;
+	__atomic_store_n(&ListPtr->newHead, ListPtr->newHead + 1, __ATOMIC_RELEASE);
+	ListPtr->cur = stPARInfoPtr;
+	ListPtr->numOfNode++;
+	return stPARInfoPtr;
 }
 
 /**
@@ -573,15 +1034,19 @@ void createNode() {
  */
 void freeAllNode(){
 
-	struct parInfo_t* tempPtr = ListPtr->head; //tempPtr = a
-	
-	while(ListPtr->head != NULL){
-	//	struct parInfo_t* tempPtr = ListPtr->head; //tempPtr = a
-		ListPtr->head = ListPtr->head->next; // header = b;
-		free(tempPtr); //a free
-		tempPtr = ListPtr->head; //b
-		syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] Free Node\n");
-	}
+	free(ListPtr->slab);
+	free(ListPtr->hash);
+	free(ListPtr->freeSlot);
+	free(ListPtr->newRing);
+	free(ListPtr->retireRing);
+	ListPtr->slab = NULL;
+	ListPtr->hash = NULL;
+	ListPtr->freeSlot = NULL;
+	ListPtr->newRing = NULL;
+	ListPtr->retireRing = NULL;
+	ListPtr->numOfNode = 0;
+	ListPtr->numOfFree = 0;
+	ListPtr->head = NULL;
 	ListPtr->cur = NULL;
 	ListPtr->tail = NULL;
 	ListPtr->numOfList = 0;
@@ -591,136 +1056,111 @@ void freeAllNode(){
 
 /**
  * getNode()
- * 링크드리스트의 idx번째 아이템을 가져오는 함수
+ * (rsuID, 채널, 인터페이스) 링크에 해당하는 노드를 해시 슬롯에서 찾아 가져오는 함수
+ * @return 노드, 없으면 NULL
  */
-struct parInfo_t* getNode(int rsuID){
-	struct parInfo_t* returnPtr = ListPtr->head;
-
-	while(returnPtr != NULL){
-		if(rsuID == returnPtr->rsuID)
-			break;
-		returnPtr = returnPtr->next;
+struct parInfo_t* getNode(int rsuID, uint8_t channel, uint8_t ifIdx){
+	uint32_t h = rsuHash(rsuID, channel, ifIdx);
+
+	while(ListPtr->hash[h] >= 0){
+		struct parInfo_t* returnPtr = &ListPtr->slab[ListPtr->hash[h]];
+		if(rsuID == returnPtr->rsuID && channel == returnPtr->channel && ifIdx == returnPtr->ifIdx)
+			return returnPtr;
+		h = (h + 1) & (RSU_HASH_SIZE - 1);
 	}
-	return returnPtr;
+	return NULL;
 }
 
 
 /**
- * getCalDataRcpi()
- * RCPI 값 MIN, MAX, avg, 마지막 값 출력 
+ * par_StatAdd()
+ * 스트리밍 통계에 샘플을 추가한다. (패킷 당 O(1))
+ * 평균/분산은 Welford 방식으로 갱신하고, 백분위수 계산을 위해 width 단위 히스토그램에 누적한다.
+ * @param offset 히스토그램 0번 구간에 해당하는 값 (범위를 벗어난 값은 양 끝 구간에 누적)
+ * @param width 히스토그램 구간 폭
  */
-void getCalDataRcpi(uint8_t* array, int arrayIdx, double* saveArray){ //int mode){
-	if(arrayIdx > 0){
-		uint16_t sum = array[0];
-		uint8_t min = array[0];
-		uint8_t max = array[0];
-
-		//syslog(LOG_INFO | LOG_LOCAL4, "rcpi[0]: %d", array[0]);
-
-		for(int i=1; i<arrayIdx; i++){
-
-			sum += array[i];
-
-			if(array[i] < min)
-				min = array[i];
-
-			if(array[i] > max)
-				max = array[i];
-
-			//syslog(LOG_INFO | LOG_LOCAL4, "rcpi[%d]: %d", i, array[i]);
-		}
-		
-		saveArray[4] = min;
-		saveArray[5] = max;
-		saveArray[6] = (double)(sum/arrayIdx);
-		saveArray[7] = array[arrayIdx-1];
-
-		/*
-		if(mode == 0)
-			syslog(LOG_INFO | LOG_LOCAL4, "Max_rcpi : %d, Min_rcpi : %d, Avr_rcpi : %.1f, Last_rcpi : %d\n",
-					max, min, (double)(sum/arrayIdx), array[arrayIdx-1]);
-		else
-			printf("Max_rcpi : %d, Min_rcpi : %d, Avr_rcpi : %.1f, Last_rcpi : %d\n",
-					max, min, (double)(sum/arrayIdx), array[arrayIdx-1]);
-		*/
+static void par_StatAdd(struct parStat_t *stat, int32_t value, int32_t offset, int32_t width){
+	double delta;
+	int64_t bin = ((int64_t)value - offset) / width;
+
+	if(stat->n == 0 || value < stat->min)
+		stat->min = value;
+	if(stat->n == 0 || value > stat->max)
+		stat->max = value;
+	stat->last = value;
+
+	stat->n++;
+	delta = value - stat->mean;
+	stat->mean += delta / stat->n;
+	stat->m2 += delta * (value - stat->mean);
+
+	if(value < offset){
+		bin = 0;
+		stat->under++;
 	}
-	else{
-		saveArray[4] = 0.0;
-		saveArray[5] = 0.0;
-		saveArray[6] = 0.0;
-		saveArray[7] = 0.0;
-
-		/*
-		 if(mode == 0)
-			 syslog(LOG_INFO | LOG_LOCAL4, "Max_rcpi : 0, Min_rcpi : 0, Avr_rcpi : 0.0, Last_rcpi : 0\n");
-		 else
-			 printf("Max_rcpi : 0, Min_rcpi : 0, Avr_rcpi : 0.0, Last_rcpi : 0\n");
-		*/
+	else if(bin >= PAR_HIST_BIN){
+		bin = PAR_HIST_BIN - 1;
+		stat->over++;
 	}
+	stat->hist[bin]++;
 }
 
 /**
- * getCalDataRxpower()
- * RXpower 값 MIN, MAX, avg, 마지막 값 출력 
+ * par_StatPercentile()
+ * 히스토그램으로부터 백분위수를 계산한다. (구간 폭이 1보다 크면 구간 중앙값)
+ * 백분위수가 범위를 벗어나 양 끝 구간에 누적된 샘플에 해당하면 구간 값 대신 min/max를 돌려준다.
+ * (링크 품질이 나빠 지연이 범위를 넘을 때 p90/p99가 마지막 구간 값에 고정되지 않도록)
  */
-void getCalDataRxpower(int16_t* array, int arrayIdx, double* saveArray){ // int mode){
-	if(arrayIdx > 0){
-		int16_t sum = array[0];
-		int16_t min = array[0];
-		int16_t max = array[0];
-
-		//syslog(LOG_INFO | LOG_LOCAL4, "rxpower[0]: %d", array[0]);
-
-		for(int i=1; i<arrayIdx; i++){
-			sum += array[i];
-
-			if(array[i] < min)
-				min = array[i];
-
-			if(array[i] > max)
-				max = array[i];
-
-			//syslog(LOG_INFO | LOG_LOCAL4, "rxpower[%d]: %d", i, array[i]);
+static double par_StatPercentile(const struct parStat_t *stat, int32_t offset, int32_t width, double pct){
+	uint32_t rank = (uint32_t)ceil(pct / 100.0 * stat->n);
+	uint32_t sum = 0;
+
+	if(rank == 0)
+		rank = 1;
+	if(rank <= stat->under)
+		return (double)stat->min;
+	for(int i = 0; i < PAR_HIST_BIN; i++){
+		sum += stat->hist[i];
+		if(sum >= rank){
+			if(i == PAR_HIST_BIN - 1 && rank > sum - stat->over)
+				return (double)stat->max;
+			return (double)(i * width + offset + width / 2);
 		}
+	}
+	return (double)stat->max;
+}
 
-		saveArray[0] = min;
-                saveArray[1] = max;
-                saveArray[2] = (double)(sum/arrayIdx);
-                saveArray[3] = array[arrayIdx-1];
-
-		/*
-		if(mode==0)
-			syslog(LOG_INFO | LOG_LOCAL4, "Max_rxpower : %d, Min_rxpower : %d, Avr_rxpower : %.1f, Last_rxpower : %d\n",
-					max, min, (double)(sum/arrayIdx), array[arrayIdx-1]);
-		else
-			printf("Max_rxpower : %d, Min_rxpower : %d, Avr_rxpower : %.1f, Last_rxpower : %d\n",
-					max, min, (double)(sum/arrayIdx), array[arrayIdx-1]);
-		*/
+/**
+ * getCalData()
+ * 보고 구간 통계로부터 min, max, avg, last 와 표준편차, 백분위수(p50, p90, p99)를 계산한다.
+ * @param basic min, max, avg, last 가 저장된다.
+ * @param ext std, p50, p90, p99 가 저장된다.
+ */
+void getCalData(const struct parStat_t *stat, int32_t offset, int32_t width, double *basic, double *ext){
+	if(stat->n > 0){
+		basic[0] = stat->min;
+		basic[1] = stat->max;
+		basic[2] = stat->mean;
+		basic[3] = stat->last;
+		ext[0] = (stat->n > 1) ? sqrt(stat->m2 / (stat->n - 1)) : 0.0;
+		ext[1] = par_StatPercentile(stat, offset, width, 50);
+		ext[2] = par_StatPercentile(stat, offset, width, 90);
+		ext[3] = par_StatPercentile(stat, offset, width, 99);
 	}
 	else{
-		saveArray[0] = 0.0;
-		saveArray[1] = 0.0;
-		saveArray[2] = 0.0;
-		saveArray[3] = 0.0;
-
-		/*
-		if(mode == 0)
-			syslog(LOG_INFO | LOG_LOCAL4, "Max_rxpower : 0, Min_rxpower : 0, Avr_rxpower : 0.0, Last_rxpower : 0\n");
-		else
-			printf("Max_rxpower : 0, Min_rxpower : 0, Avr_rxpower : 0.0, Last_rxpower : 0\n");
-		*/
+		memset(basic, 0, sizeof(double) * 4);
+		memset(ext, 0, sizeof(double) * 4);
 	}
 }
 
 
-
 /**
  * ldCaldistance()
  * 거리 계산 함수
  * RSU 위도, 경도 와 OBU 위도, 경도 이용하여 거리 계산
  * @return 거리 값
  */
-long double ldCaldistance(uint32_t rlo, uint32_t rla, uint32_t olo, uint32_t ola)
+long double ldCaldistance(int32_t rlo, int32_t rla, int32_t olo, int32_t ola)
 {
 	long double a, b, c, d, x, y, z;
 	a = (long double)((rlo * 1e-7) * M_PI / 180);
@@ -740,16 +1180,22 @@ long double ldCaldistance(uint32_t rlo, uint32_t rla, uint32_t olo, uint32_t ola
 /**
  * rxThread()
  * RX Thread
- * 1초마다 타이머를 울려 PAR_SendReport()함수 호출
+ * 다음 보고 구간 경계(+PAR_WIN_GUARD)까지 대기 후 par_Report()함수 호출
+ * 경계는 보정된 시각 기준이므로 시스템 시각으로 환산하여 CLOCK_REALTIME 절대시각으로 대기한다.
  */
 static  void* rxThread(void *notused){
-
+	uint64_t wake, sys;
+	struct timespec ts;
 
 	while(!ending){
-		/* 송신타이머로부터 시그널이 올때 때까지 대기한다. */
-		pthread_mutex_lock(&g_mib.txMtx);
-		pthread_cond_wait(&g_mib.txCond, &g_mib.txMtx);
-		pthread_mutex_unlock(&g_mib.txMtx);
+		/* 보고를 마친 다음 구간의 끝까지 대기한다. */
+		wake = (g_parWinDrained + 2) * g_mib.interval;
+		wake += (g_mib.interval / 2 < PAR_WIN_GUARD) ? g_mib.interval / 2 : PAR_WIN_GUARD;
+		sys = wake - (par_TimeCorrect(wake) - wake);
+		ts.tv_sec = sys / 1000000;
+		ts.tv_nsec = (sys % 1000000) * 1000;
+		if(clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &ts, NULL) != 0)
+			continue;
 		par_Report();
 	}
 
@@ -793,14 +1239,15 @@ static void* userSelectThread(void *notused){
 				printf("====Please select a number====\n");
 				printf("1. Printing Connected RSUID(s) Information\n");
 				printf("2. Printing the RSU information you want\n");
-				printf("3. QUit\n>> ");
+				printf("3. QUit\n");
+				printf("4. Printing retired RSU(s) history\n>> ");
 				scanf("%d",&num);
 				break;
 			case 1:
 				ptrTemp = ListPtr->head;
 				int count = 1;
 				while(ptrTemp != NULL){
-					printf("RSUID of [%d]: %d\n", count++, ptrTemp->rsuID);
+					printf("RSUID of [%d]: %d (ch%u/if%u)\n", count++, ptrTemp->rsuID, ptrTemp->channel, ptrTemp->ifIdx);
 					ptrTemp = ptrTemp->next;
 				}
 				num = 0;
@@ -808,60 +1255,89 @@ static void* userSelectThread(void *notused){
 			case 2 :
 				printf("Input wanted RSU ID >> ");
 				scanf("%d",&selectRsuID);
-				ptrTemp = getNode(selectRsuID);
-				if(ptrTemp == NULL){
+				/* 같은 RSU의 모든 채널/인터페이스 링크를 출력 */
+				if(!isThereRSUID(selectRsuID)){
 					printf("# Error(Please input correct RsuID\n");
 					break;
 				}
-				printf("**Information of RSU ID[%d]**\n",selectRsuID); 
+				for(ptrTemp = ListPtr->head; ptrTemp != NULL; ptrTemp = ptrTemp->next){
+					if(ptrTemp->rsuID != selectRsuID)
+						continue;
+					printf("**Information of RSU ID[%d] ch%u/if%u**\n", selectRsuID, ptrTemp->channel, ptrTemp->ifIdx);
 #if 0				
-				printf( "RSUID : %d\nRSU Latitude : %d\nRSU Longitude : %d\nOBU Latitude : %d\nOBU Longitude : %d\n",
-					//	ptrTemp->check,
-						ptrTemp->rsuID,
-						ptrTemp->rsuLatitude,
-						ptrTemp->rsuLongitude,
-						ptrTemp->obuLatitude,
-						ptrTemp->obuLongitude);
-				printf(/*"RXPOWER : %d\nRCPI : %d\n*/"Distance : %.0f\nOBUSpeed : %3.2f\nOBUHeading : %3.2f\nPAR : %d\n",
-						//ptrTemp->rxpower2,
-						//ptrTemp->rcpi2,
-						ptrTemp->distance,
-						(double)ptrTemp->obuSpeed,
-						(double)ptrTemp->obuHeading,
-						ptrTemp->maxPAR);
+					printf( "RSUID : %d\nRSU Latitude : %d\nRSU Longitude : %d\nOBU Latitude : %d\nOBU Longitude : %d\n",
+						//	ptrTemp->check,
+							ptrTemp->rsuID,
+							ptrTemp->rsuLatitude,
+							ptrTemp->rsuLongitude,
+							ptrTemp->obuLatitude,
+							ptrTemp->obuLongitude);
+					printf(/*"RXPOWER : %d\nRCPI : %d\n*/"Distance : %.0f\nOBUSpeed : %3.2f\nOBUHeading : %3.2f\nPAR : %d\n",
+							//ptrTemp->rxpower2,
+							//ptrTemp->rcpi2,
+							ptrTemp->distance,
+							(double)ptrTemp->obuSpeed,
+							(double)ptrTemp->obuHeading,
+							ptrTemp->maxPAR);
 #endif
-				if(ptrTemp->check && ptrTemp->arrayIdx == 0)
-				{
-					getCalDataRcpi(ptrTemp->rcpi, ptrTemp->pastArrayidx, ptrTemp->calculateData); //1);
-					getCalDataRxpower(ptrTemp->rxpower, ptrTemp->pastArrayidx, ptrTemp->calculateData); //1);
-				}
-				else
-				{
-					getCalDataRcpi(ptrTemp->rcpi, ptrTemp->arrayIdx, ptrTemp->calculateData); //1);
-					getCalDataRxpower(ptrTemp->rxpower, ptrTemp->arrayIdx, ptrTemp->calculateData); //1);
-				}
-
-				printf("RSUID : %d\nRSULatitude : %d\nRSULongitude : %d\nOBULatitude : %d\nOBULongitude : %d\nDistance : %.0f\nOBUSpeed : %3.2f\nOBUHeading : %3.2f\nPAR : %d\nMin_rxpower : %d\nMax_rxpower : %d\nAvr_rxpower : %.1f\nLast_rxpower : %d\nMin_rcpi : %d\nMax_rcpi : %d\nAvr_rcpi : %.1f\nLast_rcpi : %d\n",
-						ptrTemp->rsuID,
-						ptrTemp->rsuLatitude,
-						ptrTemp->rsuLongitude,
-						ptrTemp->obuLatitude,
-						ptrTemp->obuLongitude,
-						ptrTemp->distance,
-						(double)ptrTemp->obuSpeed,
-						(double)ptrTemp->obuHeading,
-						ptrTemp->maxPAR,
-						(int)ptrTemp->calculateData[0],
-						(int)ptrTemp->calculateData[1],
-						ptrTemp->calculateData[2],
-						(int)ptrTemp->calculateData[3],
-						(int)ptrTemp->calculateData[4],
-						(int)ptrTemp->calculateData[5],
-						ptrTemp->calculateData[6],
-						(int)ptrTemp->calculateData[7]);
+					/* calculateData는 마지막 보고 구간(par_Report())의 통계이다. */
+					printf("RSUID : %d\nRSULatitude : %d\nRSULongitude : %d\nOBULatitude : %d\nOBULongitude : %d\nDistance : %.0f\nOBUSpeed : %3.2f\nOBUHeading : %3.2f\nPAR : %d\nMin_rxpower : %d\nMax_rxpower : %d\nAvr_rxpower : %.1f\nLast_rxpower : %d\nMin_rcpi : %d\nMax_rcpi : %d\nAvr_rcpi : %.1f\nLast_rcpi : %d\nStd_rxpower : %.2f\nP50/P90/P99_rxpower : %d/%d/%d\nStd_rcpi : %.2f\nP50/P90/P99_rcpi : %d/%d/%d\nSeqRcv : %u\nLost : %u (%.2f%%)\nReorder : %u\nDup : %u\nBurst : %u\nGE_p/GE_r : %.4f/%.4f\nBurstLen : %.2f\nMin/Avr/Max_latency : %d/%.1f/%d usec\nP50/P90/P99_latency : %d/%d/%d usec\nJitter : %.1f usec\n",
+							ptrTemp->rsuID,
+							ptrTemp->rsuLatitude,
+							ptrTemp->rsuLongitude,
+							ptrTemp->obuLatitude,
+							ptrTemp->obuLongitude,
+							ptrTemp->distance,
+							(double)ptrTemp->obuSpeed,
+							(double)ptrTemp->obuHeading,
+							ptrTemp->maxPAR,
+							(int)ptrTemp->calculateData[0],
+							(int)ptrTemp->calculateData[1],
+							ptrTemp->calculateData[2],
+							(int)ptrTemp->calculateData[3],
+							(int)ptrTemp->calculateData[4],
+							(int)ptrTemp->calculateData[5],
+							ptrTemp->calculateData[6],
+							(int)ptrTemp->calculateData[7],
+							ptrTemp->calculateData[8],
+							(int)ptrTemp->calculateData[9],
+							(int)ptrTemp->calculateData[10],
+							(int)ptrTemp->calculateData[11],
+							ptrTemp->calculateData[12],
+							(int)ptrTemp->calculateData[13],
+							(int)ptrTemp->calculateData[14],
+							(int)ptrTemp->calculateData[15],
+							ptrTemp->seqReport.rcv,
+							ptrTemp->seqReport.lost,
+							ptrTemp->seqReport.lossRate,
+							ptrTemp->seqReport.reorder,
+							ptrTemp->seqReport.dup,
+							ptrTemp->seqReport.burst,
+							ptrTemp->seqReport.geP,
+							ptrTemp->seqReport.geR,
+							ptrTemp->seqReport.burstLen,
+							(int)ptrTemp->calculateData[PAR_CALC_LAT],
+							ptrTemp->calculateData[PAR_CALC_LAT + 2],
+							(int)ptrTemp->calculateData[PAR_CALC_LAT + 1],
+							(int)ptrTemp->calculateData[PAR_CALC_LAT_EXT + 1],
+							(int)ptrTemp->calculateData[PAR_CALC_LAT_EXT + 2],
+							(int)ptrTemp->calculateData[PAR_CALC_LAT_EXT + 3],
+							ptrTemp->calculateData[PAR_CALC_JITTER]);
 
+				}
 				num=0;
 				break;
+			case 4 :
+				/* 퇴출 RSU 이력 - 최근 RSU_HISTORY_MAX 개 */
+				for(uint32_t i = (g_parHistoryNum > RSU_HISTORY_MAX) ? g_parHistoryNum - RSU_HISTORY_MAX : 0; i < g_parHistoryNum; i++){
+					const struct parHistory_t *h = &g_parHistory[i % RSU_HISTORY_MAX];
+					printf("RSUID %d ch%u/if%u (%s) : heard %u windows, total %llu, lost %llu, best PAR %u, first %llu, last %llu\n",
+							h->rsuID, h->channel, h->ifIdx, h->evicted ? "table full" : "unheard", h->heardWin,
+							(unsigned long long)h->totalCnt, (unsigned long long)h->totalLost, h->bestPAR,
+							(unsigned long long)h->firstHeard, (unsigned long long)h->lastHeard);
+				}
+				num = 0;
+				break;
 			case 3 :
 				/* Trhead 종료 */
 				printf("Success Quit!\n");
@@ -897,16 +1373,31 @@ static void* userSelectThread(void *notused){
 
 /***
  * isThereRSUID()
- * 리스트에 RSUID가 있는지 확인해주는 함수
+ * 리스트에 RSUID가 (어느 채널/인터페이스로든) 있는지 확인해주는 함수
  * 있으면 TRUE 없으면 FALSE
  */
 bool isThereRSUID(int rsuID){
-	struct parInfo_t *ptrTemp = ListPtr->head;
-	while(ptrTemp != NULL){
-		if(ptrTemp->rsuID == rsuID)
+	for(struct parInfo_t *ptr = ListPtr->head; ptr != NULL; ptr = ptr->next){
+		if(ptr->rsuID == rsuID)
 			return true;
-
-		ptrTemp = ptrTemp->next;
 	}
 	return false;
 }
+
+/**
+ * par_InitStat()
+ * PAR 수신 공유메모리 통계를 등록한다. (v2xtop)
+ */
+static void par_InitStat(void)
+{
+	static const int64_t usecBounds[] = V2XSTAT_USEC_BOUNDS;
+
+	g_parStat.rx = v2xstat_Counter("rx.pkt", "pkt");
+	g_parStat.parseFail = v2xstat_Counter("rx.parse_fail", "pkt");
+	g_parStat.noNode = v2xstat_Counter("rx.no_node", "pkt");
+	g_parStat.late = v2xstat_Counter("rx.late", "pkt");
+	g_parStat.latOver = v2xstat_Counter("rx.lat_over", "pkt");
+	g_parStat.links = v2xstat_Gauge("report.links", "link");
+	g_parStat.report = v2xstat_Counter("report.window", "win");
+	g_parStat.reportTime = v2xstat_Hist("report.time", "usec", usecBounds, sizeof(usecBounds) / sizeof(usecBounds[0]));
+}
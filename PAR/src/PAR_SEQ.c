@@ -0,0 +1,128 @@
+/**********************************************************
+  [프로브 일련번호 분석]
+  송신기(PAR TX)는 전송에 성공한 프로브마다 32비트 일련번호를 1씩 증가시킨다.
+  수신기는 RSU 별로 수신한 최대 일련번호(seqHigh)와 최근 PAR_SEQ_WIN 개 일련번호의 수신 비트맵을 유지한다.
+
+  seq > seqHigh : 순서대로 수신, 사이의 공백은 손실(하나의 버스트)로 판정
+  seq <= seqHigh, 비트맵 범위 내 : 비트가 없으면 늦게 도착(순서바뀜, 손실 1 감소), 있으면 중복
+  seq <  seqHigh - PAR_SEQ_WIN   : 송신기 재시작으로 보고 다시 시작
+
+  [Gilbert-Elliott]
+  일련번호로는 상태를 직접 관측할 수 없으므로 Bad 상태 손실률 1, Good 상태 손실률 0 으로 두고
+  p = (버스트 수) / (수신 수), r = (버스트 수) / (손실 수) 로 추정한다. (평균 버스트 길이 = 1/r)
+ ************************************************************/
+
+#include <PAR.h>
+
+
+/**
+ * par_SeqMapSet()
+ * 일련번호의 수신 비트를 설정하고 이전 값을 반환한다.
+ */
+static bool par_SeqMapSet(struct parInfo_t *node, uint32_t seq)
+{
+	uint32_t idx = seq & (PAR_SEQ_WIN - 1);
+	uint32_t bit = 1u << (idx & 31);
+	bool old = (node->seqMap[idx >> 5] & bit) != 0;
+
+	node->seqMap[idx >> 5] |= bit;
+	return old;
+}
+
+/**
+ * par_SeqMapClear()
+ * 일련번호의 수신 비트를 해제한다. (최대 일련번호가 증가할 때 새로 범위에 들어오는 일련번호)
+ */
+static void par_SeqMapClear(struct parInfo_t *node, uint32_t seq)
+{
+	uint32_t idx = seq & (PAR_SEQ_WIN - 1);
+
+	node->seqMap[idx >> 5] &= ~(1u << (idx & 31));
+}
+
+/**
+ * par_SeqUpdate()
+ * 수신한 프로브 일련번호를 RSU의 보고 구간 통계에 반영한다.
+ * 수신 쓰레드에서만 호출된다. (노드의 seqHigh/seqMap은 수신 쓰레드만 사용)
+ * @param win 현재 에포크의 일련번호 통계
+ */
+void par_SeqUpdate(struct parInfo_t *node, struct parSeqWin_t *win, uint32_t seq)
+{
+	int32_t diff;
+	uint32_t gap;
+
+	if(!node->seqValid){
+		node->seqValid = true;
+		node->seqHigh = seq;
+		memset(node->seqMap, 0, sizeof(node->seqMap));
+		par_SeqMapSet(node, seq);
+		win->rcv++;
+		return;
+	}
+
+	diff = (int32_t)(seq - node->seqHigh);
+
+	/* 순서대로 수신 - 공백은 하나의 손실 버스트 */
+	if(diff > 0){
+		gap = (uint32_t)diff - 1;
+		if(gap > 0){
+			win->lost += gap;
+			win->burst++;
+		}
+		if((uint32_t)diff >= PAR_SEQ_WIN)
+			memset(node->seqMap, 0, sizeof(node->seqMap));
+		else{
+			for(uint32_t s = node->seqHigh + 1; s != seq; s++)
+				par_SeqMapClear(node, s);
+		}
+		par_SeqMapSet(node, seq);
+		node->seqHigh = seq;
+		win->rcv++;
+	}
+	/* 비트맵 범위 내의 이전 일련번호 - 늦게 도착 또는 중복 */
+	else if(diff > -PAR_SEQ_WIN){
+		if(par_SeqMapSet(node, seq))
+			win->dup++;
+		else{
+			win->reorder++;
+			win->lost--;
+		}
+	}
+	/* 송신기 재시작 */
+	else{
+		syslog(LOG_INFO | LOG_LOCAL4, "[PAR_RX] RSUID %d sequence restart(%u -> %u)\n", node->rsuID, node->seqHigh, seq);
+		node->seqHigh = seq;
+		memset(node->seqMap, 0, sizeof(node->seqMap));
+		par_SeqMapSet(node, seq);
+		win->rcv++;
+	}
+}
+
+/**
+ * par_SeqReport()
+ * 보고 구간의 일련번호 통계로부터 손실률, 순서바뀜/중복 수, Gilbert-Elliott 파라미터를 계산한다.
+ */
+void par_SeqReport(struct parInfo_t *node, const struct parSeqWin_t *win)
+{
+	struct parSeqReport_t *rep = &node->seqReport;
+
+	memset(rep, 0, sizeof(struct parSeqReport_t));
+	rep->rcv = win->rcv + win->reorder;
+	rep->lost = (win->lost > 0) ? (uint32_t)win->lost : 0;
+	rep->reorder = win->reorder;
+	rep->dup = win->dup;
+	rep->burst = win->burst;
+
+	if(rep->rcv + rep->lost > 0)
+		rep->lossRate = (double)rep->lost * 100.0 / (rep->rcv + rep->lost);
+	if(rep->burst > 0){
+		if(rep->rcv > 0)
+			rep->geP = (double)rep->burst / rep->rcv;
+		if(rep->lost > 0){
+			rep->geR = (double)rep->burst / rep->lost;
+			if(rep->geR > 1.0)
+				rep->geR = 1.0;
+			rep->burstLen = 1.0 / rep->geR;
+		}
+	}
+}
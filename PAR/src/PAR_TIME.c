@@ -0,0 +1,103 @@
+/**********************************************************
+  [송수신 시각]
+  프로브 송신시각과 수신시각은 CLOCK_REALTIME(usec)을 기준으로 한다.
+  -g 옵션 사용 시 gpsd가 알려주는 GPS 시각과 시스템 시각의 차이를 추정하여 보정한다.
+
+  [GPS 시각 보정값 추정]
+  gpsd는 fix 시각(GPS 시각, fix.time)과 fix를 받은 시스템 시각(online)을 제공한다.
+  (fix.time - online) = (GPS - 시스템 시각 오차) - (GPS 수신기 출력/전달 지연) 이므로,
+  전달 지연이 가장 작은 샘플, 즉 최근 PAR_GPS_OFFSET_WIN 개 샘플 중 최대값을 보정값으로 사용한다.
+  남는 고정 전달 지연은 송수신 양단에서 대부분 상쇄되며, 나머지는 보정모드(-K)로 측정한 -k 값으로 보정한다.
+
+  [재생]
+  재생 모드(-R)에서는 현재 시각과 보정값을 캡처 파일의 값으로 대체한다. (par_TimeReplay())
+ ************************************************************/
+
+#include <math.h>
+#include <time.h>
+#include <PAR.h>
+
+#define PAR_GPS_OFFSET_WIN 16 //보정값 추정에 사용하는 최근 fix 수 (1초 주기)
+
+static int64_t g_gpsOffsetSample[PAR_GPS_OFFSET_WIN]; //fix 별 (GPS 시각 - 시스템 시각) 샘플 (usec)
+static int g_gpsOffsetIdx;
+static int g_gpsOffsetNum;
+static double g_gpsLastFix; //마지막으로 반영한 fix 시각
+static int64_t g_gpsOffset; //GPS 시각 보정값 (usec) - gps 읽는 쓰레드가 기록, 송수신 쓰레드가 읽는다.
+static bool g_timeReplay; //재생 모드 여부
+static uint64_t g_timeReplayNow; //재생 시각 (usec) - 수신 쓰레드가 기록
+
+/**
+ * par_TimeUpdateGps()
+ * gps_read() 후 호출되어 GPS 시각 보정값을 갱신한다. (-g 옵션 사용 시)
+ * 새로운 fix에 대해서만 샘플을 추가한다.
+ */
+void par_TimeUpdateGps(const struct gps_data_t *gps)
+{
+	int64_t sample, offset;
+
+	if(!g_mib.gpsTime)
+		return;
+	if(gps->fix.mode < MODE_2D || isnan(gps->fix.time) || gps->online == 0)
+		return;
+	if(gps->fix.time == g_gpsLastFix)
+		return;
+	g_gpsLastFix = gps->fix.time;
+
+	sample = (int64_t)((gps->fix.time - gps->online) * 1000000.0);
+	g_gpsOffsetSample[g_gpsOffsetIdx] = sample;
+	g_gpsOffsetIdx = (g_gpsOffsetIdx + 1) % PAR_GPS_OFFSET_WIN;
+	if(g_gpsOffsetNum < PAR_GPS_OFFSET_WIN)
+		g_gpsOffsetNum++;
+
+	offset = g_gpsOffsetSample[0];
+	for(int i = 1; i < g_gpsOffsetNum; i++)
+	{
+		if(g_gpsOffsetSample[i] > offset)
+			offset = g_gpsOffsetSample[i];
+	}
+	__atomic_store_n(&g_gpsOffset, offset, __ATOMIC_RELAXED);
+
+	if(g_mib.dbg)
+	{
+		syslog(LOG_INFO | LOG_LOCAL4, "[PAR] GPS time offset sample : %lld usec, offset : %lld usec\n", (long long)sample, (long long)offset);
+	}
+}
+
+/**
+ * par_TimeCorrect()
+ * 시스템 시각(CLOCK_REALTIME, usec)을 GPS 시각으로 보정한다. (-g 옵션을 사용하지 않으면 그대로 반환)
+ */
+uint64_t par_TimeCorrect(uint64_t usec)
+{
+	if(!g_mib.gpsTime && !g_timeReplay)
+		return usec;
+	return usec + __atomic_load_n(&g_gpsOffset, __ATOMIC_RELAXED);
+}
+
+/**
+ * par_TimeNow()
+ * 현재 시각 (usec, CLOCK_REALTIME 기준, -g 옵션 사용 시 GPS 시각으로 보정)
+ */
+uint64_t par_TimeNow(void)
+{
+	struct timespec ts;
+
+	if(g_timeReplay)
+		return __atomic_load_n(&g_timeReplayNow, __ATOMIC_RELAXED);
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return par_TimeCorrect((uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+
+/**
+ * par_TimeReplay()
+ * 재생 모드에서 현재 시각과 GPS 시각 보정값을 설정한다. (수신 쓰레드)
+ * @param now 현재 시각 (usec, 보정된 시각)
+ * @param offset 보정값 (usec)
+ */
+void par_TimeReplay(uint64_t now, int64_t offset)
+{
+	g_timeReplay = true;
+	__atomic_store_n(&g_gpsOffset, offset, __ATOMIC_RELAXED);
+	__atomic_store_n(&g_timeReplayNow, now, __ATOMIC_RELAXED);
+}
@@ -8,6 +8,8 @@
 #include <sys/msg.h>
 #include <sys/ipc.h>
 #include <signal.h>
+#include <time.h>
+#include <errno.h>
 #include <PAR.h>
 
 /****************************************************************************************
@@ -16,12 +18,12 @@
 int par_InitTXoperation();
 void par_TXoperation();
 static void* gpsdThread(void *notused);
+static const struct v2xstatDesc_t *g_txProbeStat, *g_txFailStat; //공유메모리 통계 (v2xtop)
 
 /**
  * par_InitTXoperation()
  * PAR 송신동작을 초기화한다.
- * 송신 타이머 관련 뮤텍스, 컨디션시그널 초기화
- * 타이머 생성 및 GPSD 쓰레드 생성
+ * GPSD 쓰레드 생성 (송신 주기는 par_TXoperation()의 송신 주기 타이머로 맞춘다)
  * @return   성공 시 0, 실패 시 -1
  */
 int par_InitTXoperation(){
@@ -37,13 +39,9 @@ int par_InitTXoperation(){
 	}
 
 
-	/* 송신 타이머 관련 뮤텍스, 컨디션시그널 초기화*/
-	pthread_mutex_init(&g_mib.txMtx, NULL);
-	pthread_cond_init(&g_mib.txCond, NULL);
-
-
-	/* 타이머 생성 */
-	InitTxTimer(g_mib.interval);
+	/* 공유메모리 통계 등록 */
+	g_txProbeStat = v2xstat_Counter("tx.probe", "pkt");
+	g_txFailStat = v2xstat_Counter("tx.probe_fail", "pkt");
 
 	/* GPSD 쓰레드 생성 */
 	ret = pthread_create(&gpsd_thread, NULL, gpsdThread, NULL);
@@ -61,38 +59,72 @@ int par_InitTXoperation(){
 	return 0;
 }
 
+/* 송신 통계 (타이머 쓰레드) */
+static uint32_t g_txSeq = 0;
+static uint64_t g_txSentCnt = 0, g_txFailCnt = 0;
+
 /**
- * par_TXoperation()
- * PAR 송신동작을 수행한다.
- * RSU 구조체에 있는 정보를 OUTBUF에 저장 후 메세지큐 전송
+ * par_TxProbe()
+ * 송신주기마다 타이머 쓰레드에서 호출된다.
+ * RSU 정보에 일련번호와 송신시각을 넣어 메세지큐 전송 (프로브)
+ * 송신시각을 한 주기 이상 놓치면 몰아서 보내지 않고 놓친 주기를 건너뛴다. (타이머가 missed로 센다)
  */
-void par_TXoperation()
+static void par_TxProbe(uint64_t missed, void *notused)
 {
-	int32_t ret;
 	uint8_t outBuf[BUFSIZE];
 	uint32_t len;
-	void* status;
 
 	memset(outBuf, 0, BUFSIZE);
 
-	while(!ending)
+	/*RSU 정보 버퍼에 복사 - 일련번호, 송신시각(usec, -g 옵션 사용 시 GPS 시각) 포함 */
+	g_rsu.seq = g_txSeq;
+	g_rsu.txTime = par_TimeNow();
+	memcpy(outBuf,&g_rsu,sizeof(struct rsuInfo_t));
+	len = sizeof(struct rsuInfo_t);
+
+	/* 기지국 정보 전송 - 큐에 들어가지 못한 프로브는 일련번호를 사용하지 않는다. (수신측 손실과 구분) */
+	if(sendMQ(outBuf,len) == 0)
 	{
+		g_txSeq++;
+		g_txSentCnt++;
+		v2xstat_Inc(g_txProbeStat);
+	}
+	else
+	{
+		g_txFailCnt++;
+		v2xstat_Inc(g_txFailStat);
+	}
+}
 
-		/* 송신타이머로부터 시그널이 올때 때까지 대기한다. */
-		pthread_mutex_lock(&g_mib.txMtx);
-		pthread_cond_wait(&g_mib.txCond, &g_mib.txMtx);
-		pthread_mutex_unlock(&g_mib.txMtx);
-		
-		/*RSU 정보 버퍼에 복사 */
-		memcpy(outBuf,&g_rsu,sizeof(struct rsuInfo_t));
-		len = sizeof(struct rsuInfo_t);
+/**
+ * par_TXoperation()
+ * PAR 송신동작을 수행한다.
+ * 송신 주기 타이머(libv2x v2xtimer.c, CLOCK_MONOTONIC 절대시각)가 주기마다 par_TxProbe()를 호출하므로
+ * 처리 시간이 주기에 누적되지 않고 시스템 시각 변경에도 주기가 흔들리지 않는다.
+ */
+void par_TXoperation()
+{
+	int32_t ret;
+	void* status;
+	struct txTimer_t *timer;
+	struct txTimerStat_t stat;
+
+	memset(&stat, 0, sizeof(stat));
 
-		/* 기지국 정보 전송 */
-		sendMQ((char *)&outBuf,len);
+	timer = InitTxTimer("PAR_TX", g_mib.interval, par_TxProbe, NULL);
+	if(timer == NULL)
+		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_TX] Fail to initialize tx timer\n");
+	else
+	{
+		while(!ending)
+			sleep(1);
 
-		/* 메모리 초기화 */
-		memset(outBuf, 0, sizeof(outBuf));
+		/* 타이머 쓰레드 종료 */
+		ReleaseTxTimer(timer, &stat);
 	}
+
+	syslog(LOG_INFO | LOG_LOCAL4, "[PAR_TX] Probe sent : %llu, send fail : %llu, skipped period : %llu\n",
+			(unsigned long long)g_txSentCnt, (unsigned long long)g_txFailCnt, (unsigned long long)stat.missed);
 	
 	/* gpsd close */
 	gps_close(&gpsData);
@@ -111,10 +143,6 @@ void par_TXoperation()
 		//printf("[PAR] ERROR: return code from pthread_join() is %d\n", ret);
 		syslog(LOG_ERR | LOG_LOCAL5, "[PAR_TX] ERROR: return code from pthread_join() is %d\n", ret);
 	}
-
-	/* 뮤텍스 및 컨디션시그널 해제 */
-	pthread_mutex_destroy(&g_mib.txMtx);
-	pthread_cond_destroy(&g_mib.txCond);
 }
 
 /**
@@ -162,6 +190,8 @@ static  void* gpsdThread(void *notused){
 			syslog(LOG_ERR | LOG_LOCAL5, "[PAR_TX] gps_read() fail( %s)\n", gps_errstr(result));
 			shmCheck = true;
 		}
+		else
+			par_TimeUpdateGps(&gpsData);
 
 		/* 기지국 위도 경도 인자값으로 받음 */
 		if( g_mib.Latitude != 0 && g_mib.Longitude != 0)
@@ -114,7 +114,16 @@ int recvMQ(char *pkt)
 	return recvPkt->msg.msg_len;
 }
 
-void sendMQ(uint8_t *pPkt, uint32_t len)
+/****************************************************************************************
+
+  sendMQ()
+  메시지 큐 전송 (큐가 가득 차 있으면 대기하지 않고 실패한다)
+
+  return
+  성공 시 0, 실패 시 -1
+
+ ****************************************************************************************/
+int sendMQ(uint8_t *pPkt, uint32_t len)
 {
 	static int cnt = 0;
 	int result;
@@ -124,6 +133,10 @@ void sendMQ(uint8_t *pPkt, uint32_t len)
 
 	sendPkt->rxCnt = msgqCnt++;
 	sendPkt->msgtype = 1; 
+	sendPkt->priority = g_mib.priority;
+	sendPkt->lifetime = g_mib.lifetime;
+	sendPkt->ifindex = g_mib.ifindex;
+	sendPkt->psid = MSGQ_PSID_PAR;
 
 	// if( msgsnd( recvFD, (char *)recvPkt, sizeof(struct msgQ_elem_frame) - sizeof(long), IPC_NOWAIT) == -1 )
 	result = msgsnd( sendFD, (char *)sendPkt, sizeof(struct msgQ_elem_frame) - sizeof(long), IPC_NOWAIT);
@@ -131,6 +144,7 @@ void sendMQ(uint8_t *pPkt, uint32_t len)
 	{
 		//perror("[PAR] MQ send error : ");
 		syslog(LOG_ERR | LOG_LOCAL5, "[PAR] MQ send error : %s", strerror(errno));
+		return -1;
 	}
 	else 
 	{
@@ -145,5 +159,6 @@ void sendMQ(uint8_t *pPkt, uint32_t len)
 			 syslog(LOG_INFO | LOG_LOCAL4, "[PAR] %dth MQ send(%d Byte) \n", cnt, sendPkt->msg.msg_len);
 		}
 	}
+	return 0;
 }
 
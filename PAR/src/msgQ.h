@@ -14,12 +14,24 @@
 	프로젝트 헤더
 
 ****************************************************************************************/
+#include "v2xtrace.h"
 
 #define KEY_RECV_J2735 1716
 #define KEY_SEND_J2735 1717
 #define KEY_SEND_PAR 1718
 #define MSGMAX 4096
 
+/* 송신 우선순위 미지정 - prcsWSM의 기본 우선순위(-o)로 송신된다. */
+#define MSGQ_PRIORITY_DEFAULT 0xFF
+/* 송신 유효기간 미지정 - prcsWSM의 기본 유효기간(-e)이 적용된다. */
+#define MSGQ_LIFETIME_DEFAULT 0
+/* 송신 인터페이스 미지정 - prcsWSM의 기본 인터페이스(-x)로 송신된다. */
+#define MSGQ_IFINDEX_DEFAULT 0xFF
+/* 송신 PSID 미지정 - prcsWSM의 PSID(-p)로 송신된다. */
+#define MSGQ_PSID_DEFAULT 0xFFFFFFFF
+/* PAR 프로브 PSID - 측정을 위해 prcsWSM의 혼잡제어와 중복프레임 필터를 적용하지 않는다. */
+#define MSGQ_PSID_PAR 7777
+
 typedef enum msgType {
    msgq_msgtype_messageframe,
 }MSGQ_MSGTYPE;
@@ -34,6 +46,11 @@ struct msgQ_elem_frame
 {
    long msgtype;
    uint32_t rxCnt;
+   uint8_t priority; // 송신 우선순위(802.1D UP 0~7, 송신 메시지에만 사용)
+   uint32_t lifetime; // 송신 유효기간(msec, 송신 메시지에만 사용). 경과 시 송신하지 않고 폐기된다.
+   uint8_t ifindex; // 송신 인터페이스(송신 메시지에만 사용)
+   uint32_t psid; // 송신 PSID(송신 메시지에만 사용)
+   struct v2xtraceCtx_t trace; // 종단간 지연 추적정보(magic이 0이면 추적하지 않는 메시지)
    MSGQ_MSG msg;
 };
 
@@ -45,4 +62,4 @@ static struct mq_attr cn_MQ_attr = {O_NONBLOCK, 10, sizeof(struct msgQ_elem_fram
 int initMQ(void);
 void releaseMQ(void);
 int recvMQ(char *pkt);
-void sendMQ(uint8_t *pPkt, uint32_t len);
+int sendMQ(uint8_t *pPkt, uint32_t len);
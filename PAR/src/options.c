@@ -26,7 +26,7 @@ optopt : 알 수 없는 옵션을 만났을 때 getopt의 리턴값은 ? 임
 
  ****************************************************************************************/
 //static const char *optStr = "a:t:c:r:l:L:n:b:h";
-static const char *optStr = "a:t:c:r:l:L:i:b:h";
+static const char *optStr = "a:t:c:r:l:L:i:o:e:x:gk:Kw:m:q:A:C:R:F:b:h";
 /****************************************************************************************
   함수원형(지역/전역)
 
@@ -54,14 +54,31 @@ static void usage(char *cmd) {
 	printf("  -a <action>            set Action\n");
 	printf("                           rx    : receive only\n");
 	printf("                           tx    : transmit only\n");
-	printf("  -t <Interval>   <TX : usec>      if not set, Interval : 10000usec\n");
-	printf("                  <RX : usec>      if not set, Interval : 1000000usec\n");
+	printf("  -t <Interval>   <TX : usec>      if not set, Interval : 10000usec (probe, e.g. 500usec : 2kHz)\n");
+	printf("                  <RX : usec>      report window aligned to GPS/UTC time, if not set, Interval : 1000000usec\n");
 	printf("  -c <Cycle>      <Only RX : msec> if not set, Cycle : 10msec\n");
 	printf("  -r <RSUID>                       indicate RSUID\n");
 	printf("  -l <Latitude> 	   	   indicate Latitude\n");
 	printf("  -L <Longitude>                   indicate Longitude\n");
 	//printf("  -n <RSU Amount>                  <Only RX>\n");
 	printf("  -i <Information>                 Indicate Information\n");
+	printf("  -o <priority>   <Only TX : 0~7>  if not set, prcsWSM default priority\n");
+	printf("  -e <lifetime>   <Only TX : msec> if not set, prcsWSM default lifetime\n");
+	printf("  -x <ifindex>    <Only TX>        if not set, prcsWSM default interface\n");
+	printf("  -g                               correct TX/RX timestamps to GPS time (gpsd)\n");
+	printf("  -k <offset>     <Only RX : usec> fixed one-way latency offset (measure with -K)\n");
+	printf("  -K              <Only RX>        latency calibration mode (TX/RX on the same host)\n");
+	printf("  -w <dir[:size[:files]]> <Only RX> write binary measurement log to dir\n");
+	printf("                                   size : MByte per file (default 16), files : number of files kept (default 8)\n");
+	printf("  -m <file[:tile[:tiles[:period]]]> <Only RX> append per-RSU link coverage map tiles to CSV file\n");
+	printf("                                   tile : meter (default 50), tiles : max tiles (default 4096), period : sec (default 10)\n");
+	printf("  -q <path>       <Only RX>        serve live per-RSU statistics as JSON on UNIX socket (get/subscribe/unsubscribe)\n");
+	printf("  -A <age[:max]>  <Only RX>        retire RSUs unheard for age report windows (default 60, 0 : never)\n");
+	printf("                                   max : max tracked RSUs, least recently heard evicted (default 1024)\n");
+	printf("  -C <file>       <Only RX>        capture received messages and GNSS fixes to file\n");
+	printf("  -R <file[:speed]> <Only RX>      replay captured file instead of message queue and gpsd\n");
+	printf("                                   speed : 1 real time (default), N times, 0 unthrottled\n");
+	printf("  -F <host:port[:obuID]|/path[:obuID]> <Only RX> send per-window RSU reports to fleet aggregator (UDP/UNIX)\n");
 	printf("  -b                     activate debug message output\n");
 	printf("  -h                     Print usage\n");
 
@@ -92,6 +109,10 @@ int32_t ParsingOptions(int32_t argc, char *argv[])
 	int32_t opt;
 	bool actionSpecified = false;
 	//bool rsuNumSpecified = false;
+
+	/* 기본값 */
+	g_mib.rsuAge = PAR_RSU_AGE_DEFAULT;
+	g_mib.replaySpeed = 1.0;
 	/*----------------------------------------------------------------------------------*/
 	/* 파라미터 파싱 및 저장 */
 	/*----------------------------------------------------------------------------------*/
@@ -130,12 +151,105 @@ int32_t ParsingOptions(int32_t argc, char *argv[])
 			case 'i' :
 				g_mib.Information = strtoul(optarg, NULL,10);
 				break;
+			case 'o' :
+				g_mib.priority = (uint8_t)strtoul(optarg, NULL, 10);
+				if(g_mib.priority > 7) {
+					printf("Invalid priority - %s\n", optarg);
+					return -1;
+				}
+				break;
 			/*
 			case 'n' :
 				g_mib.rsuNum = strtoul(optarg, NULL, 10);
 				rsuNumSpecified = true;
 				break;
 				*/
+			case 'e' :
+				g_mib.lifetime = (uint32_t)strtoul(optarg, NULL, 10);
+				break;
+			case 'x' :
+				g_mib.ifindex = (uint8_t)strtoul(optarg, NULL, 10);
+				break;
+			case 'g' :
+				g_mib.gpsTime = true;
+				break;
+			case 'k' :
+				g_mib.latOffset = (int32_t)strtol(optarg, NULL, 10);
+				break;
+			case 'K' :
+				g_mib.latCalib = true;
+				break;
+			case 'w' :
+			{
+				char *p;
+				strncpy(g_mib.logDir, optarg, sizeof(g_mib.logDir) - 1);
+				p = strchr(g_mib.logDir, ':');
+				if(p != NULL) {
+					*p++ = '\0';
+					g_mib.logSize = (uint32_t)strtoul(p, &p, 10);
+					if(*p == ':')
+						g_mib.logFiles = (uint32_t)strtoul(p + 1, NULL, 10);
+				}
+				if(g_mib.logDir[0] == '\0') {
+					printf("Invalid log directory - %s\n", optarg);
+					return -1;
+				}
+				break;
+			}
+			case 'm' :
+			{
+				char *p;
+				strncpy(g_mib.geoFile, optarg, sizeof(g_mib.geoFile) - 1);
+				p = strchr(g_mib.geoFile, ':');
+				if(p != NULL) {
+					*p++ = '\0';
+					g_mib.geoTile = (uint32_t)strtoul(p, &p, 10);
+					if(*p == ':') {
+						g_mib.geoTiles = (uint32_t)strtoul(p + 1, &p, 10);
+						if(*p == ':')
+							g_mib.geoPeriod = (uint32_t)strtoul(p + 1, NULL, 10);
+					}
+				}
+				if(g_mib.geoFile[0] == '\0') {
+					printf("Invalid coverage map file - %s\n", optarg);
+					return -1;
+				}
+				break;
+			}
+			case 'q' :
+				strncpy(g_mib.qrySock, optarg, sizeof(g_mib.qrySock) - 1);
+				break;
+			case 'A' :
+			{
+				char *p;
+				g_mib.rsuAge = (uint32_t)strtoul(optarg, &p, 10);
+				if(*p == ':')
+					g_mib.rsuMax = (uint32_t)strtoul(p + 1, NULL, 10);
+				break;
+			}
+			case 'C' :
+				strncpy(g_mib.capFile, optarg, sizeof(g_mib.capFile) - 1);
+				break;
+			case 'R' :
+			{
+				char *p;
+				strncpy(g_mib.replayFile, optarg, sizeof(g_mib.replayFile) - 1);
+				p = strchr(g_mib.replayFile, ':');
+				if(p != NULL) {
+					*p++ = '\0';
+					g_mib.replaySpeed = strtod(p, NULL);
+				}
+				if(g_mib.replayFile[0] == '\0' || g_mib.replaySpeed < 0) {
+					printf("Invalid replay file - %s\n", optarg);
+					return -1;
+				}
+				g_mib.op = opRX;
+				actionSpecified = true;
+				break;
+			}
+			case 'F' :
+				strncpy(g_mib.fleetDest, optarg, sizeof(g_mib.fleetDest) - 1);
+				break;
 			case 'b':
 				g_mib.dbg = (uint32_t)strtoul(optarg, NULL, 10);
 				break;
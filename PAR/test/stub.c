@@ -0,0 +1,41 @@
+/**********************************************************
+  [PAR 호스트 테스트용 대체 구현]
+  PAR.c(main)에 정의된 전역변수와 gpsd 라이브러리 함수를 대신한다.
+  gpsd는 열리지만 fix가 없는 것으로 동작한다. (OBU 위치는 -l/-L 인자값을 사용)
+ ************************************************************/
+
+#include <PAR.h>
+
+struct rsuInfo_t g_rsu; //rsu ID, 위도, 경도 구조체
+struct obuInfo_t g_obu; //OBU 위도 ,경도, 스피드, 헤딩 구조체
+struct parMib g_mib; //어플리케이션 관리정보
+struct gps_data_t gpsData; //gpsd 구조체
+struct parPacket_t g_Packet;//prcsWSM으로부터 받은 정보 담을 구조체
+struct parInfo_t *stPARInfo;
+linkedList *ListPtr;
+int ending = 0;
+bool shmCheck = false;
+pthread_t rx_thread;
+pthread_t userSelect_thread;
+pthread_t gpsd_thread;
+
+int gps_open(const char *host, const char *port, struct gps_data_t *gps)
+{
+	memset(gps, 0, sizeof(struct gps_data_t));
+	return 0;
+}
+
+int gps_read(struct gps_data_t *gps)
+{
+	return 0;
+}
+
+int gps_close(struct gps_data_t *gps)
+{
+	return 0;
+}
+
+const char *gps_errstr(const int err)
+{
+	return "test";
+}
@@ -0,0 +1,265 @@
+/**********************************************************
+  [입력 캡처 / 재생 결정성 테스트]
+  실제 수신 루프(par_RXoperation())와 보고 쓰레드로 모의 프로브 수신 메시지를 처리하면서 캡처(-C)한 후,
+  같은 파일을 제한 없는 배속(-R file:0)으로 재생하여 보고 구간/RSU 링크 별 결과가 실시간 실행과 같은지 검사한다.
+  두 실행은 전역 상태가 섞이지 않도록 각각 자식 프로세스에서 수행하고, 결과는 공유 메모리에 모은다.
+  모의 프로브는 RSU 별로 채널/인터페이스가 다르고 일부 일련번호를 건너뛰어 손실 통계도 함께 비교한다.
+
+  실행 : test-cap [수신율(Hz)] [시간(msec)] [보고주기(usec)] [RSU 수]
+         (기본 2000Hz, 1000msec, 100000usec, 16개)
+ ************************************************************/
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "PAR_RX.c"
+#include "test.h"
+
+#define TEST_RSU_MAX 64
+#define TEST_REC_MAX 8192 //실행 당 최대 결과 수 (보고 구간 x RSU 링크)
+#define TEST_LOSS_EVERY 97 //이 수마다 일련번호 하나를 건너뛴다. (손실)
+
+/* 보고 구간/RSU 링크 별 결과 */
+struct testCapRec_t{
+	uint64_t start; //보고 구간 시작 (usec)
+	int rsuID;
+	uint8_t channel;
+	uint8_t ifIdx;
+	uint32_t cnt;
+	uint32_t curPAR;
+	double distance;
+	double calc[PAR_CALC_NUM];
+	struct parSeqReport_t seq;
+};
+
+/* 실행 결과 - 공유 메모리 */
+struct testCapResult_t{
+	uint64_t sent; //보낸 패킷 수 (실시간 실행)
+	uint64_t reported; //보고된 수신 수 합
+	uint32_t late; //늦은 패킷 수
+	uint32_t num; //결과 수
+	bool overflow; //결과가 TEST_REC_MAX를 넘음
+	struct testCapRec_t rec[TEST_REC_MAX];
+};
+
+static uint32_t g_testRate = 2000; //수신율 (Hz)
+static uint32_t g_testDuration = 1000; //수신 시간 (msec)
+static uint32_t g_testRsuNum = 16; //RSU 수
+static uint64_t g_testStart; //수신 시작 (usec, CLOCK_MONOTONIC)
+static uint64_t g_testSent; //보낸 패킷 수
+static uint64_t g_testLastWin; //마지막 패킷이 속한 보고 구간
+static uint64_t g_testWinStart; //보고 중인 구간 시작 (usec)
+static uint32_t g_testSeq[TEST_RSU_MAX + 1];
+static struct testCapResult_t *g_testResult; //현재 실행의 결과
+
+static uint64_t test_Monotonic(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/**
+ * recvMQ()
+ * prcsWSM 대신 프로브 수신 메시지를 만든다. (실시간 실행의 수신 루프)
+ * 정해진 수를 다 보내면 마지막 구간의 보고가 끝날 때까지 기다린 후 종료시킨다.
+ */
+int recvMQ(char *pkt)
+{
+	struct rsuInfo_t rsu;
+	int16_t rxPower;
+	uint8_t rcpi;
+	uint64_t rxTime, due, limit;
+	uint64_t total = (uint64_t)g_testRate * g_testDuration / 1000;
+	uint32_t len = 0;
+
+	if(g_testSent >= total){
+		limit = test_Monotonic() + 4 * g_mib.interval + 1000000;
+		while(__atomic_load_n(&g_parWinDrained, __ATOMIC_SEQ_CST) < g_testLastWin && test_Monotonic() < limit)
+			usleep(1000);
+		ending = 1;
+		return -1;
+	}
+	/* 시작 시점의 부분 구간은 보고하지 않으므로 첫 구간이 시작된 후 보낸다. */
+	if(g_testStart == 0){
+		while(par_TimeNow() / g_mib.interval <= __atomic_load_n(&g_parWinClosed, __ATOMIC_SEQ_CST))
+			usleep(100);
+		g_testStart = test_Monotonic();
+	}
+	due = g_testStart + g_testSent * 1000000ULL / g_testRate;
+	while(test_Monotonic() < due)
+		usleep(50);
+
+	memset(&rsu, 0, sizeof(rsu));
+	rsu.rsuID = (int32_t)(g_testSent % g_testRsuNum) + 1;
+	rsu.rsuLatitude = 375000000 + rsu.rsuID * 1000;
+	rsu.rsuLongitude = 1270000000 + rsu.rsuID * 1000;
+	if(g_testSent % TEST_LOSS_EVERY == TEST_LOSS_EVERY - 1)
+		++g_testSeq[rsu.rsuID];
+	rsu.seq = ++g_testSeq[rsu.rsuID];
+	rxTime = par_TimeNow();
+	rsu.txTime = rxTime - 1000 - (g_testSent % 7) * 300;
+	g_testLastWin = rxTime / g_mib.interval;
+	rxPower = (int16_t)(-60 - (int16_t)(g_testSent % 30));
+	rcpi = (uint8_t)(100 + g_testSent % 50);
+
+	memcpy(pkt + len, &rsu, sizeof(rsu));
+	len += sizeof(rsu);
+	memcpy(pkt + len, &rxPower, sizeof(rxPower));
+	len += sizeof(rxPower);
+	pkt[len++] = (char)rcpi;
+	memcpy(pkt + len, &rxTime, sizeof(rxTime));
+	len += sizeof(rxTime);
+	pkt[len++] = (char)(rsu.rsuID & 1); //수신 인터페이스
+	pkt[len++] = (char)((rsu.rsuID & 2) ? 182 : 172); //수신 채널
+	g_testSent++;
+	return (int)len;
+}
+
+/* 실시간 조회 모듈 대체 - 수신이 있었던 RSU 링크의 보고 구간 결과를 모은다. (보고 쓰레드, 재생 시 수신 루프) */
+int par_QueryInit(void)
+{
+	return 0;
+}
+
+void par_QueryBegin(uint64_t start, uint64_t end)
+{
+	g_testWinStart = start;
+}
+
+void par_QueryPut(const struct parInfo_t *node, uint32_t cnt)
+{
+	struct testCapResult_t *r = g_testResult;
+	struct testCapRec_t *rec;
+
+	if(cnt == 0)
+		return;
+	if(r->num >= TEST_REC_MAX){
+		r->overflow = true;
+		return;
+	}
+	r->reported += cnt;
+	rec = &r->rec[r->num++];
+	rec->start = g_testWinStart;
+	rec->rsuID = node->rsuID;
+	rec->channel = node->channel;
+	rec->ifIdx = node->ifIdx;
+	rec->cnt = cnt;
+	rec->curPAR = node->curPAR;
+	rec->distance = node->distance;
+	memcpy(rec->calc, node->calculateData, sizeof(rec->calc));
+	rec->seq = node->seqReport;
+}
+
+void par_QueryPublish(void)
+{
+}
+
+void par_QueryClose(void)
+{
+}
+
+/**
+ * test_Run()
+ * 자식 프로세스에서 수신 루프를 실행하고 결과를 공유 메모리에 남긴다.
+ * @param capFile 캡처 파일 (실시간 실행), NULL이면 재생
+ * @param replayFile 재생 파일 (배속 제한 없음), NULL이면 실시간 실행
+ * @param result 결과 (공유 메모리)
+ * @return 자식 프로세스 종료코드, 실패 시 -1
+ */
+static int test_Run(const char *capFile, const char *replayFile, struct testCapResult_t *result)
+{
+	pid_t pid;
+	int status;
+
+	pid = fork();
+	if(pid < 0)
+		return -1;
+	if(pid == 0){
+		g_testResult = result;
+		if(capFile != NULL)
+			snprintf(g_mib.capFile, sizeof(g_mib.capFile), "%s", capFile);
+		if(replayFile != NULL){
+			snprintf(g_mib.replayFile, sizeof(g_mib.replayFile), "%s", replayFile);
+			g_mib.replaySpeed = 0;
+		}
+		if(par_InitRXoperation() < 0){
+			fprintf(stderr, "par_InitRXoperation() fail\n");
+			_exit(1);
+		}
+		par_RXoperation();
+		result->sent = g_testSent;
+		result->late = __atomic_load_n(&g_parWinLate, __ATOMIC_SEQ_CST);
+		_exit(0);
+	}
+	if(waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+		return -1;
+	return WEXITSTATUS(status);
+}
+
+int main(int argc, char *argv[])
+{
+	struct testCapResult_t *live, *replay;
+	char capFile[] = "/tmp/par-test-cap-XXXXXX";
+	uint32_t mismatch = 0;
+	int fd;
+
+	if(argc > 1)
+		g_testRate = (uint32_t)strtoul(argv[1], NULL, 10);
+	if(argc > 2)
+		g_testDuration = (uint32_t)strtoul(argv[2], NULL, 10);
+	if(argc > 3)
+		g_mib.interval = (uint32_t)strtoul(argv[3], NULL, 10);
+	else
+		g_mib.interval = 100000;
+	if(argc > 4)
+		g_testRsuNum = (uint32_t)strtoul(argv[4], NULL, 10);
+	if(g_testRate == 0 || g_testRsuNum == 0 || g_testRsuNum > TEST_RSU_MAX){
+		fprintf(stderr, "usage: %s [rate(Hz)] [duration(msec)] [interval(usec)] [rsu(1~%d)]\n", argv[0], TEST_RSU_MAX);
+		return 2;
+	}
+	g_mib.cycle = 10;
+	g_mib.Latitude = 375000000;
+	g_mib.Longitude = 1270000000;
+
+	live = mmap(NULL, sizeof(*live), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	replay = mmap(NULL, sizeof(*replay), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	fd = mkstemp(capFile);
+	if(live == MAP_FAILED || replay == MAP_FAILED || fd < 0){
+		fprintf(stderr, "test setup fail\n");
+		return 1;
+	}
+	close(fd);
+
+	TEST_CHECK(test_Run(capFile, NULL, live) == 0);
+	TEST_CHECK(test_Run(NULL, capFile, replay) == 0);
+	unlink(capFile);
+
+	printf("live : sent %llu, reported %llu in %u results, late %u / replay : reported %llu in %u results, late %u\n",
+			(unsigned long long)live->sent, (unsigned long long)live->reported, live->num, live->late,
+			(unsigned long long)replay->reported, replay->num, replay->late);
+
+	/* 모든 패킷이 보고되었고 (늦은 패킷 없음), 재생 결과가 보고 구간/RSU 링크 별로 같아야 한다. */
+	TEST_CHECK(!live->overflow && !replay->overflow);
+	TEST_CHECK(live->late == 0 && replay->late == 0);
+	TEST_CHECK(live->sent == (uint64_t)g_testRate * g_testDuration / 1000);
+	TEST_CHECK(live->reported == live->sent && replay->reported == live->reported);
+	TEST_CHECK(live->num >= g_testRsuNum && replay->num == live->num);
+	for(uint32_t i = 0; i < live->num && i < replay->num; i++){
+		const struct testCapRec_t *a = &live->rec[i];
+		const struct testCapRec_t *b = &replay->rec[i];
+
+		if(a->start != b->start || a->rsuID != b->rsuID || a->channel != b->channel || a->ifIdx != b->ifIdx ||
+				a->cnt != b->cnt || a->curPAR != b->curPAR || a->distance != b->distance ||
+				memcmp(a->calc, b->calc, sizeof(a->calc)) != 0 ||
+				a->seq.rcv != b->seq.rcv || a->seq.lost != b->seq.lost || a->seq.reorder != b->seq.reorder ||
+				a->seq.dup != b->seq.dup || a->seq.burst != b->seq.burst || a->seq.lossRate != b->seq.lossRate){
+			if(mismatch++ < 10)
+				fprintf(stderr, "window %llu RSU %d ch %u if %u : live cnt %u PAR %u / replay window %llu RSU %d ch %u if %u cnt %u PAR %u\n",
+						(unsigned long long)a->start, a->rsuID, a->channel, a->ifIdx, a->cnt, a->curPAR,
+						(unsigned long long)b->start, b->rsuID, b->channel, b->ifIdx, b->cnt, b->curPAR);
+		}
+	}
+	TEST_CHECK(mismatch == 0);
+	return TEST_RESULT();
+}
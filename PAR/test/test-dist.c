@@ -0,0 +1,199 @@
+/**********************************************************
+  [RSU 거리 일괄 계산 정확도/성능 테스트]
+  par_DistanceBatch()를 long double haversine(기준값)과 이전 거리 함수 ldCaldistance()와 비교한다.
+    - 10 km 이내 : 기준값 대비 상대오차 1e-6 미만, ldCaldistance()와 차이 0.5 m 미만
+    - 100 km 이내 : 기준값 대비 상대오차 1e-4 미만 (위도 60도 이하)
+    - 수 km 이내에서 ldCaldistance()보다 오차가 크지 않음
+    - 벡터 경로와 스칼라 경로(나머지 계산)의 결과가 같음, 경도 ±180도 경계
+  bench 인자로 실행하면 수천 개 RSU에 대해 par_DistanceBatch()와 ldCaldistance()의 RSU 당 시간을 출력한다.
+
+  실행 : test-dist
+         test-dist bench [RSU 수] [반복 수]   (기본 4096개, 1000회)
+ ************************************************************/
+
+#include <math.h>
+#include <time.h>
+#include <PAR.h>
+#include "test.h"
+
+#define TEST_SAMPLE 20000 //거리 구간 별 표본 수
+#define TEST_EARTH_RADIUS 6371009.0L
+#define TEST_DEG_E7_TO_RAD (3.14159265358979323846264338327950288L / 180.0L * 1e-7L)
+
+long double ldCaldistance(int32_t rlo, int32_t rla, int32_t olo, int32_t ola);
+
+/* 실시간 조회 소켓/메시지큐는 사용하지 않는다. (PAR_RX.c 링크용) */
+int recvMQ(char *pkt)
+{
+	return -1;
+}
+
+static uint32_t g_testRand = 12345;
+
+/* 재현 가능한 난수 (0 ~ 1) */
+static double test_Rand(void)
+{
+	g_testRand = g_testRand * 1103515245u + 12345u;
+	return (double)(g_testRand >> 8) / (double)(1u << 24);
+}
+
+/* 기준값 - long double haversine */
+static long double test_Haversine(int32_t olat, int32_t olon, int32_t rlat, int32_t rlon)
+{
+	long double p1 = olat * TEST_DEG_E7_TO_RAD;
+	long double p2 = rlat * TEST_DEG_E7_TO_RAD;
+	long double dp = (long double)((int64_t)rlat - olat) * TEST_DEG_E7_TO_RAD;
+	long double dl = (long double)((int64_t)rlon - olon) * TEST_DEG_E7_TO_RAD;
+	long double a = sinl(dp / 2) * sinl(dp / 2) + cosl(p1) * cosl(p2) * sinl(dl / 2) * sinl(dl / 2);
+
+	return 2 * TEST_EARTH_RADIUS * asinl(sqrtl(a));
+}
+
+/* OBU 위치에서 임의 방향으로 range(m) 떨어진 RSU 위치 (1e-7도, 경도는 ±180도로 정규화) */
+static void test_Offset(int32_t olat, int32_t olon, double range, int32_t *rlat, int32_t *rlon)
+{
+	double th = test_Rand() * 2 * M_PI;
+	double lat = olat * 1e-7 + range * cos(th) / 6371009.0 * 180.0 / M_PI;
+	double lon = olon * 1e-7 + range * sin(th) / (6371009.0 * cos(olat * 1e-7 * M_PI / 180.0)) * 180.0 / M_PI;
+
+	if(lon > 180.0)
+		lon -= 360.0;
+	else if(lon < -180.0)
+		lon += 360.0;
+	*rlat = (int32_t)lround(lat * 1e7);
+	*rlon = (int32_t)lround(lon * 1e7);
+}
+
+/**
+ * test_Accuracy()
+ * 거리 범위 (0, range] 에서 기준값 대비 상대오차와 ldCaldistance()와의 차이를 검사한다.
+ */
+static void test_Accuracy(double range, double relBound, double oldBound, bool notWorse)
+{
+	static int32_t olat[TEST_SAMPLE], olon[TEST_SAMPLE], rlat[TEST_SAMPLE], rlon[TEST_SAMPLE];
+	double dist[1];
+	double maxRel = 0, maxNew = 0, maxOld = 0, maxDiff = 0;
+
+	for(int i = 0; i < TEST_SAMPLE; i++){
+		olat[i] = (int32_t)((test_Rand() * 120.0 - 60.0) * 1e7);
+		olon[i] = (int32_t)((test_Rand() * 360.0 - 180.0) * 1e7);
+		test_Offset(olat[i], olon[i], test_Rand() * range, &rlat[i], &rlon[i]);
+	}
+	for(int i = 0; i < TEST_SAMPLE; i++){
+		long double ref = test_Haversine(olat[i], olon[i], rlat[i], rlon[i]);
+		long double old = ldCaldistance(rlon[i], rlat[i], olon[i], olat[i]);
+		double errNew, errOld;
+
+		par_DistanceBatch(olat[i], olon[i], &rlat[i], &rlon[i], dist, 1);
+		errNew = fabs((double)(dist[0] - ref));
+		errOld = fabs((double)(old - ref));
+		if(ref > 1.0 && errNew / (double)ref > maxRel)
+			maxRel = errNew / (double)ref;
+		if(errNew > maxNew)
+			maxNew = errNew;
+		if(errOld > maxOld)
+			maxOld = errOld;
+		if(fabs((double)(dist[0] - old)) > maxDiff)
+			maxDiff = fabs((double)(dist[0] - old));
+	}
+	printf("range %8.0f m : max rel err %.2e, max err %.4f m (ldCaldistance %.4f m), max diff from ldCaldistance %.4f m\n",
+			range, maxRel, maxNew, maxOld, maxDiff);
+	TEST_CHECK(maxRel < relBound);
+	if(oldBound > 0)
+		TEST_CHECK(maxDiff < oldBound);
+	if(notWorse)
+		TEST_CHECK(maxNew <= maxOld);
+}
+
+/**
+ * test_Batch()
+ * 벡터 경로 결과가 RSU 별 스칼라 계산(n = 1)과 같은지, 경도 ±180도 경계를 넘는 거리가 맞는지 검사한다.
+ */
+static void test_Batch(void)
+{
+	enum { n = 1001 };
+	static int32_t rlat[n], rlon[n];
+	static double dist[n];
+	const int32_t olat = 375665000, olon = 1269780000;
+	double one;
+	int mismatch = 0;
+
+	for(int i = 0; i < n; i++)
+		test_Offset(olat, olon, test_Rand() * 20000.0, &rlat[i], &rlon[i]);
+	par_DistanceBatch(olat, olon, rlat, rlon, dist, n);
+	for(int i = 0; i < n; i++){
+		par_DistanceBatch(olat, olon, &rlat[i], &rlon[i], &one, 1);
+		if(fabs(one - dist[i]) > 1e-9 * (one + 1.0))
+			mismatch++;
+	}
+	TEST_CHECK(mismatch == 0);
+
+	/* 경도 ±180도 경계 - 적도에서 경도 0.02도 = 약 2.2 km */
+	{
+		int32_t lat[2] = { 0, 0 };
+		int32_t lon[2] = { -1799900000, 1799900000 };
+		double d[2];
+
+		par_DistanceBatch(0, 1799900000, lat, lon, d, 2);
+		TEST_CHECK(fabs(d[0] - (double)test_Haversine(0, 1799900000, 0, -1799900000)) < 0.01);
+		TEST_CHECK(d[0] > 2000.0 && d[0] < 2500.0);
+		TEST_CHECK(d[1] == 0.0);
+	}
+}
+
+/**
+ * test_Bench()
+ * RSU n 개에 대한 par_DistanceBatch()와 ldCaldistance() RSU 당 시간을 출력한다.
+ */
+static int test_Bench(int n, int iter)
+{
+	int32_t *rlat = malloc(sizeof(int32_t) * n);
+	int32_t *rlon = malloc(sizeof(int32_t) * n);
+	double *dist = malloc(sizeof(double) * n);
+	const int32_t olat = 375665000, olon = 1269780000;
+	struct timespec t0, t1;
+	volatile long double sink = 0;
+	double batchNs, oldNs;
+
+	if(rlat == NULL || rlon == NULL || dist == NULL)
+		return 1;
+	for(int i = 0; i < n; i++)
+		test_Offset(olat, olon, test_Rand() * 50000.0, &rlat[i], &rlon[i]);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(int k = 0; k < iter; k++){
+		par_DistanceBatch(olat + k, olon, rlat, rlon, dist, n);
+		sink += dist[k % n];
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	batchNs = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)n * iter);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(int k = 0; k < iter; k++){
+		for(int i = 0; i < n; i++)
+			dist[i] = (double)ldCaldistance(rlon[i], rlat[i], olon, olat + k);
+		sink += dist[k % n];
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	oldNs = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)n * iter);
+
+	printf("%d RSU x %d : par_DistanceBatch %.2f ns/RSU, ldCaldistance %.2f ns/RSU (x%.1f)\n",
+			n, iter, batchNs, oldNs, oldNs / batchNs);
+	free(rlat);
+	free(rlon);
+	free(dist);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc > 1 && strcmp(argv[1], "bench") == 0)
+		return test_Bench((argc > 2) ? atoi(argv[2]) : 4096, (argc > 3) ? atoi(argv[3]) : 1000);
+
+	test_Accuracy(1000.0, 1e-6, 0.5, true);
+	test_Accuracy(5000.0, 1e-6, 0.5, true);
+	test_Accuracy(10000.0, 1e-6, 0.5, false);
+	test_Accuracy(100000.0, 1e-4, 0, false);
+	test_Batch();
+	return TEST_RESULT();
+}
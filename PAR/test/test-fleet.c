@@ -0,0 +1,339 @@
+/**********************************************************
+  [차량군 보고 집계 테스트]
+  집계 도구(tools/parfleet.c)의 main()을 쓰레드로 실행하고, UNIX 데이터그램 소켓으로
+  수백 대 차량의 보고 구간 별 RSU 통계를 보내어 집계 결과(CSV와 RSU 링크 별 누적 통계)를 검사한다.
+
+  - 차량마다 보고 구간 당 데이터그램 하나(RSU 4~5개 링크), 같은 RSU를 두 인터페이스로 보고하는 차량 포함
+  - 일부 차량은 한 구간 늦게 보낸다. (허용 지연 이내 -> 합쳐져야 함)
+  - 일부 차량은 다섯 구간 늦게 보낸다. (허용 지연 초과 -> 버리고 늦은 항목으로 세어야 함)
+  - 일부 데이터그램은 보내지 않는다. (차량 별 일련번호로 유실을 세어야 함)
+  - 형식이 틀린 데이터그램
+  보낸 항목으로 (보고 구간, RSU 링크) 별 기대값을 직접 계산하여 CSV 각 줄과 비교한다.
+ ************************************************************/
+
+#define main parfleet_main
+#include "../tools/parfleet.c"
+#undef main
+#include <math.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "test.h"
+
+#define TEST_OBU 300 //차량 수
+#define TEST_RSU 50 //RSU 수
+#define TEST_WIN 20 //보고 구간 수
+#define TEST_IF 2 //인터페이스 수
+#define TEST_PERIOD 1000000ULL //보고주기 (usec)
+#define TEST_T0 1700000000000000ULL //첫 보고 구간 시작시각
+#define TEST_LATENESS "2500000" //허용 지연 (usec)
+#define TEST_DELAY1(obu) ((obu) % 10 == 3) //한 구간 늦게 보내는 차량
+#define TEST_DELAY5(obu) ((obu) % 50 == 7) //다섯 구간 늦게 보내는 차량 (마지막 다섯 구간은 제때 보낸다)
+#define TEST_DROP(obu, win) ((obu) % 25 == 11 && (win) % 7 == 2) //보내지 않는 데이터그램
+
+/* (보고 구간, RSU 링크) 기대값 */
+struct testCell_t{
+	uint32_t vehicles;
+	uint64_t cnt;
+	uint64_t expected;
+	uint64_t seqRcv;
+	uint64_t seqLost;
+	uint64_t latCnt;
+	float rxpowerMin;
+	float rxpowerMax;
+	bool seen; //CSV에 나옴
+};
+
+static struct testCell_t g_testCell[TEST_WIN][TEST_RSU + 1][TEST_IF];
+static uint64_t g_testLate; //늦게 보낸 항목 수
+static uint64_t g_testLateCnt;
+static uint64_t g_testDropped; //보내지 않은 데이터그램 수
+static uint64_t g_testSent; //보낸 데이터그램 수
+static char g_testSock[64];
+static char g_testCsv[64];
+
+/**
+ * test_Build()
+ * 차량 obu의 보고 구간 win 데이터그램을 만든다.
+ * @return 데이터그램 길이
+ */
+static size_t test_Build(uint8_t *buf, uint32_t obu, uint32_t win)
+{
+	struct parFleetHdr_t *hdr = (struct parFleetHdr_t*)buf;
+	struct parFleetEntry_t *e = (struct parFleetEntry_t*)(buf + sizeof(struct parFleetHdr_t));
+	int num = 0;
+
+	for(int k = 0; k < 5; k++)
+	{
+		/* k = 4 : 4대 중 1대는 첫 RSU를 인터페이스 1로도 받는다. */
+		if(k == 4 && obu % 4 != 0)
+			break;
+		memset(&e[num], 0, sizeof(struct parFleetEntry_t));
+		e[num].rsuID = (int32_t)((k == 4) ? (obu + win * 3) % TEST_RSU + 1 : (obu + win * 3 + k * 7) % TEST_RSU + 1);
+		e[num].channel = 172;
+		e[num].ifIdx = (k == 4) ? 1 : 0;
+		e[num].rsuLatitude = 374000000 + e[num].rsuID * 4500;
+		e[num].rsuLongitude = 1270000000;
+		e[num].obuLatitude = 374000000 + obu * 100;
+		e[num].obuLongitude = 1270000000;
+		e[num].distance = 100.0f + obu + k;
+		e[num].expected = 10;
+		e[num].cnt = (k == 4) ? (obu + win) % 5 : (obu * 7 + win * 3 + k) % 10 + 1;
+		e[num].seqRcv = e[num].cnt;
+		e[num].seqLost = e[num].expected - e[num].cnt;
+		e[num].rxpowerAvg = -60.0f - (float)(obu % 20) - (float)k;
+		e[num].rxpowerMin = e[num].rxpowerAvg - 5.0f;
+		e[num].rxpowerMax = e[num].rxpowerAvg + 3.0f;
+		e[num].rcpiAvg = 150.0f + (float)(obu % 20);
+		e[num].latCnt = e[num].cnt;
+		e[num].latAvg = 1000.0f + obu;
+		num++;
+	}
+	hdr->magic = PAR_FLEET_MAGIC;
+	hdr->version = PAR_FLEET_VERSION;
+	hdr->num = (uint16_t)num;
+	hdr->obuID = 1000 + obu;
+	hdr->seq = win;
+	hdr->start = TEST_T0 + win * TEST_PERIOD;
+	hdr->end = hdr->start + TEST_PERIOD;
+	return sizeof(struct parFleetHdr_t) + num * sizeof(struct parFleetEntry_t);
+}
+
+/**
+ * test_Expect()
+ * 보낸 데이터그램을 기대값에 더한다. (late이면 늦은 항목으로만 센다)
+ */
+static void test_Expect(const uint8_t *buf, uint32_t win, bool late)
+{
+	const struct parFleetHdr_t *hdr = (const struct parFleetHdr_t*)buf;
+	const struct parFleetEntry_t *e = (const struct parFleetEntry_t*)(buf + sizeof(struct parFleetHdr_t));
+
+	for(int i = 0; i < hdr->num; i++)
+	{
+		struct testCell_t *c = &g_testCell[win][e[i].rsuID][e[i].ifIdx];
+
+		if(late)
+		{
+			g_testLate++;
+			g_testLateCnt += e[i].cnt;
+			continue;
+		}
+		if(c->vehicles == 0)
+		{
+			c->rxpowerMin = FLT_MAX;
+			c->rxpowerMax = -FLT_MAX;
+		}
+		c->vehicles++;
+		c->cnt += e[i].cnt;
+		c->expected += e[i].expected;
+		c->seqRcv += e[i].seqRcv;
+		c->seqLost += e[i].seqLost;
+		c->latCnt += e[i].latCnt;
+		if(e[i].cnt != 0)
+		{
+			if(e[i].rxpowerMin < c->rxpowerMin)
+				c->rxpowerMin = e[i].rxpowerMin;
+			if(e[i].rxpowerMax > c->rxpowerMax)
+				c->rxpowerMax = e[i].rxpowerMax;
+		}
+	}
+}
+
+static void test_Send(int fd, const struct sockaddr_un *addr, uint32_t obu, uint32_t win, bool late)
+{
+	uint8_t buf[PAR_FLEET_DGRAM_MAX];
+	size_t len;
+
+	if(TEST_DROP(obu, win))
+	{
+		g_testDropped++;
+		return;
+	}
+	len = test_Build(buf, obu, win);
+	test_Expect(buf, win, late);
+	if(sendto(fd, buf, len, 0, (const struct sockaddr*)addr, sizeof(struct sockaddr_un)) == (ssize_t)len)
+		g_testSent++;
+}
+
+static void* test_Aggregator(void *arg)
+{
+	char *argv[] = { "parfleet", "-U", g_testSock, "-l", TEST_LATENESS, "-o", g_testCsv, NULL };
+
+	return (void*)(intptr_t)parfleet_main(7, argv);
+}
+
+/**
+ * test_Csv()
+ * 집계 CSV의 각 줄을 기대값과 비교한다.
+ * @return 비교한 줄 수
+ */
+static int test_Csv(void)
+{
+	FILE *fp = fopen(g_testCsv, "r");
+	char line[512];
+	int rows = 0, mismatch = 0;
+	unsigned long long lastStart = 0;
+
+	TEST_CHECK(fp != NULL);
+	if(fp == NULL)
+		return 0;
+	TEST_CHECK(fgets(line, sizeof(line), fp) != NULL && strncmp(line, "start,end,rsuID", 15) == 0);
+	while(fgets(line, sizeof(line), fp) != NULL)
+	{
+		unsigned long long start, end, cnt, expected, seqRcv, seqLost, latCnt;
+		unsigned int channel, ifIdx, vehicles;
+		int rsuID, rsuLat, rsuLon;
+		double par, per, rxMin, rxMax, rxAvg, rcpiAvg;
+		struct testCell_t *c;
+		uint64_t win;
+
+		if(sscanf(line, "%llu,%llu,%d,%u,%u,%d,%d,%u,%llu,%llu,%lf,%llu,%llu,%lf,%lf,%lf,%lf,%lf,%llu",
+				&start, &end, &rsuID, &channel, &ifIdx, &rsuLat, &rsuLon, &vehicles, &cnt, &expected, &par,
+				&seqRcv, &seqLost, &per, &rxMin, &rxMax, &rxAvg, &rcpiAvg, &latCnt) != 19)
+		{
+			mismatch++;
+			continue;
+		}
+		rows++;
+		/* 구간은 끝시각 순으로 확정된다. */
+		if(start < lastStart)
+			mismatch++;
+		lastStart = start;
+		win = (start - TEST_T0) / TEST_PERIOD;
+		if(win >= TEST_WIN || end != start + TEST_PERIOD || rsuID < 1 || rsuID > TEST_RSU || ifIdx >= TEST_IF)
+		{
+			mismatch++;
+			continue;
+		}
+		c = &g_testCell[win][rsuID][ifIdx];
+		if(c->seen || c->vehicles != vehicles || c->cnt != cnt || c->expected != expected ||
+				c->seqRcv != seqRcv || c->seqLost != seqLost || c->latCnt != latCnt ||
+				fabs(par - (double)c->cnt * 100.0 / c->expected) > 0.01 ||
+				(c->cnt != 0 && (fabs(rxMin - c->rxpowerMin) > 0.01 || fabs(rxMax - c->rxpowerMax) > 0.01)))
+		{
+			fprintf(stderr, "mismatch : %s", line);
+			mismatch++;
+		}
+		c->seen = true;
+	}
+	fclose(fp);
+	TEST_CHECK(mismatch == 0);
+	return rows;
+}
+
+int main(void)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	pthread_t thread;
+	uint8_t bad[sizeof(struct parFleetHdr_t)];
+	void *ret;
+	int fd, cells = 0, rows, unseen = 0, rsuMismatch = 0;
+	uint64_t lateEntries = g_testLate;
+
+	snprintf(g_testSock, sizeof(g_testSock), "/tmp/parfleet-test-%d.sock", (int)getpid());
+	snprintf(g_testCsv, sizeof(g_testCsv), "/tmp/parfleet-test-%d.csv", (int)getpid());
+	unlink(g_testSock);
+	if(pthread_create(&thread, NULL, test_Aggregator, NULL) != 0)
+		return 1;
+	for(int i = 0; i < 1000 && stat(g_testSock, &st) != 0; i++)
+		usleep(1000);
+
+	fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, g_testSock);
+
+	/* 단계 s : 제때 보내는 차량의 구간 s -> 한 구간 늦은 차량의 구간 s-1 -> 다섯 구간 늦은 차량의 구간 s-5 */
+	for(uint32_t s = 0; s <= TEST_WIN; s++)
+	{
+		for(uint32_t obu = 0; obu < TEST_OBU && s < TEST_WIN; obu++)
+		{
+			if(!TEST_DELAY1(obu) && !(TEST_DELAY5(obu) && s + 5 < TEST_WIN))
+				test_Send(fd, &addr, obu, s, false);
+		}
+		for(uint32_t obu = 0; obu < TEST_OBU && s >= 1; obu++)
+		{
+			if(TEST_DELAY1(obu))
+				test_Send(fd, &addr, obu, s - 1, false);
+		}
+		for(uint32_t obu = 0; obu < TEST_OBU && s >= 5 && s < TEST_WIN; obu++)
+		{
+			if(TEST_DELAY5(obu))
+				test_Send(fd, &addr, obu, s - 5, true);
+		}
+	}
+	lateEntries = g_testLate - lateEntries;
+
+	/* 형식이 틀린 데이터그램 (magic, 길이) */
+	memset(bad, 0, sizeof(bad));
+	sendto(fd, bad, sizeof(bad), 0, (struct sockaddr*)&addr, sizeof(addr));
+	sendto(fd, bad, 10, 0, (struct sockaddr*)&addr, sizeof(addr));
+	g_testSent += 2;
+
+	/* 모두 읽을 때까지 기다린 후 종료 (종료 시 열린 구간을 모두 확정한다) */
+	for(int i = 0; i < 5000 && __atomic_load_n(&g_dgrams, __ATOMIC_SEQ_CST) < g_testSent; i++)
+		usleep(1000);
+	g_stop = 1;
+	pthread_join(thread, &ret);
+	close(fd);
+	TEST_CHECK(ret == NULL);
+
+	rows = test_Csv();
+	for(int w = 0; w < TEST_WIN; w++)
+	{
+		for(int r = 1; r <= TEST_RSU; r++)
+		{
+			for(int i = 0; i < TEST_IF; i++)
+			{
+				if(g_testCell[w][r][i].vehicles == 0)
+					continue;
+				cells++;
+				if(!g_testCell[w][r][i].seen)
+					unseen++;
+			}
+		}
+	}
+	printf("sent %llu dgrams (dropped %llu), rows %d / cells %d, late entries %llu\n",
+			(unsigned long long)g_testSent, (unsigned long long)g_testDropped, rows, cells, (unsigned long long)lateEntries);
+	TEST_CHECK(rows == cells);
+	TEST_CHECK(unseen == 0);
+
+	/* 수신/늦은 도착/유실 통계 */
+	TEST_CHECK(g_dgrams == g_testSent);
+	TEST_CHECK(g_bad == 2);
+	TEST_CHECK(g_late == g_testLate);
+	TEST_CHECK(g_lateCnt == g_testLateCnt);
+	TEST_CHECK(dgramLost() == g_testDropped);
+	TEST_CHECK(g_windows == TEST_WIN);
+	TEST_CHECK(g_win == NULL);
+
+	/* RSU 링크 별 누적 통계 - 여러 차량/구간을 합친 값 */
+	for(int r = 1; r <= TEST_RSU; r++)
+	{
+		for(int i = 0; i < TEST_IF; i++)
+		{
+			struct fleetCell_t key = { .rsuID = r, .channel = 172, .ifIdx = (uint8_t)i };
+			uint64_t windows = 0, reports = 0, cnt = 0, expected = 0;
+			struct fleetRsu_t *rsu;
+
+			for(int w = 0; w < TEST_WIN; w++)
+			{
+				if(g_testCell[w][r][i].vehicles == 0)
+					continue;
+				windows++;
+				reports += g_testCell[w][r][i].vehicles;
+				cnt += g_testCell[w][r][i].cnt;
+				expected += g_testCell[w][r][i].expected;
+			}
+			if(windows == 0)
+				continue;
+			rsu = findRsu(&key);
+			if(rsu == NULL || rsu->windows != windows || rsu->reports != reports || rsu->cnt != cnt || rsu->expected != expected)
+				rsuMismatch++;
+		}
+	}
+	TEST_CHECK(rsuMismatch == 0);
+
+	unlink(g_testCsv);
+	return TEST_RESULT();
+}
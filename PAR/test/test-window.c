@@ -0,0 +1,219 @@
+/**********************************************************
+  [보고 구간 에포크 스트레스 테스트]
+  실제 수신 루프(par_RXoperation())와 보고 쓰레드(rxThread -> par_Report())를 그대로 실행하고,
+  메시지큐(recvMQ()) 대신 수십 kHz로 프로브 수신 메시지를 만들어 넣는다.
+  실시간 조회 모듈(par_Query*()) 대신 보고 구간 별 RSU 수신 수를 모아,
+  보낸 패킷 수 = 보고된 수신 수 합 + 늦은/앞선 패킷 수(g_parWinLate) 인지 (잃어버린 수신 수가 없는지) 검사한다.
+  일부 패킷은 일부러 마감된 구간/너무 앞선 구간의 수신시각으로 보내 늦은 패킷 경로도 함께 검사한다.
+  시작 전에 지연시간 백분위수가 히스토그램 범위(-4~60msec)를 넘을 때 max로 보고되고 넘은 수가 세어지는지 검사한다.
+
+  실행 : test-window [수신율(Hz)] [시간(msec)] [보고주기(usec)] [RSU 수]
+         (기본 50000Hz, 2000msec, 100000usec, 200개)
+ ************************************************************/
+
+#include "PAR_RX.c"
+#include "test.h"
+
+#define TEST_RSU_MAX 1000
+#define TEST_STALE_EVERY 1000 //이 수마다 마감된 구간의 수신시각으로 보낸다.
+#define TEST_AHEAD_EVERY 1000 //이 수마다 너무 앞선 구간의 수신시각으로 보낸다. (TEST_STALE_EVERY의 중간)
+
+static uint32_t g_testRate = 50000; //수신율 (Hz)
+static uint32_t g_testDuration = 2000; //수신 시간 (msec)
+static uint32_t g_testRsuNum = 200; //RSU 수
+static uint64_t g_testStart; //수신 시작 (usec, CLOCK_MONOTONIC)
+static uint64_t g_testSent; //보낸 패킷 수
+static uint64_t g_testInjected; //일부러 늦게/앞서 보낸 패킷 수
+static uint64_t g_testLastWin; //정상 패킷이 속한 마지막 보고 구간
+static uint64_t g_testSentRsu[TEST_RSU_MAX + 1]; //RSU 별 정상 패킷 수
+static uint64_t g_testRecvRsu[TEST_RSU_MAX + 1]; //RSU 별 보고된 수신 수
+static uint64_t g_testRecv; //보고된 수신 수 합
+static uint32_t g_testWindows; //보고 구간 수
+static uint32_t g_testSeq[TEST_RSU_MAX + 1];
+
+static uint64_t test_Monotonic(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/**
+ * recvMQ()
+ * prcsWSM 대신 프로브 수신 메시지를 만든다. (수신 루프)
+ * 정해진 수를 다 보내면 마지막 구간의 보고가 끝날 때까지 기다린 후 종료시킨다.
+ */
+int recvMQ(char *pkt)
+{
+	struct rsuInfo_t rsu;
+	int16_t rxPower;
+	uint8_t rcpi;
+	uint64_t rxTime, due, limit;
+	uint64_t total = (uint64_t)g_testRate * g_testDuration / 1000;
+	uint32_t len = 0;
+
+	if(g_testSent >= total){
+		limit = test_Monotonic() + 4 * g_mib.interval + 1000000;
+		while(__atomic_load_n(&g_parWinDrained, __ATOMIC_SEQ_CST) < g_testLastWin && test_Monotonic() < limit)
+			usleep(1000);
+		ending = 1;
+		return -1;
+	}
+	/* 시작 시점의 부분 구간은 보고하지 않으므로 첫 구간이 시작된 후 보낸다. */
+	if(g_testStart == 0){
+		while(par_TimeNow() / g_mib.interval <= __atomic_load_n(&g_parWinClosed, __ATOMIC_SEQ_CST))
+			usleep(100);
+		g_testStart = test_Monotonic();
+	}
+	due = g_testStart + g_testSent * 1000000ULL / g_testRate;
+	while(test_Monotonic() < due)
+		;
+
+	memset(&rsu, 0, sizeof(rsu));
+	rsu.rsuID = (int32_t)(g_testSent % g_testRsuNum) + 1;
+	rsu.rsuLatitude = 375000000 + rsu.rsuID * 1000;
+	rsu.rsuLongitude = 1270000000 + rsu.rsuID * 1000;
+	rsu.seq = ++g_testSeq[rsu.rsuID];
+	rxTime = par_TimeNow();
+	rsu.txTime = rxTime - 1000;
+	if(g_testSent % TEST_STALE_EVERY == TEST_STALE_EVERY - 1){
+		rxTime -= 3 * (uint64_t)g_mib.interval;
+		g_testInjected++;
+	}
+	else if(g_testSent % TEST_AHEAD_EVERY == TEST_AHEAD_EVERY / 2){
+		rxTime += 10 * (uint64_t)g_mib.interval;
+		g_testInjected++;
+	}
+	else{
+		g_testSentRsu[rsu.rsuID]++;
+		g_testLastWin = rxTime / g_mib.interval;
+	}
+	rxPower = (int16_t)(-60 - (int16_t)(g_testSent % 30));
+	rcpi = (uint8_t)(100 + g_testSent % 50);
+
+	memcpy(pkt + len, &rsu, sizeof(rsu));
+	len += sizeof(rsu);
+	memcpy(pkt + len, &rxPower, sizeof(rxPower));
+	len += sizeof(rxPower);
+	pkt[len++] = (char)rcpi;
+	memcpy(pkt + len, &rxTime, sizeof(rxTime));
+	len += sizeof(rxTime);
+	pkt[len++] = 0; //수신 인터페이스
+	pkt[len++] = 172; //수신 채널
+	g_testSent++;
+	return (int)len;
+}
+
+/* 실시간 조회 모듈 대체 - 보고된 수신 수를 모은다. (보고 쓰레드) */
+int par_QueryInit(void)
+{
+	return 0;
+}
+
+void par_QueryBegin(uint64_t start, uint64_t end)
+{
+	g_testWindows++;
+}
+
+void par_QueryPut(const struct parInfo_t *node, uint32_t cnt)
+{
+	if(node->rsuID > 0 && node->rsuID <= TEST_RSU_MAX)
+		g_testRecvRsu[node->rsuID] += cnt;
+	g_testRecv += cnt;
+}
+
+void par_QueryPublish(void)
+{
+}
+
+void par_QueryClose(void)
+{
+}
+
+/**
+ * test_Percentile()
+ * 지연시간 히스토그램 범위를 넘은 샘플 - 백분위수가 마지막 구간 값에 고정되지 않고 min/max로 보고되는지 검사한다.
+ */
+static void test_Percentile(void)
+{
+	static struct parStat_t stat;
+	double basic[4], ext[4];
+
+	/* 80개는 10msec, 20개는 100~119msec (범위 초과) - p50은 구간 중앙값, p90/p99는 max */
+	for(int i = 0; i < 80; i++)
+		par_StatAdd(&stat, 10000, PAR_HIST_LAT_OFFSET, PAR_HIST_LAT_WIDTH);
+	for(int i = 0; i < 20; i++)
+		par_StatAdd(&stat, 100000 + i * 1000, PAR_HIST_LAT_OFFSET, PAR_HIST_LAT_WIDTH);
+	getCalData(&stat, PAR_HIST_LAT_OFFSET, PAR_HIST_LAT_WIDTH, basic, ext);
+	TEST_CHECK(stat.over == 20 && stat.under == 0);
+	TEST_CHECK(ext[1] == 10000 + PAR_HIST_LAT_WIDTH / 2);
+	TEST_CHECK(ext[2] == 119000 && ext[3] == 119000);
+
+	/* 범위보다 작은 샘플은 min으로 보고 */
+	memset(&stat, 0, sizeof(stat));
+	for(int i = 0; i < 60; i++)
+		par_StatAdd(&stat, -10000 - i, PAR_HIST_LAT_OFFSET, PAR_HIST_LAT_WIDTH);
+	for(int i = 0; i < 40; i++)
+		par_StatAdd(&stat, 5000, PAR_HIST_LAT_OFFSET, PAR_HIST_LAT_WIDTH);
+	getCalData(&stat, PAR_HIST_LAT_OFFSET, PAR_HIST_LAT_WIDTH, basic, ext);
+	TEST_CHECK(stat.under == 60 && stat.over == 0);
+	TEST_CHECK(ext[1] == -10059);
+	TEST_CHECK(ext[2] == 5000 + PAR_HIST_LAT_WIDTH / 2);
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t late;
+	uint32_t mismatch = 0;
+
+	if(argc > 1)
+		g_testRate = (uint32_t)strtoul(argv[1], NULL, 10);
+	if(argc > 2)
+		g_testDuration = (uint32_t)strtoul(argv[2], NULL, 10);
+	if(argc > 3)
+		g_mib.interval = (uint32_t)strtoul(argv[3], NULL, 10);
+	else
+		g_mib.interval = 100000;
+	if(argc > 4)
+		g_testRsuNum = (uint32_t)strtoul(argv[4], NULL, 10);
+	if(g_testRate == 0 || g_testRsuNum == 0 || g_testRsuNum > TEST_RSU_MAX){
+		fprintf(stderr, "usage: %s [rate(Hz)] [duration(msec)] [interval(usec)] [rsu(1~%d)]\n", argv[0], TEST_RSU_MAX);
+		return 2;
+	}
+	test_Percentile();
+
+	g_mib.cycle = 10;
+	g_mib.Latitude = 375000000;
+	g_mib.Longitude = 1270000000;
+
+	if(par_InitRXoperation() < 0){
+		fprintf(stderr, "par_InitRXoperation() fail\n");
+		return 1;
+	}
+	par_RXoperation();
+
+	late = __atomic_load_n(&g_parWinLate, __ATOMIC_SEQ_CST);
+	printf("sent %llu (%llu/s), reported %llu in %u windows, late %llu (injected %llu)\n",
+			(unsigned long long)g_testSent, (unsigned long long)(g_testSent * 1000 / g_testDuration),
+			(unsigned long long)g_testRecv, g_testWindows,
+			(unsigned long long)late, (unsigned long long)g_testInjected);
+
+	/* 잃어버린 수신 수 없음 - 모든 패킷은 보고되거나 늦은 패킷으로 세어진다. */
+	TEST_CHECK(g_testRecv + late == g_testSent);
+	TEST_CHECK(late >= g_testInjected);
+	/* 정상 패킷이 늦지 않았으면 RSU 별로도 모두 보고되어야 한다. (부하로 수신 루프가 보호시간 넘게 멈추면 늦은 패킷이 된다) */
+	if(late == g_testInjected){
+		for(uint32_t i = 1; i <= g_testRsuNum; i++){
+			if(g_testRecvRsu[i] != g_testSentRsu[i])
+				mismatch++;
+		}
+		TEST_CHECK(mismatch == 0);
+	}
+	else{
+		printf("%llu packets late beyond guard time - per-RSU check skipped\n",
+				(unsigned long long)(late - g_testInjected));
+	}
+	TEST_CHECK(g_testWindows >= g_testDuration * 1000ULL / g_mib.interval - 1);
+	return TEST_RESULT();
+}
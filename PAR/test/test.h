@@ -0,0 +1,25 @@
+/**********************************************************
+  [PAR 호스트 테스트 공통]
+  테스트는 호스트(gcc)에서 빌드하여 ctest로 실행한다. 액세스계층/dot3/gpsd 라이브러리는 링크하지 않는다.
+  TEST_CHECK()가 실패하면 위치를 출력하고 계속 진행하며, TEST_RESULT()가 종료코드를 반환한다.
+ ************************************************************/
+
+#ifndef PAR_TEST_H
+#define PAR_TEST_H
+
+#include <stdio.h>
+
+static int g_testFail; //실패한 검사 수
+
+#define TEST_CHECK(cond) \
+	do { \
+		if(!(cond)){ \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			g_testFail++; \
+		} \
+	} while(0)
+
+#define TEST_RESULT() \
+	((g_testFail == 0) ? (printf("PASS\n"), 0) : (printf("FAIL (%d)\n", g_testFail), 1))
+
+#endif //PAR_TEST_H
@@ -0,0 +1,681 @@
+/**********************************************************
+  [parfleet]
+  PAR 차량군 보고(PAR_FLEET.h) 집계 도구
+
+  - 여러 OBU의 PAR(-F 옵션)가 보고 구간마다 보내는 RSU 별 통계를 UDP/UNIX 데이터그램 소켓으로 받아
+    (RSU, 채널, 인터페이스, 보고 구간) 별로 합치고, 구간이 확정되면 링크 별로 CSV 한 줄씩 출력한다.
+  - 보고 구간은 GPS/UTC 경계에 정렬되어 있으므로 차량이 달라도 같은 (start, end)를 가진다.
+
+  [워터마크]
+  지금까지 받은 보고 구간 끝시각의 최대값 - 허용 지연(-l)을 워터마크로 하고,
+  끝시각이 워터마크 이하인 구간을 확정하여 출력한다.
+  이미 확정된 구간의 보고가 늦게 도착하면 버리고 센다. (late)
+  허용 지연 동안 아무 보고도 없으면 열린 구간을 모두 확정한다. (마지막 구간, 송신 중단)
+  시간축은 보고에 들어 있는 시각만 사용하므로, 재생/모의 송신 배속과 관계없이 같은 결과가 나온다.
+
+  사용 예
+    parfleet -u 47000 -o fleet.csv -p 10
+    parfleet -U /tmp/parfleet.sock -l 2000000
+ ************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <signal.h>
+#include <getopt.h>
+#include <errno.h>
+#include <float.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <PAR_FLEET.h>
+
+#define FLEET_BATCH 64 //recvmmsg() 한 번에 받는 데이터그램 수
+#define FLEET_RCVBUF (4 * 1024 * 1024) //수신 소켓 버퍼 크기
+#define FLEET_POLL_MSEC 100
+#define FLEET_OBU_HASH 4096 //차량 별 일련번호 추적 해시 크기 (2의 거듭제곱)
+
+/* (RSU 링크, 보고 구간) 하나의 합산값 */
+struct fleetCell_t{
+	int32_t rsuID;
+	uint8_t channel;
+	uint8_t ifIdx;
+	int32_t rsuLatitude;
+	int32_t rsuLongitude;
+	uint32_t vehicles; //보고한 차량 수
+	uint64_t cnt;
+	uint64_t expected;
+	uint64_t seqRcv;
+	uint64_t seqLost;
+	float rxpowerMin;
+	float rxpowerMax;
+	double rxpowerSum; //수신 수 가중 합
+	double rcpiSum; //수신 수 가중 합
+	uint64_t latCnt;
+	double latSum; //지연시간 샘플 수 가중 합
+	float distMin;
+	float distMax;
+};
+
+/* 열린 보고 구간 */
+struct fleetWin_t{
+	uint64_t start;
+	uint64_t end;
+	struct fleetCell_t *cell;
+	uint32_t num;
+	uint32_t cap;
+	uint32_t *hash; //링크 -> cell 인덱스 + 1 (크기 cap * 2)
+	struct fleetWin_t *next; //끝시각 순
+};
+
+/* RSU 링크 별 누적 통계 */
+struct fleetRsu_t{
+	int32_t rsuID;
+	uint8_t channel;
+	uint8_t ifIdx;
+	uint64_t windows;
+	uint64_t reports; //차량 보고 수
+	uint64_t cnt;
+	uint64_t expected;
+	uint64_t seqRcv;
+	uint64_t seqLost;
+	struct fleetRsu_t *next;
+};
+
+/* 차량 별 데이터그램 일련번호 */
+struct fleetObu_t{
+	uint32_t obuID;
+	uint32_t first; //처음 받은 일련번호
+	uint32_t last; //가장 앞선 일련번호
+	uint64_t rcv; //받은 데이터그램 수
+	struct fleetObu_t *next;
+};
+
+static struct fleetWin_t *g_win; //열린 보고 구간 (끝시각 순)
+static uint64_t g_maxEnd; //받은 보고 구간 끝시각 최대값
+static uint64_t g_watermark; //이 시각 이하에 끝나는 구간은 확정됨
+static uint64_t g_lateness = 3000000; //허용 지연 (usec)
+static struct fleetRsu_t *g_rsu[FLEET_OBU_HASH];
+static struct fleetObu_t *g_obu[FLEET_OBU_HASH];
+static FILE *g_out;
+static bool g_csvHeader = false;
+static volatile sig_atomic_t g_stop = 0;
+
+/* 수신 통계 */
+static uint64_t g_dgrams; //받은 데이터그램 수
+static uint64_t g_bad; //형식이 틀린 데이터그램 수
+static uint64_t g_entries; //합산한 항목 수
+static uint64_t g_entryCnt; //합산한 항목의 수신 수 합
+static uint64_t g_late; //늦게 도착하여 버린 항목 수
+static uint64_t g_lateCnt; //버린 항목의 수신 수 합
+static uint64_t g_windows; //확정한 보고 구간 수
+static uint64_t g_rows; //출력한 줄 수
+
+
+static void usage(char *cmd)
+{
+	printf("Usage: %s [OPTIONS]\n\n", cmd);
+	printf("  -u <port>       receive reports on UDP port\n");
+	printf("  -U <path>       receive reports on UNIX datagram socket\n");
+	printf("  -l <usec>       allowed lateness (default 3000000)\n");
+	printf("  -o <file>       CSV output file (default stdout)\n");
+	printf("  -p <sec>        print per-RSU summary to stderr every <sec> seconds (default only at exit)\n");
+	printf("  -h              print usage\n");
+}
+
+static void sigHandler(int sig)
+{
+	(void)sig;
+	g_stop = 1;
+}
+
+static uint64_t monoUsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/**
+ * openUdp() / openUnix()
+ * 수신 소켓을 생성한다.
+ * @return 성공 시 소켓, 실패 시 -1
+ */
+static int openUdp(int port)
+{
+	struct sockaddr_in6 addr;
+	int fd, on = 1, off = 0, size = FLEET_RCVBUF;
+
+	fd = socket(AF_INET6, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if(fd < 0)
+	{
+		perror("socket");
+		return -1;
+	}
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	memset(&addr, 0, sizeof(addr));
+	addr.sin6_family = AF_INET6;
+	addr.sin6_addr = in6addr_any;
+	addr.sin6_port = htons(port);
+	if(bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		fprintf(stderr, "bind(UDP %d) : %s\n", port, strerror(errno));
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int openUnix(const char *path)
+{
+	struct sockaddr_un addr;
+	int fd, size = FLEET_RCVBUF;
+
+	if(strlen(path) >= sizeof(addr.sun_path))
+	{
+		fprintf(stderr, "Too long path - %s\n", path);
+		return -1;
+	}
+	fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if(fd < 0)
+	{
+		perror("socket");
+		return -1;
+	}
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	unlink(path);
+	if(bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		fprintf(stderr, "bind(%s) : %s\n", path, strerror(errno));
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * linkHash()
+ * (rsuID, 채널, 인터페이스) 링크 해시값
+ */
+static uint32_t linkHash(int32_t rsuID, uint8_t channel, uint8_t ifIdx)
+{
+	return ((uint32_t)rsuID * 2654435761u) ^ (((uint32_t)channel << 8 | ifIdx) * 0x85ebca77u);
+}
+
+/**
+ * findRsu()
+ * RSU 링크 누적 통계를 찾는다. 없으면 만든다.
+ */
+static struct fleetRsu_t* findRsu(const struct fleetCell_t *c)
+{
+	uint32_t h = linkHash(c->rsuID, c->channel, c->ifIdx) & (FLEET_OBU_HASH - 1);
+	struct fleetRsu_t *r;
+
+	for(r = g_rsu[h]; r != NULL; r = r->next)
+	{
+		if(r->rsuID == c->rsuID && r->channel == c->channel && r->ifIdx == c->ifIdx)
+			return r;
+	}
+	r = (struct fleetRsu_t*)calloc(1, sizeof(struct fleetRsu_t));
+	if(r == NULL)
+		return NULL;
+	r->rsuID = c->rsuID;
+	r->channel = c->channel;
+	r->ifIdx = c->ifIdx;
+	r->next = g_rsu[h];
+	g_rsu[h] = r;
+	return r;
+}
+
+/**
+ * checkObuSeq()
+ * 차량 별 데이터그램 일련번호 범위와 받은 수를 갱신한다. (유실 = 범위 - 받은 수, 순서 바뀜은 유실이 아님)
+ */
+static void checkObuSeq(uint32_t obuID, uint32_t seq)
+{
+	uint32_t h = (obuID * 2654435761u) & (FLEET_OBU_HASH - 1);
+	struct fleetObu_t *o;
+
+	for(o = g_obu[h]; o != NULL; o = o->next)
+	{
+		if(o->obuID == obuID)
+			break;
+	}
+	if(o == NULL)
+	{
+		o = (struct fleetObu_t*)calloc(1, sizeof(struct fleetObu_t));
+		if(o == NULL)
+			return;
+		o->obuID = obuID;
+		o->first = o->last = seq;
+		o->next = g_obu[h];
+		g_obu[h] = o;
+	}
+	if((int32_t)(seq - o->last) > 0)
+		o->last = seq;
+	else if((int32_t)(seq - o->first) < 0)
+		o->first = seq;
+	o->rcv++;
+}
+
+/**
+ * dgramLost()
+ * 일련번호 기준 유실 데이터그램 수
+ */
+static uint64_t dgramLost(void)
+{
+	uint64_t lost = 0;
+
+	for(int h = 0; h < FLEET_OBU_HASH; h++)
+	{
+		for(const struct fleetObu_t *o = g_obu[h]; o != NULL; o = o->next)
+		{
+			uint64_t span = (uint64_t)(o->last - o->first) + 1;
+
+			if(span > o->rcv)
+				lost += span - o->rcv;
+		}
+	}
+	return lost;
+}
+
+/**
+ * findWin()
+ * 보고 구간을 찾는다. 없으면 끝시각 순서에 맞게 만든다.
+ */
+static struct fleetWin_t* findWin(uint64_t start, uint64_t end)
+{
+	struct fleetWin_t **pp, *w;
+
+	for(pp = &g_win; *pp != NULL && (*pp)->end <= end; pp = &(*pp)->next)
+	{
+		if((*pp)->end == end && (*pp)->start == start)
+			return *pp;
+	}
+	w = (struct fleetWin_t*)calloc(1, sizeof(struct fleetWin_t));
+	if(w == NULL)
+		return NULL;
+	w->start = start;
+	w->end = end;
+	w->next = *pp;
+	*pp = w;
+	return w;
+}
+
+/**
+ * growWin()
+ * 구간의 셀 배열과 해시를 두 배로 늘린다.
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int growWin(struct fleetWin_t *w)
+{
+	uint32_t cap = (w->cap == 0) ? 64 : w->cap * 2;
+	struct fleetCell_t *cell;
+	uint32_t *hash;
+
+	cell = (struct fleetCell_t*)realloc(w->cell, cap * sizeof(struct fleetCell_t));
+	if(cell == NULL)
+		return -1;
+	w->cell = cell;
+	hash = (uint32_t*)calloc(cap * 2, sizeof(uint32_t));
+	if(hash == NULL)
+		return -1;
+	for(uint32_t i = 0; i < w->num; i++)
+	{
+		uint32_t h = linkHash(w->cell[i].rsuID, w->cell[i].channel, w->cell[i].ifIdx) & (cap * 2 - 1);
+
+		while(hash[h] != 0)
+			h = (h + 1) & (cap * 2 - 1);
+		hash[h] = i + 1;
+	}
+	free(w->hash);
+	w->hash = hash;
+	w->cap = cap;
+	return 0;
+}
+
+/**
+ * findCell()
+ * 구간에서 RSU 링크 셀을 찾는다. 없으면 만든다.
+ */
+static struct fleetCell_t* findCell(struct fleetWin_t *w, const struct parFleetEntry_t *e)
+{
+	struct fleetCell_t *c;
+	uint32_t h;
+
+	if(w->num == w->cap && growWin(w) < 0)
+		return NULL;
+	h = linkHash(e->rsuID, e->channel, e->ifIdx) & (w->cap * 2 - 1);
+	while(w->hash[h] != 0)
+	{
+		c = &w->cell[w->hash[h] - 1];
+		if(c->rsuID == e->rsuID && c->channel == e->channel && c->ifIdx == e->ifIdx)
+			return c;
+		h = (h + 1) & (w->cap * 2 - 1);
+	}
+	c = &w->cell[w->num];
+	w->hash[h] = ++w->num;
+	memset(c, 0, sizeof(struct fleetCell_t));
+	c->rsuID = e->rsuID;
+	c->channel = e->channel;
+	c->ifIdx = e->ifIdx;
+	c->rsuLatitude = e->rsuLatitude;
+	c->rsuLongitude = e->rsuLongitude;
+	c->rxpowerMin = FLT_MAX;
+	c->rxpowerMax = -FLT_MAX;
+	c->distMin = FLT_MAX;
+	c->distMax = -FLT_MAX;
+	return c;
+}
+
+/**
+ * mergeEntry()
+ * 차량 하나의 RSU 항목을 셀에 합친다.
+ */
+static void mergeEntry(struct fleetCell_t *c, const struct parFleetEntry_t *e)
+{
+	c->vehicles++;
+	c->cnt += e->cnt;
+	c->expected += e->expected;
+	c->seqRcv += e->seqRcv;
+	c->seqLost += e->seqLost;
+	if(e->cnt != 0)
+	{
+		if(e->rxpowerMin < c->rxpowerMin)
+			c->rxpowerMin = e->rxpowerMin;
+		if(e->rxpowerMax > c->rxpowerMax)
+			c->rxpowerMax = e->rxpowerMax;
+		c->rxpowerSum += (double)e->rxpowerAvg * e->cnt;
+		c->rcpiSum += (double)e->rcpiAvg * e->cnt;
+	}
+	c->latCnt += e->latCnt;
+	c->latSum += (double)e->latAvg * e->latCnt;
+	if(e->distance < c->distMin)
+		c->distMin = e->distance;
+	if(e->distance > c->distMax)
+		c->distMax = e->distance;
+}
+
+/**
+ * outputWin()
+ * 확정된 구간의 RSU 셀을 CSV로 출력하고 누적 통계에 더한다.
+ */
+static void outputWin(const struct fleetWin_t *w)
+{
+	if(!g_csvHeader)
+	{
+		fprintf(g_out, "start,end,rsuID,channel,ifIdx,rsuLatitude,rsuLongitude,vehicles,cnt,expected,par,seqRcv,seqLost,per,"
+				"rxpowerMin,rxpowerMax,rxpowerAvg,rcpiAvg,latCnt,latAvg,distanceMin,distanceMax\n");
+		g_csvHeader = true;
+	}
+	for(uint32_t i = 0; i < w->num; i++)
+	{
+		const struct fleetCell_t *c = &w->cell[i];
+		struct fleetRsu_t *r;
+		double par = (c->expected != 0) ? (double)c->cnt * 100.0 / c->expected : 0.0;
+		double per = (c->seqRcv + c->seqLost != 0) ? (double)c->seqLost * 100.0 / (c->seqRcv + c->seqLost) : 0.0;
+
+		fprintf(g_out, "%llu,%llu,%d,%u,%u,%d,%d,%u,%llu,%llu,%.2f,%llu,%llu,%.2f,%.2f,%.2f,%.2f,%.2f,%llu,%.1f,%.1f,%.1f\n",
+				(unsigned long long)w->start, (unsigned long long)w->end, c->rsuID, c->channel, c->ifIdx, c->rsuLatitude, c->rsuLongitude,
+				c->vehicles, (unsigned long long)c->cnt, (unsigned long long)c->expected, par,
+				(unsigned long long)c->seqRcv, (unsigned long long)c->seqLost, per,
+				(c->cnt != 0) ? c->rxpowerMin : 0.0, (c->cnt != 0) ? c->rxpowerMax : 0.0,
+				(c->cnt != 0) ? c->rxpowerSum / c->cnt : 0.0, (c->cnt != 0) ? c->rcpiSum / c->cnt : 0.0,
+				(unsigned long long)c->latCnt, (c->latCnt != 0) ? c->latSum / c->latCnt : 0.0,
+				c->distMin, c->distMax);
+		g_rows++;
+
+		r = findRsu(c);
+		if(r == NULL)
+			continue;
+		r->windows++;
+		r->reports += c->vehicles;
+		r->cnt += c->cnt;
+		r->expected += c->expected;
+		r->seqRcv += c->seqRcv;
+		r->seqLost += c->seqLost;
+	}
+	g_windows++;
+}
+
+/**
+ * advance()
+ * 워터마크를 올리고 끝시각이 워터마크 이하인 구간을 확정한다.
+ */
+static void advance(uint64_t watermark)
+{
+	struct fleetWin_t *w;
+
+	if(watermark > g_watermark)
+		g_watermark = watermark;
+	while(g_win != NULL && g_win->end <= g_watermark)
+	{
+		w = g_win;
+		g_win = w->next;
+		outputWin(w);
+		free(w->cell);
+		free(w->hash);
+		free(w);
+	}
+	fflush(g_out);
+}
+
+/**
+ * processDgram()
+ * 데이터그램 하나를 검사하고 항목을 구간에 합친다.
+ */
+static void processDgram(const uint8_t *buf, size_t len)
+{
+	const struct parFleetHdr_t *hdr = (const struct parFleetHdr_t*)buf;
+	const struct parFleetEntry_t *e = (const struct parFleetEntry_t*)(buf + sizeof(struct parFleetHdr_t));
+	struct fleetWin_t *w;
+	struct fleetCell_t *c;
+
+	g_dgrams++;
+	if(len < sizeof(struct parFleetHdr_t) || hdr->magic != PAR_FLEET_MAGIC || hdr->version != PAR_FLEET_VERSION ||
+			hdr->num > PAR_FLEET_ENTRY_MAX || len != sizeof(struct parFleetHdr_t) + hdr->num * sizeof(struct parFleetEntry_t) ||
+			hdr->end <= hdr->start)
+	{
+		g_bad++;
+		return;
+	}
+	checkObuSeq(hdr->obuID, hdr->seq);
+
+	/* 이미 확정된 구간 */
+	if(hdr->end <= g_watermark)
+	{
+		g_late += hdr->num;
+		for(uint32_t i = 0; i < hdr->num; i++)
+			g_lateCnt += e[i].cnt;
+		return;
+	}
+
+	w = findWin(hdr->start, hdr->end);
+	if(w == NULL)
+		return;
+	for(uint32_t i = 0; i < hdr->num; i++)
+	{
+		c = findCell(w, &e[i]);
+		if(c == NULL)
+			continue;
+		mergeEntry(c, &e[i]);
+		g_entries++;
+		g_entryCnt += e[i].cnt;
+	}
+
+	if(hdr->end > g_maxEnd)
+	{
+		g_maxEnd = hdr->end;
+		if(g_maxEnd > g_lateness)
+			advance(g_maxEnd - g_lateness);
+	}
+}
+
+/**
+ * printSummary()
+ * 수신/RSU 별 누적 통계를 표준에러로 출력한다.
+ */
+static void printSummary(void)
+{
+	fprintf(stderr, "[parfleet] dgrams %llu (bad %llu, lost %llu), entries %llu (cnt %llu), late %llu (cnt %llu), "
+			"windows %llu, rows %llu, open windows %s\n",
+			(unsigned long long)g_dgrams, (unsigned long long)g_bad, (unsigned long long)dgramLost(),
+			(unsigned long long)g_entries, (unsigned long long)g_entryCnt,
+			(unsigned long long)g_late, (unsigned long long)g_lateCnt,
+			(unsigned long long)g_windows, (unsigned long long)g_rows, (g_win != NULL) ? "yes" : "no");
+	fprintf(stderr, "%10s %4s %3s %8s %10s %12s %12s %8s %8s\n", "rsuID", "ch", "if", "windows", "reports", "cnt", "expected", "PAR(%)", "PER(%)");
+	for(int h = 0; h < FLEET_OBU_HASH; h++)
+	{
+		for(const struct fleetRsu_t *r = g_rsu[h]; r != NULL; r = r->next)
+		{
+			fprintf(stderr, "%10d %4u %3u %8llu %10llu %12llu %12llu %8.2f %8.2f\n", r->rsuID, r->channel, r->ifIdx,
+					(unsigned long long)r->windows, (unsigned long long)r->reports,
+					(unsigned long long)r->cnt, (unsigned long long)r->expected,
+					(r->expected != 0) ? (double)r->cnt * 100.0 / r->expected : 0.0,
+					(r->seqRcv + r->seqLost != 0) ? (double)r->seqLost * 100.0 / (r->seqRcv + r->seqLost) : 0.0);
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static uint8_t buf[FLEET_BATCH][PAR_FLEET_DGRAM_MAX];
+	struct mmsghdr msg[FLEET_BATCH];
+	struct iovec iov[FLEET_BATCH];
+	struct pollfd pfd[2];
+	int nfd = 0;
+	int opt, port = -1;
+	const char *path = NULL, *outFile = NULL;
+	uint64_t period = 0, lastRecv, lastSummary, now;
+
+	while((opt = getopt(argc, argv, "u:U:l:o:p:h")) != -1)
+	{
+		switch(opt)
+		{
+			case 'u' :
+				port = atoi(optarg);
+				break;
+			case 'U' :
+				path = optarg;
+				break;
+			case 'l' :
+				g_lateness = strtoull(optarg, NULL, 10);
+				break;
+			case 'o' :
+				outFile = optarg;
+				break;
+			case 'p' :
+				period = strtoull(optarg, NULL, 10) * 1000000ULL;
+				break;
+			case 'h' :
+			default :
+				usage(argv[0]);
+				return (opt == 'h') ? 0 : -1;
+		}
+	}
+	if(port < 0 && path == NULL)
+	{
+		usage(argv[0]);
+		return -1;
+	}
+
+	g_out = stdout;
+	if(outFile != NULL)
+	{
+		g_out = fopen(outFile, "w");
+		if(g_out == NULL)
+		{
+			fprintf(stderr, "fopen(%s) : %s\n", outFile, strerror(errno));
+			return -1;
+		}
+	}
+	if(port >= 0)
+	{
+		pfd[nfd].fd = openUdp(port);
+		pfd[nfd++].events = POLLIN;
+	}
+	if(path != NULL)
+	{
+		pfd[nfd].fd = openUnix(path);
+		pfd[nfd++].events = POLLIN;
+	}
+	for(int i = 0; i < nfd; i++)
+	{
+		if(pfd[i].fd < 0)
+			return -1;
+	}
+
+	signal(SIGINT, sigHandler);
+	signal(SIGTERM, sigHandler);
+	signal(SIGUSR1, sigHandler);
+
+	for(int i = 0; i < FLEET_BATCH; i++)
+	{
+		iov[i].iov_base = buf[i];
+		iov[i].iov_len = sizeof(buf[i]);
+		memset(&msg[i], 0, sizeof(msg[i]));
+		msg[i].msg_hdr.msg_iov = &iov[i];
+		msg[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	lastRecv = lastSummary = monoUsec();
+	while(!g_stop)
+	{
+		int ret = poll(pfd, nfd, FLEET_POLL_MSEC);
+
+		if(ret < 0 && errno != EINTR)
+		{
+			perror("poll");
+			break;
+		}
+		now = monoUsec();
+		for(int i = 0; i < nfd && ret > 0; i++)
+		{
+			if(!(pfd[i].revents & POLLIN))
+				continue;
+			/* 쌓인 데이터그램을 묶음으로 모두 읽는다 */
+			for(;;)
+			{
+				int n = recvmmsg(pfd[i].fd, msg, FLEET_BATCH, MSG_DONTWAIT, NULL);
+
+				if(n <= 0)
+					break;
+				for(int j = 0; j < n; j++)
+					processDgram(buf[j], msg[j].msg_len);
+				lastRecv = now;
+				if(n < FLEET_BATCH)
+					break;
+			}
+		}
+
+		/* 허용 지연 동안 보고가 없으면 열린 구간을 모두 확정 */
+		if(g_win != NULL && now - lastRecv >= g_lateness)
+			advance(g_maxEnd);
+
+		if(period != 0 && now - lastSummary >= period)
+		{
+			printSummary();
+			lastSummary = now;
+		}
+	}
+
+	advance(g_maxEnd);
+	printSummary();
+	if(path != NULL)
+		unlink(path);
+	if(g_out != stdout)
+		fclose(g_out);
+	return 0;
+}
@@ -0,0 +1,371 @@
+/**********************************************************
+  [parfleet_sim]
+  PAR 차량군 보고 모의 송신 도구
+
+  여러 대의 차량(OBU)이 PAR -F 옵션으로 보고하는 것을 한 프로세스에서 흉내 내어
+  집계 도구(parfleet)에 보낸다. 집계 결과를 확인할 수 있도록 보낸 합계를 표준에러로 출력한다.
+
+  - RSU는 직선 도로 위에 일정 간격으로 놓이고, 차량은 도로를 따라 일정 속도로 움직인다.
+    RSU 통신 반경 안에 있는 RSU만 보고하며, 수신율은 거리에 따라 떨어진다.
+  - 보고 구간은 실제 PAR처럼 보고주기 경계에 정렬한다.
+  - -D 확률로 보고를 1 ~ -k 구간 늦게 보내어 지연/늦은 도착을 흉내 낸다.
+  - -m 으로 차량 당 무선 수를 주면 같은 RSU를 인터페이스 별 링크로 따로 보고한다. (채널 SIM_CHANNEL)
+  - 목적지 문법은 PAR -F 옵션과 같다. (host:port 또는 /path, obuID는 차량 번호로 정한다)
+
+  사용 예
+    parfleet_sim -n 300 -r 40 -d 600 -s 0 127.0.0.1:47000
+    parfleet_sim -n 500 -D 5 -k 4 /tmp/parfleet.sock
+ ************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <getopt.h>
+#include <errno.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <PAR_FLEET.h>
+
+#define SIM_RSU_GAP 500.0 //RSU 간격 (m)
+#define SIM_RSU_RANGE 600.0 //RSU 통신 반경 (m)
+#define SIM_CYCLE_MSEC 100 //RSU 송신 주기 (ms)
+#define SIM_LAT0 374000000 //도로 시작 위도 (1e-7도)
+#define SIM_LON0 1270000000 //도로 시작 경도 (1e-7도)
+#define SIM_M_TO_E7 90.0 //1m 당 위도 (1e-7도, 근사)
+#define SIM_DELAY_MAX 64 //최대 지연 구간 수
+#define SIM_CHANNEL 172 //수신 채널번호
+#define SIM_RADIO_MAX 4 //차량 당 최대 무선 수
+#define SIM_RADIO_LOSS 3.0 //무선(인터페이스) 번호 당 추가 RXPOWER 감쇠 (dB)
+
+/* 지연되어 나중에 보낼 데이터그램 */
+struct simPending_t{
+	uint64_t due; //보낼 구간 번호
+	size_t len;
+	uint8_t buf[PAR_FLEET_DGRAM_MAX];
+	struct simPending_t *next;
+};
+
+/* 차량 */
+struct simObu_t{
+	uint32_t obuID;
+	uint32_t seq;
+	double pos; //도로 위 위치 (m)
+	double speed; //m/s
+};
+
+static int g_fd;
+static struct sockaddr_storage g_addr;
+static socklen_t g_addrLen;
+static struct simPending_t *g_pending;
+
+/* 보낸 합계 */
+static uint64_t g_dgrams, g_entries, g_cnt, g_expected, g_delayed, g_sendFail;
+
+
+static void usage(char *cmd)
+{
+	printf("Usage: %s [OPTIONS] <host:port | /path>\n\n", cmd);
+	printf("  -n <num>        number of vehicles (default 100)\n");
+	printf("  -r <num>        number of RSUs along the road (default 20)\n");
+	printf("  -d <sec>        simulated duration (default 60)\n");
+	printf("  -i <usec>       report interval (default 1000000)\n");
+	printf("  -s <speed>      send speed, 1 real time, N times, 0 unthrottled (default 1)\n");
+	printf("  -D <percent>    probability a report is delayed (default 0)\n");
+	printf("  -k <windows>    maximum delay in report intervals (default 2)\n");
+	printf("  -m <radios>     radios (interfaces) per vehicle, each reported as its own link (default 1)\n");
+	printf("  -b <obuID>      first vehicle obuID (default 1)\n");
+	printf("  -S <seed>       random seed (default 1)\n");
+	printf("  -h              print usage\n");
+}
+
+/**
+ * openDest()
+ * 목적지 문자열로 송신 소켓을 만든다.
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int openDest(const char *dest)
+{
+	char str[256];
+	char *port;
+
+	strncpy(str, dest, sizeof(str) - 1);
+	str[sizeof(str) - 1] = '\0';
+	if(str[0] == '/')
+	{
+		struct sockaddr_un *un = (struct sockaddr_un*)&g_addr;
+
+		if(strlen(str) >= sizeof(un->sun_path))
+			return -1;
+		un->sun_family = AF_UNIX;
+		strcpy(un->sun_path, str);
+		g_addrLen = sizeof(struct sockaddr_un);
+	}
+	else
+	{
+		struct addrinfo hints, *res;
+		int ret;
+
+		port = strrchr(str, ':');
+		if(port == NULL)
+			return -1;
+		*port++ = '\0';
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_DGRAM;
+		ret = getaddrinfo(str, port, &hints, &res);
+		if(ret != 0)
+		{
+			fprintf(stderr, "getaddrinfo(%s:%s) : %s\n", str, port, gai_strerror(ret));
+			return -1;
+		}
+		memcpy(&g_addr, res->ai_addr, res->ai_addrlen);
+		g_addrLen = res->ai_addrlen;
+		freeaddrinfo(res);
+	}
+	/* 모의 송신은 블로킹으로 보낸다 (UNIX 소켓은 유실 없음) */
+	g_fd = socket(g_addr.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if(g_fd < 0)
+	{
+		perror("socket");
+		return -1;
+	}
+	return 0;
+}
+
+static void sendDgram(const uint8_t *buf, size_t len)
+{
+	if(sendto(g_fd, buf, len, 0, (struct sockaddr*)&g_addr, g_addrLen) < 0)
+		g_sendFail++;
+	else
+		g_dgrams++;
+}
+
+/**
+ * queueDgram()
+ * 데이터그램을 바로 보내거나, 지연 확률에 따라 나중에 보낼 목록에 넣는다.
+ */
+static void queueDgram(const uint8_t *buf, size_t len, uint64_t win, int delayPct, int delayMax)
+{
+	struct simPending_t *p;
+
+	if(delayPct <= 0 || rand() % 100 >= delayPct)
+	{
+		sendDgram(buf, len);
+		return;
+	}
+	p = (struct simPending_t*)malloc(sizeof(struct simPending_t));
+	if(p == NULL)
+	{
+		sendDgram(buf, len);
+		return;
+	}
+	p->due = win + 1 + rand() % delayMax;
+	p->len = len;
+	memcpy(p->buf, buf, len);
+	p->next = g_pending;
+	g_pending = p;
+	g_delayed++;
+}
+
+/**
+ * flushPending()
+ * 보낼 때가 된 지연 데이터그램을 보낸다. (all이면 모두)
+ */
+static void flushPending(uint64_t win, bool all)
+{
+	struct simPending_t **pp = &g_pending, *p;
+
+	while(*pp != NULL)
+	{
+		p = *pp;
+		if(all || p->due <= win)
+		{
+			*pp = p->next;
+			sendDgram(p->buf, p->len);
+			free(p);
+		}
+		else
+			pp = &p->next;
+	}
+}
+
+/**
+ * simVehicle()
+ * 차량 하나의 보고 구간 데이터그램을 만든다.
+ */
+static void simVehicle(struct simObu_t *o, int rsuNum, int radios, uint64_t win, uint64_t interval, int delayPct, int delayMax)
+{
+	uint8_t buf[PAR_FLEET_DGRAM_MAX];
+	struct parFleetHdr_t *hdr = (struct parFleetHdr_t*)buf;
+	struct parFleetEntry_t *entry = (struct parFleetEntry_t*)(buf + sizeof(struct parFleetHdr_t));
+	uint32_t expected = interval / (SIM_CYCLE_MSEC * 1000);
+
+	hdr->magic = PAR_FLEET_MAGIC;
+	hdr->version = PAR_FLEET_VERSION;
+	hdr->num = 0;
+	hdr->obuID = o->obuID;
+	hdr->start = win * interval;
+	hdr->end = hdr->start + interval;
+
+	for(int l = 0; l < rsuNum * radios; l++)
+	{
+		int r = l / radios;
+		double dist = fabs(o->pos - r * SIM_RSU_GAP);
+		struct parFleetEntry_t *e;
+		double p;
+		uint32_t cnt = 0;
+
+		if(dist > SIM_RSU_RANGE)
+			continue;
+		/* 거리에 따른 수신 확률 (가까우면 약 99%, 반경 끝에서 약 50%) */
+		p = 0.99 - 0.49 * (dist / SIM_RSU_RANGE) * (dist / SIM_RSU_RANGE);
+		for(uint32_t k = 0; k < expected; k++)
+		{
+			if(rand() < p * RAND_MAX)
+				cnt++;
+		}
+		if(cnt == 0)
+			continue;
+
+		e = &entry[hdr->num];
+		memset(e, 0, sizeof(*e));
+		e->rsuID = 1000 + r;
+		e->channel = SIM_CHANNEL;
+		e->ifIdx = l % radios;
+		e->rsuLatitude = SIM_LAT0 + (int32_t)(r * SIM_RSU_GAP * SIM_M_TO_E7);
+		e->rsuLongitude = SIM_LON0;
+		e->obuLatitude = SIM_LAT0 + (int32_t)(o->pos * SIM_M_TO_E7);
+		e->obuLongitude = SIM_LON0;
+		e->distance = dist;
+		e->cnt = cnt;
+		e->expected = expected;
+		e->seqRcv = cnt;
+		e->seqLost = expected - cnt;
+		e->rxpowerAvg = -40.0 - 45.0 * dist / SIM_RSU_RANGE - SIM_RADIO_LOSS * e->ifIdx;
+		e->rxpowerMin = e->rxpowerAvg - 5.0;
+		e->rxpowerMax = e->rxpowerAvg + 5.0;
+		e->rcpiAvg = (e->rxpowerAvg + 110.0) * 2.0;
+		e->latCnt = cnt;
+		e->latAvg = 800.0 + rand() % 400;
+		g_entries++;
+		g_cnt += cnt;
+		g_expected += expected;
+
+		if(++hdr->num == PAR_FLEET_ENTRY_MAX)
+		{
+			hdr->seq = o->seq++;
+			queueDgram(buf, PAR_FLEET_DGRAM_MAX, win, delayPct, delayMax);
+			hdr->num = 0;
+		}
+	}
+	if(hdr->num != 0)
+	{
+		hdr->seq = o->seq++;
+		queueDgram(buf, sizeof(struct parFleetHdr_t) + hdr->num * sizeof(struct parFleetEntry_t), win, delayPct, delayMax);
+	}
+
+	/* 도로 끝에 닿으면 처음으로 되돌아간다 */
+	o->pos += o->speed * interval / 1000000.0;
+	if(o->pos > rsuNum * SIM_RSU_GAP)
+		o->pos -= rsuNum * SIM_RSU_GAP;
+}
+
+int main(int argc, char *argv[])
+{
+	struct simObu_t *obu;
+	struct timespec ts, t0, t1;
+	int opt, obuNum = 100, rsuNum = 20, radios = 1, delayPct = 0, delayMax = 2;
+	uint64_t duration = 60, interval = 1000000, firstWin, winNum;
+	uint32_t obuBase = 1;
+	unsigned int seed = 1;
+	double speed = 1.0, elapsed;
+
+	while((opt = getopt(argc, argv, "n:r:d:i:s:D:k:m:b:S:h")) != -1)
+	{
+		switch(opt)
+		{
+			case 'n' : obuNum = atoi(optarg); break;
+			case 'r' : rsuNum = atoi(optarg); break;
+			case 'd' : duration = strtoull(optarg, NULL, 10); break;
+			case 'i' : interval = strtoull(optarg, NULL, 10); break;
+			case 's' : speed = atof(optarg); break;
+			case 'D' : delayPct = atoi(optarg); break;
+			case 'k' : delayMax = atoi(optarg); break;
+			case 'm' : radios = atoi(optarg); break;
+			case 'b' : obuBase = strtoul(optarg, NULL, 10); break;
+			case 'S' : seed = strtoul(optarg, NULL, 10); break;
+			case 'h' :
+			default :
+				usage(argv[0]);
+				return (opt == 'h') ? 0 : -1;
+		}
+	}
+	if(optind >= argc || obuNum <= 0 || rsuNum <= 0 || interval < SIM_CYCLE_MSEC * 1000 ||
+			delayMax <= 0 || delayMax > SIM_DELAY_MAX || radios <= 0 || radios > SIM_RADIO_MAX || speed < 0.0)
+	{
+		usage(argv[0]);
+		return -1;
+	}
+	if(openDest(argv[optind]) < 0)
+	{
+		fprintf(stderr, "Invalid destination - %s\n", argv[optind]);
+		return -1;
+	}
+
+	srand(seed);
+	obu = (struct simObu_t*)calloc(obuNum, sizeof(struct simObu_t));
+	if(obu == NULL)
+		return -1;
+	for(int i = 0; i < obuNum; i++)
+	{
+		obu[i].obuID = obuBase + i;
+		obu[i].pos = (double)rand() / RAND_MAX * rsuNum * SIM_RSU_GAP;
+		obu[i].speed = 10.0 + (double)rand() / RAND_MAX * 20.0;
+	}
+
+	/* 현재 시각이 속한 보고 구간부터 시작 */
+	clock_gettime(CLOCK_REALTIME, &ts);
+	firstWin = ((uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000) / interval;
+	winNum = duration * 1000000ULL / interval;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(uint64_t w = 0; w < winNum; w++)
+	{
+		/* 배속에 맞춰 구간 끝까지 기다린다 */
+		if(speed > 0.0)
+		{
+			uint64_t due = (uint64_t)((w + 1) * interval / speed);
+
+			ts.tv_sec = t0.tv_sec + due / 1000000;
+			ts.tv_nsec = t0.tv_nsec + (due % 1000000) * 1000;
+			if(ts.tv_nsec >= 1000000000)
+			{
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000;
+			}
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+		}
+		flushPending(firstWin + w, false);
+		for(int i = 0; i < obuNum; i++)
+			simVehicle(&obu[i], rsuNum, radios, firstWin + w, interval, delayPct, delayMax);
+	}
+	flushPending(0, true);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+	fprintf(stderr, "[parfleet_sim] vehicles %d, RSUs %d, windows %llu, dgrams %llu (fail %llu, delayed %llu), "
+			"entries %llu, cnt %llu, expected %llu, %.2f sec\n",
+			obuNum, rsuNum, (unsigned long long)winNum, (unsigned long long)g_dgrams,
+			(unsigned long long)g_sendFail, (unsigned long long)g_delayed,
+			(unsigned long long)g_entries, (unsigned long long)g_cnt, (unsigned long long)g_expected, elapsed);
+	free(obu);
+	close(g_fd);
+	return 0;
+}
@@ -0,0 +1,442 @@
+/**********************************************************
+  [parlog]
+  PAR 바이너리 측정 로그(PAR_LOG.h) 변환/조회 도구
+
+  - CSV(표준출력) 또는 컬럼 별 바이너리 파일(<dir>/<컬럼>.col + schema.csv)로 변환한다.
+  - 시간 범위(-f/-t)가 주어지면 파일 헤더의 시작/끝 시각으로 파일을 거르고,
+    시간 인덱스를 이진 탐색하여 해당 레코드 묶음만 읽는다. (파일 전체를 읽지 않는다)
+
+  사용 예
+    parlog -i PAR_20200622-101500_0.bin
+    parlog -f 20200622-101600 -t 20200622-101700 -r 3 /log/PAR_*.bin > out.csv
+    parlog -o cols /log/PAR_*.bin
+ ************************************************************/
+
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <getopt.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <PAR_LOG.h>
+
+/****************************************************************************************
+  컬럼 정의
+ ****************************************************************************************/
+typedef enum
+{
+	colU64,
+	colI32,
+	colU32,
+	colF32,
+	colU8,
+} colType_e;
+
+struct parlogCol_t{
+	const char *name;
+	colType_e type;
+	size_t offset;
+};
+
+#define COL(name, type, field) { name, type, offsetof(struct parLogRec_t, field) }
+#define CALC(name, i) { name, colF32, offsetof(struct parLogRec_t, calc) + sizeof(float) * (i) }
+
+static const struct parlogCol_t g_cols[] = {
+	COL("time", colU64, time),
+	COL("timeEnd", colU64, timeEnd),
+	COL("rsuID", colI32, rsuID),
+	COL("channel", colU8, channel),
+	COL("ifIdx", colU8, ifIdx),
+	COL("rsuLatitude", colI32, rsuLatitude),
+	COL("rsuLongitude", colI32, rsuLongitude),
+	COL("obuLatitude", colI32, obuLatitude),
+	COL("obuLongitude", colI32, obuLongitude),
+	COL("distance", colF32, distance),
+	COL("obuSpeed", colF32, obuSpeed),
+	COL("obuHeading", colF32, obuHeading),
+	COL("cnt", colU32, cnt),
+	COL("par", colU32, par),
+	CALC("min_rxpower", 0), CALC("max_rxpower", 1), CALC("avr_rxpower", 2), CALC("last_rxpower", 3),
+	CALC("min_rcpi", 4), CALC("max_rcpi", 5), CALC("avr_rcpi", 6), CALC("last_rcpi", 7),
+	CALC("std_rxpower", 8), CALC("p50_rxpower", 9), CALC("p90_rxpower", 10), CALC("p99_rxpower", 11),
+	CALC("std_rcpi", 12), CALC("p50_rcpi", 13), CALC("p90_rcpi", 14), CALC("p99_rcpi", 15),
+	CALC("min_latency", 16), CALC("max_latency", 17), CALC("avr_latency", 18), CALC("last_latency", 19),
+	CALC("std_latency", 20), CALC("p50_latency", 21), CALC("p90_latency", 22), CALC("p99_latency", 23),
+	CALC("jitter", 24),
+	COL("seqRcv", colU32, seqRcv),
+	COL("seqLost", colU32, seqLost),
+	COL("seqReorder", colU32, seqReorder),
+	COL("seqDup", colU32, seqDup),
+	COL("seqBurst", colU32, seqBurst),
+	COL("lossRate", colF32, lossRate),
+	COL("geP", colF32, geP),
+	COL("geR", colF32, geR),
+	COL("burstLen", colF32, burstLen),
+};
+#define COL_NUM (sizeof(g_cols) / sizeof(g_cols[0]))
+
+static const char *g_typeName[] = { "uint64", "int32", "uint32", "float32", "uint8" };
+static const size_t g_typeSize[] = { 8, 4, 4, 4, 1 };
+
+/****************************************************************************************
+  전역변수
+ ****************************************************************************************/
+static uint64_t g_from = 0; //조회 시작시각 (usec)
+static uint64_t g_to = UINT64_MAX; //조회 끝시각 (usec)
+static bool g_rsuFilter = false;
+static int32_t g_rsuID;
+static bool g_info = false;
+static const char *g_colDir = NULL; //컬럼 출력 디렉터리
+static FILE *g_colFp[COL_NUM];
+static uint64_t g_outNum; //출력한 레코드 수
+static bool g_csvHeader = false;
+
+
+static void usage(char *cmd)
+{
+	printf("Usage: %s [OPTIONS] FILE...\n\n", cmd);
+	printf("  -f <time>       from time (unix seconds or YYYYmmdd-HHMMSS local time)\n");
+	printf("  -t <time>       to time (inclusive)\n");
+	printf("  -r <RSUID>      only this RSU\n");
+	printf("  -o <dir>        write columnar output (<dir>/<column>.col, <dir>/schema.csv) instead of CSV\n");
+	printf("  -i              print file header and time index only\n");
+	printf("  -h              print usage\n");
+}
+
+/**
+ * parseTime()
+ * 시각 문자열을 usec으로 변환한다.
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int parseTime(const char *str, uint64_t *usec)
+{
+	struct tm tm;
+	char *end;
+	double sec;
+
+	memset(&tm, 0, sizeof(tm));
+	end = strptime(str, "%Y%m%d-%H%M%S", &tm);
+	if(end != NULL && *end == '\0')
+	{
+		tm.tm_isdst = -1;
+		*usec = (uint64_t)mktime(&tm) * 1000000ULL;
+		return 0;
+	}
+	sec = strtod(str, &end);
+	if(end == str || *end != '\0' || sec < 0)
+		return -1;
+	*usec = (uint64_t)(sec * 1000000.0);
+	return 0;
+}
+
+/**
+ * printValue()
+ * 레코드의 컬럼값을 CSV로 출력한다.
+ */
+static void printValue(const struct parLogRec_t *rec, const struct parlogCol_t *col)
+{
+	const uint8_t *p = (const uint8_t*)rec + col->offset;
+	uint64_t u64;
+	int32_t i32;
+	uint32_t u32;
+	float f32;
+
+	switch(col->type)
+	{
+		case colU64 :
+			memcpy(&u64, p, sizeof(u64));
+			printf("%llu", (unsigned long long)u64);
+			break;
+		case colI32 :
+			memcpy(&i32, p, sizeof(i32));
+			printf("%d", i32);
+			break;
+		case colU32 :
+			memcpy(&u32, p, sizeof(u32));
+			printf("%u", u32);
+			break;
+		case colF32 :
+			memcpy(&f32, p, sizeof(f32));
+			printf("%g", f32);
+			break;
+		case colU8 :
+			printf("%u", *p);
+			break;
+	}
+}
+
+/**
+ * openColumns()
+ * 컬럼 출력 파일들과 스키마 파일을 생성한다.
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int openColumns(void)
+{
+	char path[512];
+
+	if(mkdir(g_colDir, 0755) < 0 && errno != EEXIST)
+	{
+		fprintf(stderr, "Fail to create %s : %s\n", g_colDir, strerror(errno));
+		return -1;
+	}
+	for(size_t i = 0; i < COL_NUM; i++)
+	{
+		snprintf(path, sizeof(path), "%s/%s.col", g_colDir, g_cols[i].name);
+		g_colFp[i] = fopen(path, "wb");
+		if(g_colFp[i] == NULL)
+		{
+			fprintf(stderr, "Fail to open %s : %s\n", path, strerror(errno));
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * closeColumns()
+ * 컬럼 출력 파일들을 닫고 스키마(컬럼명, 형식, 레코드 수)를 기록한다.
+ */
+static void closeColumns(void)
+{
+	char path[512];
+	FILE *fp;
+
+	for(size_t i = 0; i < COL_NUM; i++)
+	{
+		if(g_colFp[i] != NULL)
+			fclose(g_colFp[i]);
+	}
+	snprintf(path, sizeof(path), "%s/schema.csv", g_colDir);
+	fp = fopen(path, "w");
+	if(fp == NULL)
+	{
+		fprintf(stderr, "Fail to open %s : %s\n", path, strerror(errno));
+		return;
+	}
+	fprintf(fp, "column,type,rows\n");
+	for(size_t i = 0; i < COL_NUM; i++)
+		fprintf(fp, "%s,%s,%llu\n", g_cols[i].name, g_typeName[g_cols[i].type], (unsigned long long)g_outNum);
+	fclose(fp);
+}
+
+/**
+ * outputRecords()
+ * 조건에 맞는 레코드를 출력한다.
+ */
+static void outputRecords(const struct parLogRec_t *rec, uint32_t num)
+{
+	for(uint32_t i = 0; i < num; i++)
+	{
+		if(rec[i].time < g_from || rec[i].time > g_to)
+			continue;
+		if(g_rsuFilter && rec[i].rsuID != g_rsuID)
+			continue;
+
+		if(g_colDir != NULL)
+		{
+			for(size_t c = 0; c < COL_NUM; c++)
+				fwrite((const uint8_t*)&rec[i] + g_cols[c].offset, g_typeSize[g_cols[c].type], 1, g_colFp[c]);
+		}
+		else
+		{
+			if(!g_csvHeader)
+			{
+				for(size_t c = 0; c < COL_NUM; c++)
+					printf("%s%s", c ? "," : "", g_cols[c].name);
+				printf("\n");
+				g_csvHeader = true;
+			}
+			for(size_t c = 0; c < COL_NUM; c++)
+			{
+				if(c)
+					printf(",");
+				printValue(&rec[i], &g_cols[c]);
+			}
+			printf("\n");
+		}
+		g_outNum++;
+	}
+}
+
+/**
+ * processFile()
+ * 로그 파일 하나를 처리한다.
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int processFile(const char *path)
+{
+	int fd;
+	struct stat st;
+	struct parLogHdr_t *hdr;
+	struct parLogRec_t *rec = NULL;
+	uint32_t recNum, lo, hi, mid;
+	int ret = -1;
+
+	fd = open(path, O_RDONLY);
+	if(fd < 0)
+	{
+		fprintf(stderr, "Fail to open %s : %s\n", path, strerror(errno));
+		return -1;
+	}
+	hdr = (struct parLogHdr_t*)malloc(sizeof(struct parLogHdr_t));
+	if(hdr == NULL)
+		goto out;
+
+	/* 헤더 고정부 확인 */
+	if(pread(fd, hdr, offsetof(struct parLogHdr_t, idx), 0) != (ssize_t)offsetof(struct parLogHdr_t, idx) ||
+			memcmp(hdr->magic, PAR_LOG_MAGIC, sizeof(hdr->magic)) != 0)
+	{
+		fprintf(stderr, "%s : not a PAR log file\n", path);
+		goto out;
+	}
+	if(hdr->version != PAR_LOG_VERSION || hdr->recSize != sizeof(struct parLogRec_t) ||
+			hdr->indexMax != PAR_LOG_INDEX_MAX || hdr->indexNum > PAR_LOG_INDEX_MAX)
+	{
+		fprintf(stderr, "%s : unsupported version %u (record %u bytes)\n", path, hdr->version, hdr->recSize);
+		goto out;
+	}
+
+	/* 비정상 종료로 헤더보다 레코드가 적게 기록된 경우 */
+	fstat(fd, &st);
+	recNum = hdr->recNum;
+	if((uint64_t)st.st_size < sizeof(struct parLogHdr_t) + (uint64_t)recNum * hdr->recSize)
+		recNum = (st.st_size < (off_t)sizeof(struct parLogHdr_t)) ? 0 :
+			(uint32_t)((st.st_size - sizeof(struct parLogHdr_t)) / hdr->recSize);
+
+	if(g_info)
+		printf("%s : records %u (valid %u), index %u, start %llu, end %llu\n", path, hdr->recNum, recNum,
+				hdr->indexNum, (unsigned long long)hdr->startTime, (unsigned long long)hdr->endTime);
+
+	/* 시간 범위가 겹치지 않는 파일은 인덱스도 읽지 않는다. */
+	if(recNum == 0 || hdr->endTime < g_from || hdr->startTime > g_to)
+	{
+		ret = 0;
+		goto out;
+	}
+
+	if(pread(fd, hdr->idx, sizeof(struct parLogIdx_t) * hdr->indexNum, offsetof(struct parLogHdr_t, idx)) !=
+			(ssize_t)(sizeof(struct parLogIdx_t) * hdr->indexNum))
+	{
+		fprintf(stderr, "%s : fail to read index\n", path);
+		goto out;
+	}
+
+	if(g_info)
+	{
+		for(uint32_t i = 0; i < hdr->indexNum; i++)
+		{
+			if(hdr->idx[i].time >= g_from && hdr->idx[i].time <= g_to)
+				printf("  [%u] time %llu, first %u, num %u\n", i, (unsigned long long)hdr->idx[i].time, hdr->idx[i].first, hdr->idx[i].num);
+		}
+		ret = 0;
+		goto out;
+	}
+
+	/* 시작시각 이상인 첫 인덱스 이진 탐색 */
+	lo = 0;
+	hi = hdr->indexNum;
+	while(lo < hi)
+	{
+		mid = lo + (hi - lo) / 2;
+		if(hdr->idx[mid].time < g_from)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for(uint32_t i = lo; i < hdr->indexNum && hdr->idx[i].time <= g_to; i++)
+	{
+		uint32_t first = hdr->idx[i].first;
+		uint32_t num = hdr->idx[i].num;
+
+		if(first >= recNum)
+			break;
+		if(first + num > recNum)
+			num = recNum - first;
+		rec = realloc(rec, sizeof(struct parLogRec_t) * num);
+		if(rec == NULL)
+			goto out;
+		if(pread(fd, rec, sizeof(struct parLogRec_t) * num, sizeof(struct parLogHdr_t) + (off_t)first * sizeof(struct parLogRec_t)) !=
+				(ssize_t)(sizeof(struct parLogRec_t) * num))
+		{
+			fprintf(stderr, "%s : fail to read records\n", path);
+			goto out;
+		}
+		outputRecords(rec, num);
+	}
+	ret = 0;
+
+out:
+	free(rec);
+	free(hdr);
+	close(fd);
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	int ret = 0;
+
+	while((opt = getopt(argc, argv, "f:t:r:o:ih")) != -1)
+	{
+		switch(opt)
+		{
+			case 'f' :
+				if(parseTime(optarg, &g_from) < 0)
+				{
+					fprintf(stderr, "Invalid time - %s\n", optarg);
+					return -1;
+				}
+				break;
+			case 't' :
+				if(parseTime(optarg, &g_to) < 0)
+				{
+					fprintf(stderr, "Invalid time - %s\n", optarg);
+					return -1;
+				}
+				break;
+			case 'r' :
+				g_rsuFilter = true;
+				g_rsuID = (int32_t)strtol(optarg, NULL, 10);
+				break;
+			case 'o' :
+				g_colDir = optarg;
+				break;
+			case 'i' :
+				g_info = true;
+				break;
+			case 'h' :
+			default :
+				usage(argv[0]);
+				return (opt == 'h') ? 0 : -1;
+		}
+	}
+	if(optind >= argc)
+	{
+		usage(argv[0]);
+		return -1;
+	}
+
+	if(g_colDir != NULL && !g_info && openColumns() < 0)
+		return -1;
+
+	for(int i = optind; i < argc; i++)
+	{
+		if(processFile(argv[i]) < 0)
+			ret = -1;
+	}
+
+	if(g_colDir != NULL && !g_info)
+		closeColumns();
+	if(!g_info)
+		fprintf(stderr, "%llu records\n", (unsigned long long)g_outNum);
+	return ret;
+}
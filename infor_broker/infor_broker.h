@@ -6,6 +6,8 @@
 #include <syslog.h>
 #include <unistd.h>
 #include <stdbool.h>
+#include "v2xlog.h"
+#include "v2xstat.h"
 
 #define ADDRSIZE 20
 
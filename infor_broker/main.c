@@ -30,6 +30,12 @@ int main(int argc, char *argv[])
     else if(result == 2)
         return 0;
 
+    /* 바이너리 로그 초기화 - 디버그 모드면 LOG_DEBUG까지 기록한다. (실패 시 V2XLOG는 syslog로 기록) */
+    v2xlog_Init("infor_broker", NULL, g_mib.dbg ? LOG_DEBUG : LOG_INFO);
+
+    /* 공유메모리 통계 초기화 (v2xtop으로 조회) */
+    v2xstat_Init("infor_broker");
+
     /* 프로그램 종료 위한 시그널 등록 Ctrl+C  */
     signal(SIGINT, sigint_handler);
     signal(SIGPIPE, SIG_IGN);
@@ -49,6 +55,10 @@ int main(int argc, char *argv[])
     /* 쓰레드 닫기 */
     closeSocketThread();
 
+    /* 통계, 바이너리 로그 닫기 */
+    v2xstat_Close();
+    v2xlog_Close();
+
     return 0;
 }
 
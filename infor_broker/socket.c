@@ -18,15 +18,24 @@ int adas_sock = -1;
 bool connectFlag = false;
 struct sockaddr_in server_addr, cnvc_addr, adas_addr, client_addr;
 unsigned int client_addr_size = sizeof(client_addr);
+
+/* 공유메모리 통계 (v2xtop) */
+static struct {
+    const struct v2xstatDesc_t *rx;         ///< 수신 패킷
+    const struct v2xstatDesc_t *rxBytes;    ///< 수신 바이트
+    const struct v2xstatDesc_t *txCnvc;     ///< CARNAVICOM 관제센터 전달
+    const struct v2xstatDesc_t *txAdas;     ///< ADAS ONE 관제센터 전달
+    const struct v2xstatDesc_t *txFail;     ///< 전달 실패
+} sockStat;
 pthread_t sock_thread;
 
 static void printPkt(v2icPkt_t *pkt)
 {
-    syslog(LOG_INFO | LOG_LOCAL0, "##### [infor_broker] PKT #####\n");
-    syslog(LOG_INFO | LOG_LOCAL0, "version             : %u\n", pkt->version);
-    syslog(LOG_INFO | LOG_LOCAL0, "deviceType          : %u\n", pkt->deviceType);
-    syslog(LOG_INFO | LOG_LOCAL0, "deviceID            : %u\n", pkt->deviceID);
-    syslog(LOG_INFO | LOG_LOCAL0, "size                : %u\n", pkt->size);
+    V2XLOG(LOG_DEBUG | LOG_LOCAL0, "##### [infor_broker] PKT #####\n");
+    V2XLOG(LOG_DEBUG | LOG_LOCAL0, "version             : %u\n", pkt->version);
+    V2XLOG(LOG_DEBUG | LOG_LOCAL0, "deviceType          : %u\n", pkt->deviceType);
+    V2XLOG(LOG_DEBUG | LOG_LOCAL0, "deviceID            : %u\n", pkt->deviceID);
+    V2XLOG(LOG_DEBUG | LOG_LOCAL0, "size                : %u\n", pkt->size);
 
     if(pkt->size <= 0)
         return;
@@ -39,20 +48,20 @@ static void printPkt(v2icPkt_t *pkt)
                 memset(&gpsData, 0, sizeof(gpsPkt_t));
                 memcpy(&gpsData, pkt->data, sizeof(gpsPkt_t));
 
-                syslog(LOG_INFO | LOG_LOCAL0, "type                : Calibration Coordinate of GPS\n\n");
-                syslog(LOG_INFO | LOG_LOCAL0, "utcTime_sec         : %u\n", gpsData.utcTime_sec);
-                syslog(LOG_INFO | LOG_LOCAL0, "utcTime_usec        : %u\n", gpsData.utcTime_usec);
-                syslog(LOG_INFO | LOG_LOCAL0, "fixType             : %u\n", gpsData.fixType);
-                syslog(LOG_INFO | LOG_LOCAL0, "diffSlon            : %u\n", gpsData.diffSoln);
-                syslog(LOG_INFO | LOG_LOCAL0, "carSoln             : %u\n", gpsData.carSoln);
-                syslog(LOG_INFO | LOG_LOCAL0, "latitude            : %d\n", gpsData.lati);
-                syslog(LOG_INFO | LOG_LOCAL0, "longitude           : %d\n", gpsData.longi);
-                syslog(LOG_INFO | LOG_LOCAL0, "elevation           : %d\n", gpsData.elev);
-                syslog(LOG_INFO | LOG_LOCAL0, "nedNorSpd           : %d\n", gpsData.nedNorSpd);
-                syslog(LOG_INFO | LOG_LOCAL0, "nedEastSpd          : %d\n", gpsData.nedEastSpd);
-                syslog(LOG_INFO | LOG_LOCAL0, "endDownSpd          : %d\n", gpsData.endDownSpd);
-                syslog(LOG_INFO | LOG_LOCAL0, "heading             : %u\n", gpsData.heading);
-                syslog(LOG_INFO | LOG_LOCAL0, "numSV               : %u\n", gpsData.numSV);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "type                : Calibration Coordinate of GPS\n\n");
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "utcTime_sec         : %u\n", gpsData.utcTime_sec);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "utcTime_usec        : %u\n", gpsData.utcTime_usec);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "fixType             : %u\n", gpsData.fixType);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "diffSlon            : %u\n", gpsData.diffSoln);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "carSoln             : %u\n", gpsData.carSoln);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "latitude            : %d\n", gpsData.lati);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "longitude           : %d\n", gpsData.longi);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "elevation           : %d\n", gpsData.elev);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "nedNorSpd           : %d\n", gpsData.nedNorSpd);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "nedEastSpd          : %d\n", gpsData.nedEastSpd);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "endDownSpd          : %d\n", gpsData.endDownSpd);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "heading             : %u\n", gpsData.heading);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "numSV               : %u\n", gpsData.numSV);
                 break;
             }
         case 3 :
@@ -61,25 +70,25 @@ static void printPkt(v2icPkt_t *pkt)
                 memset(&dtcData, 0, sizeof(dtcPkt_t));
                 memcpy(&dtcData, pkt->data, sizeof(dtcPkt_t));
 
-                syslog(LOG_INFO | LOG_LOCAL0, "type                : DTC Code\n\n");
-                syslog(LOG_INFO | LOG_LOCAL0, "utcTime_sec         : %u\n", dtcData.utcTime_sec);
-                syslog(LOG_INFO | LOG_LOCAL0, "utcTime_usec        : %u\n", dtcData.utcTime_usec);
-                syslog(LOG_INFO | LOG_LOCAL0, "dtcCode             : %u %u %u %u %u\n", dtcData.dtcCode[0], dtcData.dtcCode[1], dtcData.dtcCode[2], dtcData.dtcCode[3], dtcData.dtcCode[4]);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "type                : DTC Code\n\n");
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "utcTime_sec         : %u\n", dtcData.utcTime_sec);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "utcTime_usec        : %u\n", dtcData.utcTime_usec);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "dtcCode             : %u %u %u %u %u\n", dtcData.dtcCode[0], dtcData.dtcCode[1], dtcData.dtcCode[2], dtcData.dtcCode[3], dtcData.dtcCode[4]);
                 break;
             }
         case 5 :
             {
-                syslog(LOG_INFO | LOG_LOCAL0, "type                : Forward Target\n\n");
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "type                : Forward Target\n\n");
                 break;
             }
         case 7 : 
             {
-                syslog(LOG_INFO | LOG_LOCAL0, "type                : State of Network Camera\n\n");
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "type                : State of Network Camera\n\n");
                 break;
             }
         case 9 :
             {
-                syslog(LOG_INFO | LOG_LOCAL0, "type                : State of LiDAR\n\n");
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "type                : State of LiDAR\n\n");
                 break;
             }
         case 16 : 
@@ -88,34 +97,34 @@ static void printPkt(v2icPkt_t *pkt)
                 memset(&vifData, 0, sizeof(vifPkt_t));
                 memcpy(&vifData, pkt->data, sizeof(vifPkt_t));
 
-                syslog(LOG_INFO | LOG_LOCAL0, "type                : State of ADAS(RPM Information)\n\n");
-                syslog(LOG_INFO | LOG_LOCAL0, "utcTime_sec         : %u\n", vifData.utcTime_sec);
-                syslog(LOG_INFO | LOG_LOCAL0, "utcTime_usec        : %u\n", vifData.utcTime_usec);
-                syslog(LOG_INFO | LOG_LOCAL0, "curSpeed            : %u\n", vifData.curSpeed);
-                syslog(LOG_INFO | LOG_LOCAL0, "curRPM              : %u\n", vifData.curRPM);
-                syslog(LOG_INFO | LOG_LOCAL0, "batteryVolt         : %u\n", vifData.batteryVolt);
-                syslog(LOG_INFO | LOG_LOCAL0, "coolantTemp         : %hd\n", vifData.coolantTemp);
-                syslog(LOG_INFO | LOG_LOCAL0, "engineOilTemp       : %hd\n", vifData.engineOilTemp);
-                syslog(LOG_INFO | LOG_LOCAL0, "handleAngle         : %hd\n", vifData.handleAngle);
-                syslog(LOG_INFO | LOG_LOCAL0, "remainderOil        : %u\n", vifData.remaindererOil);
-                syslog(LOG_INFO | LOG_LOCAL0, "averageFuel         : %u\n", vifData.averageFuel);
-                syslog(LOG_INFO | LOG_LOCAL0, "inhalationTemp      : %hd\n", vifData.inhalationTemp);
-                syslog(LOG_INFO | LOG_LOCAL0, "inhalationSensor    : %u\n", vifData.inhalationSensor);
-                syslog(LOG_INFO | LOG_LOCAL0, "maf                 : %u\n", vifData.maf);
-                syslog(LOG_INFO | LOG_LOCAL0, "exhaustTemp         : %hd\n", vifData.exhaustTemp);
-                syslog(LOG_INFO | LOG_LOCAL0, "cdf_dpf_capacity    : %hd\n", vifData.cdf_dpf_capacity);
-                syslog(LOG_INFO | LOG_LOCAL0, "cdf_dpf_temp        : %hd\n", vifData.cdf_dpf_temp);
-                syslog(LOG_INFO | LOG_LOCAL0, "batteryTemp         : %hd\n", vifData.batteryTemp);
-                syslog(LOG_INFO | LOG_LOCAL0, "remainderBattery    : %u\n", vifData.remainderBattery);
-                syslog(LOG_INFO | LOG_LOCAL0, "pneumatic           : %u\n", vifData.pneumatic);
-                syslog(LOG_INFO | LOG_LOCAL0, "torqueScalingFactor : %u\n", vifData.torqueScalingFactor);
-                syslog(LOG_INFO | LOG_LOCAL0, "engineTorque        : %hd\n", vifData.engineTorque);
-                syslog(LOG_INFO | LOG_LOCAL0, "gear                : %u\n", vifData.gear);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "type                : State of ADAS(RPM Information)\n\n");
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "utcTime_sec         : %u\n", vifData.utcTime_sec);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "utcTime_usec        : %u\n", vifData.utcTime_usec);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "curSpeed            : %u\n", vifData.curSpeed);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "curRPM              : %u\n", vifData.curRPM);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "batteryVolt         : %u\n", vifData.batteryVolt);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "coolantTemp         : %hd\n", vifData.coolantTemp);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "engineOilTemp       : %hd\n", vifData.engineOilTemp);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "handleAngle         : %hd\n", vifData.handleAngle);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "remainderOil        : %u\n", vifData.remaindererOil);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "averageFuel         : %u\n", vifData.averageFuel);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "inhalationTemp      : %hd\n", vifData.inhalationTemp);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "inhalationSensor    : %u\n", vifData.inhalationSensor);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "maf                 : %u\n", vifData.maf);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "exhaustTemp         : %hd\n", vifData.exhaustTemp);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "cdf_dpf_capacity    : %hd\n", vifData.cdf_dpf_capacity);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "cdf_dpf_temp        : %hd\n", vifData.cdf_dpf_temp);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "batteryTemp         : %hd\n", vifData.batteryTemp);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "remainderBattery    : %u\n", vifData.remainderBattery);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "pneumatic           : %u\n", vifData.pneumatic);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "torqueScalingFactor : %u\n", vifData.torqueScalingFactor);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "engineTorque        : %hd\n", vifData.engineTorque);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "gear                : %u\n", vifData.gear);
 
                 break;
             }
         default :
-            syslog(LOG_INFO | LOG_LOCAL0, "type              : Invalid type\n\n");
+            V2XLOG(LOG_DEBUG | LOG_LOCAL0, "type              : Invalid type\n\n");
             break;
     }
 }
@@ -131,13 +140,12 @@ int sendPkt(v2icPkt_t *sendPkt, int len)
             result = sendto( cnvc_sock, sendPkt, len, MSG_DONTWAIT|MSG_NOSIGNAL, (struct sockaddr*)&cnvc_addr, sizeof(cnvc_addr) );
             if(result >  0)
             {
-                if(g_mib.dbg)
-                {
-                    syslog(LOG_INFO | LOG_LOCAL0, "[infor_broker] Success send packet to CARNAVICOM control center%d byte\n", result);
-                }
+                v2xstat_Inc(sockStat.txCnvc);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "[infor_broker] Success send packet to CARNAVICOM control center%d byte\n", result);
             }
             else if(result == -1)
             {
+                v2xstat_Inc(sockStat.txFail);
                 syslog(LOG_ERR | LOG_LOCAL1, "[infor_broker] packet send error :%s\n", strerror(errno));
                 close(cnvc_sock);
                 server_sock = -1;
@@ -149,13 +157,12 @@ int sendPkt(v2icPkt_t *sendPkt, int len)
             result = sendto( adas_sock, sendPkt, len, MSG_DONTWAIT|MSG_NOSIGNAL, (struct sockaddr*)&adas_addr, sizeof(adas_addr) );
             if(result >  0)
             {
-                if(g_mib.dbg)
-                {
-                    syslog(LOG_INFO | LOG_LOCAL0, "[infor_broker] Success send packet to ADAS ONE crontrol center %d byte\n", result);
-                }
+                v2xstat_Inc(sockStat.txAdas);
+                V2XLOG(LOG_DEBUG | LOG_LOCAL0, "[infor_broker] Success send packet to ADAS ONE crontrol center %d byte\n", result);
             }
             else if(result == -1)
             {
+                v2xstat_Inc(sockStat.txFail);
                 syslog(LOG_ERR | LOG_LOCAL1, "[infor_broker] packet send error :%s\n", strerror(errno));
                 close(adas_sock);
                 adas_sock = -1;
@@ -205,16 +212,17 @@ static void* sock_func(void* arg)
         len = recvfrom(server_sock, &recvPkt, sizeof(v2icPkt_t), 0, (struct sockaddr*)&client_addr, &client_addr_size);
         if( len > 0 )
         {
-            if(g_mib.dbg)
-                syslog(LOG_INFO | LOG_LOCAL0, "[infor_broker] Success receive packet %d byte\n", len);
+            V2XLOG(LOG_DEBUG | LOG_LOCAL0, "[infor_broker] Success receive packet %d byte\n", len);
+            v2xstat_Inc(sockStat.rx);
+            v2xstat_Add(sockStat.rxBytes, len);
 
       //      hexdump(&recvPkt, len);
 
             /* 수신 Pkt pass */
             sendPkt(&recvPkt, len);
 
-            /* 패킷 출력 */
-            if(g_mib.dbg)
+            /* 패킷 출력 - 패킷마다 호출되므로 바이너리 로그(V2XLOG)로 남긴다. (디버그 레벨에서만 기록) */
+            if(V2XLOG_ENABLED(LOG_DEBUG))
                 printPkt(&recvPkt);
         }
     }
@@ -226,6 +234,13 @@ static void* sock_func(void* arg)
 /* 쓰레드 생성 */
 int createSockThread()
 {
+    /* 공유메모리 통계 등록 - 쓰레드 생성 전에 등록한다. */
+    sockStat.rx = v2xstat_Counter("sock.rx", "pkt");
+    sockStat.rxBytes = v2xstat_Counter("sock.rx_bytes", "byte");
+    sockStat.txCnvc = v2xstat_Counter("sock.tx_cnvc", "pkt");
+    sockStat.txAdas = v2xstat_Counter("sock.tx_adas", "pkt");
+    sockStat.txFail = v2xstat_Counter("sock.tx_fail", "pkt");
+
     /* 수신 쓰레드 생성 */
     if(  pthread_create(&sock_thread, NULL, &sock_func, NULL) != 0)
     {
@@ -0,0 +1,825 @@
+/**********************************************************
+  [지연 포맷 바이너리 로그]
+  V2XLOG()는 syslog()처럼 매번 텍스트를 만들고 시스템콜을 하지 않는다.
+  - 호출 위치(struct v2xlogSite_t)는 처음 호출될 때 포맷을 해석하여 인자 타입 목록과 ID를 얻는다.
+  - 이후 호출은 레코드 헤더와 인자 원값을 쓰레드 전용 링버퍼(단일 생산자/단일 소비자)에 복사하고 끝난다.
+    링버퍼가 가득 차면 기다리지 않고 버린 뒤 그 수를 센다.
+  - 배경 쓰레드가 V2XLOG_DRAIN_MSEC 마다 링버퍼를 비워 파일에 쓴다. 새 포맷은 그 포맷을 쓰는
+    메시지보다 먼저 파일에 기록된다.
+  - 제어 공유메모리의 level을 바꾸면(v2xlogdec -l) 재시작 없이 기록 레벨이 바뀐다.
+ ************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <sys/shm.h>
+#include <sys/eventfd.h>
+#include "v2xlog.h"
+
+/* syslog facility - 라이브러리를 빌드하는 프로젝트가 지정한다. (libv2x/CMakeLists.txt V2X_SYSLOG_INFO/ERR) */
+#ifndef V2X_SYSLOG_INFO
+#define V2X_SYSLOG_INFO LOG_LOCAL0
+#endif
+#ifndef V2X_SYSLOG_ERR
+#define V2X_SYSLOG_ERR LOG_LOCAL1
+#endif
+#define V2XLOG_LOG_INFO (LOG_INFO | V2X_SYSLOG_INFO)
+#define V2XLOG_LOG_ERR (LOG_ERR | V2X_SYSLOG_ERR)
+#define V2XLOG_SITE_MAX 1024 //등록 가능한 포맷 수 (초과 시 syslog 사용)
+#define V2XLOG_WBUF_SIZE (64 * 1024) //파일 쓰기 버퍼
+#define V2XLOG_ALIGN(n) (((n) + 7U) & ~7U)
+#define V2XLOG_RING_MASK (V2XLOG_RING_SIZE - 1)
+
+/* 쓰레드 별 링버퍼 - head는 기록 쓰레드, tail은 배경 쓰레드만 쓴다. */
+struct v2xlogRing_t{
+	struct v2xlogRing_t *next;
+	uint32_t tid;
+	int dead; //쓰레드 종료 - 비워지면 해제한다.
+	uint64_t snap; //포맷 기록 전에 읽어 둔 head (배경 쓰레드)
+	uint64_t dropsReported; //파일에 기록한 버림 수 (배경 쓰레드)
+	uint64_t head __attribute__((aligned(64)));
+	uint64_t drops;
+	uint64_t tail __attribute__((aligned(64)));
+	uint8_t buf[V2XLOG_RING_SIZE] __attribute__((aligned(64)));
+};
+
+static struct v2xlogCtl_t g_v2xlogCtlLocal = { .magic = V2XLOG_MAGIC, .level = LOG_INFO };
+struct v2xlogCtl_t *g_v2xlogCtl = &g_v2xlogCtlLocal;
+
+static struct{
+	int run;
+	int fd;
+	int efd;
+	int shmid;
+	uint64_t fileSize;
+	char path[256];
+	char name[V2XLOG_NAME_MAX];
+	pthread_t thread;
+	pthread_key_t key;
+
+	pthread_mutex_t mtx; //sites, rings 보호
+	struct v2xlogSite_t *sites[V2XLOG_SITE_MAX];
+	uint32_t nsites;
+	uint32_t emitted; //현재 파일에 기록한 포맷 수
+	struct v2xlogRing_t *rings;
+
+	uint8_t wbuf[V2XLOG_WBUF_SIZE];
+	uint32_t wlen;
+} g_v2xlog = { .fd = -1, .efd = -1, .shmid = -1, .mtx = PTHREAD_MUTEX_INITIALIZER };
+
+static __thread struct v2xlogRing_t *t_v2xlogRing;
+
+
+/**
+ * v2xlog_Now()
+ * CLOCK_REALTIME 현재시각 (nsec)
+ */
+static uint64_t v2xlog_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * v2xlog_Key()
+ * 제어 공유메모리 키 - 이름의 FNV-1a 해시
+ */
+key_t v2xlog_Key(const char *name)
+{
+	uint32_t h = 2166136261U;
+
+	while(*name != '\0')
+		h = (h ^ (uint8_t)*name++) * 16777619U;
+	return (key_t)(0x56000000 | (h & 0x00ffffff));
+}
+
+/**
+ * v2xlog_Spec()
+ * '%' 다음부터 변환지정자 하나를 해석한다.
+ * @param stars '*' 폭/정밀도 인자 수
+ * @param type  변환지정자의 인자 타입
+ * @return      변환지정자 다음 위치, 지원하지 않는 지정자면 NULL
+ */
+static const char *v2xlog_Spec(const char *p, int *stars, uint8_t *type)
+{
+	int len = 0; //0: 없음, 1: hh/h, 2: l, 3: ll/q, 4: j, 5: z, 6: t, 7: L
+
+	*stars = 0;
+	while(*p != '\0' && strchr("-+ #0'", *p) != NULL)
+		p++;
+	if(*p == '*'){
+		(*stars)++;
+		p++;
+	}
+	else{
+		while(isdigit((unsigned char)*p))
+			p++;
+	}
+	if(*p == '$') //위치 지정 인자
+		return NULL;
+	if(*p == '.'){
+		p++;
+		if(*p == '*'){
+			(*stars)++;
+			p++;
+		}
+		else{
+			while(isdigit((unsigned char)*p))
+				p++;
+		}
+	}
+
+	switch(*p){
+		case 'h': p++; if(*p == 'h') p++; len = 1; break;
+		case 'l': p++; if(*p == 'l'){ p++; len = 3; } else len = 2; break;
+		case 'q': p++; len = 3; break;
+		case 'j': p++; len = 4; break;
+		case 'z': p++; len = 5; break;
+		case 't': p++; len = 6; break;
+		case 'L': p++; len = 7; break;
+	}
+
+	switch(*p){
+		case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+			{
+				static const uint8_t intType[] = { v2xlogArgInt, v2xlogArgInt, v2xlogArgLong, v2xlogArgLLong,
+					v2xlogArgIntmax, v2xlogArgSize, v2xlogArgPtrdiff };
+				if(len == 7)
+					return NULL;
+				*type = intType[len];
+				break;
+			}
+		case 'c':
+			if(len != 0)
+				return NULL;
+			*type = v2xlogArgInt;
+			break;
+		case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+			if(len == 7)
+				return NULL;
+			*type = v2xlogArgDouble;
+			break;
+		case 's':
+			if(len != 0)
+				return NULL;
+			*type = v2xlogArgStr;
+			break;
+		case 'p':
+			*type = v2xlogArgPtr;
+			break;
+		default: //%n, %m, 와이드 문자 등
+			return NULL;
+	}
+	return p + 1;
+}
+
+/**
+ * v2xlog_ParseFmt()
+ * 포맷 문자열의 인자 타입 목록을 구한다.
+ * @return 인자 수, 지원하지 않는 포맷이면 -1
+ */
+int v2xlog_ParseFmt(const char *fmt, uint8_t *types, int max)
+{
+	const char *p = fmt;
+	int n = 0, stars;
+	uint8_t type;
+
+	while(*p != '\0'){
+		if(*p++ != '%')
+			continue;
+		if(*p == '%'){
+			p++;
+			continue;
+		}
+		p = v2xlog_Spec(p, &stars, &type);
+		if(p == NULL || n + stars + 1 > max)
+			return -1;
+		while(stars-- > 0)
+			types[n++] = v2xlogArgInt;
+		types[n++] = type;
+	}
+	return n;
+}
+
+/**
+ * v2xlog_ArgSize()
+ * 문자열을 제외한 인자의 기록 크기
+ */
+static uint32_t v2xlog_ArgSize(uint8_t type)
+{
+	if(type == v2xlogArgInt)
+		return sizeof(int32_t);
+	if(type == v2xlogArgStr)
+		return sizeof(uint16_t);
+	return sizeof(uint64_t);
+}
+
+/**
+ * v2xlog_Render()
+ * 메시지 레코드의 인자 원값으로 포맷 문자열을 텍스트로 만든다. (v2xlogdec)
+ * @param args 레코드 헤더 다음의 인자 영역
+ * @return     만든 텍스트 길이, 포맷과 인자가 맞지 않으면 -1
+ */
+int v2xlog_Render(const char *fmt, const uint8_t *types, int nargs, const uint8_t *args, uint32_t len, char *out, size_t size)
+{
+	const char *p = fmt, *e;
+	char spec[32], str[V2XLOG_STR_MAX + 1];
+	size_t o = 0;
+	uint32_t off = 0;
+	int i = 0, stars, star[2], k, ret = 0;
+	uint8_t type;
+	int32_t vi;
+	int64_t vl;
+	double vd;
+	uint16_t slen;
+
+	if(size == 0)
+		return -1;
+
+#define V2XLOG_TAKE(v) \
+	do{ \
+		if(off + sizeof(v) > len) \
+			return -1; \
+		memcpy(&(v), args + off, sizeof(v)); \
+		off += sizeof(v); \
+	}while(0)
+#define V2XLOG_PUT(v) \
+	(stars == 0 ? snprintf(out + o, size - o, spec, v) : \
+	 stars == 1 ? snprintf(out + o, size - o, spec, star[0], v) : \
+	 snprintf(out + o, size - o, spec, star[0], star[1], v))
+
+	while(*p != '\0' && o + 1 < size){
+		if(*p != '%' || p[1] == '%'){
+			out[o++] = *p;
+			p += (*p == '%') ? 2 : 1;
+			continue;
+		}
+		e = v2xlog_Spec(p + 1, &stars, &type);
+		if(e == NULL || (size_t)(e - p) >= sizeof(spec))
+			return -1;
+		memcpy(spec, p, e - p);
+		spec[e - p] = '\0';
+		p = e;
+
+		for(k = 0; k < stars; k++){
+			if(i >= nargs || types[i++] != v2xlogArgInt)
+				return -1;
+			V2XLOG_TAKE(vi);
+			star[k] = vi;
+		}
+		if(i >= nargs || types[i++] != type)
+			return -1;
+
+		switch(type){
+			case v2xlogArgInt: V2XLOG_TAKE(vi); ret = V2XLOG_PUT(vi); break;
+			case v2xlogArgLong: V2XLOG_TAKE(vl); ret = V2XLOG_PUT((long)vl); break;
+			case v2xlogArgLLong: V2XLOG_TAKE(vl); ret = V2XLOG_PUT((long long)vl); break;
+			case v2xlogArgIntmax: V2XLOG_TAKE(vl); ret = V2XLOG_PUT((intmax_t)vl); break;
+			case v2xlogArgSize: V2XLOG_TAKE(vl); ret = V2XLOG_PUT((size_t)vl); break;
+			case v2xlogArgPtrdiff: V2XLOG_TAKE(vl); ret = V2XLOG_PUT((ptrdiff_t)vl); break;
+			case v2xlogArgDouble: V2XLOG_TAKE(vd); ret = V2XLOG_PUT(vd); break;
+			case v2xlogArgPtr: V2XLOG_TAKE(vl); ret = V2XLOG_PUT((void*)(uintptr_t)vl); break;
+			case v2xlogArgStr:
+				V2XLOG_TAKE(slen);
+				if(slen > V2XLOG_STR_MAX || off + slen > len)
+					return -1;
+				memcpy(str, args + off, slen);
+				str[slen] = '\0';
+				off += slen;
+				ret = V2XLOG_PUT(str);
+				break;
+		}
+		if(ret < 0)
+			return -1;
+		o += ret;
+		if(o >= size)
+			o = size - 1;
+	}
+	out[o] = '\0';
+	return (int)o;
+
+#undef V2XLOG_TAKE
+#undef V2XLOG_PUT
+}
+
+/**
+ * v2xlog_Register()
+ * 호출 위치를 등록하고 포맷 ID를 부여한다. (위치마다 처음 한 번)
+ * @return 포맷 ID, syslog를 사용해야 하면 -1
+ */
+static int32_t v2xlog_Register(struct v2xlogSite_t *site, const char *fmt)
+{
+	int32_t id;
+	int n, i;
+	uint32_t size;
+
+	pthread_mutex_lock(&g_v2xlog.mtx);
+	if(site->id == 0){
+		n = v2xlog_ParseFmt(fmt, site->types, V2XLOG_MAX_ARGS);
+		if(n < 0 || strlen(fmt) > V2XLOG_WBUF_SIZE / 4 || g_v2xlog.nsites >= V2XLOG_SITE_MAX){
+			id = -1;
+		}
+		else{
+			size = sizeof(struct v2xlogRec_t);
+			for(i = 0; i < n; i++)
+				size += v2xlog_ArgSize(site->types[i]);
+			site->fmt = fmt;
+			site->nargs = n;
+			site->size = size;
+			g_v2xlog.sites[g_v2xlog.nsites++] = site;
+			id = g_v2xlog.nsites;
+			__atomic_store_n(&g_v2xlogCtl->sites, g_v2xlog.nsites, __ATOMIC_RELAXED);
+		}
+		__atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+	}
+	id = site->id;
+	pthread_mutex_unlock(&g_v2xlog.mtx);
+
+	return id;
+}
+
+/**
+ * v2xlog_RingExit()
+ * 쓰레드 종료 시 링버퍼를 해제 대상으로 표시한다. (남은 레코드는 배경 쓰레드가 비운 뒤 해제)
+ */
+static void v2xlog_RingExit(void *arg)
+{
+	struct v2xlogRing_t *r = (struct v2xlogRing_t*)arg;
+
+	__atomic_store_n(&r->dead, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * v2xlog_Ring()
+ * 현재 쓰레드의 링버퍼 (처음 호출 시 생성)
+ */
+static struct v2xlogRing_t *v2xlog_Ring(void)
+{
+	struct v2xlogRing_t *r = t_v2xlogRing;
+
+	if(r != NULL)
+		return r;
+	if(posix_memalign((void**)&r, 64, sizeof(struct v2xlogRing_t)) != 0)
+		return NULL;
+	memset(r, 0, offsetof(struct v2xlogRing_t, buf));
+	r->tid = (uint32_t)syscall(SYS_gettid);
+
+	pthread_mutex_lock(&g_v2xlog.mtx);
+	r->next = g_v2xlog.rings;
+	g_v2xlog.rings = r;
+	pthread_mutex_unlock(&g_v2xlog.mtx);
+
+	pthread_setspecific(g_v2xlog.key, r);
+	t_v2xlogRing = r;
+	return r;
+}
+
+/**
+ * v2xlog_Push()
+ * 레코드를 링버퍼에 넣는다. 끝에 연속 공간이 모자라면 길이 0인 표시를 남기고 처음부터 쓴다.
+ */
+static void v2xlog_Push(struct v2xlogRing_t *r, const uint8_t *rec, uint32_t len)
+{
+	uint64_t head = r->head;
+	uint64_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+	uint32_t alen = V2XLOG_ALIGN(len);
+	uint32_t off = head & V2XLOG_RING_MASK;
+	uint32_t pad = (off + alen > V2XLOG_RING_SIZE) ? V2XLOG_RING_SIZE - off : 0;
+	uint16_t zero = 0;
+
+	if(head + pad + alen - tail > V2XLOG_RING_SIZE){
+		__atomic_store_n(&r->drops, r->drops + 1, __ATOMIC_RELAXED);
+		return;
+	}
+	if(pad != 0){
+		memcpy(r->buf + off, &zero, sizeof(zero));
+		head += pad;
+		off = 0;
+	}
+	memcpy(r->buf + off, rec, len);
+	__atomic_store_n(&r->head, head + alen, __ATOMIC_RELEASE);
+}
+
+/**
+ * v2xlog_Write()
+ * V2XLOG()에서 호출한다. 인자 원값을 레코드로 만들어 링버퍼에 넣는다.
+ */
+void v2xlog_Write(struct v2xlogSite_t *site, const char *fmt, ...)
+{
+	uint8_t rec[V2XLOG_REC_MAX];
+	struct v2xlogRec_t *hdr = (struct v2xlogRec_t*)rec;
+	struct v2xlogRing_t *r = NULL;
+	uint32_t off = sizeof(struct v2xlogRec_t), strRoom;
+	int32_t id;
+	va_list ap;
+	int i;
+
+	id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+	if(id == 0)
+		id = v2xlog_Register(site, fmt);
+	if(id < 0 || !__atomic_load_n(&g_v2xlog.run, __ATOMIC_ACQUIRE) || (r = v2xlog_Ring()) == NULL){
+		va_start(ap, fmt);
+		vsyslog(site->pri, fmt, ap);
+		va_end(ap);
+		__atomic_fetch_add(&g_v2xlogCtl->fallbacks, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	strRoom = V2XLOG_REC_MAX - site->size;
+	va_start(ap, fmt);
+	for(i = 0; i < site->nargs; i++){
+		switch(site->types[i]){
+			case v2xlogArgInt:
+				{
+					int32_t v = va_arg(ap, int);
+					memcpy(rec + off, &v, sizeof(v));
+					off += sizeof(v);
+					break;
+				}
+			case v2xlogArgDouble:
+				{
+					double v = va_arg(ap, double);
+					memcpy(rec + off, &v, sizeof(v));
+					off += sizeof(v);
+					break;
+				}
+			case v2xlogArgStr:
+				{
+					const char *s = va_arg(ap, const char*);
+					uint16_t n;
+
+					if(s == NULL)
+						s = "(null)";
+					n = strnlen(s, V2XLOG_STR_MAX);
+					if(n > strRoom)
+						n = strRoom;
+					strRoom -= n;
+					memcpy(rec + off, &n, sizeof(n));
+					memcpy(rec + off + sizeof(n), s, n);
+					off += sizeof(n) + n;
+					break;
+				}
+			default:
+				{
+					int64_t v;
+
+					switch(site->types[i]){
+						case v2xlogArgLong: v = va_arg(ap, long); break;
+						case v2xlogArgLLong: v = va_arg(ap, long long); break;
+						case v2xlogArgIntmax: v = va_arg(ap, intmax_t); break;
+						case v2xlogArgSize: v = va_arg(ap, size_t); break;
+						case v2xlogArgPtrdiff: v = va_arg(ap, ptrdiff_t); break;
+						default: v = (int64_t)(uintptr_t)va_arg(ap, void*); break;
+					}
+					memcpy(rec + off, &v, sizeof(v));
+					off += sizeof(v);
+					break;
+				}
+		}
+	}
+	va_end(ap);
+
+	hdr->len = off;
+	hdr->type = v2xlogRecMsg;
+	hdr->reserved = 0;
+	hdr->id = id;
+	hdr->ts = v2xlog_Now();
+	hdr->tid = r->tid;
+	hdr->arg = 0;
+	v2xlog_Push(r, rec, off);
+}
+
+/**
+ * v2xlog_Flush()
+ * 쓰기 버퍼를 파일에 쓴다. (배경 쓰레드)
+ */
+static void v2xlog_Flush(void)
+{
+	static bool errLogged = false;
+	ssize_t n;
+	uint32_t done = 0;
+
+	while(done < g_v2xlog.wlen){
+		n = write(g_v2xlog.fd, g_v2xlog.wbuf + done, g_v2xlog.wlen - done);
+		if(n < 0 && errno == EINTR)
+			continue;
+		if(n <= 0){
+			if(!errLogged)
+				syslog(V2XLOG_LOG_ERR, "[v2xlog] Fail to write %s : %s\n", g_v2xlog.path, strerror(errno));
+			errLogged = true;
+			break;
+		}
+		done += n;
+	}
+	g_v2xlog.fileSize += done;
+	__atomic_store_n(&g_v2xlogCtl->bytes, g_v2xlogCtl->bytes + done, __ATOMIC_RELAXED);
+	g_v2xlog.wlen = 0;
+}
+
+/**
+ * v2xlog_Out()
+ * 레코드를 쓰기 버퍼에 넣는다. (배경 쓰레드)
+ */
+static void v2xlog_Out(const void *rec, uint32_t len)
+{
+	if(g_v2xlog.wlen + len > V2XLOG_WBUF_SIZE)
+		v2xlog_Flush();
+	memcpy(g_v2xlog.wbuf + g_v2xlog.wlen, rec, len);
+	g_v2xlog.wlen += len;
+}
+
+/**
+ * v2xlog_OutFmt()
+ * 포맷 정의 레코드를 쓴다. (배경 쓰레드)
+ */
+static void v2xlog_OutFmt(const struct v2xlogSite_t *site, uint32_t id)
+{
+	uint8_t rec[V2XLOG_WBUF_SIZE / 2];
+	struct v2xlogRec_t hdr;
+	struct v2xlogFmt_t body;
+	const char *file = strrchr(site->file, '/');
+	uint32_t off = sizeof(hdr), n;
+
+	file = (file != NULL) ? file + 1 : site->file;
+	body.line = site->line;
+	body.pri = site->pri;
+	body.nargs = site->nargs;
+	memcpy(rec + off, &body, sizeof(body));
+	off += sizeof(body);
+	memcpy(rec + off, site->types, site->nargs);
+	off += site->nargs;
+	n = strnlen(file, 255) + 1;
+	memcpy(rec + off, file, n);
+	rec[off + n - 1] = '\0';
+	off += n;
+	n = strlen(site->fmt) + 1;
+	memcpy(rec + off, site->fmt, n);
+	off += n;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.len = off;
+	hdr.type = v2xlogRecFmt;
+	hdr.id = id;
+	hdr.ts = v2xlog_Now();
+	memcpy(rec, &hdr, sizeof(hdr));
+	v2xlog_Out(rec, off);
+}
+
+/**
+ * v2xlog_DrainRing()
+ * 포맷 기록 전에 읽어 둔 head까지 링버퍼를 비운다. (배경 쓰레드)
+ */
+static void v2xlog_DrainRing(struct v2xlogRing_t *r)
+{
+	uint64_t tail = r->tail, drops, records = 0;
+	uint32_t off;
+	uint16_t len;
+
+	while(tail < r->snap){
+		off = tail & V2XLOG_RING_MASK;
+		memcpy(&len, r->buf + off, sizeof(len));
+		if(len == 0){
+			tail += V2XLOG_RING_SIZE - off;
+			continue;
+		}
+		v2xlog_Out(r->buf + off, len);
+		tail += V2XLOG_ALIGN(len);
+		records++;
+	}
+	__atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+	if(records != 0)
+		__atomic_store_n(&g_v2xlogCtl->records, g_v2xlogCtl->records + records, __ATOMIC_RELAXED);
+
+	drops = __atomic_load_n(&r->drops, __ATOMIC_RELAXED);
+	if(drops != r->dropsReported){
+		struct v2xlogRec_t hdr;
+
+		memset(&hdr, 0, sizeof(hdr));
+		hdr.len = sizeof(hdr);
+		hdr.type = v2xlogRecDrop;
+		hdr.ts = v2xlog_Now();
+		hdr.tid = r->tid;
+		hdr.arg = (uint32_t)(drops - r->dropsReported);
+		v2xlog_Out(&hdr, sizeof(hdr));
+		__atomic_store_n(&g_v2xlogCtl->drops, g_v2xlogCtl->drops + hdr.arg, __ATOMIC_RELAXED);
+		r->dropsReported = drops;
+	}
+}
+
+/**
+ * v2xlog_OpenFile()
+ * 로그 파일을 새로 만들고 파일 헤더를 쓴다. 기존 파일은 .1로 옮긴다.
+ */
+static int v2xlog_OpenFile(void)
+{
+	char old[sizeof(g_v2xlog.path) + 2];
+	struct v2xlogFileHdr_t hdr;
+
+	snprintf(old, sizeof(old), "%s.1", g_v2xlog.path);
+	if(rename(g_v2xlog.path, old) < 0 && errno != ENOENT)
+		syslog(V2XLOG_LOG_ERR, "[v2xlog] Fail to rename %s : %s\n", g_v2xlog.path, strerror(errno));
+
+	g_v2xlog.fd = open(g_v2xlog.path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(g_v2xlog.fd < 0){
+		syslog(V2XLOG_LOG_ERR, "[v2xlog] Fail to open %s : %s\n", g_v2xlog.path, strerror(errno));
+		return -1;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = V2XLOG_MAGIC;
+	hdr.version = V2XLOG_VERSION;
+	hdr.pid = getpid();
+	hdr.start = v2xlog_Now();
+	snprintf(hdr.name, sizeof(hdr.name), "%s", g_v2xlog.name);
+	g_v2xlog.fileSize = 0;
+	g_v2xlog.emitted = 0;
+	v2xlog_Out(&hdr, sizeof(hdr));
+	v2xlog_Flush();
+	return 0;
+}
+
+/**
+ * v2xlog_Drain()
+ * 링버퍼 head를 먼저 읽고, 새 포맷을 기록한 뒤, 읽어 둔 head까지 비운다.
+ * 이 순서로 파일에는 항상 포맷 정의가 그 포맷의 메시지보다 앞선다. (배경 쓰레드)
+ */
+static void v2xlog_Drain(void)
+{
+	struct v2xlogRing_t *r, **pr;
+	uint32_t i;
+
+	pthread_mutex_lock(&g_v2xlog.mtx);
+	for(r = g_v2xlog.rings; r != NULL; r = r->next)
+		r->snap = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+	for(i = g_v2xlog.emitted; i < g_v2xlog.nsites; i++)
+		v2xlog_OutFmt(g_v2xlog.sites[i], i + 1);
+	g_v2xlog.emitted = g_v2xlog.nsites;
+
+	pr = &g_v2xlog.rings;
+	while((r = *pr) != NULL){
+		v2xlog_DrainRing(r);
+		if(__atomic_load_n(&r->dead, __ATOMIC_ACQUIRE) && r->tail == __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)){
+			*pr = r->next;
+			free(r);
+			continue;
+		}
+		pr = &r->next;
+	}
+	pthread_mutex_unlock(&g_v2xlog.mtx);
+
+	v2xlog_Flush();
+
+	/* 크기 초과 시 파일 교체 - 새 파일에는 포맷 정의를 다시 쓴다. */
+	if(g_v2xlog.fileSize >= V2XLOG_FILE_MAX){
+		close(g_v2xlog.fd);
+		v2xlog_OpenFile();
+	}
+}
+
+/**
+ * v2xlog_Thread()
+ * 배경 쓰레드 - 종료 알림이 올 때까지 V2XLOG_DRAIN_MSEC 마다 링버퍼를 비운다.
+ */
+static void *v2xlog_Thread(void *arg)
+{
+	struct pollfd pfd;
+	int ret;
+
+	pfd.fd = g_v2xlog.efd;
+	pfd.events = POLLIN;
+	while(1){
+		ret = poll(&pfd, 1, V2XLOG_DRAIN_MSEC);
+		if(g_v2xlog.fd >= 0)
+			v2xlog_Drain();
+		if(ret > 0)
+			break;
+	}
+
+	pthread_exit((void *)0);
+}
+
+/**
+ * v2xlog_Init()
+ * 로그 파일과 제어 공유메모리를 만들고 배경 쓰레드를 시작한다.
+ * 실패해도 V2XLOG()는 syslog()로 기록하므로 호출측은 계속 동작하면 된다.
+ *
+ * @param name  데몬 이름 (파일명, 공유메모리 키)
+ * @param dir   로그 디렉터리 (NULL이면 V2XLOG_DIR 환경변수, 없으면 V2XLOG_DEFAULT_DIR)
+ * @param level 초기 기록 레벨 (LOG_DEBUG, LOG_INFO, ...)
+ * @return      성공 시 0, 실패 시 -1
+ */
+int v2xlog_Init(const char *name, const char *dir, int level)
+{
+	struct v2xlogCtl_t *ctl = NULL;
+	sigset_t set, old;
+	int ret;
+
+	if(g_v2xlog.run)
+		return 0;
+	g_v2xlogCtlLocal.level = level;
+
+	if(dir == NULL)
+		dir = getenv("V2XLOG_DIR");
+	if(dir == NULL || dir[0] == '\0')
+		dir = V2XLOG_DEFAULT_DIR;
+	strncpy(g_v2xlog.name, name, sizeof(g_v2xlog.name) - 1);
+	snprintf(g_v2xlog.path, sizeof(g_v2xlog.path), "%s/%s%s", dir, g_v2xlog.name, V2XLOG_FILE_EXT);
+
+	if(pthread_key_create(&g_v2xlog.key, v2xlog_RingExit) != 0)
+		return -1;
+	g_v2xlog.efd = eventfd(0, EFD_CLOEXEC);
+	if(g_v2xlog.efd < 0 || v2xlog_OpenFile() < 0)
+		goto fail;
+
+	/* 제어 공유메모리 - 없으면 레벨을 실행 중에 바꿀 수 없을 뿐 기록은 한다. */
+	g_v2xlog.shmid = shmget(v2xlog_Key(g_v2xlog.name), sizeof(struct v2xlogCtl_t), 0666 | IPC_CREAT);
+	if(g_v2xlog.shmid < 0 || (ctl = (struct v2xlogCtl_t*)shmat(g_v2xlog.shmid, NULL, 0)) == (void*)-1){
+		syslog(V2XLOG_LOG_ERR, "[v2xlog] Fail to attach control shm : %s\n", strerror(errno));
+		ctl = &g_v2xlogCtlLocal;
+		g_v2xlog.shmid = -1;
+	}
+	else{
+		memset(ctl, 0, sizeof(struct v2xlogCtl_t));
+		ctl->sites = g_v2xlog.nsites;
+		ctl->fallbacks = g_v2xlogCtlLocal.fallbacks;
+		snprintf(ctl->name, sizeof(ctl->name), "%s", g_v2xlog.name);
+	}
+	ctl->magic = V2XLOG_MAGIC;
+	ctl->level = level;
+	ctl->pid = getpid();
+
+	__atomic_store_n(&g_v2xlog.run, 1, __ATOMIC_RELEASE);
+	sigfillset(&set);
+	pthread_sigmask(SIG_BLOCK, &set, &old);
+	ret = pthread_create(&g_v2xlog.thread, NULL, v2xlog_Thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if(ret != 0){
+		syslog(V2XLOG_LOG_ERR, "[v2xlog] Fail to create drain thread\n");
+		__atomic_store_n(&g_v2xlog.run, 0, __ATOMIC_RELEASE);
+		goto fail;
+	}
+	g_v2xlogCtl = ctl;
+
+	syslog(V2XLOG_LOG_INFO, "[v2xlog] Logging to %s, level %d\n", g_v2xlog.path, level);
+	return 0;
+
+fail:
+	if(g_v2xlog.fd >= 0)
+		close(g_v2xlog.fd);
+	if(g_v2xlog.efd >= 0)
+		close(g_v2xlog.efd);
+	g_v2xlog.fd = g_v2xlog.efd = -1;
+	g_v2xlog.wlen = 0;
+	pthread_key_delete(g_v2xlog.key);
+	return -1;
+}
+
+/**
+ * v2xlog_Close()
+ * 남은 레코드를 파일에 쓰고 배경 쓰레드를 멈춘다. 이후 V2XLOG()는 syslog()로 기록한다.
+ */
+void v2xlog_Close(void)
+{
+	uint64_t one = 1;
+
+	if(!__atomic_load_n(&g_v2xlog.run, __ATOMIC_ACQUIRE))
+		return;
+	__atomic_store_n(&g_v2xlog.run, 0, __ATOMIC_RELEASE);
+
+	if(write(g_v2xlog.efd, &one, sizeof(one)) < 0)
+		syslog(V2XLOG_LOG_ERR, "[v2xlog] eventfd write fail : %s\n", strerror(errno));
+	pthread_join(g_v2xlog.thread, NULL);
+
+	syslog(V2XLOG_LOG_INFO, "[v2xlog] Closed %s : records %llu, bytes %llu, drops %llu, fallbacks %llu\n",
+			g_v2xlog.path, (unsigned long long)g_v2xlogCtl->records, (unsigned long long)g_v2xlogCtl->bytes,
+			(unsigned long long)g_v2xlogCtl->drops, (unsigned long long)g_v2xlogCtl->fallbacks);
+
+	close(g_v2xlog.fd);
+	close(g_v2xlog.efd);
+	g_v2xlog.fd = g_v2xlog.efd = -1;
+
+	/*
+	 * 제어 공유메모리는 다른 쓰레드가 아직 레벨을 읽을 수 있으므로 떼지 않고 제거만 표시한다.
+	 * (프로세스 종료로 detach 되면 제거된다)
+	 */
+	g_v2xlogCtl->pid = 0;
+	if(g_v2xlog.shmid >= 0)
+		shmctl(g_v2xlog.shmid, IPC_RMID, NULL);
+	g_v2xlog.shmid = -1;
+}
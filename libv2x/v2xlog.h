@@ -0,0 +1,123 @@
+/**********************************************************
+  [지연 포맷 바이너리 로그]
+  핫패스에서 syslog() 대신 V2XLOG()를 사용한다.
+  - 호출 위치마다 포맷 문자열을 한 번만 해석하여 ID를 부여하고, 이후에는 ID와 인자 원값만
+    쓰레드 별 링버퍼에 기록한다. (텍스트 변환, 시스템콜 없음)
+  - 배경 쓰레드가 링버퍼를 비워 <dir>/<name>.v2xlog 파일에 쓴다. 텍스트 변환은 v2xlogdec이 한다.
+  - 로그 레벨은 공유메모리(v2xlog_Key())에 있어 실행 중 v2xlogdec -l 로 바꿀 수 있다.
+  - 초기화 전, 해석할 수 없는 포맷(%n, %m, %L, 위치 지정 인자 등)은 syslog()로 기록한다.
+ ************************************************************/
+
+#ifndef V2XLOG_H
+#define V2XLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <syslog.h>
+#include <sys/ipc.h>
+
+#define V2XLOG_MAGIC 0x56324c47 //"V2LG"
+#define V2XLOG_VERSION 1
+#define V2XLOG_DEFAULT_DIR "/tmp"
+#define V2XLOG_FILE_EXT ".v2xlog"
+#define V2XLOG_NAME_MAX 16
+#define V2XLOG_MAX_ARGS 64 //한 레코드의 최대 인자 수 (PAR 보고 라인 45개)
+#define V2XLOG_STR_MAX 255 //문자열 인자 최대 길이 (초과분은 잘라낸다)
+#define V2XLOG_REC_MAX 1024 //레코드 최대 크기 (헤더 포함)
+#define V2XLOG_RING_SIZE (64 * 1024) //쓰레드 별 링버퍼 크기 (2의 거듭제곱)
+#define V2XLOG_DRAIN_MSEC 50 //배경 쓰레드 링버퍼 비움 주기
+#define V2XLOG_FILE_MAX (8 * 1024 * 1024) //로그 파일 최대 크기 - 초과 시 .1로 교체
+
+/* 레코드 종류 */
+enum {
+	v2xlogRecFmt = 1, //포맷 정의 (struct v2xlogFmt_t + 인자 타입 + 파일명 + 포맷)
+	v2xlogRecMsg, //메시지 (인자 원값)
+	v2xlogRecDrop, //링버퍼가 가득 차 버려진 레코드 수 (arg)
+};
+
+/* 인자 타입 - 포맷 변환지정자 별 va_arg 타입 */
+enum {
+	v2xlogArgInt = 1, //int (%d, %u, %x, %c, h/hh 포함, '*' 폭/정밀도)
+	v2xlogArgLong, //long (l)
+	v2xlogArgLLong, //long long (ll, q)
+	v2xlogArgIntmax, //intmax_t (j)
+	v2xlogArgSize, //size_t (z)
+	v2xlogArgPtrdiff, //ptrdiff_t (t)
+	v2xlogArgDouble, //double (%f, %e, %g, %a)
+	v2xlogArgStr, //문자열 (%s) - uint16_t 길이 + 내용
+	v2xlogArgPtr, //포인터 (%p)
+};
+
+/* 파일 헤더 */
+struct v2xlogFileHdr_t{
+	uint32_t magic;
+	uint32_t version;
+	int32_t pid;
+	uint32_t reserved;
+	uint64_t start; //파일 생성시각 (nsec, CLOCK_REALTIME)
+	char name[V2XLOG_NAME_MAX];
+};
+
+/* 레코드 헤더 - 링버퍼와 파일에서 같은 형식을 사용한다. */
+struct v2xlogRec_t{
+	uint16_t len; //헤더 포함 레코드 길이
+	uint8_t type; //v2xlogRecFmt, v2xlogRecMsg, v2xlogRecDrop
+	uint8_t reserved;
+	uint32_t id; //포맷 ID
+	uint64_t ts; //기록시각 (nsec, CLOCK_REALTIME)
+	uint32_t tid; //기록한 쓰레드 ID
+	uint32_t arg; //v2xlogRecDrop: 버려진 레코드 수
+};
+
+/* 포맷 정의 레코드 본문 - 뒤에 인자 타입[nargs], 파일명, 포맷 문자열(각각 NULL 종료)이 이어진다. */
+struct v2xlogFmt_t{
+	uint16_t line;
+	uint8_t pri;
+	uint8_t nargs;
+};
+
+/* 제어/상태 공유메모리 */
+struct v2xlogCtl_t{
+	uint32_t magic;
+	int32_t level; //기록할 최대 레벨 (LOG_PRI) - 외부에서 변경 가능
+	int32_t pid;
+	uint32_t sites; //등록된 포맷 수
+	uint64_t records; //파일에 쓴 메시지 수
+	uint64_t bytes; //파일에 쓴 바이트 수
+	uint64_t drops; //링버퍼가 가득 차 버려진 수
+	uint64_t fallbacks; //syslog()로 대신 기록한 수
+	char name[V2XLOG_NAME_MAX];
+};
+
+/* 호출 위치 - V2XLOG()가 위치마다 정적으로 하나 만든다. */
+struct v2xlogSite_t{
+	int pri;
+	const char *file;
+	int line;
+	int32_t id; //0: 미등록, -1: syslog 사용, 그 외: 포맷 ID
+	const char *fmt;
+	uint16_t size; //문자열을 제외한 레코드 크기 (문자열은 길이 필드만)
+	uint8_t nargs;
+	uint8_t types[V2XLOG_MAX_ARGS];
+};
+
+extern struct v2xlogCtl_t *g_v2xlogCtl;
+
+#define V2XLOG_ENABLED(pri) (LOG_PRI(pri) <= __atomic_load_n(&g_v2xlogCtl->level, __ATOMIC_RELAXED))
+
+/* syslog(pri, fmt, ...)와 같이 사용한다. 레벨이 꺼져 있으면 인자도 평가하지 않는다. */
+#define V2XLOG(prio, ...) \
+	do{ \
+		static struct v2xlogSite_t v2xlogSite_ = { .pri = (prio), .file = __FILE__, .line = __LINE__ }; \
+		if(V2XLOG_ENABLED(prio)) \
+			v2xlog_Write(&v2xlogSite_, __VA_ARGS__); \
+	}while(0)
+
+int v2xlog_Init(const char *name, const char *dir, int level);
+void v2xlog_Close(void);
+void v2xlog_Write(struct v2xlogSite_t *site, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+key_t v2xlog_Key(const char *name);
+int v2xlog_ParseFmt(const char *fmt, uint8_t *types, int max);
+int v2xlog_Render(const char *fmt, const uint8_t *types, int nargs, const uint8_t *args, uint32_t len, char *out, size_t size);
+
+#endif //V2XLOG_H
@@ -0,0 +1,357 @@
+/**********************************************************
+  [공유메모리 통계]
+  - 등록은 프로세스 안에서 뮤텍스로 보호하고, 정의를 다 채운 뒤 nmetric을 증가시켜 v2xtop에 공개한다.
+  - 쓰레드는 처음 기록할 때 빈 슬롯을 하나 차지한다. 쓰레드가 끝나면 슬롯을 비우며 값은 남아서
+    다음에 슬롯을 차지하는 쓰레드가 이어서 더한다. (합계가 줄어들지 않는다)
+  - 같은 이름의 프로세스가 실행 중이면 "<이름>.<pid>"로 따로 만든다. (v2xtop은 모든 통계 공유메모리를 찾는다)
+  - 공유메모리는 프로세스가 끝나도 지우지 않는다. 종료 직전 값을 v2xtop으로 볼 수 있고 다음 실행 때 초기화된다.
+  - 초기화 전이나 공유메모리를 만들 수 없으면 프로세스 내부 메모리에 기록한다.
+ ************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <syslog.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <sys/shm.h>
+#include "v2xstat.h"
+
+/* syslog facility - 라이브러리를 빌드하는 프로젝트가 지정한다. (libv2x/CMakeLists.txt V2X_SYSLOG_INFO/ERR) */
+#ifndef V2X_SYSLOG_INFO
+#define V2X_SYSLOG_INFO LOG_LOCAL0
+#endif
+#ifndef V2X_SYSLOG_ERR
+#define V2X_SYSLOG_ERR LOG_LOCAL1
+#endif
+#define V2XSTAT_LOG_INFO (LOG_INFO | V2X_SYSLOG_INFO)
+#define V2XSTAT_LOG_ERR (LOG_ERR | V2X_SYSLOG_ERR)
+#define V2XSTAT_CELL_FIRST 2 //앞쪽 값은 등록 실패 시 돌려주는 통계가 쓴다.
+
+static struct v2xstatShm_t g_v2xstatLocal = { .magic = V2XSTAT_MAGIC, .version = V2XSTAT_VERSION };
+static struct v2xstatShm_t *g_v2xstat = &g_v2xstatLocal;
+static pthread_mutex_t g_v2xstatMtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t g_v2xstatOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_v2xstatKey;
+static uint32_t g_v2xstatCells = V2XSTAT_CELL_FIRST;
+
+/* 등록 실패 시 돌려주는 통계 - 값은 기록되지만 v2xtop에는 보이지 않는다. */
+static const struct v2xstatDesc_t g_v2xstatNone[] = {
+	{ .name = "none", .type = v2xstatCounter },
+	{ .name = "none", .type = v2xstatGauge },
+	{ .name = "none", .type = v2xstatHist },
+};
+
+static __thread int t_v2xstatSlot; //차지한 슬롯 번호 (0: 아직 없음 또는 공용 슬롯)
+
+
+/**
+ * v2xstat_Key()
+ * 통계 공유메모리 키 - 이름의 FNV-1a 해시
+ */
+key_t v2xstat_Key(const char *name)
+{
+	uint32_t h = 2166136261U;
+
+	while(*name != '\0')
+		h = (h ^ (uint8_t)*name++) * 16777619U;
+	return (key_t)(0x53000000 | (h & 0x00ffffff));
+}
+
+/**
+ * v2xstat_Attach()
+ * 통계 공유메모리를 만든다.
+ *
+ * @return  공유메모리, 같은 이름의 다른 프로세스가 사용 중이면 NULL (*busy = 1), 실패 시 (void*)-1
+ */
+static struct v2xstatShm_t *v2xstat_Attach(const char *name, int *busy)
+{
+	struct v2xstatShm_t *shm;
+	key_t key = v2xstat_Key(name);
+	int shmid;
+
+	*busy = 0;
+	shmid = shmget(key, sizeof(struct v2xstatShm_t), 0666 | IPC_CREAT);
+	if(shmid < 0 && errno == EINVAL){
+		/* 크기가 다른 이전 버전 - 지우고 다시 만든다. */
+		shmid = shmget(key, 0, 0666);
+		if(shmid >= 0)
+			shmctl(shmid, IPC_RMID, NULL);
+		shmid = shmget(key, sizeof(struct v2xstatShm_t), 0666 | IPC_CREAT);
+	}
+	if(shmid < 0 || (shm = (struct v2xstatShm_t*)shmat(shmid, NULL, 0)) == (void*)-1){
+		syslog(V2XSTAT_LOG_ERR, "[v2xstat] Fail to attach %s stats : %s\n", name, strerror(errno));
+		return (void*)-1;
+	}
+	if(shm->magic == V2XSTAT_MAGIC && shm->pid > 0 && shm->pid != getpid() && kill(shm->pid, 0) == 0){
+		*busy = 1;
+		shmdt(shm);
+		return NULL;
+	}
+	return shm;
+}
+
+/**
+ * v2xstat_Init()
+ * 통계 공유메모리를 만들고 초기화한다. 통계를 등록하기 전에 호출한다.
+ * 실패해도 통계 기록은 동작하며 v2xtop에 보이지 않을 뿐이다.
+ *
+ * @param name  데몬 이름 (공유메모리 키)
+ * @return      성공 시 0, 실패 시 -1
+ */
+int v2xstat_Init(const char *name)
+{
+	struct v2xstatShm_t *shm;
+	struct timespec ts;
+	char own[V2XSTAT_NAME_MAX];
+	int busy;
+
+	if(g_v2xstat != &g_v2xstatLocal)
+		return 0;
+
+	snprintf(own, sizeof(own), "%s", name);
+	shm = v2xstat_Attach(own, &busy);
+	if(busy){
+		snprintf(own, sizeof(own), "%.9s.%d", name, (int)getpid());
+		syslog(V2XSTAT_LOG_INFO, "[v2xstat] %s is running, use %s for stats\n", name, own);
+		shm = v2xstat_Attach(own, &busy);
+	}
+	if(shm == NULL || shm == (void*)-1)
+		return -1;
+
+	pthread_mutex_lock(&g_v2xstatMtx);
+	memset(shm, 0, sizeof(struct v2xstatShm_t));
+	shm->version = V2XSTAT_VERSION;
+	shm->pid = getpid();
+	clock_gettime(CLOCK_REALTIME, &ts);
+	shm->start = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	snprintf(shm->name, sizeof(shm->name), "%s", own);
+	/* 초기화 전에 등록/기록된 통계를 옮긴다. */
+	memcpy(shm->desc, g_v2xstatLocal.desc, sizeof(shm->desc));
+	memcpy(shm->slot, g_v2xstatLocal.slot, sizeof(shm->slot));
+	shm->nmetric = g_v2xstatLocal.nmetric;
+	__atomic_store_n(&shm->magic, V2XSTAT_MAGIC, __ATOMIC_RELEASE);
+	__atomic_store_n(&g_v2xstat, shm, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&g_v2xstatMtx);
+
+	syslog(V2XSTAT_LOG_INFO, "[v2xstat] Stats %s(0x%08x) initialized\n", own, (unsigned int)v2xstat_Key(own));
+	return 0;
+}
+
+/**
+ * v2xstat_Close()
+ * 종료를 표시한다. 다른 쓰레드가 아직 기록할 수 있으므로 공유메모리에서 분리하지 않는다. (프로세스 종료 시 분리된다)
+ */
+void v2xstat_Close(void)
+{
+	struct v2xstatShm_t *shm = g_v2xstat;
+
+	if(shm == &g_v2xstatLocal)
+		return;
+	if(shm->pid == getpid())
+		__atomic_store_n(&shm->pid, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * v2xstat_Register()
+ * 통계를 등록한다. 같은 이름과 종류로 이미 등록되어 있으면 등록된 통계를 돌려준다.
+ */
+static const struct v2xstatDesc_t *v2xstat_Register(const char *name, const char *unit, uint8_t type,
+                                                    const int64_t *bounds, int nbounds)
+{
+	struct v2xstatShm_t *shm;
+	struct v2xstatDesc_t *d;
+	uint32_t ncell = (type == v2xstatHist) ? (uint32_t)nbounds + 2 : 1;
+
+	if(nbounds < 0 || nbounds > V2XSTAT_BOUND_MAX){
+		syslog(V2XSTAT_LOG_ERR, "[v2xstat] Invalid histogram %s - %d bounds\n", name, nbounds);
+		return &g_v2xstatNone[type - 1];
+	}
+
+	pthread_mutex_lock(&g_v2xstatMtx);
+	shm = g_v2xstat;
+	for(uint32_t i = 0; i < shm->nmetric; i++){
+		d = &shm->desc[i];
+		if(strncmp(d->name, name, sizeof(d->name)) == 0){
+			pthread_mutex_unlock(&g_v2xstatMtx);
+			if(d->type == type)
+				return d;
+			syslog(V2XSTAT_LOG_ERR, "[v2xstat] %s is already registered as another type\n", name);
+			return &g_v2xstatNone[type - 1];
+		}
+	}
+	if(shm->nmetric >= V2XSTAT_METRIC_MAX || g_v2xstatCells + ncell > V2XSTAT_CELL_MAX){
+		pthread_mutex_unlock(&g_v2xstatMtx);
+		syslog(V2XSTAT_LOG_ERR, "[v2xstat] No room for %s\n", name);
+		return &g_v2xstatNone[type - 1];
+	}
+
+	d = &shm->desc[shm->nmetric];
+	memset(d, 0, sizeof(struct v2xstatDesc_t));
+	snprintf(d->name, sizeof(d->name), "%s", name);
+	snprintf(d->unit, sizeof(d->unit), "%s", unit ? unit : "");
+	d->type = type;
+	d->cell = (uint16_t)g_v2xstatCells;
+	if(type == v2xstatHist){
+		d->nbounds = (uint8_t)nbounds;
+		memcpy(d->bounds, bounds, sizeof(int64_t) * nbounds);
+	}
+	g_v2xstatCells += ncell;
+	__atomic_store_n(&shm->nmetric, shm->nmetric + 1, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&g_v2xstatMtx);
+	return d;
+}
+
+/**
+ * v2xstat_Counter()
+ * 카운터를 등록한다.
+ *
+ * @param name  통계 이름 ("<분류>.<이름>", 최대 31자)
+ * @param unit  단위 (v2xtop 출력용, 최대 7자)
+ */
+const struct v2xstatDesc_t *v2xstat_Counter(const char *name, const char *unit)
+{
+	return v2xstat_Register(name, unit, v2xstatCounter, NULL, 0);
+}
+
+/**
+ * v2xstat_Gauge()
+ * 게이지를 등록한다.
+ */
+const struct v2xstatDesc_t *v2xstat_Gauge(const char *name, const char *unit)
+{
+	return v2xstat_Register(name, unit, v2xstatGauge, NULL, 0);
+}
+
+/**
+ * v2xstat_Hist()
+ * 히스토그램을 등록한다.
+ *
+ * @param bounds    구간 상한 (오름차순, 최대 V2XSTAT_BOUND_MAX개) - 마지막 상한을 넘는 값은 마지막 구간에 센다.
+ * @param nbounds   구간 상한 수
+ */
+const struct v2xstatDesc_t *v2xstat_Hist(const char *name, const char *unit, const int64_t *bounds, int nbounds)
+{
+	return v2xstat_Register(name, unit, v2xstatHist, bounds, nbounds);
+}
+
+/* 쓰레드 종료 - 슬롯을 비운다. (값은 그대로 둔다) */
+static void v2xstat_SlotExit(void *arg)
+{
+	int slot = (int)(intptr_t)arg;
+
+	__atomic_store_n(&g_v2xstat->slot[slot].tid, 0, __ATOMIC_RELEASE);
+}
+
+static void v2xstat_KeyInit(void)
+{
+	pthread_key_create(&g_v2xstatKey, v2xstat_SlotExit);
+}
+
+/**
+ * v2xstat_Slot()
+ * 쓰레드의 슬롯 번호. 처음 호출될 때 빈 슬롯을 차지한다. 빈 슬롯이 없으면 0 (공용 슬롯)
+ */
+static int v2xstat_Slot(struct v2xstatShm_t *shm)
+{
+	int32_t tid, empty;
+
+	if(t_v2xstatSlot > 0)
+		return t_v2xstatSlot;
+	if(t_v2xstatSlot < 0)
+		return 0;
+
+	pthread_once(&g_v2xstatOnce, v2xstat_KeyInit);
+	tid = (int32_t)syscall(SYS_gettid);
+	for(int i = 1; i < V2XSTAT_SLOT_MAX; i++){
+		empty = 0;
+		if(__atomic_compare_exchange_n(&shm->slot[i].tid, &empty, tid, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+			pthread_setspecific(g_v2xstatKey, (void*)(intptr_t)i);
+			t_v2xstatSlot = i;
+			return i;
+		}
+	}
+	t_v2xstatSlot = -1;
+	return 0;
+}
+
+/**
+ * v2xstat_Add()
+ * 카운터를 n만큼 증가시킨다. 게이지면 현재값을 n만큼 증감한다.
+ */
+void v2xstat_Add(const struct v2xstatDesc_t *m, int64_t n)
+{
+	struct v2xstatShm_t *shm = __atomic_load_n(&g_v2xstat, __ATOMIC_ACQUIRE);
+	int slot;
+	int64_t *p;
+
+	if(m->type == v2xstatGauge){
+		__atomic_fetch_add(&shm->slot[0].cell[m->cell], n, __ATOMIC_RELAXED);
+		return;
+	}
+	slot = v2xstat_Slot(shm);
+	p = &shm->slot[slot].cell[m->cell];
+	if(slot == 0)
+		__atomic_fetch_add(p, n, __ATOMIC_RELAXED);
+	else
+		__atomic_store_n(p, __atomic_load_n(p, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+/**
+ * v2xstat_Set()
+ * 게이지의 현재값을 기록한다.
+ */
+void v2xstat_Set(const struct v2xstatDesc_t *m, int64_t v)
+{
+	struct v2xstatShm_t *shm = __atomic_load_n(&g_v2xstat, __ATOMIC_ACQUIRE);
+
+	__atomic_store_n(&shm->slot[0].cell[m->cell], v, __ATOMIC_RELAXED);
+}
+
+/**
+ * v2xstat_Observe()
+ * 히스토그램에 값을 하나 더한다.
+ */
+void v2xstat_Observe(const struct v2xstatDesc_t *m, int64_t v)
+{
+	struct v2xstatShm_t *shm = __atomic_load_n(&g_v2xstat, __ATOMIC_ACQUIRE);
+	int slot, b = 0;
+	int64_t *p;
+
+	while(b < m->nbounds && v > m->bounds[b])
+		b++;
+	slot = v2xstat_Slot(shm);
+	p = &shm->slot[slot].cell[m->cell];
+	if(slot == 0){
+		__atomic_fetch_add(&p[b], 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&p[m->nbounds + 1], v, __ATOMIC_RELAXED);
+	}
+	else{
+		__atomic_store_n(&p[b], __atomic_load_n(&p[b], __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+		__atomic_store_n(&p[m->nbounds + 1], __atomic_load_n(&p[m->nbounds + 1], __ATOMIC_RELAXED) + v, __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * v2xstat_Value()
+ * 값 하나를 읽는다. (v2xtop) - 모든 슬롯의 합
+ *
+ * @param cell  struct v2xstatDesc_t의 cell (히스토그램은 cell + 구간 번호, 합은 cell + nbounds + 1)
+ */
+int64_t v2xstat_Value(const struct v2xstatShm_t *shm, int cell)
+{
+	int64_t sum = 0;
+
+	if(cell < 0 || cell >= V2XSTAT_CELL_MAX)
+		return 0;
+	for(int i = 0; i < V2XSTAT_SLOT_MAX; i++)
+		sum += __atomic_load_n(&shm->slot[i].cell[cell], __ATOMIC_RELAXED);
+	return sum;
+}
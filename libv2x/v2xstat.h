@@ -0,0 +1,86 @@
+/**********************************************************
+  [공유메모리 통계]
+  데몬의 카운터/게이지/히스토그램을 이름 붙은 공유메모리(v2xstat_Key())에 둔다.
+  - v2xtop이 공유메모리를 읽어 초당 증가량과 백분위수를 보여 주고 JSON으로 저장한다.
+  - 카운터와 히스토그램은 쓰레드 별 슬롯에 기록한다. 슬롯에는 그 쓰레드만 쓰므로 원자적 연산이나
+    잠금이 필요 없다. 읽는 쪽은 모든 슬롯을 더한다. (슬롯이 부족하면 공용 슬롯 0에 원자적으로 더한다)
+  - 게이지는 현재값 하나이므로 슬롯 0에 원자적으로 기록한다.
+  - 등록은 초기화 때 한 번만 한다. 등록한 통계는 지울 수 없다.
+ ************************************************************/
+
+#ifndef V2XSTAT_H
+#define V2XSTAT_H
+
+#include <stdint.h>
+#include <sys/ipc.h>
+
+#define V2XSTAT_MAGIC 0x56325354 //"V2ST"
+#define V2XSTAT_VERSION 1
+#define V2XSTAT_NAME_MAX 16 //데몬 이름
+#define V2XSTAT_METRIC_NAME_MAX 32 //통계 이름 ("<분류>.<이름>")
+#define V2XSTAT_UNIT_MAX 8
+#define V2XSTAT_METRIC_MAX 128 //등록 가능한 통계 수
+#define V2XSTAT_BOUND_MAX 15 //히스토그램 구간 경계 수 (구간은 경계 수 + 1)
+#define V2XSTAT_CELL_MAX 1024 //슬롯 당 값 수
+#define V2XSTAT_SLOT_MAX 32 //슬롯 수 (0은 공용 슬롯)
+
+/* 처리시간(usec) 히스토그램 기본 구간 - static const int64_t b[] = V2XSTAT_USEC_BOUNDS; */
+#define V2XSTAT_USEC_BOUNDS { 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000 }
+
+/* 통계 종류 */
+enum {
+	v2xstatCounter = 1, //누적 증가값
+	v2xstatGauge, //현재값
+	v2xstatHist, //분포 - 구간 별 개수와 합
+};
+
+/* 통계 정의 - 값은 슬롯의 cell 번째부터 (카운터/게이지 1개, 히스토그램 구간 수 + 1개(합)) */
+struct v2xstatDesc_t{
+	char name[V2XSTAT_METRIC_NAME_MAX];
+	char unit[V2XSTAT_UNIT_MAX];
+	uint8_t type;
+	uint8_t nbounds;
+	uint16_t cell;
+	uint32_t reserved;
+	int64_t bounds[V2XSTAT_BOUND_MAX]; //구간 상한 (값 <= bounds[i]이면 i번째 구간, 모두 넘으면 nbounds번째 구간)
+};
+
+/* 쓰레드 별 슬롯 */
+struct v2xstatSlot_t{
+	int32_t tid; //사용 중인 쓰레드 ID (0: 비어 있음) - 쓰레드가 끝나면 비우고 값은 다음 쓰레드가 이어서 쓴다.
+	uint32_t reserved;
+	int64_t cell[V2XSTAT_CELL_MAX] __attribute__((aligned(64)));
+};
+
+/* 공유메모리 */
+struct v2xstatShm_t{
+	uint32_t magic; //초기화가 끝나면 기록한다.
+	uint32_t version;
+	int32_t pid; //0: 종료됨
+	uint32_t nmetric; //등록된 통계 수 - 정의를 다 채운 뒤 증가시킨다.
+	uint64_t start; //시작시각 (nsec, CLOCK_REALTIME)
+	char name[V2XSTAT_NAME_MAX];
+	struct v2xstatDesc_t desc[V2XSTAT_METRIC_MAX];
+	struct v2xstatSlot_t slot[V2XSTAT_SLOT_MAX] __attribute__((aligned(64)));
+};
+
+int v2xstat_Init(const char *name);
+void v2xstat_Close(void);
+key_t v2xstat_Key(const char *name);
+
+/* 등록 - 초기화 때 한 번 호출하고 돌려받은 통계로 기록한다. (실패해도 NULL을 돌려주지 않는다) */
+const struct v2xstatDesc_t *v2xstat_Counter(const char *name, const char *unit);
+const struct v2xstatDesc_t *v2xstat_Gauge(const char *name, const char *unit);
+const struct v2xstatDesc_t *v2xstat_Hist(const char *name, const char *unit, const int64_t *bounds, int nbounds);
+
+/* 기록 - 핫패스에서 사용한다. v2xstat_Add()는 게이지에도 사용할 수 있다. (증감) */
+void v2xstat_Add(const struct v2xstatDesc_t *m, int64_t n);
+void v2xstat_Set(const struct v2xstatDesc_t *m, int64_t v);
+void v2xstat_Observe(const struct v2xstatDesc_t *m, int64_t v);
+
+/* 읽기 (v2xtop) */
+int64_t v2xstat_Value(const struct v2xstatShm_t *shm, int cell);
+
+#define v2xstat_Inc(m) v2xstat_Add((m), 1)
+
+#endif //V2XSTAT_H
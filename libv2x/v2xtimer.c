@@ -0,0 +1,275 @@
+/**********************************************************
+  [송신 주기 타이머]
+  timer_create(CLOCK_REALTIME, SIGEV_THREAD)는 만기마다 통지 쓰레드를 만들고, 시스템 시각이
+  바뀌면(timeSync의 date 설정) 만기가 앞당겨지거나 밀린다. 또 만기를 condvar 시그널로만 알리므로
+  대기 전에 온 시그널과 겹친 만기가 사라진다.
+
+  여기서는 timerfd(CLOCK_MONOTONIC)를 사용한다.
+  - 첫 만기를 절대시각(TFD_TIMER_ABSTIME)으로 걸고 커널 주기로 반복하므로 주기가 밀리지 않는다.
+  - read()가 지난 호출 이후의 만기 횟수를 돌려주므로 놓친 주기 수를 정확히 센다.
+  - 콜백은 타이머 전용 쓰레드에서 호출한다. (시그널은 받지 않는다)
+  - 만기시각 대비 깨어난 지연(지터)과 놓친 주기 수를 TX_TIMER_REPORT_SEC 마다, 그리고 해제 시 남긴다.
+ ************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <syslog.h>
+#include <time.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include "v2xtimer.h"
+
+/* syslog facility - 라이브러리를 빌드하는 프로젝트가 지정한다. (libv2x/CMakeLists.txt V2X_SYSLOG_INFO/ERR) */
+#ifndef V2X_SYSLOG_INFO
+#define V2X_SYSLOG_INFO LOG_LOCAL0
+#endif
+#ifndef V2X_SYSLOG_ERR
+#define V2X_SYSLOG_ERR LOG_LOCAL1
+#endif
+#define TX_TIMER_LOG_INFO (LOG_INFO | V2X_SYSLOG_INFO)
+#define TX_TIMER_LOG_ERR (LOG_ERR | V2X_SYSLOG_ERR)
+#define TX_TIMER_REPORT_SEC 60 //통계 출력 주기 (sec)
+
+struct txTimer_t{
+	char name[16]; //로그 접두어
+	int tfd; //timerfd
+	int efd; //종료 알림 eventfd
+	uint64_t period; //주기 (nsec)
+	uint64_t start; //첫 만기시각 (nsec, CLOCK_MONOTONIC)
+	uint64_t expired; //지금까지의 만기 수
+	txTimerFn_t fn;
+	void *arg;
+	pthread_t thread;
+
+	/* 통계 - 타이머 쓰레드가 갱신, GetTxTimerStat()이 읽는다. */
+	pthread_mutex_t mtx;
+	uint64_t ticks;
+	uint64_t missed;
+	uint64_t jitterSum;
+	uint64_t jitterMax;
+
+	/* 주기 출력 구간 통계 (타이머 쓰레드) */
+	uint64_t winStart;
+	uint64_t winTicks;
+	uint64_t winMissed;
+	uint64_t winJitterSum;
+	uint64_t winJitterMax;
+};
+
+
+/**
+ * TxTimerNow()
+ * CLOCK_MONOTONIC 현재시각 (nsec)
+ */
+static uint64_t TxTimerNow(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * TxTimerExpired()
+ * 만기 처리 - 지터와 놓친 주기를 집계하고 콜백을 호출한다. (타이머 쓰레드)
+ * @param n 지난 호출 이후의 만기 수
+ */
+static void TxTimerExpired(struct txTimer_t *t, uint64_t n)
+{
+	uint64_t now, deadline, jitter;
+
+	now = TxTimerNow();
+	t->expired += n;
+	deadline = t->start + (t->expired - 1) * t->period; //가장 최근 만기시각
+	jitter = (now > deadline) ? now - deadline : 0;
+
+	t->fn(n - 1, t->arg);
+
+	pthread_mutex_lock(&t->mtx);
+	t->ticks++;
+	t->missed += n - 1;
+	t->jitterSum += jitter;
+	if(jitter > t->jitterMax)
+		t->jitterMax = jitter;
+	pthread_mutex_unlock(&t->mtx);
+
+	t->winTicks++;
+	t->winMissed += n - 1;
+	t->winJitterSum += jitter;
+	if(jitter > t->winJitterMax)
+		t->winJitterMax = jitter;
+
+	if(now - t->winStart >= TX_TIMER_REPORT_SEC * 1000000000ULL)
+	{
+		syslog(TX_TIMER_LOG_INFO, "[%s] Tx timer : ticks %llu, missed %llu, jitter avg %lluus max %lluus\n",
+				t->name, (unsigned long long)t->winTicks, (unsigned long long)t->winMissed,
+				(unsigned long long)(t->winJitterSum / t->winTicks / 1000), (unsigned long long)(t->winJitterMax / 1000));
+		t->winStart = now;
+		t->winTicks = t->winMissed = t->winJitterSum = t->winJitterMax = 0;
+	}
+}
+
+/**
+ * TxTimerThread()
+ * 타이머 쓰레드 - 종료 알림이 올 때까지 만기마다 TxTimerExpired()를 호출한다.
+ */
+static void* TxTimerThread(void *arg)
+{
+	struct txTimer_t *t = (struct txTimer_t*)arg;
+	struct pollfd pfd[2];
+	uint64_t n;
+
+	pfd[0].fd = t->tfd;
+	pfd[0].events = POLLIN;
+	pfd[1].fd = t->efd;
+	pfd[1].events = POLLIN;
+
+	while(1)
+	{
+		if(poll(pfd, 2, -1) < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			syslog(TX_TIMER_LOG_ERR, "[%s] Tx timer poll() fail : %s\n", t->name, strerror(errno));
+			break;
+		}
+		if(pfd[1].revents & POLLIN)
+			break;
+		if((pfd[0].revents & POLLIN) && read(t->tfd, &n, sizeof(n)) == sizeof(n) && n > 0)
+			TxTimerExpired(t, n);
+	}
+
+	pthread_exit((void *)0);
+}
+
+/**
+ * InitTxTimer()
+ * 송신 주기 타이머를 생성하고 타이머 쓰레드를 시작한다. 첫 만기는 1msec 후이다.
+ *
+ * @param name      로그 접두어
+ * @param interval  송신주기(usec)
+ * @param fn        주기마다 타이머 쓰레드에서 호출할 함수
+ * @return          성공 시 타이머, 실패 시 NULL
+ */
+struct txTimer_t *InitTxTimer(const char *name, const uint32_t interval, txTimerFn_t fn, void *arg)
+{
+	struct txTimer_t *t;
+	struct itimerspec ts;
+	sigset_t set, old;
+	int ret;
+
+	printf("Initializing tx timer - interval: %uusec\n", interval);
+
+	if(interval == 0)
+		return NULL;
+
+	t = (struct txTimer_t*)calloc(1, sizeof(struct txTimer_t));
+	if(t == NULL)
+	{
+		syslog(TX_TIMER_LOG_ERR, "[%s] Fail to allocate tx timer\n", name);
+		return NULL;
+	}
+	strncpy(t->name, name, sizeof(t->name) - 1);
+	t->period = (uint64_t)interval * 1000;
+	t->fn = fn;
+	t->arg = arg;
+	pthread_mutex_init(&t->mtx, NULL);
+
+	t->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	t->efd = eventfd(0, EFD_CLOEXEC);
+	if(t->tfd < 0 || t->efd < 0)
+	{
+		syslog(TX_TIMER_LOG_ERR, "[%s] Fail to create timer : %s\n", name, strerror(errno));
+		goto fail;
+	}
+
+	/*
+	 * 첫 만기를 절대시각으로 걸고 이후 커널 주기로 반복한다.
+	 */
+	t->start = TxTimerNow() + 1000000;
+	t->winStart = t->start;
+	ts.it_value.tv_sec = t->start / 1000000000ULL;
+	ts.it_value.tv_nsec = t->start % 1000000000ULL;
+	ts.it_interval.tv_sec = interval / 1000000;
+	ts.it_interval.tv_nsec = (interval % 1000000) * 1000;
+	if(timerfd_settime(t->tfd, TFD_TIMER_ABSTIME, &ts, NULL) < 0)
+	{
+		syslog(TX_TIMER_LOG_ERR, "[%s] Fail to set timer : %s\n", name, strerror(errno));
+		goto fail;
+	}
+
+	/*
+	 * 타이머 쓰레드는 시그널을 받지 않는다. (SIGINT는 다른 쓰레드가 받아 종료를 처리한다)
+	 */
+	sigfillset(&set);
+	pthread_sigmask(SIG_BLOCK, &set, &old);
+	ret = pthread_create(&t->thread, NULL, TxTimerThread, t);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if(ret != 0)
+	{
+		syslog(TX_TIMER_LOG_ERR, "[%s] Fail to create tx timer thread\n", name);
+		goto fail;
+	}
+
+	printf("Success to initialize tx timer.\n");
+	return t;
+
+fail:
+	if(t->tfd >= 0)
+		close(t->tfd);
+	if(t->efd >= 0)
+		close(t->efd);
+	pthread_mutex_destroy(&t->mtx);
+	free(t);
+	return NULL;
+}
+
+/**
+ * GetTxTimerStat()
+ * 타이머 시작 이후의 통계를 읽는다.
+ */
+void GetTxTimerStat(struct txTimer_t *t, struct txTimerStat_t *stat)
+{
+	pthread_mutex_lock(&t->mtx);
+	stat->ticks = t->ticks;
+	stat->missed = t->missed;
+	stat->jitterAvg = (t->ticks != 0) ? t->jitterSum / t->ticks : 0;
+	stat->jitterMax = t->jitterMax;
+	pthread_mutex_unlock(&t->mtx);
+}
+
+/**
+ * ReleaseTxTimer()
+ * 타이머 쓰레드를 멈추고 통계를 남긴 뒤 해제한다. 반환 후에는 콜백이 호출되지 않는다.
+ * @param stat 최종 통계를 받을 곳 (NULL이면 받지 않는다)
+ */
+void ReleaseTxTimer(struct txTimer_t *t, struct txTimerStat_t *stat)
+{
+	struct txTimerStat_t last;
+	uint64_t one = 1;
+
+	if(t == NULL)
+		return;
+
+	if(write(t->efd, &one, sizeof(one)) < 0)
+		syslog(TX_TIMER_LOG_ERR, "[%s] Tx timer eventfd write fail : %s\n", t->name, strerror(errno));
+	pthread_join(t->thread, NULL);
+
+	GetTxTimerStat(t, &last);
+	syslog(TX_TIMER_LOG_INFO, "[%s] Tx timer total : ticks %llu, missed %llu, jitter avg %lluus max %lluus\n",
+			t->name, (unsigned long long)last.ticks, (unsigned long long)last.missed,
+			(unsigned long long)(last.jitterAvg / 1000), (unsigned long long)(last.jitterMax / 1000));
+	if(stat != NULL)
+		*stat = last;
+
+	close(t->tfd);
+	close(t->efd);
+	pthread_mutex_destroy(&t->mtx);
+	free(t);
+}
@@ -0,0 +1,31 @@
+//
+// 송신 주기 타이머
+//  - timerfd(CLOCK_MONOTONIC)에 절대시각으로 첫 만기를 걸고 주기마다 전용 쓰레드에서 콜백을 호출한다.
+//  - 시스템 시각 변경(timeSync의 date 설정)에 영향을 받지 않는다.
+//  - 콜백이 늦어 여러 주기가 한 번에 만기되면 콜백은 한 번만 호출하고 놓친 주기 수를 넘긴다.
+//  - 주기마다 만기시각 대비 깨어난 시각의 지연(지터)과 놓친 주기 수를 집계한다.
+//
+
+#ifndef V2XTIMER_H
+#define V2XTIMER_H
+
+#include <stdint.h>
+
+/* 송신 주기 타이머 통계 */
+struct txTimerStat_t{
+	uint64_t ticks; //콜백 호출 수
+	uint64_t missed; //놓친 주기 수
+	uint64_t jitterAvg; //만기시각 대비 깨어난 지연 평균 (nsec)
+	uint64_t jitterMax; //최대 지연 (nsec)
+};
+
+struct txTimer_t;
+
+/* 콜백 - missed : 직전 호출 이후 놓친 주기 수 */
+typedef void (*txTimerFn_t)(uint64_t missed, void *arg);
+
+struct txTimer_t *InitTxTimer(const char *name, const uint32_t interval, txTimerFn_t fn, void *arg);
+void ReleaseTxTimer(struct txTimer_t *t, struct txTimerStat_t *stat);
+void GetTxTimerStat(struct txTimer_t *t, struct txTimerStat_t *stat);
+
+#endif //V2XTIMER_H
@@ -0,0 +1,250 @@
+/**********************************************************
+  [종단간 지연 추적]
+  v2xtrace_Stamp()는 추적정보에 단계 시각을 적고 같은 내용을 공유메모리 링에 남긴다.
+  - 링은 여러 쓰레드가 함께 쓴다. head를 원자적으로 증가시켜 슬롯을 얻고, 슬롯의 seq를 0으로
+    만든 뒤 내용을 쓰고 마지막에 seq를 기록한다. (읽는 쪽은 seq가 앞뒤로 같을 때만 사용한다)
+  - 링이 돌면 가장 오래된 이벤트를 덮어쓴다. 추적하지 않는 메시지(magic == 0)는 기록하지 않는다.
+  - 링은 프로세스가 끝나도 지우지 않는다. 종료 후에도 v2xtrace로 수집할 수 있고 다음 실행 때 초기화된다.
+    같은 이름의 프로세스가 실행 중이면(한 장치에서 송수신 prcsJ2735를 함께 실행) 초기화하지 않고 함께 쓴다.
+ ************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <syslog.h>
+#include <time.h>
+#include <sys/shm.h>
+#include "v2xtrace.h"
+
+/* syslog facility - 라이브러리를 빌드하는 프로젝트가 지정한다. (libv2x/CMakeLists.txt V2X_SYSLOG_INFO/ERR) */
+#ifndef V2X_SYSLOG_INFO
+#define V2X_SYSLOG_INFO LOG_LOCAL0
+#endif
+#ifndef V2X_SYSLOG_ERR
+#define V2X_SYSLOG_ERR LOG_LOCAL1
+#endif
+#define V2XTRACE_LOG_INFO (LOG_INFO | V2X_SYSLOG_INFO)
+#define V2XTRACE_LOG_ERR (LOG_ERR | V2X_SYSLOG_ERR)
+#define V2XTRACE_RING_MASK (V2XTRACE_RING_LEN - 1)
+
+static struct v2xtraceRing_t *g_v2xtraceRing = NULL;
+static uint32_t g_v2xtraceId = 0;
+
+static const char *g_v2xtraceStageName[v2xtraceStage_Num] = {
+	"gpsdRead", "rtcmPkt", "construct", "mqTx", "mqTxRecv", "dot3",
+	"radio", "obuRx", "mqRx", "mqRxRecv", "decode", "gpsdWrite"
+};
+
+
+/**
+ * v2xtrace_Key()
+ * 링 공유메모리 키 - 이름의 FNV-1a 해시
+ */
+key_t v2xtrace_Key(const char *name)
+{
+	uint32_t h = 2166136261U;
+
+	while(*name != '\0')
+		h = (h ^ (uint8_t)*name++) * 16777619U;
+	return (key_t)(0x54000000 | (h & 0x00ffffff));
+}
+
+/**
+ * v2xtrace_Now()
+ * CLOCK_REALTIME 현재시각 (nsec)
+ */
+uint64_t v2xtrace_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * v2xtrace_StageName()
+ * 단계 이름 (로그, 수집 도구 출력용)
+ */
+const char *v2xtrace_StageName(int stage)
+{
+	if(stage < 0 || stage >= v2xtraceStage_Num)
+		return "unknown";
+	return g_v2xtraceStageName[stage];
+}
+
+/**
+ * v2xtrace_Init()
+ * 링 공유메모리를 만들고 초기화한다.
+ * 실패해도 추적정보는 다음 프로세스로 전달되며 이 프로세스의 링 기록만 빠진다.
+ *
+ * @param name  데몬 이름 (공유메모리 키)
+ * @return      성공 시 0, 실패 시 -1
+ */
+int v2xtrace_Init(const char *name)
+{
+	struct v2xtraceRing_t *ring;
+	key_t key = v2xtrace_Key(name);
+	int shmid;
+
+	if(g_v2xtraceRing != NULL)
+		return 0;
+	g_v2xtraceId = (uint32_t)(v2xtrace_Now() / 1000);
+
+	shmid = shmget(key, sizeof(struct v2xtraceRing_t), 0666 | IPC_CREAT);
+	if(shmid < 0 && errno == EINVAL){
+		/* 크기가 다른 이전 버전의 링 - 지우고 다시 만든다. */
+		shmid = shmget(key, 0, 0666);
+		if(shmid >= 0)
+			shmctl(shmid, IPC_RMID, NULL);
+		shmid = shmget(key, sizeof(struct v2xtraceRing_t), 0666 | IPC_CREAT);
+	}
+	if(shmid < 0 || (ring = (struct v2xtraceRing_t*)shmat(shmid, NULL, 0)) == (void*)-1){
+		syslog(V2XTRACE_LOG_ERR, "[v2xtrace] Fail to attach trace ring : %s\n", strerror(errno));
+		return -1;
+	}
+
+	if(ring->magic == V2XTRACE_MAGIC && ring->len == V2XTRACE_RING_LEN && ring->pid > 0 && kill(ring->pid, 0) == 0){
+		g_v2xtraceRing = ring;
+		syslog(V2XTRACE_LOG_INFO, "[v2xtrace] Share trace ring 0x%08x with pid %d\n", (unsigned int)key, ring->pid);
+		return 0;
+	}
+	memset(ring, 0, sizeof(struct v2xtraceRing_t));
+	ring->len = V2XTRACE_RING_LEN;
+	ring->pid = getpid();
+	snprintf(ring->name, sizeof(ring->name), "%s", name);
+	__atomic_store_n(&ring->magic, V2XTRACE_MAGIC, __ATOMIC_RELEASE);
+	g_v2xtraceRing = ring;
+
+	syslog(V2XTRACE_LOG_INFO, "[v2xtrace] Trace ring 0x%08x, %u events\n", (unsigned int)key, V2XTRACE_RING_LEN);
+	return 0;
+}
+
+/**
+ * v2xtrace_Close()
+ * 링에서 분리한다. (링은 수집을 위해 남겨 둔다)
+ */
+void v2xtrace_Close(void)
+{
+	struct v2xtraceRing_t *ring = g_v2xtraceRing;
+
+	if(ring == NULL)
+		return;
+	g_v2xtraceRing = NULL;
+	syslog(V2XTRACE_LOG_INFO, "[v2xtrace] Closed, %llu events\n", (unsigned long long)ring->head);
+	if(ring->pid == getpid())
+		ring->pid = 0;
+	shmdt(ring);
+}
+
+/**
+ * v2xtrace_Record()
+ * 추적정보를 링에 남긴다.
+ */
+static void v2xtrace_Record(const struct v2xtraceCtx_t *ctx, int stage)
+{
+	struct v2xtraceRing_t *ring = g_v2xtraceRing;
+	struct v2xtraceEvt_t *e;
+	struct timespec ts;
+	uint64_t seq;
+
+	if(ring == NULL)
+		return;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	seq = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+	e = &ring->evt[seq & V2XTRACE_RING_MASK];
+	__atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	e->mono = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	e->stage = (uint8_t)stage;
+	e->ctx = *ctx;
+	__atomic_store_n(&e->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * v2xtrace_Begin()
+ * 새 추적정보를 만든다. 첫 단계는 호출측이 v2xtrace_StampAt()으로 기록한다.
+ *
+ * @param now   첫 단계 시각 (nsec, CLOCK_REALTIME)
+ */
+void v2xtrace_Begin(struct v2xtraceCtx_t *ctx, uint64_t now)
+{
+	memset(ctx, 0, sizeof(struct v2xtraceCtx_t));
+	ctx->magic = V2XTRACE_MAGIC;
+	ctx->id = __atomic_add_fetch(&g_v2xtraceId, 1, __ATOMIC_RELAXED);
+	ctx->origin = now;
+}
+
+/**
+ * v2xtrace_StampAt()
+ * 단계 시각을 기록한다. 추적하지 않는 메시지면 아무것도 하지 않는다.
+ *
+ * @param now   단계 시각 (nsec, CLOCK_REALTIME)
+ */
+void v2xtrace_StampAt(struct v2xtraceCtx_t *ctx, int stage, uint64_t now)
+{
+	if(!V2XTRACE_VALID(ctx) || stage < 0 || stage >= v2xtraceStage_Num)
+		return;
+	ctx->stamp[stage] = (int32_t)(((int64_t)(now - ctx->origin)) / 1000);
+	ctx->mask |= (uint16_t)(1U << stage);
+	v2xtrace_Record(ctx, stage);
+}
+
+/**
+ * v2xtrace_Stamp()
+ * 현재시각으로 단계 시각을 기록한다.
+ */
+void v2xtrace_Stamp(struct v2xtraceCtx_t *ctx, int stage)
+{
+	if(!V2XTRACE_VALID(ctx))
+		return;
+	v2xtrace_StampAt(ctx, stage, v2xtrace_Now());
+}
+
+/**
+ * v2xtrace_AppendTrailer()
+ * WSM 페이로드 뒤에 추적정보 트레일러를 붙인다.
+ *
+ * @param buf   페이로드
+ * @param len   페이로드 길이
+ * @param size  buf 크기
+ * @return      트레일러를 포함한 길이 (추적하지 않거나 공간이 없으면 len)
+ */
+int v2xtrace_AppendTrailer(const struct v2xtraceCtx_t *ctx, uint8_t *buf, int len, int size)
+{
+	struct v2xtraceTrailer_t t;
+
+	if(!V2XTRACE_VALID(ctx) || len + (int)sizeof(t) > size)
+		return len;
+	memset(&t, 0, sizeof(t));
+	t.ctx = *ctx;
+	t.magic = V2XTRACE_TRAILER_MAGIC;
+	memcpy(buf + len, &t, sizeof(t));
+	return len + (int)sizeof(t);
+}
+
+/**
+ * v2xtrace_StripTrailer()
+ * 수신한 WSM 페이로드 끝의 추적정보 트레일러를 떼어 낸다.
+ *
+ * @param ctx   추적정보가 저장될 변수 (트레일러가 없으면 magic이 0)
+ * @param buf   페이로드
+ * @param len   페이로드 길이 - 트레일러가 있으면 트레일러를 뺀 길이로 바뀐다.
+ * @return      트레일러가 있으면 1, 없으면 0
+ */
+int v2xtrace_StripTrailer(struct v2xtraceCtx_t *ctx, const uint8_t *buf, int *len)
+{
+	struct v2xtraceTrailer_t t;
+
+	ctx->magic = 0;
+	if(*len < (int)sizeof(t))
+		return 0;
+	memcpy(&t, buf + *len - sizeof(t), sizeof(t));
+	if(t.magic != V2XTRACE_TRAILER_MAGIC || !V2XTRACE_VALID(&t.ctx))
+		return 0;
+	*ctx = t.ctx;
+	*len -= (int)sizeof(t);
+	return 1;
+}
@@ -0,0 +1,90 @@
+/**********************************************************
+  [종단간 지연 추적]
+  RTCM 보정정보가 RSU gpsd부터 OBU gpsd까지 거치는 단계 별 시각을 기록한다.
+  - 추적정보(struct v2xtraceCtx_t)는 메시지큐 프레임(msgQ_elem_frame.trace)으로 다음 프로세스에 전달된다.
+    magic이 0이면 추적하지 않는 메시지다.
+  - 무선구간은 시험용으로만 WSM 페이로드 뒤의 트레일러로 전달한다. 트레일러는 실제로 송신되므로
+    RSU/OBU prcsWSM 모두 -T 옵션을 준 경우에만 붙이고 뗀다. (기본은 꺼짐 - OBU 단계는 추적되지 않는다)
+  - 단계 시각은 CLOCK_REALTIME(timeSync로 GPS에 동기)이므로 RSU와 OBU의 시각을 비교할 수 있다.
+  - 각 프로세스는 단계마다 추적정보 전체와 CLOCK_MONOTONIC 시각을 공유메모리 링(v2xtrace_Key())에 남긴다.
+    수집은 v2xtrace 도구가 한다. (단계 별 지연 히스토그램, Chrome trace JSON)
+ ************************************************************/
+
+#ifndef V2XTRACE_H
+#define V2XTRACE_H
+
+#include <stdint.h>
+#include <sys/ipc.h>
+
+#define V2XTRACE_MAGIC 0x56325452 //"V2TR"
+#define V2XTRACE_TRAILER_MAGIC 0x54524c52 //"TRLR" - WSM 트레일러 끝 표시
+#define V2XTRACE_NAME_MAX 16
+#define V2XTRACE_RING_LEN 4096 //공유메모리 링 이벤트 수 (2의 거듭제곱)
+
+/* 추적 단계 - 순서대로 지난다. */
+enum {
+	v2xtraceStage_GpsdRead, //RSU prcsJ2735: gpsd 보고 수신
+	v2xtraceStage_RtcmPkt, //RSU prcsJ2735: rtcmPkt() 저장
+	v2xtraceStage_Construct, //RSU prcsJ2735: ConstructRTCM() 인코딩
+	v2xtraceStage_MqTx, //RSU prcsJ2735: 송신 메시지큐(1717) 넣음
+	v2xtraceStage_MqTxRecv, //RSU prcsWSM: 송신 메시지큐(1717) 꺼냄
+	v2xtraceStage_Dot3, //RSU prcsWSM: AC 송신큐에서 꺼내 WSM MPDU 생성
+	v2xtraceStage_Radio, //RSU prcsWSM: Al_TransmitMpdu() 완료 (링에만 기록, 트레일러 생성 이후)
+	v2xtraceStage_ObuRx, //OBU prcsWSM: 수신 (수신 콜백 시각)
+	v2xtraceStage_MqRx, //OBU prcsWSM: 수신 메시지큐(1716) 넣음
+	v2xtraceStage_MqRxRecv, //OBU prcsJ2735: 수신 메시지큐(1716) 꺼냄
+	v2xtraceStage_Decode, //OBU prcsJ2735: rxJ2735 디코딩
+	v2xtraceStage_GpsdWrite, //OBU prcsJ2735: gpsd 쓰기
+	v2xtraceStage_Num
+};
+
+/* 추적정보 - 메시지큐 프레임과 WSM 트레일러에 그대로 실린다. */
+struct v2xtraceCtx_t{
+	uint32_t magic; //V2XTRACE_MAGIC이면 유효
+	uint32_t id;
+	uint64_t origin; //첫 단계 시각 (nsec, CLOCK_REALTIME)
+	uint16_t mask; //기록된 단계 (1 << stage)
+	uint16_t reserved;
+	int32_t stamp[v2xtraceStage_Num]; //단계 별 시각 (origin 기준 usec, 다른 장치의 시각은 음수일 수 있다)
+};
+
+/* WSM 트레일러 - 페이로드 뒤에 붙는다. */
+struct v2xtraceTrailer_t{
+	struct v2xtraceCtx_t ctx;
+	uint32_t magic; //V2XTRACE_TRAILER_MAGIC
+};
+
+/* 공유메모리 링 이벤트 - seq가 0이거나 바뀌었으면 기록 중인 이벤트다. */
+struct v2xtraceEvt_t{
+	uint64_t seq; //링 순번 + 1
+	uint64_t mono; //기록시각 (nsec, CLOCK_MONOTONIC)
+	uint8_t stage;
+	uint8_t reserved[7];
+	struct v2xtraceCtx_t ctx; //stage까지 기록된 추적정보
+};
+
+/* 공유메모리 링 */
+struct v2xtraceRing_t{
+	uint32_t magic;
+	uint32_t len; //V2XTRACE_RING_LEN
+	int32_t pid;
+	uint32_t reserved;
+	char name[V2XTRACE_NAME_MAX];
+	uint64_t head __attribute__((aligned(64))); //다음에 기록할 순번
+	struct v2xtraceEvt_t evt[V2XTRACE_RING_LEN] __attribute__((aligned(64)));
+};
+
+#define V2XTRACE_VALID(ctx) ((ctx)->magic == V2XTRACE_MAGIC)
+
+int v2xtrace_Init(const char *name);
+void v2xtrace_Close(void);
+key_t v2xtrace_Key(const char *name);
+uint64_t v2xtrace_Now(void);
+void v2xtrace_Begin(struct v2xtraceCtx_t *ctx, uint64_t now);
+void v2xtrace_StampAt(struct v2xtraceCtx_t *ctx, int stage, uint64_t now);
+void v2xtrace_Stamp(struct v2xtraceCtx_t *ctx, int stage);
+int v2xtrace_AppendTrailer(const struct v2xtraceCtx_t *ctx, uint8_t *buf, int len, int size);
+int v2xtrace_StripTrailer(struct v2xtraceCtx_t *ctx, const uint8_t *buf, int *len);
+const char *v2xtrace_StageName(int stage);
+
+#endif //V2XTRACE_H
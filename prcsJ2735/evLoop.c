@@ -0,0 +1,501 @@
+/****************************************************************************************
+  [이벤트 루프]
+  prcsJ2735의 모든 입력(송신 타이머, gpsd 소켓, UDP 소켓, 메시지큐)을 epoll 하나로 처리한다.
+
+  - fd 등록     : evAdd() / evDel(), 준비된 fd의 핸들러를 루프 쓰레드에서 호출한다.
+  - 주기 타이머 : evTimer(), timerfd(CLOCK_MONOTONIC)를 사용하며 만기 횟수를 읽으므로
+                  루프가 늦어져도 만기가 사라지지 않는다. (evTimerRead() 참조)
+  - 작업 큐     : evPost()는 다른 쓰레드에서 루프 쓰레드로 작업을 넘긴다. (eventfd로 깨운다)
+                  evOffloadWait()는 --worker 옵션이 있으면 작업 쓰레드에서, 없으면 루프 쓰레드에서
+                  작업(인코딩/디코딩)을 실행하며, 큐가 가득 차면 빈 슬롯이 생길 때까지 기다린다.
+ ****************************************************************************************/
+
+#include <prcsJ2735.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define EV_FD_MAX 16        /* 등록 가능한 최대 fd 수 */
+#define EV_QUEUE_LEN 64     /* 작업 큐 길이 */
+#define EV_JOB_MAX (4096 + sizeof(struct v2xtraceCtx_t))   /* 작업 데이터 최대 크기 (추적정보 + MSGMAX) */
+
+/* 등록된 fd */
+typedef struct
+{
+    int fd;
+    uint32_t gen;           /* 재사용된 슬롯의 지난 이벤트를 거르기 위한 세대번호 */
+    evHandler_t fn;
+    void *arg;
+} evFd_t;
+
+/* 작업 */
+typedef struct
+{
+    evJob_t fn;
+    uint32_t len;
+    uint64_t putTime;       /* 큐에 넣은 시각 (usec, CLOCK_MONOTONIC) */
+    uint8_t data[EV_JOB_MAX];
+} evSlot_t;
+
+/* 작업 큐 - 생산자 여럿, 소비자 하나 */
+typedef struct
+{
+    int efd;
+    pthread_mutex_t mtx;
+    pthread_cond_t space;   /* 소비자가 슬롯을 비웠음 (evQueuePut(wait)) */
+    uint32_t head;
+    uint32_t tail;
+    uint32_t drop;          /* 큐가 가득 차 버린 작업 수 */
+    uint32_t dropReported;
+    const struct v2xstatDesc_t *statDepth;  /* 공유메모리 통계 - 쌓인 작업 수 */
+    const struct v2xstatDesc_t *statDrop;   /* 큐가 가득 차 버린 작업 수 */
+    const struct v2xstatDesc_t *statWait;   /* 큐에서 기다린 시간(usec) 분포 */
+    evSlot_t slot[EV_QUEUE_LEN];
+} evQueue_t;
+
+/* 전역변수 */
+static int epfd = -1;
+static evFd_t evFd[EV_FD_MAX];
+static pthread_t loop_thread;
+static evQueue_t *loopQ = NULL;
+static evQueue_t *workQ = NULL;
+static pthread_t work_thread;
+static volatile bool workRun = false;
+
+/* 함수원형 */
+static void evQueueHandler(int fd, uint32_t events, void *arg);
+
+static uint64_t evNowUsec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * 작업 큐를 만든다.
+ *
+ * @param name      공유메모리 통계 이름 ("ev.<name>_depth" 등)
+ */
+static evQueue_t *evQueueCreate(const char *name, int flags)
+{
+    static const int64_t waitBounds[] = V2XSTAT_USEC_BOUNDS;
+    char statName[V2XSTAT_METRIC_NAME_MAX];
+    evQueue_t *q;
+
+    q = (evQueue_t *)calloc(1, sizeof(evQueue_t));
+    if(q == NULL)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Fail to allocate event queue\n");
+        return NULL;
+    }
+    q->efd = eventfd(0, EFD_CLOEXEC | flags);
+    if(q->efd < 0)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] eventfd() fail : %s\n", strerror(errno));
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->mtx, NULL);
+    pthread_cond_init(&q->space, NULL);
+
+    snprintf(statName, sizeof(statName), "ev.%s_depth", name);
+    q->statDepth = v2xstat_Gauge(statName, "job");
+    snprintf(statName, sizeof(statName), "ev.%s_drop", name);
+    q->statDrop = v2xstat_Counter(statName, "job");
+    snprintf(statName, sizeof(statName), "ev.%s_wait", name);
+    q->statWait = v2xstat_Hist(statName, "usec", waitBounds, sizeof(waitBounds) / sizeof(waitBounds[0]));
+    return q;
+}
+
+static void evQueueRelease(evQueue_t *q)
+{
+    if(q == NULL)
+        return;
+    close(q->efd);
+    pthread_mutex_destroy(&q->mtx);
+    pthread_cond_destroy(&q->space);
+    free(q);
+}
+
+/**
+ * 작업을 큐에 넣고 소비자를 깨운다.
+ * wait가 true이면 큐가 가득 찼을 때 빈 슬롯이 생기거나 종료될 때까지 기다린다.
+ */
+static int evQueuePut(evQueue_t *q, evJob_t fn, const void *data, uint32_t len, bool wait)
+{
+    evSlot_t *s;
+    uint64_t one = 1;
+    struct timespec ts;
+
+    if(len > EV_JOB_MAX)
+        return -1;
+
+    pthread_mutex_lock(&q->mtx);
+    while(q->head - q->tail == EV_QUEUE_LEN)
+    {
+        if(!wait || ending)
+        {
+            q->drop++;
+            pthread_mutex_unlock(&q->mtx);
+            v2xstat_Inc(q->statDrop);
+            return -1;
+        }
+        /* 종료를 확인하기 위해 100msec마다 깨어난다. */
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 100000000;
+        if(ts.tv_nsec >= 1000000000)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&q->space, &q->mtx, &ts);
+    }
+    s = &q->slot[q->head % EV_QUEUE_LEN];
+    s->fn = fn;
+    s->len = len;
+    s->putTime = evNowUsec();
+    if(len > 0)
+        memcpy(s->data, data, len);
+    q->head++;
+    v2xstat_Set(q->statDepth, q->head - q->tail);
+    pthread_mutex_unlock(&q->mtx);
+
+    /* 이미 깨어 있더라도 카운터가 쌓이므로 깨움이 사라지지 않는다. */
+    if(write(q->efd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] eventfd write fail : %s\n", strerror(errno));
+
+    return 0;
+}
+
+/**
+ * 큐에 쌓인 작업을 모두 실행한다. (소비자 쓰레드)
+ * 소비자가 하나이므로 슬롯은 tail을 올리기 전까지 덮어쓰이지 않는다. 작업은 잠금 없이 실행한다.
+ */
+static void evQueueRun(evQueue_t *q)
+{
+    evSlot_t *s;
+    uint32_t drop;
+
+    while(1)
+    {
+        pthread_mutex_lock(&q->mtx);
+        if(q->tail == q->head)
+        {
+            drop = q->drop;
+            pthread_mutex_unlock(&q->mtx);
+            break;
+        }
+        s = &q->slot[q->tail % EV_QUEUE_LEN];
+        pthread_mutex_unlock(&q->mtx);
+
+        v2xstat_Observe(q->statWait, (int64_t)(evNowUsec() - s->putTime));
+        s->fn(s->data, s->len);
+
+        pthread_mutex_lock(&q->mtx);
+        q->tail++;
+        v2xstat_Set(q->statDepth, q->head - q->tail);
+        pthread_cond_signal(&q->space);
+        pthread_mutex_unlock(&q->mtx);
+    }
+
+    if(drop != q->dropReported)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Event queue full, %u jobs dropped\n", drop - q->dropReported);
+        q->dropReported = drop;
+    }
+}
+
+static void evQueueHandler(int fd, uint32_t events, void *arg)
+{
+    uint64_t cnt;
+
+    /* 카운터를 비운 뒤 실행하므로 실행 중 들어온 작업은 다음 깨움에 처리된다. */
+    if(read(fd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] eventfd read fail : %s\n", strerror(errno));
+    evQueueRun((evQueue_t *)arg);
+}
+
+/**
+ * 이벤트 루프를 초기화한다. 루프를 실행할 쓰레드(evRun())에서 호출한다.
+ *
+ * @return          성공 시 0, 실패 시 -1
+ */
+int evInit(void)
+{
+    for(int i = 0; i < EV_FD_MAX; i++)
+        evFd[i].fd = -1;
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if(epfd < 0)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] epoll_create1() fail : %s\n", strerror(errno));
+        return -1;
+    }
+    loop_thread = pthread_self();
+
+    loopQ = evQueueCreate("loop", EFD_NONBLOCK);
+    if(loopQ == NULL || evAdd(loopQ->efd, evQueueHandler, loopQ) < 0)
+    {
+        evRelease();
+        return -1;
+    }
+
+    if(g_mib.worker && evWorkerStart() < 0)
+    {
+        evRelease();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * 이벤트 루프를 해제한다. 작업 쓰레드를 먼저 멈춘다.
+ */
+void evRelease(void)
+{
+    evWorkerStop();
+
+    for(int i = 0; i < EV_FD_MAX; i++)
+        evFd[i].fd = -1;
+    evQueueRelease(loopQ);
+    loopQ = NULL;
+
+    if(epfd >= 0)
+        close(epfd);
+    epfd = -1;
+}
+
+/**
+ * fd를 등록한다. fd가 읽기 가능해지면 루프 쓰레드에서 fn이 호출된다.
+ *
+ * @return          성공 시 0, 실패 시 -1
+ */
+int evAdd(int fd, evHandler_t fn, void *arg)
+{
+    struct epoll_event ev;
+    int i;
+
+    for(i = 0; i < EV_FD_MAX; i++)
+    {
+        if(evFd[i].fd == -1)
+            break;
+    }
+    if(i == EV_FD_MAX)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Too many event fds\n");
+        return -1;
+    }
+
+    evFd[i].fd = fd;
+    evFd[i].gen++;
+    evFd[i].fn = fn;
+    evFd[i].arg = arg;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = ((uint64_t)evFd[i].gen << 32) | (uint32_t)i;
+    if(epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] epoll_ctl(%d) fail : %s\n", fd, strerror(errno));
+        evFd[i].fd = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * fd 등록을 해제한다. fd를 닫기 전에 호출한다.
+ */
+void evDel(int fd)
+{
+    for(int i = 0; i < EV_FD_MAX; i++)
+    {
+        if(evFd[i].fd == fd)
+        {
+            epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+            evFd[i].fd = -1;
+            return;
+        }
+    }
+}
+
+/**
+ * 주기 타이머를 생성하여 등록한다. 최초 만기는 1msec 후이다.
+ *
+ * @param interval  주기(usec)
+ * @return          성공 시 타이머 fd, 실패 시 -1
+ */
+int evTimer(uint32_t interval, evHandler_t fn, void *arg)
+{
+    int fd;
+    struct itimerspec ts;
+
+    fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(fd < 0)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] timerfd_create() fail : %s\n", strerror(errno));
+        return -1;
+    }
+
+    ts.it_value.tv_sec = 0;
+    ts.it_value.tv_nsec = 1000000;
+    ts.it_interval.tv_sec = interval / 1000000;
+    ts.it_interval.tv_nsec = (interval % 1000000) * 1000;
+    if(timerfd_settime(fd, 0, &ts, NULL) < 0 || evAdd(fd, fn, arg) < 0)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Fail to set timer : %s\n", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * 타이머 핸들러에서 호출하여 지난 호출 이후의 만기 횟수를 읽는다.
+ * 1보다 크면 루프가 늦어 그만큼의 만기가 한 번에 전달된 것이다.
+ */
+uint64_t evTimerRead(int fd)
+{
+    uint64_t expired = 0;
+
+    if(read(fd, &expired, sizeof(expired)) < 0)
+        return 0;
+    return expired;
+}
+
+/**
+ * ending이 설정될 때까지 이벤트를 처리한다.
+ * 시그널이 다른 쓰레드로 전달되어도 1초 안에 종료를 확인한다.
+ */
+void evRun(void)
+{
+    struct epoll_event ev[EV_FD_MAX];
+    evFd_t *e;
+    int n;
+
+    while(!ending)
+    {
+        n = epoll_wait(epfd, ev, EV_FD_MAX, 1000);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] epoll_wait() fail : %s\n", strerror(errno));
+            break;
+        }
+
+        for(int i = 0; i < n; i++)
+        {
+            e = &evFd[(uint32_t)ev[i].data.u64];
+            /* 같은 배치에서 앞선 핸들러가 해제/재등록한 fd는 건너뛴다. */
+            if(e->fd == -1 || e->gen != (uint32_t)(ev[i].data.u64 >> 32))
+                continue;
+            e->fn(e->fd, ev[i].events, e->arg);
+        }
+    }
+}
+
+/**
+ * 작업을 루프 쓰레드에서 실행한다. 루프 쓰레드에서 호출하면 바로 실행한다.
+ *
+ * @return          성공 시 0, 큐가 가득 차면 -1
+ */
+int evPost(evJob_t fn, const void *data, uint32_t len)
+{
+    if(pthread_equal(pthread_self(), loop_thread))
+    {
+        fn((uint8_t *)data, len);
+        return 0;
+    }
+    return evQueuePut(loopQ, fn, data, len, false);
+}
+
+/**
+ * 인코딩/디코딩 작업을 작업 쓰레드에 넘긴다. (--worker 옵션이 없으면 루프 쓰레드에서 실행한다)
+ * 큐가 가득 차면 빈 슬롯이 생길 때까지 기다린다.
+ * 앞단에 버퍼가 있는 입력(메시지 큐)을 넘길 때 사용하여, 버리지 않고 앞단에 쌓이게 한다.
+ *
+ * @return          성공 시 0, 종료 중이면 -1
+ */
+int evOffloadWait(evJob_t fn, const void *data, uint32_t len)
+{
+    if(workQ != NULL)
+        return evQueuePut(workQ, fn, data, len, true);
+    if(pthread_equal(pthread_self(), loop_thread))
+    {
+        fn((uint8_t *)data, len);
+        return 0;
+    }
+    return evQueuePut(loopQ, fn, data, len, true);
+}
+
+static void* workThread(void *notused)
+{
+    uint64_t cnt;
+
+    while(workRun)
+    {
+        /* 작업이 들어올 때까지 대기한다. */
+        if(read(workQ->efd, &cnt, sizeof(cnt)) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] worker eventfd read fail : %s\n", strerror(errno));
+            break;
+        }
+        evQueueRun(workQ);
+    }
+
+    pthread_exit((void *)0);
+}
+
+/**
+ * 작업 쓰레드를 생성한다.
+ *
+ * @return          성공 시 0, 실패 시 -1
+ */
+int evWorkerStart(void)
+{
+    workQ = evQueueCreate("work", 0);
+    if(workQ == NULL)
+        return -1;
+
+    workRun = true;
+    if(pthread_create(&work_thread, NULL, workThread, NULL) != 0)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Fail to create worker thread\n");
+        workRun = false;
+        evQueueRelease(workQ);
+        workQ = NULL;
+        return -1;
+    }
+
+    syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Worker thread started\n");
+    return 0;
+}
+
+/**
+ * 작업 쓰레드를 멈춘다. 큐에 남은 작업은 실행하지 않는다.
+ */
+void evWorkerStop(void)
+{
+    uint64_t one = 1;
+    evQueue_t *q = workQ;
+
+    if(q == NULL)
+        return;
+
+    workRun = false;
+    if(write(q->efd, &one, sizeof(one)) < 0)
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] eventfd write fail : %s\n", strerror(errno));
+    pthread_join(work_thread, NULL);
+
+    workQ = NULL;
+    evQueueRelease(q);
+}
@@ -1,4 +1,5 @@
 #include <prcsJ2735.h>
+#include <msgQ.h>
 
 /* 전역변수 */
 mib_t		g_mib;
@@ -18,6 +19,8 @@ int main(int argc, char *argv[])
 	memset(&g_mib, 0, sizeof(mib_t));
     g_mib.interval = 100000;
     g_mib.gpsdPort = "2947";
+    g_mib.priority = MSGQ_PRIORITY_DEFAULT;
+    g_mib.ifindex = MSGQ_IFINDEX_DEFAULT;
 
 	/* 사용자가 입력한 파라미터들을 MIB에 저장한다. */
 	result	=	ParsingOptions(argc, argv);
@@ -27,6 +30,15 @@ int main(int argc, char *argv[])
     /* 파라미터 출력 */
     PrintOptions();
 
+    /* 바이너리 로그 초기화 - 디버그 모드면 LOG_DEBUG까지 기록한다. (실패 시 V2XLOG는 syslog로 기록) */
+    v2xlog_Init("prcsJ2735", NULL, g_mib.dbg ? LOG_DEBUG : LOG_INFO);
+
+    /* 지연 추적 링 초기화 - 수신측은 송신측이 시작한 추적을 이어서 기록한다. */
+    v2xtrace_Init("prcsJ2735");
+
+    /* 공유메모리 통계 초기화 (v2xtop으로 조회) */
+    v2xstat_Init("prcsJ2735");
+
 #if 0
     /* syslog library open */
     openlog(prcsJ2735, LOG_CONS | LOG_NDELAY | LOG_PERROR, LOG_LOCAL0);
@@ -49,6 +61,11 @@ int main(int argc, char *argv[])
     /* Messge Queue 닫기 */
     releaseMQ();
 
+    /* 통계, 지연 추적 링, 바이너리 로그 닫기 */
+    v2xstat_Close();
+    v2xtrace_Close();
+    v2xlog_Close();
+
     //closelog();
 
     return 0;
@@ -1,3 +1,6 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE //pthread_timedjoin_np()
+#endif
 #include <signal.h>
 #include <msgQ.h>
 #include <sys/types.h>
@@ -10,11 +13,19 @@
 mqd_t fd;
 struct msgQ_elem_frame *msgqPkt = NULL; // 메시지 버퍼
 uint32_t msgqCnt = 0;
+static pthread_t mq_thread;
+static bool mqPumpRun = false;
+static evJob_t mqPumpJob = NULL;
+static const struct v2xstatDesc_t *mqRecvStat;  // 공유메모리 통계 - 1716 수신 수
+static const struct v2xstatDesc_t *mqSendStat;  // 1717 송신 수
+static const struct v2xstatDesc_t *mqDropStat;  // 1717 큐가 가득 차 버린 수
 
 int initMQ(void)
 {
     if(g_mib.op == opType_rx)
     {
+        mqRecvStat = v2xstat_Counter("mq.1716_recv", "msg");
+
         /*  수신 메세지 큐용 버퍼 Allocation */
         msgqPkt = (struct msgQ_elem_frame *)calloc(1, sizeof(struct msgQ_elem_frame));
         if( msgqPkt == NULL )
@@ -36,6 +47,9 @@ int initMQ(void)
     }
     else
     {
+        mqSendStat = v2xstat_Counter("mq.1717_send", "msg");
+        mqDropStat = v2xstat_Counter("mq.1717_drop", "msg");
+
         /* 송신 메세지 큐용 버퍼 Allocation */
         msgqPkt = (struct msgQ_elem_frame *)calloc(1, sizeof(struct msgQ_elem_frame));
         if( msgqPkt == NULL )
@@ -86,12 +100,15 @@ void releaseMQ(void)
     }
 }
 
-int recvMQ(char *pkt)
+int recvMQ(char *pkt, struct v2xtraceCtx_t *trace)
 {
     memset(msgqPkt->msg.msg, 0, msgqPkt->msg.msg_len);
 
     if( msgrcv(fd, (char *)msgqPkt, sizeof(struct msgQ_elem_frame) - sizeof(long), 1, 0) == -1 )
     {
+        /* 종료 시 stopMQpump()의 시그널로 깨어난 경우 */
+        if(errno == EINTR)
+            return -1;
         //perror("[prcsJ2735] MQ receive error :  " );
         syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] MQ receive error : %s", strerror(errno));
         return -1;
@@ -104,12 +121,17 @@ int recvMQ(char *pkt)
             syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] MQ receive(len: %d)\n", msgqPkt->msg.msg_len);
         }
         memcpy(pkt, msgqPkt->msg.msg, msgqPkt->msg.msg_len);
+        v2xstat_Inc(mqRecvStat);
+
+        /* 추적 중인 메시지면 메시지큐에서 꺼낸 시각을 기록한다. */
+        *trace = msgqPkt->trace;
+        v2xtrace_Stamp(trace, v2xtraceStage_MqRxRecv);
     }
 
     return msgqPkt->msg.msg_len;
 }
 
-void sendMQ(uint8_t *pPkt, uint32_t len)
+void sendMQ(uint8_t *pPkt, uint32_t len, struct v2xtraceCtx_t *trace)
 {
     memset(msgqPkt->msg.msg, 0, msgqPkt->msg.msg_len);
     msgqPkt->msg.msg_len = len;
@@ -117,14 +139,24 @@ void sendMQ(uint8_t *pPkt, uint32_t len)
 
     msgqPkt->rxCnt = msgqCnt++;
     msgqPkt->msgtype = 1; 
+    msgqPkt->priority = g_mib.priority;
+    msgqPkt->lifetime = g_mib.lifetime;
+    msgqPkt->ifindex = g_mib.ifindex;
+    msgqPkt->psid = MSGQ_PSID_DEFAULT;
+
+    /* 추적 중인 메시지면 메시지큐에 넣는 시각을 기록하여 함께 보낸다. */
+    v2xtrace_Stamp(trace, v2xtraceStage_MqTx);
+    msgqPkt->trace = *trace;
 
     if( msgsnd( fd, (char *)msgqPkt, sizeof(struct msgQ_elem_frame) - sizeof(long), IPC_NOWAIT) == -1 )
     {
         //perror("[precsJ2735] MQ send error : ");
         syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] MQ send error : %s", strerror(errno));
+        v2xstat_Inc(mqDropStat);
     }
     else
     {
+        v2xstat_Inc(mqSendStat);
         if( g_mib.dbg)
         {
             //printf("[prcsJ2735] MQ send(%d Byte) \n", msgqPkt->msg.msg_len);
@@ -133,3 +165,87 @@ void sendMQ(uint8_t *pPkt, uint32_t len)
     }
 }
 
+/****************************************************************************************
+
+  mqPumpThread()
+  메시지 큐 수신 쓰레드
+  SysV 메시지 큐는 epoll로 기다릴 수 없으므로 이 쓰레드가 msgrcv()로 대기하다가
+  수신한 메시지를 작업으로 넘긴다. (evOffloadWait(), eventfd로 이벤트 루프/작업 쓰레드를 깨운다)
+  처리가 밀리면 이 쓰레드가 기다리므로 메시지는 버려지지 않고 메시지 큐에 쌓인다.
+  작업 데이터는 추적정보(struct v2xtraceCtx_t) 뒤에 메시지가 붙은 형태다.
+
+ ****************************************************************************************/
+static void* mqPumpThread(void *notused)
+{
+    uint8_t job[sizeof(struct v2xtraceCtx_t) + MSGMAX];
+    struct v2xtraceCtx_t trace;
+    int len;
+
+    while(!ending)
+    {
+        len = recvMQ((char *)job + sizeof(trace), &trace);
+        if(len < 0)
+            continue;
+        memcpy(job, &trace, sizeof(trace));
+
+        if(evOffloadWait(mqPumpJob, job, sizeof(trace) + (uint32_t)len) < 0)
+            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Drop MQ message(len: %d)\n", len);
+    }
+
+    pthread_exit((void *)0);
+}
+
+/****************************************************************************************
+
+  startMQpump()
+  메시지 큐 수신 쓰레드 생성
+
+  arguments
+    fn      수신한 메시지마다 실행할 작업
+
+  return
+    성공 시 0, 실패 시 -1
+
+ ****************************************************************************************/
+int startMQpump(evJob_t fn)
+{
+    mqPumpJob = fn;
+    if( pthread_create(&mq_thread, NULL, mqPumpThread, NULL) != 0 )
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Fail to create MQ thread : %s\n", strerror(errno));
+        return -1;
+    }
+    mqPumpRun = true;
+
+    return 0;
+}
+
+/****************************************************************************************
+
+  stopMQpump()
+  메시지 큐 수신 쓰레드 종료
+  msgrcv()는 시그널 핸들러 이후 재시작되지 않으므로 SIGINT로 대기를 깨운다.
+  msgrcv() 진입 직전에 시그널을 받았을 수 있으므로 종료될 때까지 100msec마다 다시 보낸다.
+
+ ****************************************************************************************/
+void stopMQpump(void)
+{
+    struct timespec ts;
+
+    if( !mqPumpRun )
+        return;
+
+    ending = 1;
+    do
+    {
+        pthread_kill(mq_thread, SIGINT);
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 100000000;
+        if(ts.tv_nsec >= 1000000000)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+    } while(pthread_timedjoin_np(mq_thread, NULL, &ts) == ETIMEDOUT);
+    mqPumpRun = false;
+}
@@ -2,7 +2,7 @@
 #include <getopt.h>
 
 /*	전역변수 */
-static const char	*optStr	=	"123456789";
+static const char	*optStr	=	"123456789plxwt";
 struct option options[] =
 {
 	{"op", required_argument, 0, '1'},
@@ -14,6 +14,11 @@ struct option options[] =
 	{"help", no_argument, 0, '7'},
 	{"udpPort", required_argument, 0, '8'},
 	{"udpIP", required_argument, 0, '9'},
+	{"priority", required_argument, 0, 'p'},
+	{"lifetime", required_argument, 0, 'l'},
+	{"ifindex", required_argument, 0, 'x'},
+	{"worker", no_argument, 0, 'w'},
+	{"trace", required_argument, 0, 't'},
     {0, 0, 0, 0} // 옵션 배열은 {0,0,0,0} 센티넬에 의해 만료된다.
 };
 
@@ -37,6 +42,17 @@ static void usage()
 	printf("  --help                         print usage\n");
 	printf("  --udpPort                      Set port for UDP\n");
 	printf("  --udpIP                        Set IP for UDP\n");
+	printf("  --priority=<0~7>               Set tx priority(802.1D user priority) for prcsWSM\n");
+	printf("                                    if not set, prcsWSM default priority(-o) is used\n");
+	printf("  --lifetime=<msec>              Set tx lifetime, stale messages are dropped by prcsWSM\n");
+	printf("                                    if not set, prcsWSM default lifetime(-e) is used\n");
+	printf("  --ifindex=<if>                 Set tx interface of prcsWSM\n");
+	printf("                                    if not set, prcsWSM default interface(-x) is used\n");
+	printf("  --worker                       Decode received messages on a worker thread\n");
+	printf("                                    if not set, messages are processed on the event loop thread\n");
+	printf("  --trace=<n>                    Trace end-to-end latency of every n-th RTCM message(for tx)\n");
+	printf("                                    stage timestamps are carried to the OBU and recorded in trace rings\n");
+	printf("                                    if not set, no message is traced\n");
 
     printf("\nExample usage\n");
     printf("  Rx All    :   ./prcsJ2735 --op=rx --psid=32\n");
@@ -148,6 +164,25 @@ int32_t ParsingOptions(int32_t argc, char *argv[])
         case '9':
             memcpy(g_mib.destIP, optarg, strlen(optarg) < ADDRSIZE ? strlen(optarg) : ADDRSIZE );
             break;
+        case 'p':
+            g_mib.priority	=   (uint8_t)strtoul(optarg, NULL, 10);
+            if(g_mib.priority > 7) {
+                printf("Invalid priority - %s\n", optarg);
+                return	-1;
+            }
+            break;
+        case 'l':
+            g_mib.lifetime	=   (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'x':
+            g_mib.ifindex	=   (uint8_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'w':
+            g_mib.worker	=   true;
+            break;
+        case 't':
+            g_mib.trace	=   (uint32_t)strtoul(optarg, NULL, 10);
+            break;
         default:
             break;
         }
@@ -226,4 +261,6 @@ void PrintOptions(void)
         }
     }
     printf("dbg        : 0x%x\n", g_mib.dbg);
+    printf("worker     : %s\n", g_mib.worker ? "on" : "off");
+    printf("trace      : %u\n", g_mib.trace);
 }
@@ -7,6 +7,10 @@
 #include <gps.h>
 #include <hexdump.h>
 #include <syslog.h>
+#include "v2xtimer.h"
+#include "v2xlog.h"
+#include "v2xtrace.h"
+#include "v2xstat.h"
 
 #define ADDRSIZE 20
 
@@ -40,13 +44,21 @@ typedef struct
 
     /* 타이머 변수 */
     uint32_t    interval;
-    timer_t     timer;
-    pthread_mutex_t txMtx;
-    pthread_cond_t txCond; 
+
+    /* 인코딩/디코딩 작업 쓰레드 사용 (--worker) */
+    bool        worker;
+
+    /* 종단간 지연 추적 - n개 메시지마다 하나를 추적한다. 0이면 추적하지 않는다. (--trace) */
+    uint32_t    trace;
 
     /* gpsd */
     char *gpsdPort;
 
+    /* 송신 우선순위/유효기간(msec)/인터페이스 (prcsWSM 전달) */
+    uint8_t     priority;
+    uint32_t    lifetime;
+    uint8_t     ifindex;
+
     /* 디버그 변수 */
     uint32_t    dbg;
 
@@ -63,6 +75,10 @@ typedef struct
     bool flag;
 } rtcmData_t;
 
+/* 이벤트 루프 fd 핸들러 / 작업 (evLoop.c) */
+typedef void (*evHandler_t)(int fd, uint32_t events, void *arg);
+typedef void (*evJob_t)(uint8_t *data, uint32_t len);
+
 /*----------------------------------------------------------------------------------*/
 
 
@@ -89,24 +105,36 @@ void asn1_xer_printf(const ASN1CType *msg_type, void* msg);
 /* msgQ.c */
 int initMQ(void);
 void releaseMQ(void);
-int recvMQ(char *pkt);
-void sendMQ(uint8_t *pPkt, uint32_t len);
+int recvMQ(char *pkt, struct v2xtraceCtx_t *trace);
+void sendMQ(uint8_t *pPkt, uint32_t len, struct v2xtraceCtx_t *trace);
+int startMQpump(evJob_t fn);
+void stopMQpump(void);
 /* txJ2735.c */ 
 void setJ2735tx();
 void sendJ2735(void);
-/* timer.c */
-int InitTxTimer(const uint32_t interval);
 /* rxJ2735.c */ 
 void setJ2735rx();
 /* prcsRTCM.c */
 int getRTCM(uint8_t *buf);
 void setRTCM(uint8_t *buf, int len);
-int rtcmPkt(struct gps_data_t * gpsData);
+int rtcmPkt(struct gps_data_t * gpsData, uint64_t readTime);
 int ConstructRTCM(uint8_t *pkt, uint32_t *len);
 void setRTCM_mutex(int op);
-void fillRTCM();
+void fillRTCM(struct v2xtraceCtx_t *trace);
 //void set_renewFlag();
 /* socket.c */
-int createSockThread();
-void closeSocketThread();
+void closeSocket(void);
 void connection_Check(void);
+int sendPkt();
+/* evLoop.c */
+int evInit(void);
+void evRelease(void);
+int evAdd(int fd, evHandler_t fn, void *arg);
+void evDel(int fd);
+int evTimer(uint32_t interval, evHandler_t fn, void *arg);
+uint64_t evTimerRead(int fd);
+void evRun(void);
+int evPost(evJob_t fn, const void *data, uint32_t len);
+int evOffloadWait(evJob_t fn, const void *data, uint32_t len);
+int evWorkerStart(void);
+void evWorkerStop(void);
@@ -10,6 +10,9 @@ bool rtcmFlag = false;
 //bool renewFlag = true;
 //bool restartFlag = false;
 pthread_mutex_t rtcmMtx;
+static struct v2xtraceCtx_t rtcmTrace;  // 다음 송신 메시지의 추적정보 (rtcmMtx)
+static bool rtcmTraceArm = true;        // 다음 RTCM 수신 시 추적을 시작한다. (rtcmMtx)
+static uint32_t rtcmTraceCnt = 0;
 
 void setRTCM_mutex(int op)
 {
@@ -20,8 +23,29 @@ void setRTCM_mutex(int op)
 
 }
 
-void fillRTCM()
+/**
+ * 추적할 차례이면 gpsd 수신시각부터 추적을 시작한다. (rtcmMtx 잠금 상태에서 호출)
+ * 한 메시지에 여러 RTCM이 모이므로 첫 RTCM의 수신시각이 메시지의 시작이 된다.
+ */
+static void rtcmTraceBegin(uint64_t readTime)
 {
+    if(!rtcmTraceArm || V2XTRACE_VALID(&rtcmTrace))
+        return;
+
+    v2xtrace_Begin(&rtcmTrace, readTime);
+    v2xtrace_StampAt(&rtcmTrace, v2xtraceStage_GpsdRead, readTime);
+    v2xtrace_Stamp(&rtcmTrace, v2xtraceStage_RtcmPkt);
+    rtcmTraceArm = false;
+}
+
+/**
+ * 송신주기마다 모인 RTCM을 송신 버퍼로 옮긴다.
+ * 추적 중인 RTCM이 포함되면 trace에 추적정보를 넘기고, --trace 주기에 따라 다음 추적을 준비한다.
+ */
+void fillRTCM(struct v2xtraceCtx_t *trace)
+{
+    trace->magic = 0;
+
     pthread_mutex_lock(&rtcmMtx);
     memset(&rtcmBuf, 0, sizeof(rtcmBuf));
     rtcmLen = 0;
@@ -36,10 +60,26 @@ void fillRTCM()
         }
     }
 
+    if(rtcmLen > 0 && g_mib.trace > 0)
+    {
+        *trace = rtcmTrace;
+        rtcmTrace.magic = 0;
+        if(++rtcmTraceCnt >= g_mib.trace)
+        {
+            rtcmTraceCnt = 0;
+            rtcmTraceArm = true;
+        }
+    }
+
     pthread_mutex_unlock(&rtcmMtx);
 }
 
-int rtcmPkt(struct gps_data_t * gpsData)
+/**
+ * gpsd 보고의 RTCM을 종류 별로 저장한다. (이벤트 루프 쓰레드)
+ *
+ * @param readTime  gpsd 보고 수신시각 (nsec, CLOCK_REALTIME) - 지연 추적의 시작 시각
+ */
+int rtcmPkt(struct gps_data_t * gpsData, uint64_t readTime)
 {
     /* rtcm type별 관리 */
     switch(gpsData->rtcm3.type)
@@ -53,7 +93,8 @@ int rtcmPkt(struct gps_data_t * gpsData)
                 memset(rtcmData[0].buf, 0, 1024); 
                 memcpy(rtcmData[0].buf, gpsData->rtcm3.rtcmtypes.data, gpsData->rtcm3.length+6);
                 rtcmData[0].flag = true;
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1005 \n");
+                rtcmTraceBegin(readTime);
+                V2XLOG(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1005 \n");
                 pthread_mutex_unlock(&rtcmMtx);
             }
             break;
@@ -66,7 +107,8 @@ int rtcmPkt(struct gps_data_t * gpsData)
                 memset(rtcmData[1].buf, 0, 1024); 
                 memcpy(rtcmData[1].buf, gpsData->rtcm3.rtcmtypes.data, gpsData->rtcm3.length+6);
                 rtcmData[1].flag = true;
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1077\n");
+                rtcmTraceBegin(readTime);
+                V2XLOG(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1077\n");
                 pthread_mutex_unlock(&rtcmMtx);
             }
             break;
@@ -79,7 +121,8 @@ int rtcmPkt(struct gps_data_t * gpsData)
                 memset(rtcmData[2].buf, 0, 1024); 
                 memcpy(rtcmData[2].buf, gpsData->rtcm3.rtcmtypes.data, gpsData->rtcm3.length+6);
                 rtcmData[2].flag = true;
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1087\n");
+                rtcmTraceBegin(readTime);
+                V2XLOG(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1087\n");
                 pthread_mutex_unlock(&rtcmMtx);
             }
             break;
@@ -92,7 +135,8 @@ int rtcmPkt(struct gps_data_t * gpsData)
                 memset(rtcmData[3].buf, 0, 1024); 
                 memcpy(rtcmData[3].buf, gpsData->rtcm3.rtcmtypes.data, gpsData->rtcm3.length+6);
                 rtcmData[3].flag = true;
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1097\n");
+                rtcmTraceBegin(readTime);
+                V2XLOG(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1097\n");
                 pthread_mutex_unlock(&rtcmMtx);
             }
             break;
@@ -105,7 +149,8 @@ int rtcmPkt(struct gps_data_t * gpsData)
                 memset(rtcmData[4].buf, 0, 1024); 
                 memcpy(rtcmData[4].buf, gpsData->rtcm3.rtcmtypes.data, gpsData->rtcm3.length+6);
                 rtcmData[4].flag = true;
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1127\n");
+                rtcmTraceBegin(readTime);
+                V2XLOG(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1127\n");
                 pthread_mutex_unlock(&rtcmMtx);
             }
             break;
@@ -118,7 +163,8 @@ int rtcmPkt(struct gps_data_t * gpsData)
                 memset(rtcmData[5].buf, 0, 1024); 
                 memcpy(rtcmData[5].buf, gpsData->rtcm3.rtcmtypes.data, gpsData->rtcm3.length+6);
                 rtcmData[5].flag = true;
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1230\n");
+                rtcmTraceBegin(readTime);
+                V2XLOG(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Read RTCM 1230\n");
                 pthread_mutex_unlock(&rtcmMtx);
             }
             break;
@@ -198,9 +244,11 @@ int getRTCM(uint8_t *buf)
 
 void setRTCM(uint8_t *buf, int len)
 {
+    pthread_mutex_lock(&rtcmMtx);
     memset(&rtcmBuf, 0, sizeof(rtcmBuf));
     memcpy(&rtcmBuf, buf, len); 
     rtcmLen = len;
+    pthread_mutex_unlock(&rtcmMtx);
     //rtcmFlag = true;
 }
 
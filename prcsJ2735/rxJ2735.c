@@ -10,19 +10,41 @@
 #include "ublox_debug.h"
 #include "shm.h"
 
+#define GPSD_IDLE_MAX 3 /* gpsd로부터 이 시간(초) 동안 수신이 없으면 연결을 다시 맺는다. */
+
 /* 전역변수 */
-bool sockCheck = false;
+bool sockCheck = true;
 struct gps_data_t gpsData;
-pthread_t gpsd_thread;
 char *shmPtr = NULL;
 int shmid;
 bool gpsdCheckFlag = false;
 int writeErrCnt = 0;
 int recvCnt = 0;
 int errCnt = 0;
+static int gpsdIdle = 0;
+static uint32_t prevItow = 0;
+
+/* 공유메모리 통계 (v2xtop) */
+static struct
+{
+    const struct v2xstatDesc_t *decode;         /* 디코딩 성공 수 */
+    const struct v2xstatDesc_t *decodeFail;     /* 디코딩 실패 수 */
+    const struct v2xstatDesc_t *rtcm;           /* 수신한 RTCM 보정정보 수 */
+    const struct v2xstatDesc_t *rtcmDrop;       /* 이벤트 루프로 넘기지 못한 RTCM 수 */
+    const struct v2xstatDesc_t *write;          /* gpsd로 쓴 RTCM 수 */
+    const struct v2xstatDesc_t *writeBytes;     /* gpsd로 쓴 바이트 수 */
+    const struct v2xstatDesc_t *writeSkip;      /* 1초 제한 또는 gpsd 미연결로 쓰지 않은 RTCM 수 */
+    const struct v2xstatDesc_t *writeFail;      /* write() 실패 수 */
+    const struct v2xstatDesc_t *writeTime;      /* write() 시간(usec) */
+    const struct v2xstatDesc_t *reconnect;      /* gpsd 재연결 수 */
+} rxStat;
 
 /* 함수 원형 */
-static void* gpsdThread(void *notused);
+static void rxDecode(uint8_t *pkt, uint32_t len);
+static void rxWriteRTCM(uint8_t *buf, uint32_t len);
+static void rxGpsdRead(int fd, uint32_t events, void *arg);
+static void rxHousekeep(int fd, uint32_t events, void *arg);
+static void rxInitStat(void);
 struct timeval startTime, endTime = {0, };
 bool timeFlag = true;
 
@@ -44,61 +66,66 @@ int openGPSD()
         if(gpsData.gps_fd == 0)
         {
         syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_fd is 0");
+        gps_close(&gpsData);
         sockCheck = true;
         return -1;
         }
     }
     (void) gps_stream(&gpsData, WATCH_ENABLE | WATCH_JSON, NULL);
+
+    /* gpsd 수신은 이벤트 루프에서 처리한다. */
+    if(evAdd(gpsData.gps_fd, rxGpsdRead, NULL) < 0)
+    {
+        gps_close(&gpsData);
+        sockCheck = true;
+        return -1;
+    }
     syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] gps_open() Success\n");
     
     sockCheck = false;
+    gpsdIdle = 0;
 
     return 0;
 }
 
+static void closeGPSD()
+{
+    if(sockCheck == true)
+        return;
+
+    evDel(gpsData.gps_fd);
+    gps_close(&gpsData);
+    sockCheck = true;
+}
+
 void setJ2735rx()
 {
-    int result, status;
-    void *msg;
-    ASN1Error err;
-    char pkt[kMpduMaxSize] = {0, };
-    int timeCheck = 0;
+    int hkTimerFd;
+#if 0
+    int result;
+#endif
 
     /* 현재 시간 획득 */
     gettimeofday(&startTime, NULL);
     gettimeofday(&endTime, NULL);
 
+    rxInitStat();
+
     /* Shared Memory open */
     if(InitShm(&shmid, &shmPtr) == -1)
         return;
 
-//    if(g_mib.dbg)
-//    {
-        /* GPSD 쓰레드 생성 */
-        result = pthread_create(&gpsd_thread, NULL, gpsdThread, NULL);
-        if (result < 0) {
-            //perror("[prcsJ2735] Fail to create tx thread() ");
-            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Fail to create tx thread() : %s\n", strerror(errno));
-            return;
-        }
-//    }
-#if 0
-    else if(g_mib.dbg == 0)
+    /* 이벤트 루프 초기화 */
+    if(evInit() < 0)
     {
-        /* GPSD */
-        result = gps_open("localhost", g_mib.gpsdPort, &gpsData);
-        if(result < 0 )
-        {
-            //printf("[prcsJ2735] gps_opn() fail(%s)\n", gps_errstr(result));
-            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_open() fail(%s)\n", gps_errstr(result));
-            sockCheck = true;
-            return;
-        }
-        (void) gps_stream(&gpsData, WATCH_ENABLE | WATCH_JSON, NULL);
-
-        //gpsdOpenFlag = true;
-        openGPSD();
+        ReleaseShm(shmPtr);
+        return;
     }
+
+    /* GPSD 연결, 실패 시 rxHousekeep()에서 다시 연결한다. */
+    openGPSD();
+
+#if 0
     /* UBLOX LOG En */
     if(g_mib.dbg == 2)
     {
@@ -124,278 +151,266 @@ void setJ2735rx()
     }
 #endif
 
-    while(!ending)
+    /* 1초 주기로 gpsd 연결/수신을 확인한다. */
+    hkTimerFd = evTimer(1000000, rxHousekeep, NULL);
+
+    /* msgQ 수신 쓰레드 생성 */
+    if(hkTimerFd >= 0 && startMQpump(rxDecode) == 0)
+        evRun();
+
+    /* msgQ 수신 쓰레드 종료 */
+    stopMQpump();
+
+    if(hkTimerFd >= 0)
     {
-#if 0
-        if(g_mib.dbg == 0)
-        {
-            /* connection check */
-            if(sockCheck == true)
-            {
-                gps_close(&gpsData);
+        evDel(hkTimerFd);
+        close(hkTimerFd);
+    }
 
-                //printf("[prcsJ2735] Re connection to GPSD\n");
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Re connection to GPSD\n");
+    /* 작업 쓰레드 종료 */
+    evRelease();
 
-                result = gps_open("localhost", g_mib.gpsdPort, &gpsData);
-                if(result < 0 )
-                {
-                    //printf("[prcsJ2735] gps_opn() fail(%s)\n", gps_errstr(result));
-                    syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_opn() fail(%s)\n", gps_errstr(result));
-                    sleep(1);
-                    continue;
-                }
-                (void) gps_stream(&gpsData, WATCH_ENABLE | WATCH_JSON, NULL);
-                if(openGPSD() == -1)
-                {
-                    sleep(1);
-                    continue;
-                }
-            }
-        }
-#endif
-        /* msgQ read */
-        result = recvMQ(pkt);
-        if(result < 0 )
-            continue;
-        else
-        {
-          
-            /* J2735 Decoding */
-            result = asn1_uper_decode(&msg, asn1_type_MessageFrame, pkt, result, &err);
-            if(result < 0)
-            {
-                //printf("[prcsJ2735] Decoding fail \n");
-                syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Decoding fail \n");
-            }
-            else
+    closeGPSD();
+
+    ReleaseShm(shmPtr);
+
+    return;
+}
+
+/**
+ * 수신한 J2735 메시지를 디코딩한다. (작업 쓰레드 또는 이벤트 루프 쓰레드)
+ * gpsd 소켓은 이벤트 루프 쓰레드만 사용하므로 RTCM 보정정보는 rxWriteRTCM()으로 넘긴다.
+ * 작업 데이터는 추적정보 뒤에 메시지가 붙은 형태다. (mqPumpThread() 참조)
+ */
+static void rxDecode(uint8_t *data, uint32_t len)
+{
+    int result;
+    void *msg;
+    ASN1Error err;
+    struct v2xtraceCtx_t trace;
+    uint8_t *pkt = data + sizeof(trace);
+
+    memcpy(&trace, data, sizeof(trace));
+    len -= sizeof(trace);
+
+    /* J2735 Decoding */
+    result = asn1_uper_decode(&msg, asn1_type_MessageFrame, pkt, len, &err);
+    if(result < 0)
+    {
+        //printf("[prcsJ2735] Decoding fail \n");
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Decoding fail \n");
+        v2xstat_Inc(rxStat.decodeFail);
+        return;
+    }
+    v2xtrace_Stamp(&trace, v2xtraceStage_Decode);
+    v2xstat_Inc(rxStat.decode);
+
+    if( g_mib.dbg)
+    {
+        //printf("[prcsJ2735] Decoding success\n");
+        //asn1_xer_printf(asn1_type_MessageFrame, msg);
+        syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Decoding success\n");
+    }
+
+    switch( ((MessageFrame *)msg)->messageId)
+    {
+        case 28 :
             {
+                RTCMcorrections *pRTCM = ((MessageFrame *)msg)->value.u.data;
+                uint8_t job[sizeof(trace) + kMpduMaxSize];
+
+                v2xstat_Inc(rxStat.rtcm);
                 if( g_mib.dbg)
                 {
-                    //printf("[prcsJ2735] Decoding success\n");
-                    //asn1_xer_printf(asn1_type_MessageFrame, msg);
-                    syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Decoding success\n");
+                    //printf("[prcsJ2735] Receive RTCM(%d Byte)\n", result);
+                    syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Receive RTCM(%d Byte)\n", result);
+                    //hexdump(pRTCM->msgs.tab->buf, pRTCM->msgs.tab->len);
                 }
 
-                /* 1초 계산 획득 */
-                if(timeFlag == false)
+                /* 추적정보를 붙여 이벤트 루프 쓰레드로 넘긴다. */
+                if(pRTCM->msgs.tab->len <= kMpduMaxSize)
                 {
-                    gettimeofday(&startTime, NULL);
-                    timeCheck = startTime.tv_sec - endTime.tv_sec;
-                    if(timeCheck >= 1)
-                    {
-                        timeFlag = true;
-                    }
-                    else if(timeCheck < 0)
-                    {
-                        gettimeofday(&endTime, NULL);
-                        continue;
-                    }
+                    memcpy(job, &trace, sizeof(trace));
+                    memcpy(job + sizeof(trace), pRTCM->msgs.tab->buf, pRTCM->msgs.tab->len);
                 }
-
-                switch( ((MessageFrame *)msg)->messageId)
+                if(pRTCM->msgs.tab->len > kMpduMaxSize ||
+                   evPost(rxWriteRTCM, job, sizeof(trace) + pRTCM->msgs.tab->len) < 0)
                 {
-                    case 28 :
-                        {
-                            RTCMcorrections *pRTCM = ((MessageFrame *)msg)->value.u.data;
-
-                            if( g_mib.dbg)
-                            {
-                                //printf("[prcsJ2735] Receive RTCM(%d Byte)\n", result);
-                                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Receive RTCM(%d Byte)\n", result);
-                                //hexdump(pRTCM->msgs.tab->buf, pRTCM->msgs.tab->len);
-                            }
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] startTime : %d, endTime : %d\n",  startTime.tv_sec, endTime.tv_sec);
-
-                            if(sockCheck == false )
-                            {
-                                if(timeFlag)
-                                {
-                                    timeFlag = false;
-                                    gettimeofday(&endTime, NULL);
-
-                                    syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] gps_fd : %d\n", gpsData.gps_fd);
-                                    result = write(gpsData.gps_fd, pRTCM->msgs.tab->buf, pRTCM->msgs.tab->len);
-                                    if( result < 0)
-                                    {
-                                        //perror("[prcsJ2735] RTCM write fail : ");
-                                        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735]  RTCM write fail : %s\n", strerror(errno));
-                                        gps_close(&gpsData);
-                                        sockCheck = true;
-                                    }
-                                    else
-                                    {
-                                        if(gpsData.pvt.flags == 0x01)
-                                            writeErrCnt++;
-                                        else
-                                            writeErrCnt = 0;
-
-                                        if(writeErrCnt >= 3)
-                                        {
-                                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] RTCM write err\n");
-                                            gps_close(&gpsData);
-                                            sockCheck = true;
-                                            writeErrCnt = 0;
-                                            continue;
-                                        }
-
-                                        if( g_mib.dbg)
-                                        {
-
-                                            //printf("[prcsJ2735] Write RTCM(%d byte)\n",  result);
-                                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Write RTCM(%d byte)\n",  result);
-                                        }
-                                    }
-                                }
-                            }
-                            else
-                                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] GPSd socket not open\n");
-
-                            break;
-                        }
-                        /* TO DO - MapData, SPaT, PVD, BSM, RSA, TIM 
-                           추가 필요 */
+                    syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Drop RTCM(%d Byte)\n", (int)pRTCM->msgs.tab->len);
+                    v2xstat_Inc(rxStat.rtcmDrop);
                 }
+                break;
             }
-        }
+            /* TO DO - MapData, SPaT, PVD, BSM, RSA, TIM 
+               추가 필요 */
     }
 
-    if(g_mib.dbg)
+    asn1_free_value(asn1_type_MessageFrame, msg);
+}
+
+/**
+ * RTCM 보정정보를 gpsd로 쓴다. 1초에 한 번만 쓴다. (이벤트 루프 쓰레드)
+ * 작업 데이터는 추적정보 뒤에 RTCM이 붙은 형태다. 쓰지 않고 넘긴 RTCM의 추적은 디코딩 단계에서 끝난다.
+ */
+static void rxWriteRTCM(uint8_t *data, uint32_t len)
+{
+    int result;
+    int timeCheck = 0;
+    struct v2xtraceCtx_t trace;
+    struct timespec t0, t1;
+    uint8_t *buf = data + sizeof(trace);
+
+    memcpy(&trace, data, sizeof(trace));
+    len -= sizeof(trace);
+
+    /* 1초 계산 획득 */
+    if(timeFlag == false)
     {
-        /* 송신 쓰레드 종료 */
-        result = pthread_join(gpsd_thread, (void **)status);
-        if( result == 0 )
+        gettimeofday(&startTime, NULL);
+        timeCheck = startTime.tv_sec - endTime.tv_sec;
+        if(timeCheck >= 1)
         {
-            if( g_mib.dbg )
-            {
-                //printf("[prcsJ2735] Completed join with gpsdThread status = %d\n", status);
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Completed join with gpsdThread status = %d\n", status);
-            }
+            timeFlag = true;
         }
-        else
+        else if(timeCheck < 0)
         {
-            //printf("[prcsJ2735] ERROR: return code from pthread_join() is %d\n", result);
-            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] ERROR: return code from pthread_join() is %d\n", result);
+            gettimeofday(&endTime, NULL);
+            v2xstat_Inc(rxStat.writeSkip);
+            return;
         }
     }
-    else if(g_mib.dbg == 0)
-        gps_close(&gpsData);
+    syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] startTime : %ld, endTime : %ld\n",  (long)startTime.tv_sec, (long)endTime.tv_sec);
 
-    ReleaseShm(shmPtr);
-
-    return;
-}
+    if(sockCheck == true)
+    {
+        syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] GPSd socket not open\n");
+        v2xstat_Inc(rxStat.writeSkip);
+        return;
+    }
+    if(timeFlag == false)
+    {
+        v2xstat_Inc(rxStat.writeSkip);
+        return;
+    }
 
-static void* gpsdThread(void *notused)
-{
-    int result;
-    GPS_Pkt_t shared_GPS;
-    uint32_t prevItow = 0;
+    timeFlag = false;
+    gettimeofday(&endTime, NULL);
 
-#if 0
-    //result = gps_open("localhost", g_mib.gpsdPort, &gpsData);
-    result = gps_open(GPSD_SHARED_MEMORY, 0, &gpsData);
-    if(result < 0 )
+    syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] gps_fd : %d\n", gpsData.gps_fd);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    result = write(gpsData.gps_fd, buf, len);
+    if( result < 0)
     {
-        //printf("[prcsJ2735] gps_opn() fail(%s)\n", gps_errstr(result));
-        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_opn() fail(%s)\n", gps_errstr(result));
-        sockCheck = true;
+        //perror("[prcsJ2735] RTCM write fail : ");
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735]  RTCM write fail : %s\n", strerror(errno));
+        v2xstat_Inc(rxStat.writeFail);
+        closeGPSD();
+        return;
     }
-    //gpsdOpenFlag = true;
-    //(void) gps_stream(&gpsData, WATCH_ENABLE | WATCH_JSON, NULL);
-#else
-    openGPSD();
-#endif
+    v2xtrace_Stamp(&trace, v2xtraceStage_GpsdWrite);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    v2xstat_Inc(rxStat.write);
+    v2xstat_Add(rxStat.writeBytes, result);
+    v2xstat_Observe(rxStat.writeTime, (t1.tv_sec - t0.tv_sec) * 1000000LL + (t1.tv_nsec - t0.tv_nsec) / 1000);
+
+    if(gpsData.pvt.flags == 0x01)
+        writeErrCnt++;
+    else
+        writeErrCnt = 0;
 
+    if(writeErrCnt >= 3)
+    {
+        syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] RTCM write err\n");
+        closeGPSD();
+        writeErrCnt = 0;
+        return;
+    }
 
-    while(!ending)
+    if( g_mib.dbg)
     {
-        /* connection check */
-        if(sockCheck == true)
-        {
-#if 0
-            gps_close(&gpsData);
+        //printf("[prcsJ2735] Write RTCM(%d byte)\n",  result);
+        syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Write RTCM(%d byte)\n",  result);
+    }
+}
 
-            //printf("[prcsJ2735] Re connection to GPSD\n");
-            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Re connection to GPSD\n");
+/**
+ * gpsd 보고를 읽는다. (이벤트 루프 쓰레드)
+ */
+static void rxGpsdRead(int fd, uint32_t events, void *arg)
+{
+    int result;
 
-            //result = gps_open("localhost", g_mib.gpsdPort, &gpsData);
-            result = gps_open(GPSD_SHARED_MEMORY, 0, &gpsData);
-            if(result < 0 )
-            {
-                //printf("[prcsJ2735] gps_opn() fail(%s)\n", gps_errstr(result));
-                syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_opn() fail(%s)\n", gps_errstr(result));
-                sleep(1);
-                continue;
-            }
-            //(void) gps_stream(&gpsData, WATCH_ENABLE | WATCH_JSON, NULL);
+    gpsdIdle = 0;
 
-            sockCheck = false;
-#else
-            if(openGPSD() == -1)
-            {
-                sleep(1);
-                continue;
-            }
-#endif
+    /* libgps 버퍼에 남은 보고까지 모두 읽는다. (버퍼에 남은 데이터로는 epoll이 깨지 않는다) */
+    do
+    {
+        result = gps_read(&gpsData);
+        if(result < 0)
+        {
+            //printf("[prcsJ2735] gps_read() fail( %s)\n", gps_errstr(result));
+            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_read() fail( %s)\n", gps_errstr(result));
+            closeGPSD();
+            return;
         }
 
-        /* gps read */
-        if (gps_waiting(&gpsData, 3000000))
+        if(gpsData.set & UBX_PVT_SET )
         {
-//            gpsdCheckFlag = false;
-            result = gps_read(&gpsData);
-            if(result < 0)
-            {
-                //printf("[prcsJ2735] gps_read() fail( %s)\n", gps_errstr(result));
-                syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_read() fail( %s)\n", gps_errstr(result));
-                gps_close(&gpsData);
-                sockCheck = true;
-                sleep(1);
-            }
-            else
+            if(g_mib.dbg)
             {
-                if(gpsData.set & UBX_PVT_SET )
+                if(prevItow != gpsData.pvt.itow)
                 {
-                    if(g_mib.dbg)
-                    {
-                        if(prevItow != gpsData.pvt.itow)
-                        {
-#if 1
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] %u %u %d 0x%02x %u %u-%u-%u %u:%u:%u.%d\n", gpsData.pvt.lat, gpsData.pvt.lon, gpsData.pvt.gSpeed, gpsData.pvt.flags, gpsData.pvt.pDOP, gpsData.pvt.year, gpsData.pvt.month, gpsData.pvt.day, gpsData.pvt.hour, gpsData.pvt.min, gpsData.pvt.sec, gpsData.pvt.nano);
-#else
-                            syslog(LOG_INFO | LOG_LOCAL0, "*******************gpsData*****************\n");
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] itow      : %u\t", gpsData.pvt.itow);
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] time      : %u-%u-%u %u:%u:%u.%d\t", gpsData.pvt.year, gpsData.pvt.month, gpsData.pvt.day, gpsData.pvt.hour, gpsData.pvt.min, gpsData.pvt.sec, gpsData.pvt.nano);
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] latitude  : %u\t", gpsData.pvt.lat);
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] longitude : %u\t", gpsData.pvt.lon);
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] speed     : %u\t", gpsData.pvt.gSpeed);
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] numSV     : %u\t", gpsData.pvt.numSV);
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] pDOP      : %u\t", gpsData.pvt.pDOP);
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] hAcc      : %u\t", gpsData.pvt.hAcc);
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] vAcc      : %u\t", gpsData.pvt.vAcc);
-                            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] flags     : 0x%02x\t", gpsData.pvt.flags);
-                            syslog(LOG_INFO | LOG_LOCAL0, "*******************************************\n");
-#endif
-                            prevItow = gpsData.pvt.itow;
-                        }
-                    }
+                    syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] %u %u %d 0x%02x %u %u-%u-%u %u:%u:%u.%d\n", gpsData.pvt.lat, gpsData.pvt.lon, gpsData.pvt.gSpeed, gpsData.pvt.flags, gpsData.pvt.pDOP, gpsData.pvt.year, gpsData.pvt.month, gpsData.pvt.day, gpsData.pvt.hour, gpsData.pvt.min, gpsData.pvt.sec, gpsData.pvt.nano);
+                    prevItow = gpsData.pvt.itow;
                 }
             }
         }
-        else
-        {
-            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_waiting() fail( %s)\n", gps_errstr(result));
+    } while(gps_waiting(&gpsData, 0));
+}
 
-            gpsdCheckFlag = true;
-            memcpy(shmPtr, &gpsdCheckFlag, sizeof(bool));
+/**
+ * 1초마다 gpsd 연결과 수신을 확인한다. (이벤트 루프 쓰레드)
+ */
+static void rxHousekeep(int fd, uint32_t events, void *arg)
+{
+    evTimerRead(fd);
 
-            gps_close(&gpsData);
-            sockCheck = true;
-        }
+    /* connection check */
+    if(sockCheck == true)
+    {
+        syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Re connection to GPSD\n");
+        v2xstat_Inc(rxStat.reconnect);
+        openGPSD();
+        return;
     }
-    gps_close(&gpsData);
-    pthread_exit((void *)0);
-}
 
+    /* gps_waiting() 3초 타임아웃과 같이 수신이 없으면 공유메모리 플래그를 set하고 다시 연결한다. */
+    if(++gpsdIdle >= GPSD_IDLE_MAX)
+    {
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] No gpsd data for %d sec\n", gpsdIdle);
 
+        gpsdCheckFlag = true;
+        memcpy(shmPtr, &gpsdCheckFlag, sizeof(bool));
+
+        closeGPSD();
+    }
+}
+
+/**
+ * 수신 동작의 공유메모리 통계를 등록한다.
+ */
+static void rxInitStat(void)
+{
+    static const int64_t usecBounds[] = V2XSTAT_USEC_BOUNDS;
+
+    rxStat.decode = v2xstat_Counter("rx.decode", "msg");
+    rxStat.decodeFail = v2xstat_Counter("rx.decode_fail", "msg");
+    rxStat.rtcm = v2xstat_Counter("rx.rtcm", "msg");
+    rxStat.rtcmDrop = v2xstat_Counter("rx.rtcm_drop", "msg");
+    rxStat.write = v2xstat_Counter("gpsd.rtcm_write", "msg");
+    rxStat.writeBytes = v2xstat_Counter("gpsd.rtcm_bytes", "byte");
+    rxStat.writeSkip = v2xstat_Counter("gpsd.rtcm_skip", "msg");
+    rxStat.writeFail = v2xstat_Counter("gpsd.write_fail", "msg");
+    rxStat.writeTime = v2xstat_Hist("gpsd.write_time", "usec", usecBounds, sizeof(usecBounds) / sizeof(usecBounds[0]));
+    rxStat.reconnect = v2xstat_Counter("gpsd.reconnect", "conn");
+}
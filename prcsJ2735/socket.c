@@ -17,8 +17,6 @@ int client_sock = -1;
 bool connectFlag = false;
 struct sockaddr_in server_addr1, server_addr2, client_addr;
 unsigned int client_addr_size = sizeof(client_addr);
-pthread_mutex_t fd_mutex = PTHREAD_MUTEX_INITIALIZER; 
-pthread_t sock_thread;
 
 int sendPkt()
 {
@@ -26,6 +24,10 @@ int sendPkt()
     uint8_t buf[1024];
     int len; 
 
+    /* 소켓이 아직 없으면 connection_Check()가 생성할 때까지 보내지 않는다. */
+    if(server_sock1 == -1 && server_sock2 == -1)
+        return 0;
+
     memset(&buf, 0, sizeof(buf));
 
     len = getRTCM(buf);
@@ -44,10 +46,8 @@ int sendPkt()
         {
             //perror("[prcsJ2735] packet send error :");
             syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] packet send error :%s\n", strerror(errno));
-            pthread_mutex_lock(&fd_mutex);
             close(server_sock1);
             server_sock1 = -1;
-            pthread_mutex_unlock(&fd_mutex);
             return -1;
         }
         result = sendto( server_sock2, &buf, len, MSG_DONTWAIT|MSG_NOSIGNAL, (struct sockaddr*)&server_addr2, sizeof(client_addr) );
@@ -65,10 +65,8 @@ int sendPkt()
         {
             //perror("[prcsJ2735] packet send error :");
             syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] packet send error :%s\n", strerror(errno));
-            pthread_mutex_lock(&fd_mutex);
             close(server_sock2);
             server_sock2 = -1;
-            pthread_mutex_unlock(&fd_mutex);
             return -1;
         }
 
@@ -85,7 +83,7 @@ int recvPkt()
     uint8_t buf[1024];
 
     /* Receive UDP Packet  */
-    result = recvfrom(client_sock, &buf, sizeof(buf), 0, (struct sockaddr*)&client_addr, &client_addr_size);
+    result = recvfrom(client_sock, &buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr*)&client_addr, &client_addr_size);
     if( result > 0 )
     {
         if(g_mib.dbg)
@@ -97,94 +95,39 @@ int recvPkt()
     }
     else if(result == -1)
     {
+        if(errno == EAGAIN || errno == EINTR)
+            return 0;
         //perror("[prcsJ2735] packet recv error :");
         syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] packet recv error : %s\n", strerror(errno));
-        pthread_mutex_lock(&fd_mutex);
+        evDel(client_sock);
         close(client_sock);
         client_sock = -1;
-        pthread_mutex_unlock(&fd_mutex);
         return -1;
     }
-}
-
-
-/* socket Thread */
-static void* sock_func(void* arg)
-{
-    uint32_t result;
-
-    while(!ending)
-    {
-        /* Socket check */
-        if(g_mib.sockType == udpServer)
-        {
-            if(server_sock1 == -1 && server_sock2 == -1)
-            {
-                //printf("[prcsJ2735] No setting socket yet\n");
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] No setting socket yet\n");
-                sleep(1);
-
-                continue;
-            }
-
-            pthread_mutex_lock(&g_mib.txMtx);
-            pthread_cond_wait(&g_mib.txCond, &g_mib.txMtx);
-            pthread_mutex_unlock(&g_mib.txMtx);
-
-            sendPkt();
-        }
-        if(g_mib.sockType == udpClient)
-        {
-            if(client_sock == -1)
-            {
-                //printf("[prcsJ2735] No setting socket yet\n");
-                syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] No setting socket yet\n");
-                sleep(1);
-
-                continue;
-            }
-
-            recvPkt();
-        }
-    }
 
-    pthread_exit((void *)0);
+    return result;
 }
 
 
-/* 쓰레드 생성 */
-int createSockThread()
+/* UDP 클라이언트 소켓 수신 (이벤트 루프 쓰레드) */
+static void sockRead(int fd, uint32_t events, void *arg)
 {
-    /* 수신 쓰레드 생성 */
-    if(  pthread_create(&sock_thread, NULL, &sock_func, NULL) != 0)
-    {
-        //perror("[prcsJ2735] Fail to create recv thread : ");
-        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] Fail to create recv thread : %s\n", strerror(errno));
-        return -1;
-    }
-
-    return 0;
+    recvPkt();
 }
 
-/* 쓰레드 닫기 */
-void closeSocketThread()
+/* 소켓 닫기 */
+void closeSocket(void)
 {
-    int rc;
-    int status;
-
-    rc = pthread_join(sock_thread, (void **)&status);
-    if( rc == 0 )
+    if(server_sock1 != -1)
+        close(server_sock1);
+    if(server_sock2 != -1)
+        close(server_sock2);
+    if(client_sock != -1)
     {
-        //printf("Completed join with sockThread status = %d\n", status);
-        syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Completed join with sockThread status = %d\n", status);
-    }
-    else
-    {
-        //printf("[prcsJ2735] ERROR: return code from pthread_join() is %d\n", rc);
-        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] ERROR: return code from pthread_join() is %d\n", rc);
+        evDel(client_sock);
+        close(client_sock);
     }
-
-    pthread_mutex_destroy(&fd_mutex);
+    server_sock1 = server_sock2 = client_sock = -1;
 
     return;
 }
@@ -267,6 +210,14 @@ int clientSockConnection(int connect_timeout_usec)
 
         client_sock = dup(tmpfd);
         close(tmpfd);
+
+        /* 수신은 이벤트 루프에서 처리한다. */
+        if(evAdd(client_sock, sockRead, NULL) < 0)
+        {
+            close(client_sock);
+            client_sock = -1;
+            return -1;
+        }
     }
     return 0;
 }
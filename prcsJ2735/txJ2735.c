@@ -2,137 +2,238 @@
 #include <unistd.h>
 
 /* 전역변수 */
-pthread_t tx_thread;
+static struct gps_data_t gpsData;
+static bool gpsdOpen = false;
+static int hkTimerFd = -1;
 
-/* 함수원형*/
-static void* txThread(void *notused);
+/* 공유메모리 통계 (v2xtop) */
+static struct
+{
+    const struct v2xstatDesc_t *tick;           /* 송신주기 수 */
+    const struct v2xstatDesc_t *tickMissed;     /* 늦게 처리되어 건너뛴 송신주기 수 */
+    const struct v2xstatDesc_t *encode;         /* 메시지 생성 수 */
+    const struct v2xstatDesc_t *encodeFail;     /* 메시지 생성 실패 수 */
+    const struct v2xstatDesc_t *encodeTime;     /* 메시지 생성 시간(usec) */
+    const struct v2xstatDesc_t *gpsdRead;       /* gpsd 보고 수 */
+    const struct v2xstatDesc_t *gpsdReadFail;   /* gps_read() 실패 수 */
+    const struct v2xstatDesc_t *reconnect;      /* gpsd 재연결 수 */
+} txStat;
 
-void setJ2735tx()
+/* 함수원형*/
+static void txTick(uint64_t missed, void *notused);
+static void txUdpSend(uint8_t *notused, uint32_t len);
+static void txEncode(struct v2xtraceCtx_t *trace);
+static void txGpsdRead(int fd, uint32_t events, void *arg);
+static void txHousekeep(int fd, uint32_t events, void *arg);
+static void txInitStat(void);
+
+static int txGpsdOpen(void)
 {
     int result;
-    int status;
-    struct gps_data_t gpsData;
 
-    /* GPSD */
-    if(g_mib.sockType == udpServer)
+    result = gps_open("localhost", g_mib.gpsdPort, &gpsData);
+    if(result < 0 )
     {
-        result = gps_open("localhost", g_mib.gpsdPort, &gpsData);
-        if(result < 0 )
-        {
-        //    printf("[prcsJ2735] gps_opn() fail(%s)\n", gps_errstr(result));
-            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_open() fail(%s)\n", gps_errstr(result));
-            return;
-        }
-        (void) gps_stream(&gpsData, WATCH_ENABLE | WATCH_JSON, NULL);
+    //    printf("[prcsJ2735] gps_opn() fail(%s)\n", gps_errstr(result));
+        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_open() fail(%s)\n", gps_errstr(result));
+        return -1;
     }
+    (void) gps_stream(&gpsData, WATCH_ENABLE | WATCH_JSON, NULL);
 
-    /* 송신 타이머 관련 뮤텍스, 컨디션시그널 초기*/
-    pthread_mutex_init(&g_mib.txMtx, NULL);
-    pthread_cond_init(&g_mib.txCond, NULL);
+    if(evAdd(gpsData.gps_fd, txGpsdRead, NULL) < 0)
+    {
+        gps_close(&gpsData);
+        return -1;
+    }
+    gpsdOpen = true;
 
-    setRTCM_mutex(0);
+    return 0;
+}
 
-    /* 송신 쓰레드 생성 */
-    result = pthread_create(&tx_thread, NULL, txThread, NULL);
-    if (result < 0) {
-        //perror("[prcsJ2735] fail to create tx thread() ");
-        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] fail to create tx thread() : %s\n", strerror(errno));
+static void txGpsdClose(void)
+{
+    if(!gpsdOpen)
         return;
-    }
+    evDel(gpsData.gps_fd);
+    gps_close(&gpsData);
+    gpsdOpen = false;
+}
 
-    /* 타이머 생성 */ 
-    InitTxTimer(g_mib.interval);
+void setJ2735tx()
+{
+    struct txTimer_t *timer;
 
-    /* Socket 쓰레드 생성 */
-    createSockThread();
+    txInitStat();
 
-    while(!ending)
-    {
-        /* Socket connection */
-        connection_Check();
-       
-        if(g_mib.sockType == udpServer)
-        {
-            if (gps_waiting(&gpsData, 1000000))
-            {
-                result = gps_read(&gpsData);
-                if(result == -1)
-                {
-                //    printf("[prcsJ2735] gps_read() fail( %s)\n", gps_errstr(result));
-                    syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_read() fail( %s)\n", gps_errstr(result));
-                }
-                else if(result > 0)
-                {
-                    /* RTCM 송신일경우 RTCM 파싱 */
-                    if(g_mib.op == opType_tx_RTCM /*&& gpsData.set & RTCM3_SET*/)
-                        rtcmPkt(&gpsData);
-                }
-            }
-        }
-        else
-            sleep(1);
-    }
+    /* 이벤트 루프 초기화 */
+    if(evInit() < 0)
+        return;
+
+    setRTCM_mutex(0);
 
-    /* 송신 쓰레드 종료 */
-    result = pthread_join(tx_thread, (void **)status);
-    if( result == 0 )
+    /* GPSD */
+    if(g_mib.sockType == udpServer)
     {
-        if( g_mib.dbg )
+        if(txGpsdOpen() < 0)
         {
-            //printf("[prcsJ2735] Completed join with txThread status = %d\n", status);
-            syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Completed join with txThread status = %d\n", status);
+            setRTCM_mutex(1);
+            evRelease();
+            return;
         }
     }
-    else
+
+    /* Socket 생성 */
+    connection_Check();
+
+    /* 1초 주기로 소켓/gpsd 연결을 확인한다. */
+    hkTimerFd = evTimer(1000000, txHousekeep, NULL);
+
+    /* 송신 타이머 생성 - 송신주기마다 타이머 쓰레드에서 txTick()이 호출된다. */
+    timer = InitTxTimer("prcsJ2735", g_mib.interval, txTick, NULL);
+    if(timer != NULL)
+        evRun();
+
+    ReleaseTxTimer(timer, NULL);
+    if(hkTimerFd >= 0)
     {
-        printf("[prcsJ2735] ERROR: return code from pthread_join() is %d\n", result);
-        syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] ERROR: return code from pthread_join() is %d\n", result);
+        evDel(hkTimerFd);
+        close(hkTimerFd);
     }
 
-    /* Socket 쓰레드 종료 */
+    /* gpsd Socket close */
+    txGpsdClose();
 
+    /* Socket close */
+    closeSocket();
 
-    /* 뮤텍스 및 컨디션시그널 해제 */
-    pthread_mutex_destroy(&g_mib.txMtx);
-    pthread_cond_destroy(&g_mib.txCond);
+    /* 작업 쓰레드 종료 후 뮤텍스 해제 */
+    evRelease();
     setRTCM_mutex(1);
 
-    /* gpsd Socket close */
+    return;
+}
+
+/**
+ * 송신주기마다 타이머 쓰레드에서 호출된다.
+ * 여러 주기가 한 번에 만기되었으면 최신 RTCM으로 한 번만 송신한다. (놓친 주기는 타이머가 센다)
+ */
+static void txTick(uint64_t missed, void *notused)
+{
+    struct v2xtraceCtx_t trace;
+
+    v2xstat_Inc(txStat.tick);
+    v2xstat_Add(txStat.tickMissed, (int64_t)missed);
+    if(missed > 0 && g_mib.dbg)
+        syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Tx tick late, %llu ticks missed\n", (unsigned long long)missed);
+
+    fillRTCM(&trace);
+
+    /* UDP 서버일 경우 RTCM을 전달한다. (소켓은 이벤트 루프 쓰레드가 관리한다) */
     if(g_mib.sockType == udpServer)
-        gps_close(&gpsData);
+        evPost(txUdpSend, NULL, 0);
 
-    return;
+    /* 메시지 생성 및 송신 */
+    txEncode(&trace);
+}
+
+static void txUdpSend(uint8_t *notused, uint32_t len)
+{
+    sendPkt();
 }
 
-static void* txThread(void *notused)
+/**
+ * 설정된 동작에 따라 메시지를 생성하여 송신한다. (타이머 쓰레드)
+ *
+ * @param trace     메시지의 추적정보 (추적하지 않으면 magic이 0)
+ */
+static void txEncode(struct v2xtraceCtx_t *trace)
 {
     int	result;
     uint8_t pkt[kMpduMaxSize];
-    uint32_t len = 0;
+    uint32_t pktLen = 0;
+    struct timespec t0, t1;
 
-    /* 설정된 동작에 따라 메시지를 생성한다. */
-    while(!ending)
+    /* 동작모드가 RTCM일때 */
+    if(g_mib.op == opType_tx_RTCM)
     {
-        /* 송신타이머로부터 시그널이 올때 때까지 대기한다. */
-        pthread_mutex_lock(&g_mib.txMtx);
-        pthread_cond_wait(&g_mib.txCond, &g_mib.txMtx);
-        pthread_mutex_unlock(&g_mib.txMtx);
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        result	=	ConstructRTCM(pkt, &pktLen);
+        if(result < 0)
+        {
+            v2xstat_Inc(txStat.encodeFail);
+            return;
+        }
+        v2xtrace_Stamp(trace, v2xtraceStage_Construct);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        v2xstat_Inc(txStat.encode);
+        v2xstat_Observe(txStat.encodeTime, (t1.tv_sec - t0.tv_sec) * 1000000LL + (t1.tv_nsec - t0.tv_nsec) / 1000);
 
-        /* 동작모드가 RTCM일때 */
-        if(g_mib.op == opType_tx_RTCM)
+        /* 생성된 메시지를 송신한다. */
+        sendMQ(pkt, pktLen, trace);
+    }
+    /* TO DO - MapData, SPaT, PVD, BSM, RSA, TIM
+       추가 필요 */
+}
+
+static void txGpsdRead(int fd, uint32_t events, void *arg)
+{
+    int result;
+    uint64_t readTime;
+
+    /* libgps 버퍼에 남은 보고까지 모두 읽는다. (버퍼에 남은 데이터로는 epoll이 깨지 않는다) */
+    do
+    {
+        /* 지연 추적의 시작 시각 - 보고를 읽기 시작한 시각 */
+        readTime = g_mib.trace ? v2xtrace_Now() : 0;
+        result = gps_read(&gpsData);
+        if(result == -1)
+        {
+        //    printf("[prcsJ2735] gps_read() fail( %s)\n", gps_errstr(result));
+            syslog(LOG_ERR | LOG_LOCAL1, "[prcsJ2735] gps_read() fail( %s)\n", gps_errstr(result));
+            v2xstat_Inc(txStat.gpsdReadFail);
+            txGpsdClose();
+            return;
+        }
+        else if(result > 0)
         {
-            result	=	ConstructRTCM(pkt, &len);
-            if(result < 0)
-                continue;
+            v2xstat_Inc(txStat.gpsdRead);
 
-            /* 생성된 메시지를 송신한다. */
-            sendMQ(pkt, len); 
-            memset(pkt, 0, sizeof(pkt));
+            /* RTCM 송신일경우 RTCM 파싱 */
+            if(g_mib.op == opType_tx_RTCM /*&& gpsData.set & RTCM3_SET*/)
+                rtcmPkt(&gpsData, readTime);
         }
-        /* TO DO - MapData, SPaT, PVD, BSM, RSA, TIM 
-           추가 필요 */
+    } while(gps_waiting(&gpsData, 0));
+}
+
+static void txHousekeep(int fd, uint32_t events, void *arg)
+{
+    evTimerRead(fd);
 
+    /* Socket connection */
+    connection_Check();
+
+    /* gpsd 재연결 */
+    if(g_mib.sockType == udpServer && !gpsdOpen)
+    {
+        syslog(LOG_INFO | LOG_LOCAL0, "[prcsJ2735] Re connection to GPSD\n");
+        v2xstat_Inc(txStat.reconnect);
+        txGpsdOpen();
     }
+}
 
-    pthread_exit((void *)0);
+/**
+ * 송신 동작의 공유메모리 통계를 등록한다.
+ */
+static void txInitStat(void)
+{
+    static const int64_t usecBounds[] = V2XSTAT_USEC_BOUNDS;
+
+    txStat.tick = v2xstat_Counter("tx.tick", "tick");
+    txStat.tickMissed = v2xstat_Counter("tx.tick_missed", "tick");
+    txStat.encode = v2xstat_Counter("tx.encode", "msg");
+    txStat.encodeFail = v2xstat_Counter("tx.encode_fail", "msg");
+    txStat.encodeTime = v2xstat_Hist("tx.encode_time", "usec", usecBounds, sizeof(usecBounds) / sizeof(usecBounds[0]));
+    txStat.gpsdRead = v2xstat_Counter("gpsd.read", "report");
+    txStat.gpsdReadFail = v2xstat_Counter("gpsd.read_fail", "report");
+    txStat.reconnect = v2xstat_Counter("gpsd.reconnect", "conn");
 }
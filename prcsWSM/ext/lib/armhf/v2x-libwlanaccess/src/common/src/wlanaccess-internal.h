@@ -10,6 +10,8 @@
 #define LIBWLANACCESS_WLANACCESS_INTERNAL_H
 
 
+#include <pthread.h>
+
 #include "wlanaccess.h"
 
 
@@ -86,8 +88,11 @@ struct AlPlatformSpecificData {
  */
 struct AlPlatform {
 
-  struct AlTxStatstics txstats[_V2X_IF_NUM_][2]; /// 인터페이스/타임슬롯 별 송신통계정보
-  struct AlRxStatstics rxstats[_V2X_IF_NUM_][2]; /// 인터페이스/타임슬롯 별 수신통계정보
+  struct AlTxStatstics txstats[_V2X_IF_NUM_][2]; /// 인터페이스/타임슬롯 별 송신통계정보 (하드웨어 누적값)
+  struct AlRxStatstics rxstats[_V2X_IF_NUM_][2]; /// 인터페이스/타임슬롯 별 수신통계정보 (하드웨어 누적값)
+  struct AlTxStatstics txstats_base[_V2X_IF_NUM_][2]; /// 마지막 Al_ClearTxStatistics() 호출 시점의 송신통계정보
+  struct AlRxStatstics rxstats_base[_V2X_IF_NUM_][2]; /// 마지막 Al_ClearRxStatistics() 호출 시점의 수신통계정보
+  pthread_mutex_t stats_mtx; /// 통계정보 뮤텍스 (이벤트폴링 쓰레드/어플리케이션 쓰레드 간)
   struct AlPlatformSpecificData platform_data; /// 플랫폼 의존적 정보
 
   /// @brief 채널접속 처리결과 전달 콜백함수 포인터
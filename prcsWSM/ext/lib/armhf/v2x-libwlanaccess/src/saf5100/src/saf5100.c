@@ -9,6 +9,7 @@
 #include <inttypes.h>
 #include <poll.h>
 #include <stdio.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "wlanaccess-16094.h"
@@ -308,6 +309,62 @@ al_SAF5100_ConvertDataRateToMcs(
 }
 
 
+/**
+ * @brief 시스템 단조시간(CLOCK_MONOTONIC)을 마이크로초 단위로 반환한다.
+ * @return 시스템 단조시간 (마이크로초)
+ */
+uint64_t INTERNAL al_SAF5100_GetMonotonicTime(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000ULL);
+}
+
+
+/**
+ * @brief 송신패킷의 만료시각(MKx Expiry)을 계산한다.
+ * @param saf5100_dev SAF5100 디바이스 정보
+ * @param expiry 현재시간으로부터의 유효기간 (마이크로초, 0이면 만료되지 않음)
+ * @return 만료시각 (절대 TSF, 마이크로초). 만료되지 않거나 TSF를 알 수 없으면 0
+ *
+ * 마지막으로 수신한 TSF(GetTSFInd)에 경과한 시스템 단조시간을 더해 현재 TSF를 추정한다.
+ * TSF 기준값이 SAF5100_TSF_REFRESH_INTERVAL 보다 오래되었으면 GetTSFReq()로 갱신을 요청한다.
+ * (응답은 이벤트폴링 쓰레드에서 비동기로 수신되므로 여기서는 대기하지 않는다)
+ */
+static tMKxTSF al_SAF5100_GetExpiryTsf(struct SAF5100Device *const saf5100_dev, const uint64_t expiry)
+{
+  tMKxTSF tsf = 0;
+  bool refresh = false;
+  uint64_t now = al_SAF5100_GetMonotonicTime();
+
+  pthread_mutex_lock(&saf5100_dev->tsf_mtx);
+  if (saf5100_dev->tsf_valid) {
+    tsf = saf5100_dev->tsf + (now - saf5100_dev->tsf_mono);
+  }
+  if ((!saf5100_dev->tsf_valid || (now - saf5100_dev->tsf_mono > SAF5100_TSF_REFRESH_INTERVAL)) &&
+      (now - saf5100_dev->tsf_req_mono > SAF5100_TSF_REQ_INTERVAL)) {
+    saf5100_dev->tsf_req_mono = now;
+    refresh = true;
+  }
+  pthread_mutex_unlock(&saf5100_dev->tsf_mtx);
+
+  if (refresh) {
+    int ret = saf5100_dev->mkx->API.Functions.GetTSFReq(saf5100_dev->mkx);
+    if (ret != MKXSTATUS_SUCCESS) {
+      Err("Fail to request TSF. GetTSFReq() failed - eMKxStatus: %d\n", ret);
+    }
+  }
+
+  if ((expiry == 0) || (tsf == 0)) {
+    if (expiry) {
+      Log(kAlLogLevel_event, "TSF is not available yet - transmit without expiry\n");
+    }
+    return 0;
+  }
+  return tsf + expiry;
+}
+
+
 /**
  * SAF5100 플랫폼의 MPDU 전송 함수 구현부.
  * 초기화 루틴에서 struct AlDeviceSpecificData 구조체의 TransmitMpdu() 함수포인터에 연결되며, Al_TransmitMpdu() 에서 호출된다.
@@ -391,7 +448,7 @@ static int al_SAF5100_TransmitMpdu(
   txpktdata->MCS = al_SAF5100_ConvertDataRateToMcs(mkx, ifindex_in_dev, txparams->datarate);
   txpktdata->TxPower = (tMKxPower)txparams->txpower;
   txpktdata->TxCtrlFlags = 0; // 0: 일반동작
-  txpktdata->Expiry = 0; // TODO:: 현재 TSF 읽어와서 txparams->expiry를 더한 TSF 값을 설정하는 것으로 변경
+  txpktdata->Expiry = al_SAF5100_GetExpiryTsf(&saf5100_platform->dev[dev_index], txparams->expiry);
   txpktdata->TxFrameLength = mpdu_size; // CRC 제외
   memcpy(txpktdata->TxFrame, mpdu, mpdu_size);
 
@@ -778,9 +835,17 @@ int INTERNAL al_PlatformInit(struct AlPlatform *const platform, const bool reset
     saf5100_dev->mkx->API.Callbacks.RxInd = al_SAF5100_RxInd;
     saf5100_dev->mkx->API.Callbacks.NotifInd = al_SAF5100_NotifInd;
 //  saf5100_dev->mkx->API.Callbacks.DebugInd = SAF5100_DebugInd;
-//  saf5100_dev->mkx->API.Callbacks.GetTSFInd = SAF5100_GetTSFInd;
+    saf5100_dev->mkx->API.Callbacks.GetTSFInd = al_SAF5100_GetTSFInd;
     saf5100_dev->mkx->API.Callbacks.C2XSecRsp = NULL;
     saf5100_dev->mkx->pPriv = (void *)&g_al_saf5100_platform.dev[i];
+    pthread_mutex_init(&saf5100_dev->tsf_mtx, NULL);
+
+    // 송신패킷 만료시각 계산을 위해 TSF 기준값을 미리 요청해 둔다. (응답: al_SAF5100_GetTSFInd())
+    ret = mkx->API.Functions.GetTSFReq(mkx);
+    if (ret != MKXSTATUS_SUCCESS) {
+      Err("Fail to request TSF of device %d. GetTSFReq() failed - eMKxStatus: %d\n", i, ret);
+    }
+    saf5100_dev->tsf_req_mono = al_SAF5100_GetMonotonicTime();
   }
 
   /*
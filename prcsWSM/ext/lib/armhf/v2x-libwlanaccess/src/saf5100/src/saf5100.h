@@ -10,6 +10,8 @@
 #define LIBWLANACCESS_SAF5100_H
 
 
+#include <pthread.h>
+
 #include "wlanaccess-internal.h"
 #include "llc-api.h"
 
@@ -28,6 +30,11 @@
 #define LLC_DEV_HEADROOM (72)
 #define LLC_DEV_TAILROOM (16)
 
+/// TSF 기준값 갱신 주기 (마이크로초). 기준값이 이보다 오래되면 GetTSFReq()로 갱신을 요청한다.
+#define SAF5100_TSF_REFRESH_INTERVAL (1000000ULL)
+/// GetTSFReq() 재요청 최소 간격 (마이크로초)
+#define SAF5100_TSF_REQ_INTERVAL (100000ULL)
+
 /*
  * API 를 통해 요청되는 요청의 유형
  */
@@ -48,6 +55,15 @@ struct SAF5100Device
   struct MKx *mkx;                   ///< 해당 디바이스에 연관된 MKx 핸들
   int fd;                            ///< 해당 디바이스에 대한 파일 디스크립터 (이벤트 폴링용)
   SAF5100ReqType req[SAF5100_IF_NUM_IN_DEV];   ///< 해당 디바이스의 각 인터페이스에 대한 요청 상태
+
+  /*
+   * TSF 기준값 - GetTSFInd() 수신 시 갱신되며, 송신 시 경과시간을 더해 현재 TSF를 추정한다.
+   */
+  pthread_mutex_t tsf_mtx;           ///< TSF 기준값 뮤텍스 (이벤트폴링 쓰레드/송신 쓰레드 간)
+  bool tsf_valid;                    ///< TSF 기준값 유효 여부
+  tMKxTSF tsf;                       ///< GetTSFInd()로 수신한 TSF
+  uint64_t tsf_mono;                 ///< TSF 수신 시점의 시스템 단조시간 (마이크로초)
+  uint64_t tsf_req_mono;             ///< 마지막 GetTSFReq() 요청 시점의 시스템 단조시간 (마이크로초)
 };
 
 /*
@@ -73,5 +89,7 @@ tMKxStatus INTERNAL al_SAF5100_TxCnf(struct MKx *pMKx, tMKxTxPacket *pTxPkt, con
 tMKxStatus INTERNAL al_SAF5100_RxAlloc(struct MKx *pMKx, int BufLen, uint8_t **ppBuf, void **ppPriv);
 tMKxStatus INTERNAL al_SAF5100_RxInd(struct MKx *pMKx, tMKxRxPacket *pRxPkt, void *pPriv);
 tMKxStatus INTERNAL al_SAF5100_NotifInd(struct MKx *pMKx, tMKxNotif Notif);
+tMKxStatus INTERNAL al_SAF5100_GetTSFInd(struct MKx *pMKx, tMKxTSF TSF);
+uint64_t INTERNAL al_SAF5100_GetMonotonicTime(void);
 
 #endif //LIBWLANACCESS_SAF5100_H
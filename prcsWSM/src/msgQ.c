@@ -13,8 +13,21 @@ struct msgQ_elem_frame *parRecvPkt = NULL; //PAR 메세지 버퍼
 struct msgQ_elem_frame *sendPkt = NULL; // 메시지 버퍼
 uint32_t msgqCnt = 0;
 
+/* 공유메모리 통계 (v2xtop) */
+static const struct v2xstatDesc_t *g_mqTxRecv; // 1717 송신요청 수신 수
+static const struct v2xstatDesc_t *g_mqRxSend; // 1716 수신패킷 전달 수
+static const struct v2xstatDesc_t *g_mqRxDrop; // 1716 큐가 가득 차 버린 수
+static const struct v2xstatDesc_t *g_mqParSend; // 1718 PAR 프로브 전달 수
+static const struct v2xstatDesc_t *g_mqParDrop; // 1718 큐가 가득 차 버린 수
+
 int initMQ(void)
 {
+    g_mqTxRecv = v2xstat_Counter("mq.1717_recv", "msg");
+    g_mqRxSend = v2xstat_Counter("mq.1716_send", "msg");
+    g_mqRxDrop = v2xstat_Counter("mq.1716_drop", "msg");
+    g_mqParSend = v2xstat_Counter("mq.1718_send", "msg");
+    g_mqParDrop = v2xstat_Counter("mq.1718_drop", "msg");
+
     if(g_mib.op == opRX || g_mib.op == opTRX)
     {
         /*  수신 메세지 큐용 버퍼 Allocation */
@@ -106,7 +119,7 @@ void releaseMQ(void)
     }
 }
 
-int recvMQ(char *pkt)
+int recvMQ(char *pkt, uint8_t *priority, uint32_t *lifetime, uint8_t *ifindex, uint32_t *psid, struct v2xtraceCtx_t *trace)
 {
     memset(sendPkt->msg.msg, 0, sendPkt->msg.msg_len);
 
@@ -123,18 +136,55 @@ int recvMQ(char *pkt)
             //printf("[prcsWSM] MQ receive(len: %d)\n", sendPkt->msg.msg_len);
             syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] MQ receive(len: %d)\n", sendPkt->msg.msg_len);
         }
+        if (sendPkt->msg.msg_len > MSGMAX)
+        {
+            syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] MQ receive error : invalid length(%u)", sendPkt->msg.msg_len);
+            return -1;
+        }
         memcpy(pkt, sendPkt->msg.msg, sendPkt->msg.msg_len);
+        v2xstat_Inc(g_mqTxRecv);
+
+        /* 우선순위 미지정 메시지는 기본 우선순위로 송신한다. */
+        if (sendPkt->priority > kDot3Priority_Max)
+            *priority = (uint8_t)g_mib.priority;
+        else
+            *priority = sendPkt->priority;
+
+        /* 유효기간 미지정 메시지는 기본 유효기간을 적용한다. */
+        if (sendPkt->lifetime == MSGQ_LIFETIME_DEFAULT)
+            *lifetime = g_mib.txLifetime;
+        else
+            *lifetime = sendPkt->lifetime;
+
+        /* 인터페이스 미지정 메시지는 기본 인터페이스로 송신한다. */
+        if (sendPkt->ifindex == MSGQ_IFINDEX_DEFAULT)
+            *ifindex = (uint8_t)g_mib.netIfIndex;
+        else
+            *ifindex = sendPkt->ifindex;
+
+        /* PSID 미지정 메시지는 기본 PSID로 송신한다. */
+        if (sendPkt->psid == MSGQ_PSID_DEFAULT)
+            *psid = g_mib.psid;
+        else
+            *psid = sendPkt->psid;
+
+        /* 추적 중인 메시지면 메시지큐에서 꺼낸 시각을 기록한다. */
+        *trace = sendPkt->trace;
+        v2xtrace_Stamp(trace, v2xtraceStage_MqTxRecv);
     }
 
     return sendPkt->msg.msg_len;
 }
 
-void sendMQ(uint8_t *pPkt, uint32_t len)
+void sendMQ(uint8_t *pPkt, uint32_t len, const struct v2xtraceCtx_t *trace)
 {
     memset(recvPkt->msg.msg, 0, recvPkt->msg.msg_len);
     recvPkt->msg.msg_len = len;
     memcpy(recvPkt->msg.msg, pPkt, len);
 
+    recvPkt->trace = *trace;
+    v2xtrace_Stamp(&recvPkt->trace, v2xtraceStage_MqRx);
+
     recvPkt->rxCnt = msgqCnt++;
     recvPkt->msgtype = 1; 
 
@@ -142,9 +192,11 @@ void sendMQ(uint8_t *pPkt, uint32_t len)
     {
         //perror("[precsWSM] MQ send error : ");
         syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] MQ send error : %s", strerror(errno));
+        v2xstat_Inc(g_mqRxDrop);
     }
     else
     {
+        v2xstat_Inc(g_mqRxSend);
         if (g_dbg >= kDbgMsgLevel_event)
         {
             //printf("[prcsWSM] MQ send(%d Byte) \n", recvPkt->msg.msg_len);
@@ -166,9 +218,11 @@ void PARsendMQ(uint8_t *pPkt, uint32_t len)
 	{
 		//perror("[precsWSM] PAR MQ send error : ");
 		syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] PAR MQ send error : %s", strerror(errno));
+		v2xstat_Inc(g_mqParDrop);
 	}
 	else
 	{
+		v2xstat_Inc(g_mqParSend);
 		if (g_dbg >= kDbgMsgLevel_event)
 		{
 			//printf("[prcsWSM] MQ send(%d Byte) for PAR \n", parRecvPkt->msg.msg_len);
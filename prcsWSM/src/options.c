@@ -6,7 +6,7 @@
 	전역변수
 
 ****************************************************************************************/
-static const char	*optStr	=	"a:x:n:k:p:r:w:o:b:h";
+static const char	*optStr	=	"a:x:n:k:p:r:w:o:s:q:i:e:I:d:c:Tb:h";
 
 
 /****************************************************************************************
@@ -45,6 +45,36 @@ static void usage(char *cmd) {
   printf("                           if not specified, set to 20dBm\n");
   printf("  -o <priority>          set tx priority(for tx)\n");
   printf("                           if not specified, set to 7\n");
+  printf("                           used when the sender does not specify a priority\n");
+  printf("  -s <sched>             set tx queue scheduling(for tx)\n");
+  printf("                           strict : strict priority (VO > VI > BE > BK)\n");
+  printf("                           wrr    : weighted round robin (VO:VI:BE:BK = 8:4:2:1)\n");
+  printf("                           if not specified, set to strict\n");
+  printf("  -q <depth>             set tx queue depth per access category(for tx)\n");
+  printf("                           if not specified, set to %d\n", TXQ_DEFAULT_DEPTH);
+  printf("  -i <sec>               set interface statistics and tx queueing delay histogram report interval\n");
+  printf("                           0 : disable, if not specified, set to %d\n", STATS_DEFAULT_REPORT_INTERVAL);
+  printf("  -e <msec>              set default tx lifetime(for tx)\n");
+  printf("                           stale packets are dropped instead of being transmitted\n");
+  printf("                           used when the sender does not specify a lifetime\n");
+  printf("                           0 : never expire, if not specified, set to 0\n");
+  printf("  -I <if>:<ts0>[:<ts1>]  use additional interface concurrently (can be repeated)\n");
+  printf("                           prcsWSM accesses <ts0>/<ts1> channel on interface <if>\n");
+  printf("                           if <ts1> is not specified, set to <ts0>\n");
+  printf("                           <if> : 0~%d, <ts0>/<ts1> : %d~%d\n", V2X_OBU_IF_MAX - 1, kDot3Channel_Min, kDot3Channel_Max);
+  printf("  -d <msec>              set rx duplicate frame filter window\n");
+  printf("                           same (source mac, psid, payload) received within window is dropped\n");
+  printf("                           use when the same WSM is received via relay RSU or multiple interfaces (e.g. 1000)\n");
+  printf("                           0 : disable, if not specified, set to %d\n", DUPF_DEFAULT_WINDOW);
+  printf("  -c <psid>:<min itt>:<max itt>[:<min power>:<max power>]\n");
+  printf("                         enable CBR based congestion control for <psid>(for tx) (can be repeated, max %d)\n", CC_PSID_MAX);
+  printf("                           tx interval(msec) grows with node density within [<min itt>, <max itt>]\n");
+  printf("                           tx power(dBm) falls from <max power> to <min power> as CBR grows from %d%% to %d%%\n", CC_CBR_MIN, CC_CBR_MAX);
+  printf("                           if power is not specified, set to %d~%d\n", CC_DEFAULT_MIN_POWER, CC_DEFAULT_MAX_POWER);
+  printf("                           applied per psid of each tx message, PAR probe psid %d is never controlled\n", MSGQ_PSID_PAR);
+  printf("  -T                     append end-to-end trace trailer to tx WSM payload and strip it from rx WSM payload\n");
+  printf("                           FOR TEST ONLY: the trailer is transmitted over the air\n");
+  printf("                           must be set on both RSU and OBU, if not specified, disabled\n");
   printf("  -b                     activate debug message output\n");
   printf("  -h                     Print usage\n");
 
@@ -124,6 +154,89 @@ int32_t ParsingOptions(int32_t argc, char *argv[])
 			g_mib.priority		=	(Dot3Priority)strtol(optarg, NULL, 10);
 			break;
 
+		case 's':
+			if(!strncmp(optarg, "strict", 6))
+				g_mib.txqSched	=	kTxqSched_Strict;
+			else if(!strncmp(optarg, "wrr", 3))
+				g_mib.txqSched	=	kTxqSched_Wrr;
+			else {
+				printf("Invalid tx queue scheduling - %s\n", optarg);
+				return	-1;
+			}
+			break;
+
+		case 'q':
+			g_mib.txqDepth	=	(uint32_t)strtoul(optarg, NULL, 10);
+			if((g_mib.txqDepth == 0) || (g_mib.txqDepth > TXQ_MAX_DEPTH)) {
+				printf("Invalid tx queue depth - %s (1~%d)\n", optarg, TXQ_MAX_DEPTH);
+				return	-1;
+			}
+			break;
+
+		case 'i':
+			g_mib.reportInterval	=	(uint32_t)strtoul(optarg, NULL, 10);
+			break;
+
+		case 'I':
+		{
+			unsigned int if_idx, ts0_chan, ts1_chan;
+			int cnt = sscanf(optarg, "%u:%u:%u", &if_idx, &ts0_chan, &ts1_chan);
+			if(cnt < 2) {
+				printf("Invalid interface - %s\n", optarg);
+				return	-1;
+			}
+			if(cnt == 2)
+				ts1_chan = ts0_chan;
+			if((ts0_chan > kDot3Channel_Max) || (ts1_chan > kDot3Channel_Max)) {
+				printf("Invalid channel - %s (%d~%d)\n", optarg, kDot3Channel_Min, kDot3Channel_Max);
+				return	-1;
+			}
+			if((if_idx >= V2X_OBU_IF_MAX) ||
+			   (V2X_OBU_AddIf((uint8_t)if_idx, (Dot3ChannelNumber)ts0_chan, (Dot3ChannelNumber)ts1_chan, true) < 0)) {
+				printf("Invalid interface index - %u (0~%d)\n", if_idx, V2X_OBU_IF_MAX - 1);
+				return	-1;
+			}
+			break;
+		}
+
+		case 'e':
+			g_mib.txLifetime	=	(uint32_t)strtoul(optarg, NULL, 10);
+			break;
+
+		case 'd':
+			g_mib.dupWindow	=	(uint32_t)strtoul(optarg, NULL, 10);
+			break;
+
+		case 'c':
+		{
+			unsigned int psid, min_itt, max_itt;
+			int min_power = CC_DEFAULT_MIN_POWER, max_power = CC_DEFAULT_MAX_POWER;
+			int cnt = sscanf(optarg, "%u:%u:%u:%d:%d", &psid, &min_itt, &max_itt, &min_power, &max_power);
+			if((cnt != 3 && cnt != 5) || (min_itt == 0) || (min_itt > max_itt) || (min_power > max_power)) {
+				printf("Invalid congestion control - %s\n", optarg);
+				return	-1;
+			}
+			if(psid == MSGQ_PSID_PAR) {
+				printf("Congestion control is not applied to PAR probe psid %u\n", psid);
+				return	-1;
+			}
+			if(g_mib.cc_num >= CC_PSID_MAX) {
+				printf("Too many congestion control psid (max %d)\n", CC_PSID_MAX);
+				return	-1;
+			}
+			g_mib.cc[g_mib.cc_num].psid = (Dot3Psid)psid;
+			g_mib.cc[g_mib.cc_num].min_itt = min_itt;
+			g_mib.cc[g_mib.cc_num].max_itt = max_itt;
+			g_mib.cc[g_mib.cc_num].min_power = (Dot3Power)min_power;
+			g_mib.cc[g_mib.cc_num].max_power = (Dot3Power)max_power;
+			g_mib.cc_num++;
+			break;
+		}
+
+		case 'T':
+			g_mib.traceTrailer	=	true;
+			break;
+
 		case 'b':
 			g_dbg = (DbgMsgLevel)strtoul(optarg, NULL, 10);
 			break;
@@ -0,0 +1,364 @@
+/**
+ * @file v2x-obu-cc.c
+ * @date 2026-10-19
+ * @brief Channel Busy Ratio(CBR) 기반 혼잡제어 기능 구현 (SAE J2945/1 방식)
+ *
+ *  - 인터페이스 별로 CC_INTERVAL 주기마다 CBR을 측정한다.
+ *    액세스계층 수신통계(Al_GetRxStatistics())의 CBR 측정값을 사용하며, 측정값이 없는 경우 수신 패킷의 점유시간으로 추정한다.
+ *    배포된 libwlanaccess(ext/lib/aarch64)에는 통계 API가 없으므로 약한 참조로 링크하고, 없으면 항상 추정값을 사용한다.
+ *  - 인터페이스 별로 CC_DENSITY_WINDOW 동안 수신된 송신지 MAC 주소의 수로 주변 송신기 밀도를 추정한다.
+ *  - 혼잡제어가 설정된 PSID(-c 옵션)에 대해 다음과 같이 송신주기(ITT)와 송신파워를 결정한다.
+ *      - 송신파워 : CBR이 CC_CBR_MIN 이하이면 최대파워, CC_CBR_MAX 이상이면 최소파워, 그 사이는 선형 감소
+ *      - 송신주기 : 최소주기 x (송신기 밀도 / CC_DENSITY_COEF) 를 [최소주기, 최대주기] 범위로 제한
+ *  - 송신쓰레드는 패킷의 PSID 별로 송신주기가 지나지 않은 패킷을 폐기하고, 결정된 송신파워로 패킷을 송신한다.
+ *    PAR 프로브(MSGQ_PSID_PAR)는 수신 성능 측정을 위해 혼잡제어를 적용하지 않는다.
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "wlanaccess/wlanaccess.h"
+
+#include "v2x-obu.h"
+
+
+/*
+ * 액세스계층 통계 API - 라이브러리에 없으면 NULL이 된다. (V2X_OBU_CcHasAlStatistics())
+ */
+#pragma weak Al_GetRxStatistics
+#pragma weak Al_ClearRxStatistics
+#pragma weak Al_ClearTxStatistics
+
+/// 송신기 밀도 추정용 MAC 주소 해시셋 슬롯 수 (2의 거듭제곱)
+#define CC_MAC_SET_SIZE (256)
+/// 송신기 밀도 추정용 MAC 주소 해시셋 최대 엔트리 수
+#define CC_MAC_SET_FULL (CC_MAC_SET_SIZE * 3 / 4)
+
+/**
+ * PSID 별 혼잡제어 상태
+ */
+struct V2X_OBU_CcPsid
+{
+    uint32_t itt; ///< 현재 송신주기(msec)
+    Dot3Power power; ///< 현재 송신파워(dBm)
+    bool txed; ///< 송신 이력 존재 여부
+    struct timespec last_tx_ts; ///< 마지막 송신 시각 (CLOCK_MONOTONIC)
+    uint32_t tx_cnt; ///< 송신 허용 수
+    uint32_t drop_cnt; ///< 송신주기 제한에 의해 폐기된 수
+};
+
+/**
+ * 인터페이스 별 혼잡제어 상태
+ */
+struct V2X_OBU_CcIf
+{
+    double cbr; ///< 평활화된 CBR(%)
+    bool cbr_measured; ///< 액세스계층 CBR 측정값 사용 여부 (false이면 추정값)
+    double density; ///< 평활화된 송신기 밀도
+    uint64_t rx_airtime; ///< 현재 측정주기 동안 수신된 패킷의 점유시간 합(usec)
+    uint64_t mac[CC_MAC_SET_SIZE]; ///< 현재 밀도 측정구간 동안 수신된 송신지 MAC 주소 (0은 빈 슬롯)
+    uint32_t mac_cnt; ///< 현재 밀도 측정구간 동안 수신된 송신지 MAC 주소 수
+    struct V2X_OBU_CcPsid psid[CC_PSID_MAX]; ///< PSID 별 혼잡제어 상태 (g_mib.cc[] 와 동일 인덱스)
+    pthread_mutex_t mtx; ///< 상태 뮤텍스 (수신콜백/송신쓰레드/혼잡제어쓰레드 간)
+};
+
+static struct V2X_OBU_CcIf g_cc[V2X_OBU_IF_MAX]; ///< 인터페이스 별 혼잡제어 상태
+static pthread_t g_cc_thread; ///< 혼잡제어 쓰레드
+
+
+/**
+ * 링크된 액세스계층 라이브러리가 통계 API(Al_GetRxStatistics() 등)를 제공하는지 확인한다.
+ *
+ * @return  제공하면 true
+ */
+static bool V2X_OBU_CcHasAlStatistics(void)
+{
+    return (Al_GetRxStatistics != NULL) && (Al_ClearRxStatistics != NULL) && (Al_ClearTxStatistics != NULL);
+}
+
+
+/**
+ * J2945/1 방식의 혼잡제어 알고리즘. 측정값으로부터 송신주기와 송신파워를 계산한다.
+ *  - 상태를 갖지 않으므로 가상 송신기를 이용한 시뮬레이션에서 단독으로 호출할 수 있다.
+ *
+ * @param conf      PSID 별 혼잡제어 설정
+ * @param cbr       평활화된 CBR(%)
+ * @param density   평활화된 송신기 밀도
+ * @param itt       계산된 송신주기(msec)가 반환된다.
+ * @param power     계산된 송신파워(dBm)가 반환된다.
+ */
+void V2X_OBU_CcControlLaw(const struct V2X_OBU_CcConf *conf, const double cbr, const double density,
+                          uint32_t *itt, Dot3Power *power)
+{
+    double t;
+
+    /* 송신파워 - CBR에 따라 선형 감소 */
+    if (cbr <= CC_CBR_MIN) {
+        *power = conf->max_power;
+    } else if (cbr >= CC_CBR_MAX) {
+        *power = conf->min_power;
+    } else {
+        *power = (Dot3Power)(conf->max_power -
+                             (conf->max_power - conf->min_power) * (cbr - CC_CBR_MIN) / (CC_CBR_MAX - CC_CBR_MIN));
+    }
+
+    /* 송신주기 - 송신기 밀도에 비례 */
+    t = (double)conf->min_itt * density / CC_DENSITY_COEF;
+    if (t < conf->min_itt) {
+        t = conf->min_itt;
+    } else if (t > conf->max_itt) {
+        t = conf->max_itt;
+    }
+    *itt = (uint32_t)t;
+}
+
+
+/**
+ * 수신 패킷의 채널 점유시간(usec)을 계산한다. (10MHz OFDM 기준)
+ *  - 프리앰블/SIGNAL 40usec + (SERVICE 16bit + MPDU + tail 6bit)를 심볼(8usec) 단위로 올림
+ *  - 주변 송신기는 다른 데이터레이트로 송신할 수 있으므로 패킷이 수신된 데이터레이트를 사용한다.
+ *    수신 데이터레이트가 없으면(0) 내 송신 데이터레이트를 사용한다.
+ *
+ * @param mpdu_size 수신 MPDU 크기
+ * @param datarate  수신 데이터레이트(500kbps 단위)
+ */
+static uint32_t V2X_OBU_CcAirtime(const uint16_t mpdu_size, const uint8_t datarate)
+{
+    uint32_t bits_per_symbol = (uint32_t)(datarate ? datarate : g_mib.dataRate) * 4; // 500kbps 단위 x 8usec
+    if (bits_per_symbol == 0) {
+        bits_per_symbol = 48;
+    }
+    uint32_t bits = 16 + (uint32_t)mpdu_size * 8 + 6;
+    return 40 + ((bits + bits_per_symbol - 1) / bits_per_symbol) * 8;
+}
+
+
+/**
+ * 수신 패킷 정보를 혼잡제어 상태에 반영한다. (수신콜백에서 호출된다)
+ *
+ * @param if_idx    수신 인터페이스 식별번호
+ * @param src_mac   송신지 MAC 주소
+ * @param mpdu_size 수신 MPDU 크기
+ * @param datarate  수신 데이터레이트(500kbps 단위, 0이면 내 송신 데이터레이트로 계산)
+ */
+void V2X_OBU_CcNotifyRx(const uint8_t if_idx, const uint8_t *src_mac, const uint16_t mpdu_size, const uint8_t datarate)
+{
+    struct V2X_OBU_CcIf *cc = &g_cc[if_idx];
+    uint64_t key = 0;
+
+    if (g_mib.cc_num == 0) {
+        return;
+    }
+
+    for (int i = 0; i < kDot3MacAddrSize; i++) {
+        key = (key << 8) | src_mac[i];
+    }
+    key |= 1ULL << 63; // 0은 빈 슬롯
+
+    pthread_mutex_lock(&cc->mtx);
+    cc->rx_airtime += V2X_OBU_CcAirtime(mpdu_size, datarate);
+    if (cc->mac_cnt < CC_MAC_SET_FULL) {
+        uint32_t i = (uint32_t)(key ^ (key >> 24)) & (CC_MAC_SET_SIZE - 1);
+        while (cc->mac[i] && (cc->mac[i] != key)) {
+            i = (i + 1) & (CC_MAC_SET_SIZE - 1);
+        }
+        if (!cc->mac[i]) {
+            cc->mac[i] = key;
+            cc->mac_cnt++;
+        }
+    }
+    pthread_mutex_unlock(&cc->mtx);
+}
+
+
+/**
+ * 송신 허용 여부를 확인하고 송신파워를 결정한다. (송신쓰레드에서 호출된다)
+ *
+ * @param if_idx    송신 인터페이스 식별번호
+ * @param psid      송신 패킷의 PSID
+ * @param power     혼잡제어 대상 PSID인 경우 결정된 송신파워가 반환된다. (그 외에는 변경되지 않는다)
+ * @return          송신 가능하면 true, 송신주기가 지나지 않아 폐기해야 하면 false
+ */
+bool V2X_OBU_CcAdmitTx(const uint8_t if_idx, const Dot3Psid psid, Dot3Power *power)
+{
+    struct V2X_OBU_CcIf *cc = &g_cc[if_idx];
+    struct timespec now;
+    bool admit = true;
+    int i;
+
+    /* PAR 프로브는 송신주기를 줄이면 측정 대상인 수신율이 달라지므로 제외한다. */
+    if (psid == MSGQ_PSID_PAR) {
+        return true;
+    }
+
+    for (i = 0; i < g_mib.cc_num; i++) {
+        if (g_mib.cc[i].psid == psid) {
+            break;
+        }
+    }
+    if (i == g_mib.cc_num) {
+        return true;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    pthread_mutex_lock(&cc->mtx);
+    struct V2X_OBU_CcPsid *p = &cc->psid[i];
+    if (p->txed) {
+        int64_t elapsed = (int64_t)(now.tv_sec - p->last_tx_ts.tv_sec) * 1000 + (now.tv_nsec - p->last_tx_ts.tv_nsec) / 1000000;
+        admit = (elapsed >= p->itt);
+    }
+    if (admit) {
+        p->txed = true;
+        p->last_tx_ts = now;
+        p->tx_cnt++;
+        *power = p->power;
+    } else {
+        p->drop_cnt++;
+    }
+    pthread_mutex_unlock(&cc->mtx);
+    return admit;
+}
+
+
+/**
+ * 인터페이스의 CBR을 측정한다.
+ *  - 액세스계층 CBR 측정값(송신 TimeSlot)을 우선 사용하고, 없으면 수신 점유시간으로 추정한다.
+ *
+ * @param if_idx    인터페이스 식별번호
+ * @param measured  액세스계층 측정값 사용 여부가 반환된다.
+ * @return          CBR(%)
+ */
+static double V2X_OBU_CcMeasureCbr(const uint8_t if_idx, bool *measured)
+{
+    struct V2X_OBU_CcIf *cc = &g_cc[if_idx];
+    struct AlRxStatstics rxstats;
+    AlTimeSlot ts = (g_if[if_idx].timeSlot == kDot3TimeSlot_1) ? kAlTimeSlot_1 : kAlTimeSlot_0;
+    uint64_t airtime;
+
+    pthread_mutex_lock(&cc->mtx);
+    airtime = cc->rx_airtime;
+    cc->rx_airtime = 0;
+    pthread_mutex_unlock(&cc->mtx);
+
+    if (V2X_OBU_CcHasAlStatistics() && (Al_GetRxStatistics(if_idx, ts, &rxstats) == 0) && rxstats.cbr_valid) {
+        *measured = true;
+        return (double)rxstats.channel_busy_ratio * 100 / 255;
+    }
+
+    *measured = false;
+    double cbr = (double)airtime * 100 / (CC_INTERVAL * 1000);
+    return (cbr > 100) ? 100 : cbr;
+}
+
+
+/**
+ * 혼잡제어 쓰레드 함수
+ *  - CC_INTERVAL 주기로 CBR을, CC_DENSITY_WINDOW 주기로 송신기 밀도를 갱신하고 PSID 별 송신주기/송신파워를 계산한다.
+ *
+ * @param notused   사용되지 않음
+ * @return          NULL (프로그램 종료시에만 리턴됨)
+ */
+static void* V2X_OBU_CcThread(void *notused)
+{
+    uint32_t tick = 0;
+
+    while (1) {
+        usleep(CC_INTERVAL * 1000);
+        tick++;
+
+        for (int i = 0; i < V2X_OBU_IF_MAX; i++) {
+            struct V2X_OBU_CcIf *cc = &g_cc[i];
+            bool measured;
+            if (!g_if[i].enabled) {
+                continue;
+            }
+
+            double cbr = V2X_OBU_CcMeasureCbr(i, &measured);
+
+            pthread_mutex_lock(&cc->mtx);
+            cc->cbr = (cc->cbr + cbr) / 2;
+            cc->cbr_measured = measured;
+            if ((tick % (CC_DENSITY_WINDOW / CC_INTERVAL)) == 0) {
+                cc->density = (cc->density + cc->mac_cnt) / 2;
+                memset(cc->mac, 0, sizeof(cc->mac));
+                cc->mac_cnt = 0;
+            }
+            for (int j = 0; j < g_mib.cc_num; j++) {
+                V2X_OBU_CcControlLaw(&g_mib.cc[j], cc->cbr, cc->density, &cc->psid[j].itt, &cc->psid[j].power);
+            }
+            pthread_mutex_unlock(&cc->mtx);
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * 인터페이스의 혼잡제어 상태를 syslog로 출력한다.
+ *
+ * @param if_idx    인터페이스 식별번호
+ */
+void V2X_OBU_ReportCc(const uint8_t if_idx)
+{
+    struct V2X_OBU_CcIf *cc = &g_cc[if_idx];
+
+    if (g_mib.cc_num == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&cc->mtx);
+    syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] if%u cc - cbr: %.1f%%(%s) density: %.1f\n",
+           if_idx, cc->cbr, cc->cbr_measured ? "measured" : "estimated", cc->density);
+    for (int i = 0; i < g_mib.cc_num; i++) {
+        struct V2X_OBU_CcPsid *p = &cc->psid[i];
+        syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] if%u cc psid %u - itt: %ums power: %ddBm tx: %u drop: %u\n",
+               if_idx, g_mib.cc[i].psid, p->itt, p->power, p->tx_cnt, p->drop_cnt);
+    }
+    pthread_mutex_unlock(&cc->mtx);
+}
+
+
+/**
+ * 혼잡제어 기능을 초기화한다. 혼잡제어 대상 PSID가 설정되지 않았으면 아무 동작도 하지 않는다.
+ *
+ * @return  성공 시 0, 실패 시 -1
+ */
+int V2X_OBU_InitCc(void)
+{
+    int ret;
+
+    if (g_mib.cc_num == 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < V2X_OBU_IF_MAX; i++) {
+        pthread_mutex_init(&g_cc[i].mtx, NULL);
+        for (int j = 0; j < g_mib.cc_num; j++) {
+            g_cc[i].psid[j].itt = g_mib.cc[j].min_itt;
+            g_cc[i].psid[j].power = g_mib.cc[j].max_power;
+        }
+        if (g_if[i].enabled && V2X_OBU_CcHasAlStatistics()) {
+            Al_ClearRxStatistics(i);
+            Al_ClearTxStatistics(i);
+        }
+    }
+
+    ret = pthread_create(&g_cc_thread, NULL, V2X_OBU_CcThread, NULL);
+    if (ret) {
+        syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] Fail to create congestion control thread : %s\n", strerror(ret));
+        return -1;
+    }
+    if (!V2X_OBU_CcHasAlStatistics()) {
+        syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Access layer has no statistics API - estimate CBR from received packets\n");
+    }
+    for (int i = 0; i < g_mib.cc_num; i++) {
+        syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Congestion control psid %u - itt: %u~%ums power: %d~%ddBm\n",
+               g_mib.cc[i].psid, g_mib.cc[i].min_itt, g_mib.cc[i].max_itt, g_mib.cc[i].min_power, g_mib.cc[i].max_power);
+    }
+    return 0;
+}
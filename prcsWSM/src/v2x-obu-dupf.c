@@ -0,0 +1,155 @@
+/**
+ * @file v2x-obu-dupf.c
+ * @date 2026-10-19
+ * @brief 수신 중복프레임 필터 기능 구현
+ *
+ *  - 여러 인터페이스 또는 중계 RSU로부터 동일한 WSM이 중복 수신되는 경우, 설정된 시간(g_mib.dupWindow) 이내의
+ *    중복 프레임을 폐기하여 상위 프로세스(prcsJ2735)로 전달되지 않도록 한다.
+ *  - 같은 내용을 재송신하는 정상 메시지도 폐기되므로 기본은 비활성화이며, 필요한 배치에서 -d 옵션으로 켠다.
+ *  - PAR 프로브(PSID 7777)는 인터페이스/채널 별 수신 성능 측정 대상이므로 필터를 적용하지 않는다. (v2x-obu-rx.c)
+ *  - 키는 (송신지 MAC 주소, PSID, 페이로드)의 64비트 해시값이다.
+ *  - 고정크기 해시셋 2개(현재/이전 세대)를 교대로 사용하며, 현재 세대가 윈도우 시간을 넘기면 이전 세대를 비우고
+ *    현재 세대로 전환한다. 따라서 중복 판정 시간은 윈도우 시간 이상, 윈도우 시간의 2배 이하이다.
+ *  - 해시셋이 가득 차면 윈도우 시간과 무관하게 세대를 전환하므로 메모리 사용량은 고정된다.
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "v2x-obu.h"
+
+
+/// 세대 별 해시셋 슬롯 수 (2의 거듭제곱)
+#define DUPF_SET_SIZE (1024)
+/// 세대 전환을 강제하는 해시셋 엔트리 수 (슬롯 수의 3/4)
+#define DUPF_SET_FULL (DUPF_SET_SIZE * 3 / 4)
+
+/**
+ * 세대 별 해시셋 (open addressing, linear probing)
+ */
+struct V2X_OBU_DupfSet
+{
+    uint64_t key[DUPF_SET_SIZE]; ///< 해시값 (0은 빈 슬롯)
+    uint32_t cnt; ///< 저장된 엔트리 수
+};
+
+/**
+ * 중복프레임 필터
+ */
+struct V2X_OBU_Dupf
+{
+    struct V2X_OBU_DupfSet set[2]; ///< 현재/이전 세대 해시셋
+    uint8_t cur; ///< 현재 세대 해시셋 인덱스
+    struct timespec rotate_ts; ///< 현재 세대 시작 시각 (CLOCK_MONOTONIC)
+    pthread_mutex_t mtx; ///< 필터 뮤텍스 (인터페이스 별 수신 콜백에서 동시에 호출될 수 있다)
+};
+
+static struct V2X_OBU_Dupf g_dupf = { .mtx = PTHREAD_MUTEX_INITIALIZER }; ///< 중복프레임 필터
+
+
+/**
+ * (송신지 MAC 주소, PSID, 페이로드)에 대한 64비트 FNV-1a 해시값을 계산한다.
+ *  - 0은 빈 슬롯을 의미하므로 반환되지 않는다.
+ */
+static uint64_t V2X_OBU_DupfHash(const uint8_t *src_mac, const Dot3Psid psid, const uint8_t *payload, const int len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < kDot3MacAddrSize; i++) {
+        h = (h ^ src_mac[i]) * 0x100000001b3ULL;
+    }
+    for (int i = 0; i < 4; i++) {
+        h = (h ^ ((psid >> (i * 8)) & 0xff)) * 0x100000001b3ULL;
+    }
+    for (int i = 0; i < len; i++) {
+        h = (h ^ payload[i]) * 0x100000001b3ULL;
+    }
+    return h ? h : 1;
+}
+
+
+/**
+ * 해시셋에서 키를 찾는다. 찾지 못하면 키가 저장될 빈 슬롯 인덱스를 slot에 반환한다.
+ *
+ * @return  키가 존재하면 true
+ */
+static bool V2X_OBU_DupfLookup(const struct V2X_OBU_DupfSet *set, const uint64_t key, uint32_t *slot)
+{
+    uint32_t i = (uint32_t)key & (DUPF_SET_SIZE - 1);
+    while (set->key[i]) {
+        if (set->key[i] == key) {
+            return true;
+        }
+        i = (i + 1) & (DUPF_SET_SIZE - 1);
+    }
+    *slot = i;
+    return false;
+}
+
+
+/**
+ * 현재 세대를 이전 세대로 전환하고 새로운 현재 세대를 비운다.
+ */
+static void V2X_OBU_DupfRotate(const struct timespec *now)
+{
+    g_dupf.cur ^= 1;
+    memset(&g_dupf.set[g_dupf.cur], 0, sizeof(struct V2X_OBU_DupfSet));
+    g_dupf.rotate_ts = *now;
+}
+
+
+/**
+ * 수신 프레임이 윈도우 시간 이내에 수신된 프레임과 중복인지 확인한다. 중복이 아니면 필터에 등록한다.
+ *
+ * @param src_mac   송신지 MAC 주소
+ * @param psid      PSID
+ * @param payload   WSM 페이로드
+ * @param len       WSM 페이로드 길이
+ * @return          중복 프레임이면 true, 그렇지 않거나 필터가 비활성화되어 있으면 false
+ */
+bool V2X_OBU_CheckDupRx(const uint8_t *src_mac, const Dot3Psid psid, const uint8_t *payload, const int len)
+{
+    struct timespec now;
+    uint64_t key, elapsed;
+    uint32_t slot;
+    bool dup;
+
+    if (g_mib.dupWindow == 0) {
+        return false;
+    }
+
+    key = V2X_OBU_DupfHash(src_mac, psid, payload, len);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&g_dupf.mtx);
+
+    /* 윈도우 시간이 지난 세대 정리 - 2배 이상 지났으면 이전 세대도 의미가 없다. */
+    elapsed = (uint64_t)(now.tv_sec - g_dupf.rotate_ts.tv_sec) * 1000 + (now.tv_nsec - g_dupf.rotate_ts.tv_nsec) / 1000000;
+    if (elapsed >= (uint64_t)g_mib.dupWindow * 2) {
+        memset(g_dupf.set, 0, sizeof(g_dupf.set));
+        g_dupf.rotate_ts = now;
+    } else if (elapsed >= g_mib.dupWindow) {
+        V2X_OBU_DupfRotate(&now);
+    }
+
+    dup = V2X_OBU_DupfLookup(&g_dupf.set[g_dupf.cur ^ 1], key, &slot);
+    if (!dup) {
+        dup = V2X_OBU_DupfLookup(&g_dupf.set[g_dupf.cur], key, &slot);
+    }
+    if (!dup) {
+        struct V2X_OBU_DupfSet *set = &g_dupf.set[g_dupf.cur];
+        if (set->cnt >= DUPF_SET_FULL) {
+            V2X_OBU_DupfRotate(&now);
+            set = &g_dupf.set[g_dupf.cur];
+            V2X_OBU_DupfLookup(set, key, &slot);
+        }
+        set->key[slot] = key;
+        set->cnt++;
+    }
+
+    pthread_mutex_unlock(&g_dupf.mtx);
+    return dup;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file v2x-obu-if.c
+ * @date 2026-10-19
+ * @brief 다중 인터페이스 관리 기능 구현
+ *
+ *  - 기본 인터페이스(-x/-n)와 추가 인터페이스(-I)를 관리한다.
+ *  - 추가 인터페이스는 prcsWSM이 직접 채널접속을 수행한다.
+ *  - 인터페이스 별 송수신 통계와 송신큐 큐잉지연 히스토그램을 주기적으로 출력한다.
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "wlanaccess/wlanaccess.h"
+
+#include "v2x-obu.h"
+
+
+struct V2X_OBU_If g_if[V2X_OBU_IF_MAX]; ///< 인터페이스 별 동작 정보
+static pthread_t g_stats_thread; ///< 통계 출력 쓰레드
+
+
+/**
+ * 사용할 인터페이스를 추가한다. (옵션 파싱 시 호출된다)
+ *
+ * @param if_idx    인터페이스 식별번호
+ * @param ts0_chan  TS0 채널번호
+ * @param ts1_chan  TS1 채널번호
+ * @param access    prcsWSM이 직접 채널접속을 수행할지 여부
+ * @return          성공 시 0, 실패 시 -1
+ */
+int V2X_OBU_AddIf(const uint8_t if_idx, const Dot3ChannelNumber ts0_chan, const Dot3ChannelNumber ts1_chan, const bool access)
+{
+    if (if_idx >= V2X_OBU_IF_MAX) {
+        return -1;
+    }
+    g_if[if_idx].enabled = true;
+    g_if[if_idx].access = access;
+    g_if[if_idx].ts0_chan = ts0_chan;
+    g_if[if_idx].ts1_chan = ts1_chan;
+    g_if[if_idx].timeSlot = kDot3TimeSlot_0;
+    return 0;
+}
+
+
+/**
+ * 인터페이스 별 통계 이름("if<번호>.<이름>")을 만든다.
+ *
+ * @param buf       이름이 저장될 버퍼 (V2XSTAT_METRIC_NAME_MAX 이상)
+ * @param if_idx    인터페이스 식별번호
+ * @param name      통계 이름
+ * @return          buf
+ */
+const char *V2X_OBU_IfMetricName(char *buf, const int if_idx, const char *name)
+{
+    snprintf(buf, V2XSTAT_METRIC_NAME_MAX, "if%d.%s", if_idx, name);
+    return buf;
+}
+
+
+/**
+ * 인터페이스 별 송수신 통계를 공유메모리 통계(v2xtop)에 등록한다.
+ *  - 수신 콜백이 등록되기 전(액세스계층 라이브러리를 열기 전)에 호출되어야 한다.
+ *  - 기본 인터페이스는 V2X_OBU_InitIfs()에서 활성화되므로 미리 등록한다.
+ *  - 송신큐 통계는 V2X_OBU_InitTxq()에서 등록한다.
+ */
+void V2X_OBU_InitIfMetrics(void)
+{
+    static const int64_t rx_power_bound[] = { -95, -90, -85, -80, -75, -70, -65, -60, -55, -50, -45, -40, -35 };
+    struct V2X_OBU_IfMetrics *m;
+    char name[V2XSTAT_METRIC_NAME_MAX];
+
+    for (int i = 0; i < V2X_OBU_IF_MAX; i++) {
+        if (!g_if[i].enabled && (i != (int)g_mib.netIfIndex)) {
+            continue;
+        }
+        m = &g_if[i].metrics;
+        m->rx = v2xstat_Counter(V2X_OBU_IfMetricName(name, i, "rx"), "pkt");
+        m->rx_parse_fail = v2xstat_Counter(V2X_OBU_IfMetricName(name, i, "rx_parse_fail"), "pkt");
+        m->rx_fwd = v2xstat_Counter(V2X_OBU_IfMetricName(name, i, "rx_fwd"), "pkt");
+        m->rx_ignore = v2xstat_Counter(V2X_OBU_IfMetricName(name, i, "rx_ignore"), "pkt");
+        m->rx_dup = v2xstat_Counter(V2X_OBU_IfMetricName(name, i, "rx_dup"), "pkt");
+        m->rx_power = v2xstat_Hist(V2X_OBU_IfMetricName(name, i, "rx_power"), "dBm", rx_power_bound,
+                                   sizeof(rx_power_bound) / sizeof(rx_power_bound[0]));
+        m->tx = v2xstat_Counter(V2X_OBU_IfMetricName(name, i, "tx"), "pkt");
+        m->tx_fail = v2xstat_Counter(V2X_OBU_IfMetricName(name, i, "tx_fail"), "pkt");
+        m->tx_cc_drop = v2xstat_Counter(V2X_OBU_IfMetricName(name, i, "tx_cc_drop"), "pkt");
+    }
+}
+
+
+/**
+ * 인터페이스들을 초기화한다. 액세스계층 라이브러리를 연 후에 호출되어야 한다.
+ *  - 기본 인터페이스(g_mib.netIfIndex)를 등록한다. 기본 인터페이스의 채널은 외부(chan config)에서 설정된다.
+ *  - 추가 인터페이스에 대해 채널접속을 수행한다.
+ *  - 인터페이스 별 MAC 주소를 설정한다. if0/if1은 g_if0_mac_address/g_if1_mac_address를,
+ *    그 외 인터페이스는 g_if0_mac_address의 마지막 바이트를 인터페이스 번호로 바꾼 주소를 사용한다.
+ *
+ * @return  성공 시 0, 실패 시 -1
+ */
+int V2X_OBU_InitIfs(void)
+{
+    int ret;
+
+    /* 기본 인터페이스 - -I 옵션으로 같은 인터페이스가 지정된 경우 해당 설정을 따른다. */
+    if ((g_mib.netIfIndex < V2X_OBU_IF_MAX) && !g_if[g_mib.netIfIndex].enabled) {
+        V2X_OBU_AddIf(g_mib.netIfIndex, g_mib.channel, g_mib.channel, false);
+        g_if[g_mib.netIfIndex].timeSlot = g_mib.timeSlot;
+    }
+
+    for (int i = 0; i < V2X_OBU_IF_MAX; i++) {
+        if (!g_if[i].enabled) {
+            continue;
+        }
+        if (i >= g_mib.if_num) {
+            syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] Invalid interface if%d - %u interface is supported\n", i, g_mib.if_num);
+            return -1;
+        }
+        if (g_if[i].access) {
+            ret = V2X_OBU_AccessChannel(i, g_if[i].ts0_chan, g_if[i].ts1_chan);
+            if (ret < 0) {
+                return -1;
+            }
+        }
+        memcpy(g_if[i].mac_addr, (i == 1) ? g_if1_mac_address : g_if0_mac_address, kDot3MacAddrSize);
+        if (i > 1) {
+            g_if[i].mac_addr[kDot3MacAddrSize - 1] = (uint8_t)i;
+        }
+        ret = V2X_OBU_SetIfMacAddress(i, g_if[i].mac_addr);
+        if (ret < 0) {
+            return -1;
+        }
+        syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Interface if%d enabled - ts0_chan: %u, ts1_chan: %u, timeslot: %u\n",
+               i, g_if[i].ts0_chan, g_if[i].ts1_chan, g_if[i].timeSlot);
+    }
+    return 0;
+}
+
+
+/**
+ * 인터페이스 별 송수신 통계를 syslog로 출력한다.
+ */
+static void V2X_OBU_ReportIfStats(void)
+{
+    for (int i = 0; i < V2X_OBU_IF_MAX; i++) {
+        struct V2X_OBU_IfStats *s = &g_if[i].stats;
+        if (!g_if[i].enabled) {
+            continue;
+        }
+        syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] if%d(ch %u/%u) rx: %u parse_fail: %u fwd: %u ignore: %u dup: %u "
+               "last_rxpower: %d last_rcpi: %u | tx: %u fail: %u no_if: %u\n",
+               i, g_if[i].ts0_chan, g_if[i].ts1_chan,
+               s->rx_cnt, s->rx_parse_fail_cnt, s->rx_fwd_cnt, s->rx_ignore_cnt, s->rx_dup_cnt, s->rx_last_rxpower, s->rx_last_rcpi,
+               s->tx_cnt, s->tx_fail_cnt, s->tx_no_if_cnt);
+        if (g_mib.op == opTX || g_mib.op == opTRX) {
+            V2X_OBU_ReportTxq(i);
+        }
+        V2X_OBU_ReportCc(i);
+    }
+}
+
+
+/**
+ * 통계 출력 쓰레드 함수
+ *  - g_mib.reportInterval 주기로 인터페이스 별 송수신 통계와 송신큐 통계를 출력한다.
+ *
+ * @param notused   사용되지 않음
+ * @return          NULL (프로그램 종료시에만 리턴됨)
+ */
+static void* V2X_OBU_StatsThread(void *notused)
+{
+    while (1) {
+        sleep(g_mib.reportInterval);
+        V2X_OBU_ReportIfStats();
+    }
+    return NULL;
+}
+
+
+/**
+ * 통계 출력 쓰레드를 생성한다. 출력주기가 0이면 생성하지 않는다.
+ *
+ * @return  성공 시 0, 실패 시 -1
+ */
+int V2X_OBU_InitStatsReport(void)
+{
+    if (g_mib.reportInterval == 0) {
+        return 0;
+    }
+    int ret = pthread_create(&g_stats_thread, NULL, V2X_OBU_StatsThread, NULL);
+    if (ret) {
+        syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] Fail to create stats thread : %s\n", strerror(ret));
+        return -1;
+    }
+    return 0;
+}
@@ -8,6 +8,7 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "wlanaccess/wlanaccess.h"
@@ -18,14 +19,15 @@
 pthread_t g_poll_thread; ///< 이벤트 폴링 쓰레드
 
 
-/// 채널접속이 완료되었는지 여부를 나타내는 변수. 채널접속요청 API 와 채널접속결과 콜백함수에서 사용된다.
-volatile bool g_chan_access_complete = false;
 /// MAC주소설정이 완료되었는지 여부를 나타내는 변수. MAC주소설정요청 API 와 MAC주소설정결과 콜백함수에서 사용된다.
 volatile bool g_set_if_mac_addr_done = false;
 
 
 /**
  * MPDU 수신처리 콜백함수. access 라이브러리에서 호출된다.
+ *  - 수신 인터페이스 별로 통계를 갱신하고, 수신정보(rxpower/rcpi/수신시각)와 함께 수신처리로 전달한다.
+ *  - 수신시각은 콜백 진입 시점의 호스트 시각(CLOCK_REALTIME)이다.
+ *    (배포된 액세스 라이브러리의 AlMpduRxParams에는 하드웨어 수신시각이 없으며, 구조체를 바꾸면 라이브러리와 ABI가 맞지 않는다)
  *
  * @param mpdu
  * @param mpdu_size
@@ -36,25 +38,30 @@ static void V2X_OBU_ProcessRxMpduCallback(
         const AlMpduSize mpdu_size,
         const struct AlMpduRxParams *const rxparams)
 {
-    if(g_dbg)
-    {
-#if 0
-        printf("\n-- Processing received MPDU --------------------------------\n");
-        printf("Rx MPDU callback - MPDU size: %u, ifindex: %u, timeslot: %u, channel: %u, "
-                "rxpower: %d(0.5dBm), rcpi: %u, datarate: %u(500kbps)\n",
-                mpdu_size, rxparams->ifindex, rxparams->timeslot, rxparams->channel,
-                rxparams->rxpower, rxparams->rcpi, rxparams->datarate);
-#endif
-        syslog(LOG_INFO | LOG_LOCAL6, "\n-- Processing received MPDU --------------------------------\n");
-        syslog(LOG_INFO | LOG_LOCAL6, "Rx MPDU callback - MPDU size: %u, ifindex: %u, timeslot: %u, channel: %u, "
-                "rxpower: %d(0.5dBm), rcpi: %u, datarate: %u(500kbps)\n",
-                mpdu_size, rxparams->ifindex, rxparams->timeslot, rxparams->channel,
-                rxparams->rxpower, rxparams->rcpi, rxparams->datarate);
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    const uint64_t rx_time = ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000ULL);
+
+    /* 수신 프레임마다 호출되므로 바이너리 로그(V2XLOG)로 남긴다. (디버그 레벨에서만 기록) */
+    V2XLOG(LOG_DEBUG | LOG_LOCAL6, "\n-- Processing received MPDU --------------------------------\n");
+    V2XLOG(LOG_DEBUG | LOG_LOCAL6, "Rx MPDU callback - MPDU size: %u, ifindex: %u, timeslot: %u, channel: %u, "
+            "rxpower: %d(0.5dBm), rcpi: %u, datarate: %u(500kbps)\n",
+            mpdu_size, rxparams->ifindex, rxparams->timeslot, rxparams->channel,
+            rxparams->rxpower, rxparams->rcpi, rxparams->datarate);
+
+    if ((rxparams->ifindex >= V2X_OBU_IF_MAX) || !g_if[rxparams->ifindex].enabled) {
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "[prcsWSM] Drop MPDU received on disabled interface if%u\n", rxparams->ifindex);
+        return;
     }
 
-    g_mib.rcpi = rxparams->rcpi;
-    g_mib.rxpower = rxparams->rxpower/2;
-    V2X_OBU_ProcessRxMpdu(mpdu, mpdu_size);
+    struct V2X_OBU_IfStats *stats = &g_if[rxparams->ifindex].stats;
+    stats->rx_cnt++;
+    v2xstat_Inc(g_if[rxparams->ifindex].metrics.rx);
+    v2xstat_Observe(g_if[rxparams->ifindex].metrics.rx_power, rxparams->rxpower/2);
+    stats->rx_last_rcpi = rxparams->rcpi;
+    stats->rx_last_rxpower = rxparams->rxpower/2;
+    V2X_OBU_ProcessRxMpdu(rxparams->ifindex, rxparams->channel, mpdu, mpdu_size, rxparams->rxpower/2, rxparams->rcpi,
+                          rxparams->datarate, rx_time);
 }
 
 
@@ -67,7 +74,8 @@ static void V2X_OBU_ProcessAccessChannelResultCallback(const AlIfIndex ifindex)
 {
     //printf("Access channel result callback - ifindex: %u\n", ifindex);
     syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Access channel result callback - ifindex: %u\n", ifindex);
-    g_chan_access_complete = true;
+    if (ifindex < V2X_OBU_IF_MAX)
+        g_if[ifindex].chan_access_complete = true;
 }
 
 
@@ -187,15 +195,18 @@ int V2X_OBU_AccessChannel(const uint8_t if_idx, const uint8_t ts0_chan, const ui
     //printf("Accessing channel - if_idx: %u, ts0_chan: %u, ts1_chan: %u\n", if_idx, ts0_chan, ts1_chan);
     syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Accessing channel - if_idx: %u, ts0_chan: %u, ts1_chan: %u\n", if_idx, ts0_chan, ts1_chan);
 
-    g_chan_access_complete = false;
+    g_if[if_idx].chan_access_complete = false;
     int ret = Al_AccessChannel(if_idx, ts0_chan, ts1_chan);
     if (ret < 0) {
         //printf("Fail to Al_AccessChannel() - %d\n", ret);
         syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] Fail to Al_AccessChannel() - %d\n", ret);
         return ret;
     }
-    //while(!g_chan_access_complete); // 채널접속결과 콜백함수가 호출될 때까지 대기
-    usleep(10000);
+    /* 채널접속결과 콜백함수가 호출될 때까지 최대 1초 대기 (콜백이 오지 않더라도 기존과 같이 진행한다) */
+    for (int i = 0; (i < 100) && !g_if[if_idx].chan_access_complete; i++)
+        usleep(10000);
+    if (!g_if[if_idx].chan_access_complete)
+        syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] No access channel result callback on if%u\n", if_idx);
 
     //printf("Success to access channel\n");
     syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Success to access channel\n");
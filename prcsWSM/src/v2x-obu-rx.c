@@ -27,49 +27,49 @@
 static void V2X_OBU_PrintWsaParseParams(const struct Dot3ParseWsaParams *const params)
 {
   //printf("WSA params\n");
-  syslog(LOG_INFO | LOG_LOCAL6, "WSA params\n");
+  V2XLOG(LOG_DEBUG | LOG_LOCAL6, "WSA params\n");
   //printf("  version: %u, wsa_id: %u, content_count: %u\n",
   //        params->hdr.version, params->hdr.wsa_id, params->hdr.content_count);
-  syslog(LOG_INFO | LOG_LOCAL6, "  version: %u, wsa_id: %u, content_count: %u\n",
+  V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  version: %u, wsa_id: %u, content_count: %u\n",
           params->hdr.version, params->hdr.wsa_id, params->hdr.content_count);
   if (params->hdr.extensions.repeat_rate) {
       //printf("  repeat_rate: %u\n", params->hdr.repeat_rate);
-      syslog(LOG_INFO | LOG_LOCAL6, "  repeat_rate: %u\n", params->hdr.repeat_rate);
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  repeat_rate: %u\n", params->hdr.repeat_rate);
   }
   if (params->hdr.extensions.twod_location) {
       //printf("  2DLocation.latitude: %d\n", params->hdr.twod_location.latitude);
       //printf("  2DLocation.longitude: %d\n", params->hdr.twod_location.longitude);
-      syslog(LOG_INFO | LOG_LOCAL6, "  2DLocation.latitude: %d\n", params->hdr.twod_location.latitude);
-      syslog(LOG_INFO | LOG_LOCAL6, "  2DLocation.longitude: %d\n", params->hdr.twod_location.longitude);
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  2DLocation.latitude: %d\n", params->hdr.twod_location.latitude);
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  2DLocation.longitude: %d\n", params->hdr.twod_location.longitude);
   }
   if (params->hdr.extensions.threed_location) {
       //printf("  3DLocation.latitude: %d\n", params->hdr.threed_location.latitude);
       //printf("  3DLocation.longitude: %d\n", params->hdr.threed_location.longitude);
       //printf("  3DLocation.elevation: %d\n", params->hdr.threed_location.elevation);
 
-      syslog(LOG_INFO | LOG_LOCAL6, "  3DLocation.latitude: %d\n", params->hdr.threed_location.latitude);
-      syslog(LOG_INFO | LOG_LOCAL6, "  3DLocation.longitude: %d\n", params->hdr.threed_location.longitude);
-      syslog(LOG_INFO | LOG_LOCAL6, "  3DLocation.elevation: %d\n", params->hdr.threed_location.elevation);
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  3DLocation.latitude: %d\n", params->hdr.threed_location.latitude);
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  3DLocation.longitude: %d\n", params->hdr.threed_location.longitude);
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  3DLocation.elevation: %d\n", params->hdr.threed_location.elevation);
   }
   if (params->hdr.extensions.advertiser_id) {
       //printf("  Advertiser Id: %s\n", params->hdr.advertiser_id.id);
-      syslog(LOG_INFO | LOG_LOCAL6, "  Advertiser Id: %s\n", params->hdr.advertiser_id.id);
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  Advertiser Id: %s\n", params->hdr.advertiser_id.id);
   }
   for (int i = 0; i < params->wsi_num; i++) {
       //printf("  Serv info[%d] - psid: %u, channel_index: %u,", i, params->wsis[i].psid, params->wsis[i].channel_index);
-      syslog(LOG_INFO | LOG_LOCAL6, "  Serv info[%d] - psid: %u, channel_index: %u,", i, params->wsis[i].psid, params->wsis[i].channel_index);
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  Serv info[%d] - psid: %u, channel_index: %u,", i, params->wsis[i].psid, params->wsis[i].channel_index);
       if (params->wsis[i].extensions.ipv6_address) {
           char ip_str[IPV6_ADDR_STR_MAX_LEN];
           inet_ntop(AF_INET6, params->wsis[i].ipv6_address, ip_str, IPV6_ADDR_STR_MAX_LEN);
           //printf("  ip: %s, ", ip_str);
-          syslog(LOG_INFO | LOG_LOCAL6, "  ip: %s, ", ip_str);
+          V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  ip: %s, ", ip_str);
       }
       if (params->wsis[i].extensions.service_port) {
           //printf("  port: %u, ", params->wsis[i].service_port);
-          syslog(LOG_INFO | LOG_LOCAL6, "  port: %u, ", params->wsis[i].service_port);
+          V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  port: %u, ", params->wsis[i].service_port);
       }
       //printf("\n");
-      syslog(LOG_INFO | LOG_LOCAL6, "\n");
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "\n");
   }
   for (int i = 0; i < params->wci_num; i++) {
       //printf("  Chan info[%d] - chan: %d, power: %d, datarate: %d, adaptable: %u\n",
@@ -77,7 +77,7 @@ static void V2X_OBU_PrintWsaParseParams(const struct Dot3ParseWsaParams *const p
               //params->wcis[i].transmit_power_level,
               //params->wcis[i].datarate,
               //params->wcis[i].adaptable_datarate);
-      syslog(LOG_INFO | LOG_LOCAL6, "  Chan info[%d] - chan: %d, power: %d, datarate: %d, adaptable: %u\n",
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  Chan info[%d] - chan: %d, power: %d, datarate: %d, adaptable: %u\n",
               i,params->wcis[i].chan_num,
               params->wcis[i].transmit_power_level,
               params->wcis[i].datarate,
@@ -90,7 +90,7 @@ static void V2X_OBU_PrintWsaParseParams(const struct Dot3ParseWsaParams *const p
       inet_ntop(AF_INET6, params->wra.primary_dns, primary_dns, IPV6_ADDR_STR_MAX_LEN);
       //printf("  WRA - lifetime: %u, ip_prefix: %s/%u, default_gw: %s, primary_dns: %s\n",
               //params->wra.router_lifetime, ip_prefix_str, params->wra.ip_prefix_len, default_gw, primary_dns);
-      syslog(LOG_INFO | LOG_LOCAL6, "  WRA - lifetime: %u, ip_prefix: %s/%u, default_gw: %s, primary_dns: %s\n",
+      V2XLOG(LOG_DEBUG | LOG_LOCAL6, "  WRA - lifetime: %u, ip_prefix: %s/%u, default_gw: %s, primary_dns: %s\n",
               params->wra.router_lifetime, ip_prefix_str, params->wra.ip_prefix_len, default_gw, primary_dns);
   }
 }
@@ -101,11 +101,20 @@ static void V2X_OBU_PrintWsaParseParams(const struct Dot3ParseWsaParams *const p
  *  - WSM 파싱을 시도한다.
  *
  *
+ * @param if_idx    수신 인터페이스 식별번호
+ * @param chan      수신 채널번호
  * @param mpdu      수신된 MPDU
  * @param mpdu_size 수신된 MPDU의 크기
+ * @param rxpower   수신 파워(dBm)
+ * @param rcpi      수신 RCPI
+ * @param datarate  수신 데이터레이트(500kbps 단위, 0이면 알 수 없음)
+ * @param rx_time   수신시각 (CLOCK_REALTIME 기준 마이크로초, 수신 콜백 진입 시점)
  */
-void V2X_OBU_ProcessRxMpdu(const uint8_t *const mpdu, const uint16_t mpdu_size)
+void V2X_OBU_ProcessRxMpdu(const uint8_t if_idx, const uint8_t chan, const uint8_t *const mpdu, const uint16_t mpdu_size,
+                           const int16_t rxpower, const uint8_t rcpi, const uint8_t datarate, const uint64_t rx_time)
 {
+    struct V2X_OBU_IfStats *stats = &g_if[if_idx].stats;
+    const struct V2X_OBU_IfMetrics *m = &g_if[if_idx].metrics;
 
     /*
      * WSM MPDU 파싱
@@ -115,19 +124,31 @@ void V2X_OBU_ProcessRxMpdu(const uint8_t *const mpdu, const uint16_t mpdu_size)
     uint8_t BUFFER[kMpduMaxSize];
     uint8_t outbuf[kMpduMaxSize];
     int len=0;
+    struct v2xtraceCtx_t trace;
     int payload_size = Dot3_ParseWsmMpdu(mpdu, mpdu_size, outbuf, sizeof(outbuf), &dot3_params, &wsr_registered);
     if (payload_size < 0) {
-        if(g_dbg)
-        {
-            //printf("Fail to Dot3_ParseWsmMpdu() %d\n", payload_size);
-            //printf("------------------------------------------------------------\n\n");
-            syslog(LOG_ERR | LOG_LOCAL7, "Fail to Dot3_ParseWsmMpdu() %d\n", payload_size);
-            syslog(LOG_INFO | LOG_LOCAL6, "------------------------------------------------------------\n\n");
-        }
+        stats->rx_parse_fail_cnt++;
+        v2xstat_Inc(m->rx_parse_fail);
+        //printf("Fail to Dot3_ParseWsmMpdu() %d\n", payload_size);
+        //printf("------------------------------------------------------------\n\n");
+        V2XLOG(LOG_DEBUG | LOG_LOCAL7, "Fail to Dot3_ParseWsmMpdu() %d\n", payload_size);
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "------------------------------------------------------------\n\n");
         return;
     }
 
-    if (g_dbg >= kDbgMsgLevel_event) {
+    /*
+     * 추적정보 트레일러가 붙어 있으면 떼어 내고 수신시각(수신 콜백 시각)을 기록한다.
+     * 트레일러는 -T 옵션(시험용)을 준 경우에만 찾는다. 꺼져 있으면 페이로드를 그대로 전달한다.
+     */
+    trace.magic = 0;
+    if (g_mib.traceTrailer && v2xtrace_StripTrailer(&trace, outbuf, &payload_size)) {
+        v2xtrace_StampAt(&trace, v2xtraceStage_ObuRx, rx_time * 1000);
+    }
+
+    /*
+     * 수신 프레임 마다의 로그는 바이너리 로그(V2XLOG)로 남긴다. (디버그 레벨에서만 기록)
+     */
+    if (V2XLOG_ENABLED(LOG_DEBUG)) {
 #if 0
         printf("Success to Dot3_ParseWsmMpdu() - payload_size: %d\n", payload_size);
         printf("    tx_chan_num: %d, tx_datarate: %d, tx_power: %d, priority: %d, psid: %d\n",
@@ -138,11 +159,11 @@ void V2X_OBU_ProcessRxMpdu(const uint8_t *const mpdu, const uint16_t mpdu_size)
                 dot3_params.src_mac_addr[0], dot3_params.src_mac_addr[1], dot3_params.src_mac_addr[2],
                 dot3_params.src_mac_addr[3], dot3_params.src_mac_addr[4], dot3_params.src_mac_addr[5]);
 #endif
-        syslog(LOG_INFO | LOG_LOCAL6, "Success to Dot3_ParseWsmMpdu() - payload_size: %d\n", payload_size);
-        syslog(LOG_INFO | LOG_LOCAL6, "    tx_chan_num: %d, tx_datarate: %d, tx_power: %d, priority: %d, psid: %d\n",
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "Success to Dot3_ParseWsmMpdu() - payload_size: %d\n", payload_size);
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "    tx_chan_num: %d, tx_datarate: %d, tx_power: %d, priority: %d, psid: %d\n",
                 dot3_params.tx_chan_num, dot3_params.tx_datarate, dot3_params.tx_power, dot3_params.priority, dot3_params.psid);
-	syslog(LOG_INFO | LOG_LOCAL6, "rx_power : %d, rcpi : %d \n",
-			g_mib.rxpower, g_mib.rcpi);
+	V2XLOG(LOG_DEBUG | LOG_LOCAL6, "if%u rx_power : %d, rcpi : %d \n",
+			if_idx, rxpower, rcpi);
         //syslog(LOG_INFO | LOG_LOCAL6, "    dst_mac_addr: %02X:%02X:%02X:%02X:%02X:%02X, src_mac_addr: %02X:%02X:%02X:%02X:%02X:%02X\n",
                 //dot3_params.dst_mac_addr[0], dot3_params.dst_mac_addr[1], dot3_params.dst_mac_addr[2],
                 //dot3_params.dst_mac_addr[3], dot3_params.dst_mac_addr[4], dot3_params.dst_mac_addr[5],
@@ -164,6 +185,23 @@ void V2X_OBU_ProcessRxMpdu(const uint8_t *const mpdu, const uint16_t mpdu_size)
 #endif
     }
 
+    /*
+     * 혼잡제어 - 채널 점유시간과 송신기 밀도 측정에 반영한다. (중복 프레임도 채널을 점유하므로 필터링 전에 반영한다)
+     */
+    V2X_OBU_CcNotifyRx(if_idx, dot3_params.src_mac_addr, mpdu_size, datarate);
+
+    /*
+     * 윈도우 시간 이내에 이미 수신된 프레임(다른 인터페이스 또는 중계 RSU 경유)이면 폐기한다.
+     * PAR 프로브는 인터페이스/채널 별로 측정하므로 중복 필터를 적용하지 않는다.
+     */
+    if ((dot3_params.psid != MSGQ_PSID_PAR) && V2X_OBU_CheckDupRx(dot3_params.src_mac_addr, dot3_params.psid, outbuf, payload_size)) {
+        stats->rx_dup_cnt++;
+        v2xstat_Inc(m->rx_dup);
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "Drop duplicate WSM for psid %u\n", dot3_params.psid);
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "------------------------------------------------------------\n\n");
+        return;
+    }
+
     /*
      * WSA 인 경우 파싱한다.
      */
@@ -172,18 +210,15 @@ void V2X_OBU_ProcessRxMpdu(const uint8_t *const mpdu, const uint16_t mpdu_size)
         memset(&wsa_params, 0, sizeof(wsa_params));
         int ret = Dot3_ParseWsa(outbuf, payload_size, &wsa_params);
         if (ret < 0) {
-            if(g_dbg)
-            {
-                //printf("Fail to parse WSA - %d\n", ret);
-                //printf("------------------------------------------------------------\n\n");
-                syslog(LOG_INFO | LOG_LOCAL6, "Fail to parse WSA - %d\n", ret);
-                syslog(LOG_INFO | LOG_LOCAL6, "------------------------------------------------------------\n\n");
-            }
+            //printf("Fail to parse WSA - %d\n", ret);
+            //printf("------------------------------------------------------------\n\n");
+            V2XLOG(LOG_DEBUG | LOG_LOCAL6, "Fail to parse WSA - %d\n", ret);
+            V2XLOG(LOG_DEBUG | LOG_LOCAL6, "------------------------------------------------------------\n\n");
             return;
         }
-        if (g_dbg >= kDbgMsgLevel_event) {
+        if (V2XLOG_ENABLED(LOG_DEBUG)) {
             //printf("Success to parse WSA()\n");
-            syslog(LOG_INFO | LOG_LOCAL6, "Success to parse WSA()\n");
+            V2XLOG(LOG_DEBUG | LOG_LOCAL6, "Success to parse WSA()\n");
             V2X_OBU_PrintWsaParseParams(&wsa_params);
         }
     }
@@ -191,30 +226,34 @@ void V2X_OBU_ProcessRxMpdu(const uint8_t *const mpdu, const uint16_t mpdu_size)
      * 원하는 WSMP인 경우 적당히 처리한다.
      */
     if (dot3_params.psid == g_mib.psid) {
-        sendMQ(outbuf, payload_size);
-        if (g_dbg >= kDbgMsgLevel_event) {
-            //printf("Processing interseted WSM for psid %u\n", dot3_params.psid);
-            //printf("------------------------------------------------------------\n\n");
-            syslog(LOG_INFO | LOG_LOCAL6, "Processing interseted WSM for psid %u\n", dot3_params.psid);
-            syslog(LOG_INFO | LOG_LOCAL6, "------------------------------------------------------------\n\n");
-        }
+        sendMQ(outbuf, payload_size, &trace);
+        stats->rx_fwd_cnt++;
+        v2xstat_Inc(m->rx_fwd);
+        //printf("Processing interseted WSM for psid %u\n", dot3_params.psid);
+        //printf("------------------------------------------------------------\n\n");
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "Processing interseted WSM for psid %u\n", dot3_params.psid);
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "------------------------------------------------------------\n\n");
         /* TO DO */
     }
-    else if (dot3_params.psid == 7777) {
+    else if (dot3_params.psid == MSGQ_PSID_PAR) {
 	    memset(BUFFER,0,sizeof(kMpduMaxSize));
 	    memcpy(BUFFER+len,outbuf,payload_size);
 	    len+=payload_size;
-	    memcpy(BUFFER+len, &g_mib.rxpower, sizeof(int16_t)); //int16_t short int 2Byte
+	    memcpy(BUFFER+len, &rxpower, sizeof(int16_t)); //int16_t short int 2Byte
 	    len+=sizeof(int16_t);
-	    memcpy(BUFFER+len, &g_mib.rcpi, sizeof(uint8_t)); //uint8_t unsigned char 1Byte
+	    memcpy(BUFFER+len, &rcpi, sizeof(uint8_t)); //uint8_t unsigned char 1Byte
 	    len+=sizeof(uint8_t);
+	    memcpy(BUFFER+len, &rx_time, sizeof(uint64_t)); //수신시각(usec) 8Byte
+	    len+=sizeof(uint64_t);
+	    BUFFER[len++] = if_idx; //수신 인터페이스 1Byte
+	    BUFFER[len++] = chan; //수신 채널번호 1Byte
         PARsendMQ(BUFFER, len);
-        if (g_dbg >= kDbgMsgLevel_event) {
-            //printf("Processing interseted WSM for psid %u\n", dot3_params.psid);
-            //printf("------------------------------------------------------------\n\n");
-            syslog(LOG_INFO | LOG_LOCAL6, "Processing interseted WSM for PAR psid %u\n", dot3_params.psid);
-            syslog(LOG_INFO | LOG_LOCAL6, "------------------------------------------------------------\n\n");
-        }
+        stats->rx_fwd_cnt++;
+        v2xstat_Inc(m->rx_fwd);
+        //printf("Processing interseted WSM for psid %u\n", dot3_params.psid);
+        //printf("------------------------------------------------------------\n\n");
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "Processing interseted WSM for PAR psid %u\n", dot3_params.psid);
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "------------------------------------------------------------\n\n");
         /* TO DO */
     }
 
@@ -223,12 +262,12 @@ void V2X_OBU_ProcessRxMpdu(const uint8_t *const mpdu, const uint16_t mpdu_size)
      * 그 외 WSMP는 무시한다.
      */
     else {
-        if (g_dbg >= kDbgMsgLevel_event) {
-            //printf("Drop not interseted WSM for psid %u\n", dot3_params.psid);
-            //printf("------------------------------------------------------------\n\n");
-            syslog(LOG_INFO | LOG_LOCAL6, "Drop not interseted WSM for psid %u\n", dot3_params.psid);
-            syslog(LOG_INFO | LOG_LOCAL6, "------------------------------------------------------------\n\n");
-        }
+        stats->rx_ignore_cnt++;
+        v2xstat_Inc(m->rx_ignore);
+        //printf("Drop not interseted WSM for psid %u\n", dot3_params.psid);
+        //printf("------------------------------------------------------------\n\n");
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "Drop not interseted WSM for psid %u\n", dot3_params.psid);
+        V2XLOG(LOG_DEBUG | LOG_LOCAL6, "------------------------------------------------------------\n\n");
     }
 }
 
@@ -23,18 +23,59 @@ static timer_t g_tx_timer; ///< 송신타이머
 static pthread_mutex_t g_tx_timer_mtx; ///< 송신타이머 뮤텍스
 static pthread_cond_t tx_timer_cond; ///< 송신타이머 컨디션
 #endif
-static pthread_t g_tx_thread; ///< 송신쓰레드
+static pthread_t g_tx_thread[V2X_OBU_IF_MAX]; ///< 인터페이스 별 송신쓰레드
+static pthread_t g_tx_mq_thread; ///< 송신 메시지큐 수신쓰레드
+static const struct v2xstatDesc_t *g_tx_no_if_metric; ///< 활성화되지 않은 인터페이스로 요청되어 폐기된 수 (공유메모리 통계)
 
 
 /**
- * WSM 송신 쓰레드 함수
- *  - 대기하고 있다가, 송신타이머쓰레드로부터 컨디션 시그널을 수신하면, WSM을 송신한다.
+ * WSM 송신 메시지큐 수신쓰레드 함수
+ *  - 메시지큐로부터 송신패킷을 수신하여 송신 인터페이스의 우선순위에 해당하는 AC 송신큐에 삽입한다.
  *
  * @param notused   사용되지 않음
  * @return          NULL (프로그램 종료시에만 리턴됨)
  */
-static void* V2X_OBU_WsmTxThread(void *notused)
+static void* V2X_OBU_WsmTxMqThread(void *notused)
 {
+    uint8_t pkt[MSGMAX];
+    uint8_t priority;
+    uint32_t lifetime;
+    uint8_t if_idx;
+    uint32_t psid;
+    struct v2xtraceCtx_t trace;
+    int len;
+
+    do {
+        /* Receive MsgQ */
+        len = recvMQ((char *)pkt, &priority, &lifetime, &if_idx, &psid, &trace);
+        if (len < 0)
+            continue;
+
+        if ((if_idx >= V2X_OBU_IF_MAX) || !g_if[if_idx].enabled) {
+            if (if_idx < V2X_OBU_IF_MAX)
+                g_if[if_idx].stats.tx_no_if_cnt++;
+            v2xstat_Inc(g_tx_no_if_metric);
+            syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] Drop tx packet for disabled interface if%u\n", if_idx);
+            continue;
+        }
+        V2X_OBU_EnqueueTxq(if_idx, pkt, (uint32_t)len, priority, lifetime, (Dot3Psid)psid, &trace);
+    } while(1);
+}
+
+
+/**
+ * WSM 송신 쓰레드 함수 (인터페이스 별로 하나씩 생성된다)
+ *  - 인터페이스의 AC 송신큐에서 스케줄링 방식에 따라 패킷을 꺼내 WSM을 송신한다.
+ *
+ * @param arg       인터페이스 식별번호
+ * @return          NULL (프로그램 종료시에만 리턴됨)
+ */
+static void* V2X_OBU_WsmTxThread(void *arg)
+{
+    const uint8_t if_idx = (uint8_t)(uintptr_t)arg;
+    struct V2X_OBU_If *netif = &g_if[if_idx];
+    Dot3ChannelNumber chan = (netif->timeSlot == kDot3TimeSlot_1) ? netif->ts1_chan : netif->ts0_chan;
+
     int mpdu_size;
     uint8_t mpdu[kMpduMaxSize];
 
@@ -43,21 +84,44 @@ static void* V2X_OBU_WsmTxThread(void *notused)
 
     /* 190827- yslee */
     uint8_t pkt[kMpduMaxSize];
-    uint32_t len = 0;
+    uint8_t priority;
+    Dot3Psid psid;
+    uint64_t remain;
+    Dot3Power power;
+    struct v2xtraceCtx_t trace;
+    int len = 0;
 
 
     do {
-        if (g_dbg >= kDbgMsgLevel_msgdump) {
-            //printf("\n-- Sending WSM ---------------------------------------------\n");
-            syslog(LOG_INFO | LOG_LOCAL6, "\n-- Sending WSM ---------------------------------------------\n");
-        }
-
-        /* Receive MsgQ */
-        len = recvMQ(pkt);
-        if (len < 0)
+        /* Dequeue */
+        len = V2X_OBU_DequeueTxq(if_idx, pkt, &priority, &psid, &remain, &trace, 1000);
+        if (len <= 0)
             continue;
         else
         {
+            if (g_dbg >= kDbgMsgLevel_msgdump) {
+                //printf("\n-- Sending WSM ---------------------------------------------\n");
+                syslog(LOG_INFO | LOG_LOCAL6, "\n-- Sending WSM ---------------------------------------------\n");
+            }
+
+            /*
+             * 혼잡제어 - 패킷의 PSID 별로 송신주기가 지나지 않았으면 폐기하고, 송신파워를 결정한다.
+             */
+            power = g_mib.power;
+            if (!V2X_OBU_CcAdmitTx(if_idx, psid, &power)) {
+                v2xstat_Inc(netif->metrics.tx_cc_drop);
+                continue;
+            }
+
+            /*
+             * 추적 중인 메시지면 WSM 생성 시각을 기록한다.
+             * 추적정보 트레일러는 무선으로 송신되므로 -T 옵션(시험용)을 준 경우에만 페이로드 뒤에 붙인다.
+             */
+            if (V2XTRACE_VALID(&trace)) {
+                v2xtrace_Stamp(&trace, v2xtraceStage_Dot3);
+                if (g_mib.traceTrailer)
+                    len = v2xtrace_AppendTrailer(&trace, pkt, len, sizeof(pkt));
+            }
 
             /*
              * WSM MPDU 를 생성한다.
@@ -66,17 +130,19 @@ static void* V2X_OBU_WsmTxThread(void *notused)
             wsm_params.hdr_extensions.chan_num = true;
             wsm_params.hdr_extensions.datarate = true;
             wsm_params.hdr_extensions.transmit_power = true;
-            wsm_params.ifindex = g_mib.netIfIndex;
-            wsm_params.chan_num = g_mib.channel;
-            wsm_params.timeslot = g_mib.timeSlot;
+            wsm_params.ifindex = if_idx;
+            wsm_params.chan_num = chan;
+            wsm_params.timeslot = netif->timeSlot;
             wsm_params.datarate = g_mib.dataRate;
-            wsm_params.transmit_power = g_mib.power;
-            wsm_params.priority = g_mib.priority;
+            wsm_params.transmit_power = power;
+            wsm_params.priority = priority;
             memcpy(wsm_params.dst_mac_addr, g_mib.destMac, MAC_ALEN);
-            memcpy(wsm_params.src_mac_addr, g_if1_mac_address, MAC_ALEN);
-            wsm_params.psid = g_mib.psid;
+            memcpy(wsm_params.src_mac_addr, netif->mac_addr, MAC_ALEN);
+            wsm_params.psid = psid;
             mpdu_size = Dot3_ConstructWsmMpdu(&wsm_params, pkt, len, mpdu, sizeof(mpdu));
             if (mpdu_size < 0) {
+                netif->stats.tx_fail_cnt++;
+                v2xstat_Inc(netif->metrics.tx_fail);
                 //printf("Fail to Dot3_ConstructWsmMpdu() - %d\n", mpdu_size);
                 //printf("------------------------------------------------------------\n\n");
                 syslog(LOG_ERR | LOG_LOCAL7, "Fail to Dot3_ConstructWsmMpdu() - %d\n", mpdu_size);
@@ -103,19 +169,24 @@ static void* V2X_OBU_WsmTxThread(void *notused)
              * WSM MPDU 를 전송한다.
              */
             memset(&al_params, 0, sizeof(al_params));
-            al_params.channel = g_mib.channel;
-            al_params.timeslot = g_mib.timeSlot; // 현재까지 TimeSlot_0 동작만 확인됨.
+            al_params.channel = chan;
+            al_params.timeslot = netif->timeSlot; // 현재까지 TimeSlot_0 동작만 확인됨.
             al_params.datarate = g_mib.dataRate;
-            al_params.expiry = 0;
-            al_params.txpower = g_mib.power;
-            int ret = Al_TransmitMpdu(g_mib.netIfIndex, mpdu, mpdu_size, &al_params);
+            al_params.expiry = remain; // 남은 유효기간 - 다시 빌드한 액세스계층에서만 TSF 기준 만료시각으로 변환된다. (v2x-obu-txq.c 참고)
+            al_params.txpower = power;
+            int ret = Al_TransmitMpdu(if_idx, mpdu, mpdu_size, &al_params);
             if (ret < 0) {
+                netif->stats.tx_fail_cnt++;
+                v2xstat_Inc(netif->metrics.tx_fail);
                 //printf("Fail to Al_TransmitMpdu() - ret: %d\n", ret);
                 //printf("------------------------------------------------------------\n\n");
                 syslog(LOG_ERR | LOG_LOCAL7, "Fail to Al_TransmitMpdu() - ret: %d\n", ret);
                 syslog(LOG_INFO | LOG_LOCAL6, "------------------------------------------------------------\n\n");
                 continue;
             } else {
+                netif->stats.tx_cnt++;
+                v2xstat_Inc(netif->metrics.tx);
+                v2xtrace_Stamp(&trace, v2xtraceStage_Radio);
                 if (g_dbg >= kDbgMsgLevel_event)
                 {
                     //printf("[prcsWSM] Success to Al_TransmitMpdu()\n");
@@ -207,10 +278,31 @@ int V2X_OBU_InitWsmTx(const uint32_t timer_interval)
 {
     //printf("Initializing WSM tx operation\n");
     syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Initializing WSM tx operation\n");
-    int ret = pthread_create(&g_tx_thread, NULL, V2X_OBU_WsmTxThread, NULL);
+    int ret;
+
+    g_tx_no_if_metric = v2xstat_Counter("tx.no_if", "pkt");
+
+    /* 활성화된 인터페이스 별로 송신큐와 송신쓰레드를 생성한다. */
+    for (int i = 0; i < V2X_OBU_IF_MAX; i++) {
+        if (!g_if[i].enabled) {
+            continue;
+        }
+        ret = V2X_OBU_InitTxq(i);
+        if (ret < 0) {
+            return -1;
+        }
+
+        ret = pthread_create(&g_tx_thread[i], NULL, V2X_OBU_WsmTxThread, (void *)(uintptr_t)i);
+        if (ret < 0) {
+            //perror("Fail to create WSM tx thread() ");
+            syslog(LOG_ERR | LOG_LOCAL7, "Fail to create WSM tx thread() on if%d : %s\n", i, strerror(errno));
+            return -1;
+        }
+    }
+
+    ret = pthread_create(&g_tx_mq_thread, NULL, V2X_OBU_WsmTxMqThread, NULL);
     if (ret < 0) {
-        //perror("Fail to create WSM tx thread() ");
-        syslog(LOG_ERR | LOG_LOCAL7, "Fail to create WSM tx thread() : %s\n", strerror(errno));
+        syslog(LOG_ERR | LOG_LOCAL7, "Fail to create WSM tx msgQ thread() : %s\n", strerror(errno));
         return -1;
     }
 
@@ -0,0 +1,426 @@
+/**
+ * @file v2x-obu-txq.c
+ * @date 2026-10-19
+ * @brief EDCA 액세스카테고리(AC) 별 송신큐 기능 구현
+ *
+ *  - 송신큐는 인터페이스 별로 독립적으로 유지되며, 인터페이스 별 송신쓰레드가 각각 큐를 비운다.
+ *  - 메시지큐로부터 수신한 송신패킷을 우선순위(802.1D UP)에 따라 4개의 AC 큐(BK/BE/VI/VO)에 저장한다.
+ *  - 송신쓰레드는 strict-priority 또는 가중치(WRR) 방식으로 큐에서 패킷을 꺼내 전송한다.
+ *  - 큐가 가득 찬 경우 가장 오래된 패킷을 폐기(drop-oldest)한다.
+ *  - 유효기간이 지난 패킷은 송신하지 않고 폐기하며, 남은 유효기간은 액세스계층의 Expiry로 전달된다.
+ *    배포된 libwlanaccess(ext/lib/aarch64)는 MKx Expiry를 0으로 보내므로, 현재 만료 처리는 이 송신큐 폐기로만 이루어진다.
+ *    (TSF 기준 Expiry 변환은 ext/lib/armhf/v2x-libwlanaccess 소스에만 있으며 라이브러리를 다시 빌드해야 적용된다)
+ *  - AC 별 큐잉지연 히스토그램을 주기적으로 syslog에 출력한다.
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "v2x-obu.h"
+
+
+/// 큐잉지연 히스토그램 구간 상한값(usec). 마지막 구간은 상한 없음.
+static const uint32_t g_txq_hist_bound[kTxqHistBin_Num - 1] = {
+    100, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000
+};
+
+/// AC 별 WRR 가중치 (BK, BE, VI, VO)
+static const uint32_t g_txq_weight[kTxAc_Num] = { 1, 2, 4, 8 };
+
+/// AC 이름 (로그 출력용)
+static const char *g_txq_ac_name[kTxAc_Num] = { "BK", "BE", "VI", "VO" };
+
+/**
+ * 송신큐 엔트리
+ */
+struct V2X_OBU_TxqEntry
+{
+    uint8_t priority; ///< 802.1D 사용자 우선순위 (0~7)
+    uint32_t len; ///< 페이로드 길이
+    uint64_t lifetime; ///< 유효기간(usec), 0이면 만료되지 않음
+    Dot3Psid psid; ///< 송신 PSID
+    struct timespec enq_ts; ///< 큐 삽입 시각 (CLOCK_MONOTONIC)
+    struct v2xtraceCtx_t trace; ///< 종단간 지연 추적정보
+    uint8_t pkt[kMpduMaxSize]; ///< 페이로드
+};
+
+/**
+ * AC 별 송신큐 (링버퍼)
+ */
+struct V2X_OBU_Txq
+{
+    struct V2X_OBU_TxqEntry *entry; ///< 엔트리 배열 (g_mib.txqDepth 개)
+    uint32_t head; ///< 다음에 꺼낼 엔트리 인덱스
+    uint32_t cnt; ///< 저장된 엔트리 개수
+    uint32_t credit; ///< WRR 잔여 송신 횟수
+    struct V2X_OBU_TxqStats stats; ///< 통계
+};
+
+/**
+ * 인터페이스 별 송신큐 집합
+ */
+struct V2X_OBU_TxqSet
+{
+    struct V2X_OBU_Txq txq[kTxAc_Num]; ///< AC 별 송신큐
+    pthread_mutex_t mtx; ///< 송신큐 뮤텍스
+    pthread_cond_t cond; ///< 송신큐 컨디션 (패킷 삽입 시 시그널)
+    const struct V2X_OBU_IfMetrics *metrics; ///< 인터페이스 공유메모리 통계
+};
+
+static struct V2X_OBU_TxqSet g_txqs[V2X_OBU_IF_MAX]; ///< 인터페이스 별 송신큐
+
+
+/**
+ * 두 시각의 차이를 usec 단위로 반환한다.
+ */
+static uint64_t V2X_OBU_TxqElapsedUsec(const struct timespec *from, const struct timespec *to)
+{
+    int64_t usec = (int64_t)(to->tv_sec - from->tv_sec) * 1000000 + (to->tv_nsec - from->tv_nsec) / 1000;
+    return (usec < 0) ? 0 : (uint64_t)usec;
+}
+
+
+/**
+ * 802.1D 사용자 우선순위를 EDCA AC로 변환한다. (IEEE 802.11 Table 10-1)
+ *
+ * @param priority  사용자 우선순위 (0~7)
+ * @return          AC
+ */
+TxAc V2X_OBU_PriorityToAc(const uint8_t priority)
+{
+    switch (priority) {
+        case 1:
+        case 2:
+            return kTxAc_BK;
+        case 4:
+        case 5:
+            return kTxAc_VI;
+        case 6:
+        case 7:
+            return kTxAc_VO;
+        case 0:
+        case 3:
+        default:
+            return kTxAc_BE;
+    }
+}
+
+
+/**
+ * 인터페이스의 AC 별 송신큐를 초기화한다.
+ *
+ * @param if_idx    인터페이스 식별번호
+ * @return          성공 시 0, 실패 시 -1
+ */
+int V2X_OBU_InitTxq(const uint8_t if_idx)
+{
+    struct V2X_OBU_TxqSet *set = &g_txqs[if_idx];
+    struct V2X_OBU_IfMetrics *m = &g_if[if_idx].metrics;
+    pthread_condattr_t attr;
+    int64_t bound[kTxqHistBin_Num - 1];
+    char name[V2XSTAT_METRIC_NAME_MAX];
+
+    syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Initializing tx queue on if%u - depth: %u, sched: %s\n",
+           if_idx, g_mib.txqDepth, (g_mib.txqSched == kTxqSched_Wrr) ? "wrr" : "strict");
+
+    memset(set, 0, sizeof(*set));
+    set->metrics = m;
+    for (int ac = 0; ac < kTxAc_Num; ac++) {
+        set->txq[ac].entry = (struct V2X_OBU_TxqEntry *)calloc(g_mib.txqDepth, sizeof(struct V2X_OBU_TxqEntry));
+        if (set->txq[ac].entry == NULL) {
+            syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] Fail to allocate memory for tx queue(if%u, %s)\n", if_idx, g_txq_ac_name[ac]);
+            V2X_OBU_ReleaseTxq(if_idx);
+            return -1;
+        }
+        set->txq[ac].credit = g_txq_weight[ac];
+    }
+
+    /* 타임아웃 대기 시 시스템 시간 변경(timeSync)의 영향을 받지 않도록 MONOTONIC 클럭을 사용한다. */
+    pthread_mutex_init(&set->mtx, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&set->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    /* 공유메모리 통계 - 큐잉지연 분포는 출력용 히스토그램과 같은 구간을 사용한다. */
+    for (int bin = 0; bin < kTxqHistBin_Num - 1; bin++) {
+        bound[bin] = g_txq_hist_bound[bin];
+    }
+    m->txq_depth = v2xstat_Gauge(V2X_OBU_IfMetricName(name, if_idx, "txq_depth"), "pkt");
+    m->txq_drop = v2xstat_Counter(V2X_OBU_IfMetricName(name, if_idx, "txq_drop"), "pkt");
+    m->txq_expire = v2xstat_Counter(V2X_OBU_IfMetricName(name, if_idx, "txq_expire"), "pkt");
+    m->txq_delay = v2xstat_Hist(V2X_OBU_IfMetricName(name, if_idx, "txq_delay"), "usec", bound, kTxqHistBin_Num - 1);
+
+    syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Success to initialize tx queue on if%u\n", if_idx);
+    return 0;
+}
+
+
+/**
+ * 인터페이스의 AC 별 송신큐를 해제한다.
+ *
+ * @param if_idx    인터페이스 식별번호
+ */
+void V2X_OBU_ReleaseTxq(const uint8_t if_idx)
+{
+    for (int ac = 0; ac < kTxAc_Num; ac++) {
+        free(g_txqs[if_idx].txq[ac].entry);
+        g_txqs[if_idx].txq[ac].entry = NULL;
+    }
+}
+
+
+/**
+ * 송신패킷을 인터페이스의 우선순위에 해당하는 AC 큐에 삽입한다.
+ *  - 큐가 가득 찬 경우 가장 오래된 패킷을 폐기한다.
+ *
+ * @param if_idx    인터페이스 식별번호
+ * @param pkt       페이로드
+ * @param len       페이로드 길이
+ * @param priority  사용자 우선순위 (0~7)
+ * @param lifetime  유효기간(msec), 0이면 만료되지 않음
+ * @param psid      송신 PSID
+ * @param trace     종단간 지연 추적정보
+ * @return          성공 시 0, 실패 시 -1
+ */
+int V2X_OBU_EnqueueTxq(const uint8_t if_idx, const uint8_t *pkt, const uint32_t len, const uint8_t priority, const uint32_t lifetime,
+                       const Dot3Psid psid, const struct v2xtraceCtx_t *trace)
+{
+    TxAc ac = V2X_OBU_PriorityToAc(priority);
+    struct V2X_OBU_TxqSet *set = &g_txqs[if_idx];
+    struct V2X_OBU_Txq *q = &set->txq[ac];
+    struct V2X_OBU_TxqEntry *e;
+
+    if (len > sizeof(e->pkt)) {
+        syslog(LOG_ERR | LOG_LOCAL7, "[prcsWSM] Fail to enqueue tx packet - too long(%u)\n", len);
+        return -1;
+    }
+
+    pthread_mutex_lock(&set->mtx);
+    if (q->cnt >= g_mib.txqDepth) {
+        /* drop-oldest */
+        q->head = (q->head + 1) % g_mib.txqDepth;
+        q->cnt--;
+        q->stats.drop_cnt++;
+        v2xstat_Inc(g_if[if_idx].metrics.txq_drop);
+        v2xstat_Add(g_if[if_idx].metrics.txq_depth, -1);
+        if (g_dbg >= kDbgMsgLevel_event) {
+            syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Tx queue(if%u, %s) full - drop oldest packet\n", if_idx, g_txq_ac_name[ac]);
+        }
+    }
+    e = &q->entry[(q->head + q->cnt) % g_mib.txqDepth];
+    e->priority = priority;
+    e->len = len;
+    e->lifetime = (uint64_t)lifetime * 1000;
+    e->psid = psid;
+    memcpy(e->pkt, pkt, len);
+    e->trace = *trace;
+    clock_gettime(CLOCK_MONOTONIC, &e->enq_ts);
+    q->cnt++;
+    q->stats.enq_cnt++;
+    v2xstat_Add(g_if[if_idx].metrics.txq_depth, 1);
+    pthread_cond_signal(&set->cond);
+    pthread_mutex_unlock(&set->mtx);
+
+    return 0;
+}
+
+
+/**
+ * 각 AC 큐의 맨 앞에서부터 유효기간이 지난 패킷들을 폐기한다. (set->mtx 잠금 상태에서 호출)
+ *  - 패킷마다 유효기간이 다를 수 있으므로, 맨 앞이 아닌 만료 패킷은 맨 앞에 도달했을 때 폐기된다.
+ *
+ * @param set   인터페이스 송신큐 집합
+ * @param now   현재 시각 (CLOCK_MONOTONIC)
+ */
+static void V2X_OBU_PurgeExpiredTxq(struct V2X_OBU_TxqSet *set, const struct timespec *now)
+{
+    struct V2X_OBU_Txq *q;
+    struct V2X_OBU_TxqEntry *e;
+
+    for (int ac = 0; ac < kTxAc_Num; ac++) {
+        q = &set->txq[ac];
+        while (q->cnt) {
+            e = &q->entry[q->head];
+            if ((e->lifetime == 0) || (V2X_OBU_TxqElapsedUsec(&e->enq_ts, now) < e->lifetime)) {
+                break;
+            }
+            q->head = (q->head + 1) % g_mib.txqDepth;
+            q->cnt--;
+            q->stats.expire_cnt++;
+            v2xstat_Inc(set->metrics->txq_expire);
+            v2xstat_Add(set->metrics->txq_depth, -1);
+            if (g_dbg >= kDbgMsgLevel_event) {
+                syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] Tx queue(%s) drop expired packet\n", g_txq_ac_name[ac]);
+            }
+        }
+    }
+}
+
+
+/**
+ * 스케줄링 정책에 따라 다음에 송신할 AC를 선택한다. (set->mtx 잠금 상태에서 호출)
+ *
+ * @param set   인터페이스 송신큐 집합
+ * @return      선택된 AC, 모든 큐가 비어 있으면 -1
+ */
+static int V2X_OBU_SelectTxq(struct V2X_OBU_TxqSet *set)
+{
+    struct V2X_OBU_Txq *txq = set->txq;
+    int ac;
+
+    if (g_mib.txqSched == kTxqSched_Strict) {
+        for (ac = kTxAc_Num - 1; ac >= 0; ac--) {
+            if (txq[ac].cnt) {
+                return ac;
+            }
+        }
+        return -1;
+    }
+
+    /*
+     * WRR: 잔여 송신횟수가 남아 있는 AC 중 우선순위가 높은 AC를 선택한다.
+     *      패킷이 있는 모든 AC의 송신횟수가 소진되면 가중치만큼 재충전한다.
+     */
+    for (int round = 0; round < 2; round++) {
+        for (ac = kTxAc_Num - 1; ac >= 0; ac--) {
+            if (txq[ac].cnt && txq[ac].credit) {
+                txq[ac].credit--;
+                return ac;
+            }
+        }
+        for (ac = 0; ac < kTxAc_Num; ac++) {
+            txq[ac].credit = g_txq_weight[ac];
+        }
+    }
+    return -1;
+}
+
+
+/**
+ * 인터페이스 송신큐에서 다음 송신패킷을 꺼낸다. 모든 큐가 비어 있으면 timeout_ms 동안 대기한다.
+ *  - 유효기간이 지난 패킷은 꺼내지 않고 폐기한다.
+ *
+ * @param if_idx    인터페이스 식별번호
+ * @param pkt       페이로드가 저장될 버퍼 (kMpduMaxSize 이상)
+ * @param priority  사용자 우선순위가 저장될 변수
+ * @param psid      송신 PSID가 저장될 변수
+ * @param remain    남은 유효기간(usec)이 저장될 변수, 0이면 만료되지 않음
+ * @param trace     종단간 지연 추적정보가 저장될 변수
+ * @param timeout_ms 최대 대기시간(msec)
+ * @return          페이로드 길이, 타임아웃 시 0
+ */
+int V2X_OBU_DequeueTxq(const uint8_t if_idx, uint8_t *pkt, uint8_t *priority, Dot3Psid *psid, uint64_t *remain,
+                       struct v2xtraceCtx_t *trace, const uint32_t timeout_ms)
+{
+    struct V2X_OBU_TxqSet *set = &g_txqs[if_idx];
+    struct timespec now, deadline;
+    struct V2X_OBU_Txq *q;
+    struct V2X_OBU_TxqEntry *e;
+    uint64_t delay;
+    int ac, len, bin;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&set->mtx);
+    while (1) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        V2X_OBU_PurgeExpiredTxq(set, &now);
+        if ((ac = V2X_OBU_SelectTxq(set)) >= 0) {
+            break;
+        }
+        if (pthread_cond_timedwait(&set->cond, &set->mtx, &deadline) == ETIMEDOUT) {
+            pthread_mutex_unlock(&set->mtx);
+            return 0;
+        }
+    }
+
+    q = &set->txq[ac];
+    e = &q->entry[q->head];
+    len = (int)e->len;
+    *priority = e->priority;
+    *psid = e->psid;
+    *trace = e->trace;
+    memcpy(pkt, e->pkt, e->len);
+    q->head = (q->head + 1) % g_mib.txqDepth;
+    q->cnt--;
+
+    /* 큐잉지연 히스토그램 갱신 */
+    delay = V2X_OBU_TxqElapsedUsec(&e->enq_ts, &now);
+    *remain = e->lifetime ? (e->lifetime - delay) : 0;
+    for (bin = 0; bin < kTxqHistBin_Num - 1; bin++) {
+        if (delay < g_txq_hist_bound[bin]) {
+            break;
+        }
+    }
+    q->stats.hist[bin]++;
+    q->stats.deq_cnt++;
+    v2xstat_Add(g_if[if_idx].metrics.txq_depth, -1);
+    v2xstat_Observe(g_if[if_idx].metrics.txq_delay, (int64_t)delay);
+    q->stats.delay_cnt++;
+    q->stats.delay_sum += delay;
+    if (delay > q->stats.delay_max) {
+        q->stats.delay_max = delay;
+    }
+    pthread_mutex_unlock(&set->mtx);
+
+    return len;
+}
+
+
+/**
+ * 인터페이스의 AC 별 송신큐 통계를 복사한다.
+ *
+ * @param if_idx    인터페이스 식별번호
+ * @param ac        AC
+ * @param stats     통계가 저장될 변수
+ */
+void V2X_OBU_GetTxqStats(const uint8_t if_idx, const TxAc ac, struct V2X_OBU_TxqStats *stats)
+{
+    pthread_mutex_lock(&g_txqs[if_idx].mtx);
+    *stats = g_txqs[if_idx].txq[ac].stats;
+    pthread_mutex_unlock(&g_txqs[if_idx].mtx);
+}
+
+
+/**
+ * 인터페이스의 AC 별 큐잉지연 히스토그램을 syslog로 출력한다. 통계출력 쓰레드에서 주기적으로 호출된다.
+ *  - 출력 후 히스토그램은 초기화되며, 누적 카운터(enq/deq/drop/expired)는 유지된다.
+ *
+ * @param if_idx    인터페이스 식별번호
+ */
+void V2X_OBU_ReportTxq(const uint8_t if_idx)
+{
+    struct V2X_OBU_TxqSet *set = &g_txqs[if_idx];
+    struct V2X_OBU_TxqStats stats[kTxAc_Num];
+
+    pthread_mutex_lock(&set->mtx);
+    for (int ac = 0; ac < kTxAc_Num; ac++) {
+        stats[ac] = set->txq[ac].stats;
+        memset(set->txq[ac].stats.hist, 0, sizeof(set->txq[ac].stats.hist));
+        set->txq[ac].stats.delay_cnt = 0;
+        set->txq[ac].stats.delay_sum = 0;
+        set->txq[ac].stats.delay_max = 0;
+    }
+    pthread_mutex_unlock(&set->mtx);
+
+    syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM] if%u tx queue delay(usec) <100 <500 <1m <2m <5m <10m <20m <50m <100m >=100m | avg max | enq deq drop expired\n", if_idx);
+    for (int ac = kTxAc_Num - 1; ac >= 0; ac--) {
+        uint32_t *h = stats[ac].hist;
+        syslog(LOG_INFO | LOG_LOCAL6, "[prcsWSM]   %s : %u %u %u %u %u %u %u %u %u %u | %llu %llu | %u %u %u %u\n",
+               g_txq_ac_name[ac], h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7], h[8], h[9],
+               stats[ac].delay_cnt ? (unsigned long long)(stats[ac].delay_sum / stats[ac].delay_cnt) : 0ULL,
+               (unsigned long long)stats[ac].delay_max,
+               stats[ac].enq_cnt, stats[ac].deq_cnt, stats[ac].drop_cnt, stats[ac].expire_cnt);
+    }
+}
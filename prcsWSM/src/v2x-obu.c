@@ -83,6 +83,10 @@ int V2X_OBU_Main(int argc, char *argv[])
     g_mib.timeSlot = kDot3TimeSlot_0;
     g_mib.dataRate = 12;
     g_mib.power = 20;
+    g_mib.txqDepth = TXQ_DEFAULT_DEPTH;
+    g_mib.txqSched = kTxqSched_Strict;
+    g_mib.reportInterval = STATS_DEFAULT_REPORT_INTERVAL;
+    g_mib.dupWindow = DUPF_DEFAULT_WINDOW;
     memset(g_mib.destMac, 0xff, kDot3MacAddrSize);
 
 	/* 사용자가 입력한 파라미터들을 MIB에 저장한다. */
@@ -90,6 +94,16 @@ int V2X_OBU_Main(int argc, char *argv[])
 	if(ret < 0)
 		return	-1;
 
+    /* 바이너리 로그 초기화 - 디버그 출력레벨이면 LOG_DEBUG까지 기록한다. (실패 시 V2XLOG는 syslog로 기록) */
+    v2xlog_Init("prcsWSM", NULL, (g_dbg >= kDbgMsgLevel_event) ? LOG_DEBUG : LOG_INFO);
+
+    /* 지연 추적 링 초기화 - 추적은 송신측 prcsJ2735(--trace)가 시작하며 트레일러로 전달된다. */
+    v2xtrace_Init("prcsWSM");
+
+    /* 공유메모리 통계 초기화 - 수신 콜백이 등록되기 전에 인터페이스 별 통계를 등록한다. (v2xtop으로 조회) */
+    v2xstat_Init("prcsWSM");
+    V2X_OBU_InitIfMetrics();
+
      /* 라이브러리 초기화 */
     ret = V2X_OBU_InitV2XLibs();
     if (ret < 0) {
@@ -115,10 +129,24 @@ int V2X_OBU_Main(int argc, char *argv[])
             g_if0_mac_address[3], g_if0_mac_address[4], g_if0_mac_address[5]);
 #endif
 
+    /* 인터페이스 초기화 - 추가 인터페이스(-I) 채널 접속 */
+    ret = V2X_OBU_InitIfs();
+    if (ret < 0) {
+        return -1;
+    }
+
+    /* 혼잡제어 초기화 */
+    if(V2X_OBU_InitCc() < 0)
+        return -1;
+
     /* MsgQ Open */
     if(initMQ() == -1)
         return -1;
 
+    /* 인터페이스 별 통계 출력 쓰레드 생성 */
+    if(V2X_OBU_InitStatsReport() < 0)
+        return -1;
+
     if(g_mib.op == opTX || g_mib.op == opTRX)
     {
         /* WSM 송신 타이머 생성- 시나리오: WSM을 정해진 주기로 전송된다.*/
@@ -149,6 +177,10 @@ int V2X_OBU_Main(int argc, char *argv[])
     /* MsgQ Close */
     releaseMQ();
 
+    /* 통계, 지연 추적 링, 바이너리 로그 닫기 */
+    v2xstat_Close();
+    v2xtrace_Close();
+    v2xlog_Close();
 
     return 0;
 }
@@ -16,6 +16,9 @@
 #include <msgQ.h>
 #include <syslog.h>
 #include "dot3/dot3.h"
+#include "v2xlog.h"
+#include "v2xtrace.h"
+#include "v2xstat.h"
 
 
 // 서비스 PSID
@@ -60,6 +63,118 @@ enum eDbgMsgLevel {
 };
 typedef uint32_t DbgMsgLevel; ///< @copydoc eDbgMsgLevel
 
+// 송신큐 기본 설정
+#define TXQ_DEFAULT_DEPTH (32) // AC 별 최대 저장 패킷 수
+#define TXQ_MAX_DEPTH (1024)
+#define STATS_DEFAULT_REPORT_INTERVAL (10) // 인터페이스/큐잉지연 통계 출력주기(sec)
+
+// 수신 중복프레임 필터 기본 윈도우 시간(msec) - 0(비활성화). 동일 내용을 재송신하는 정상 메시지(RTCM, SPaT 등)도
+// 폐기되므로 중계 RSU 또는 다중 인터페이스로 같은 WSM을 여러 번 수신하는 배치에서만 -d 옵션으로 켠다.
+#define DUPF_DEFAULT_WINDOW (0)
+
+// 혼잡제어 (SAE J2945/1 방식)
+#define CC_PSID_MAX (8) // 혼잡제어 대상 PSID 최대 개수
+#define CC_INTERVAL (100) // CBR 측정/제어 주기(msec)
+#define CC_DENSITY_WINDOW (1000) // 송신기 밀도 측정구간(msec)
+#define CC_CBR_MIN (50) // 최대 송신파워를 사용하는 CBR 상한(%)
+#define CC_CBR_MAX (80) // 최소 송신파워를 사용하는 CBR 하한(%)
+#define CC_DENSITY_COEF (25) // 송신주기 계산 밀도 계수 (밀도가 이 값 이하이면 최소주기로 송신)
+#define CC_DEFAULT_MIN_POWER (10) // 기본 최소 송신파워(dBm)
+#define CC_DEFAULT_MAX_POWER (20) // 기본 최대 송신파워(dBm)
+
+// 인터페이스 최대 개수 (SAF5100 플랫폼 기준: 디바이스 2개 x 라디오 2개)
+#define V2X_OBU_IF_MAX (4)
+
+// EDCA 액세스카테고리 (값이 클수록 우선순위가 높다)
+enum eTxAc {
+  kTxAc_BK, ///< Background
+  kTxAc_BE, ///< Best effort
+  kTxAc_VI, ///< Video
+  kTxAc_VO, ///< Voice
+  kTxAc_Num
+};
+typedef int TxAc; ///< @copydoc eTxAc
+
+// 송신큐 스케줄링 방식
+enum eTxqSched {
+  kTxqSched_Strict, ///< 높은 AC 큐가 빌 때까지 우선 송신
+  kTxqSched_Wrr, ///< AC 별 가중치에 따라 순환 송신
+};
+typedef uint8_t TxqSched; ///< @copydoc eTxqSched
+
+// 큐잉지연 히스토그램 구간 수
+#define kTxqHistBin_Num (10)
+
+// AC 별 송신큐 통계
+struct V2X_OBU_TxqStats
+{
+  uint32_t enq_cnt; ///< 누적 삽입 수
+  uint32_t deq_cnt; ///< 누적 송신 수
+  uint32_t drop_cnt; ///< 누적 폐기(drop-oldest) 수
+  uint32_t expire_cnt; ///< 누적 유효기간 만료 폐기 수
+  uint32_t hist[kTxqHistBin_Num]; ///< 출력주기 내 큐잉지연 히스토그램
+  uint32_t delay_cnt; ///< 출력주기 내 송신 수
+  uint64_t delay_sum; ///< 출력주기 내 큐잉지연 합(usec)
+  uint64_t delay_max; ///< 출력주기 내 최대 큐잉지연(usec)
+};
+
+// 인터페이스 별 송수신 통계
+struct V2X_OBU_IfStats
+{
+  uint32_t rx_cnt; ///< 수신 MPDU 수
+  uint32_t rx_parse_fail_cnt; ///< WSM 파싱 실패 수
+  uint32_t rx_fwd_cnt; ///< 상위 프로세스(prcsJ2735/PAR)로 전달한 수
+  uint32_t rx_ignore_cnt; ///< 관심 PSID가 아니어서 무시한 수
+  uint32_t rx_dup_cnt; ///< 중복프레임 필터에 의해 폐기된 수
+  int16_t rx_last_rxpower; ///< 마지막 수신 파워(dBm)
+  uint8_t rx_last_rcpi; ///< 마지막 수신 RCPI
+  uint32_t tx_cnt; ///< Al_TransmitMpdu() 성공 수
+  uint32_t tx_fail_cnt; ///< WSM 생성 또는 Al_TransmitMpdu() 실패 수
+  uint32_t tx_no_if_cnt; ///< 활성화되지 않은 인터페이스로 요청되어 폐기된 수
+};
+
+// 인터페이스 별 공유메모리 통계 (v2xtop으로 조회)
+struct V2X_OBU_IfMetrics
+{
+  const struct v2xstatDesc_t *rx; ///< 수신 MPDU 수
+  const struct v2xstatDesc_t *rx_parse_fail; ///< WSM 파싱 실패 수
+  const struct v2xstatDesc_t *rx_fwd; ///< 상위 프로세스(prcsJ2735/PAR)로 전달한 수
+  const struct v2xstatDesc_t *rx_ignore; ///< 관심 PSID가 아니어서 무시한 수
+  const struct v2xstatDesc_t *rx_dup; ///< 중복프레임 필터에 의해 폐기된 수
+  const struct v2xstatDesc_t *rx_power; ///< 수신 파워(dBm) 분포
+  const struct v2xstatDesc_t *tx; ///< Al_TransmitMpdu() 성공 수
+  const struct v2xstatDesc_t *tx_fail; ///< WSM 생성 또는 Al_TransmitMpdu() 실패 수
+  const struct v2xstatDesc_t *tx_cc_drop; ///< 혼잡제어 송신주기 제한에 의해 폐기된 수
+  const struct v2xstatDesc_t *txq_depth; ///< 송신큐(모든 AC)에 쌓인 패킷 수
+  const struct v2xstatDesc_t *txq_drop; ///< 송신큐가 가득 차 폐기(drop-oldest)된 수
+  const struct v2xstatDesc_t *txq_expire; ///< 송신큐에서 유효기간이 지나 폐기된 수
+  const struct v2xstatDesc_t *txq_delay; ///< 큐잉지연(usec) 분포
+};
+
+// 인터페이스 별 동작 정보
+struct V2X_OBU_If
+{
+  bool enabled; ///< 사용 여부
+  bool access; ///< prcsWSM이 직접 채널접속을 수행하는지 여부 (false이면 외부(chan config)에서 설정됨)
+  Dot3ChannelNumber ts0_chan; ///< TS0 채널번호 (송신 채널)
+  Dot3ChannelNumber ts1_chan; ///< TS1 채널번호
+  Dot3TimeSlot timeSlot; ///< 송신 TimeSlot
+  volatile bool chan_access_complete; ///< 채널접속 완료 여부
+  uint8_t mac_addr[kDot3MacAddrSize]; ///< 인터페이스 MAC 주소 (송신 WSM의 송신지 MAC 주소)
+  struct V2X_OBU_IfStats stats; ///< 송수신 통계
+  struct V2X_OBU_IfMetrics metrics; ///< 공유메모리 통계
+};
+
+// PSID 별 혼잡제어 설정
+struct V2X_OBU_CcConf
+{
+  Dot3Psid psid; ///< 혼잡제어 대상 PSID
+  uint32_t min_itt; ///< 최소 송신주기(msec)
+  uint32_t max_itt; ///< 최대 송신주기(msec)
+  Dot3Power min_power; ///< 최소 송신파워(dBm)
+  Dot3Power max_power; ///< 최대 송신파워(dBm)
+};
+
 typedef enum
 {
     opRX,
@@ -83,8 +198,24 @@ struct V2X_OBU_MIB
   Dot3DataRate      dataRate;
   Dot3Power         power;
   Dot3Psid          psid;
-  int16_t rxpower;
-  uint8_t rcpi;
+
+  /* 송신큐 변수 */
+  uint32_t txqDepth; ///< AC 별 큐 깊이
+  TxqSched txqSched; ///< 스케줄링 방식
+  uint32_t txLifetime; ///< 기본 송신 유효기간(msec), 0이면 만료되지 않음
+
+  /* 혼잡제어 변수 */
+  struct V2X_OBU_CcConf cc[CC_PSID_MAX]; ///< PSID 별 혼잡제어 설정
+  uint8_t cc_num; ///< 혼잡제어 대상 PSID 개수, 0이면 혼잡제어를 수행하지 않음
+
+  /* 수신 변수 */
+  uint32_t dupWindow; ///< 중복프레임 필터 윈도우 시간(msec), 0이면 필터링하지 않음
+
+  /* 통계 변수 */
+  uint32_t reportInterval; ///< 인터페이스/큐잉지연 통계 출력주기(sec), 0이면 출력하지 않음
+
+  /* 추적 변수 */
+  bool traceTrailer; ///< 종단간 지연 추적정보를 WSM 페이로드 트레일러로 송수신(시험용, 무선으로 송신됨), 기본 false
 
 };
 
@@ -94,6 +225,7 @@ struct V2X_OBU_MIB
  */
 extern struct V2X_OBU_MIB g_mib;
 extern DbgMsgLevel g_dbg;
+extern struct V2X_OBU_If g_if[V2X_OBU_IF_MAX];
 extern const uint8_t g_if0_mac_address[];
 extern const uint8_t g_if1_mac_address[];
 
@@ -111,10 +243,35 @@ int V2X_OBU_GetCurrentChannel(uint8_t *const ts0_chan, uint8_t *const ts1_chan);
 int V2X_OBU_SetIfMacAddress(const uint8_t if_idx, const uint8_t *addr);
 void V2X_OBU_WaitEventPolling(void);
 
+/*
+ * v2x-obu-if.c
+ */
+int V2X_OBU_AddIf(const uint8_t if_idx, const Dot3ChannelNumber ts0_chan, const Dot3ChannelNumber ts1_chan, const bool access);
+int V2X_OBU_InitIfs(void);
+void V2X_OBU_InitIfMetrics(void);
+const char *V2X_OBU_IfMetricName(char *buf, const int if_idx, const char *name);
+int V2X_OBU_InitStatsReport(void);
+
+/*
+ * v2x-obu-cc.c
+ */
+void V2X_OBU_CcControlLaw(const struct V2X_OBU_CcConf *conf, const double cbr, const double density,
+                          uint32_t *itt, Dot3Power *power);
+void V2X_OBU_CcNotifyRx(const uint8_t if_idx, const uint8_t *src_mac, const uint16_t mpdu_size, const uint8_t datarate);
+bool V2X_OBU_CcAdmitTx(const uint8_t if_idx, const Dot3Psid psid, Dot3Power *power);
+void V2X_OBU_ReportCc(const uint8_t if_idx);
+int V2X_OBU_InitCc(void);
+
+/*
+ * v2x-obu-dupf.c
+ */
+bool V2X_OBU_CheckDupRx(const uint8_t *src_mac, const Dot3Psid psid, const uint8_t *payload, const int len);
+
 /*
  * v2s-obu-rx.c
  */
-void V2X_OBU_ProcessRxMpdu(const uint8_t *const mpdu, const uint16_t mpdu_size);
+void V2X_OBU_ProcessRxMpdu(const uint8_t if_idx, const uint8_t chan, const uint8_t *const mpdu, const uint16_t mpdu_size,
+                           const int16_t rxpower, const uint8_t rcpi, const uint8_t datarate, const uint64_t rx_time);
 //int rtcmCheckTimer(const uint32_t interval);
 
 /*
@@ -127,6 +284,19 @@ int V2X_OBU_InitWsaTx(const uint32_t timer_interval);
  */
 int V2X_OBU_InitWsmTx(const uint32_t timer_interval);
 
+/*
+ * v2x-obu-txq.c
+ */
+TxAc V2X_OBU_PriorityToAc(const uint8_t priority);
+int V2X_OBU_InitTxq(const uint8_t if_idx);
+void V2X_OBU_ReleaseTxq(const uint8_t if_idx);
+int V2X_OBU_EnqueueTxq(const uint8_t if_idx, const uint8_t *pkt, const uint32_t len, const uint8_t priority, const uint32_t lifetime,
+                       const Dot3Psid psid, const struct v2xtraceCtx_t *trace);
+int V2X_OBU_DequeueTxq(const uint8_t if_idx, uint8_t *pkt, uint8_t *priority, Dot3Psid *psid, uint64_t *remain,
+                       struct v2xtraceCtx_t *trace, const uint32_t timeout_ms);
+void V2X_OBU_GetTxqStats(const uint8_t if_idx, const TxAc ac, struct V2X_OBU_TxqStats *stats);
+void V2X_OBU_ReportTxq(const uint8_t if_idx);
+
 /* options.c */
 int32_t ParsingOptions(int32_t argc, char *argv[]);
 
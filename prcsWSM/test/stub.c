@@ -0,0 +1,26 @@
+/**
+ * @file stub.c
+ * @date 2026-10-19
+ * @brief prcsWSM 호스트 테스트용 전역변수/함수 대체 구현
+ *
+ *  - v2x-obu.c(main), v2x-obu-if.c에 정의된 전역변수와 테스트에서 사용하는 함수를 대신한다.
+ */
+
+#include "v2x-obu.h"
+
+struct V2X_OBU_MIB g_mib; ///< 어플리케이션 관리정보
+DbgMsgLevel g_dbg = kDbgMsgLevel_nothing; ///< 디버그메시지 출력레벨
+const uint8_t g_if0_mac_address[] = { 0x00, 0x49, 0x54, 0x45, 0xCC, 0x00};
+const uint8_t g_if1_mac_address[] = { 0x00, 0x49, 0x54, 0x45, 0xCC, 0x01};
+
+struct V2X_OBU_If g_if[V2X_OBU_IF_MAX]; ///< 인터페이스 별 동작 정보
+
+
+/**
+ * 인터페이스 별 통계 이름을 만든다. (v2x-obu-if.c와 동일)
+ */
+const char *V2X_OBU_IfMetricName(char *buf, const int if_idx, const char *name)
+{
+    snprintf(buf, V2XSTAT_METRIC_NAME_MAX, "if%d.%s", if_idx, name);
+    return buf;
+}
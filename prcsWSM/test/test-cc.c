@@ -0,0 +1,175 @@
+/**
+ * @file test-cc.c
+ * @date 2026-10-19
+ * @brief CBR 기반 혼잡제어 시뮬레이션 테스트
+ *
+ *  - 가상 채널에서 수십 개의 가상 송신기가 주기적으로 송신하는 것처럼 수신 정보를 혼잡제어에 전달하고,
+ *    채널이 한산할 때와 혼잡할 때 혼잡제어 대상 PSID의 송신주기/송신파워가 설정 범위 안에서 조절되는지 확인한다.
+ *  - TEST_CC_AL_STATISTICS가 정의되지 않으면 액세스계층 통계 API가 없는 라이브러리(배포된 aarch64)와 같이
+ *    수신 점유시간으로 CBR을 추정한다. 정의되면 이 파일의 Al_GetRxStatistics()가 가상 채널의 CBR 측정값을 제공한다.
+ *  - 가상 송신기는 내 송신 데이터레이트(24Mbps)와 다른 6Mbps로 송신한다. 점유시간 추정은 수신 데이터레이트를
+ *    사용해야 혼잡한 채널을 알 수 있다. (내 데이터레이트로 계산하면 CBR이 1/4로 추정된다)
+ *  - PAR 프로브 PSID와 혼잡제어 대상이 아닌 PSID는 항상 송신이 허용되어야 한다.
+ */
+
+#include <time.h>
+
+#include "wlanaccess/wlanaccess.h"
+
+#include "v2x-obu.h"
+#include "test.h"
+
+#define TEST_IF (0)
+#define TEST_PSID (32) // 혼잡제어 대상 PSID
+#define TEST_OTHER_PSID (33) // 혼잡제어 대상이 아닌 PSID
+#define TEST_MIN_ITT (100)
+#define TEST_MAX_ITT (1000)
+#define TEST_MIN_POWER (10)
+#define TEST_MAX_POWER (20)
+#define TEST_QUIET_NODES (3) // 한산한 채널의 가상 송신기 수
+#define TEST_BUSY_NODES (60) // 혼잡한 채널의 가상 송신기 수
+#define TEST_NODE_RATE (10) // 가상 송신기 송신주기(Hz)
+#define TEST_NODE_DATARATE (kDot3DataRate_6Mbps) // 가상 송신기 송신 데이터레이트
+#define TEST_QUIET_FRAME (300) // 한산한 채널의 MPDU 크기
+#ifdef TEST_CC_AL_STATISTICS
+#define TEST_BUSY_FRAME (300) // 점유시간 추정으로는 혼잡하지 않은 크기 - 액세스계층 측정값으로만 혼잡을 알 수 있다.
+#else
+#define TEST_BUSY_FRAME (2000) // 점유시간 추정(6Mbps)으로 CBR이 100%가 되는 크기 (24Mbps로 계산하면 약 43%)
+#endif
+
+/**
+ * 가상 채널
+ */
+struct TestChannel
+{
+    volatile uint32_t nodes; ///< 가상 송신기 수
+    volatile uint16_t frame; ///< 가상 송신기 MPDU 크기
+    volatile uint8_t cbr; ///< 액세스계층 CBR 측정값 (255 = 100%)
+    volatile bool stop;
+};
+
+static struct TestChannel g_ch;
+
+
+#ifdef TEST_CC_AL_STATISTICS
+/**
+ * 액세스계층 수신통계 - 가상 채널의 CBR 측정값을 반환한다.
+ */
+int Al_GetRxStatistics(const AlIfIndex ifindex, const AlTimeSlot timeslot, struct AlRxStatstics *const stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->channel_busy_ratio = g_ch.cbr;
+    stats->cbr_valid = true;
+    return 0;
+}
+
+int Al_ClearRxStatistics(const AlIfIndex ifindex)
+{
+    return 0;
+}
+
+int Al_ClearTxStatistics(const AlIfIndex ifindex)
+{
+    return 0;
+}
+#endif
+
+
+/**
+ * 가상 채널 쓰레드 - 가상 송신기마다 TEST_NODE_RATE 주기로 수신 정보를 혼잡제어에 전달한다.
+ *  - 송신 시점이 CBR 측정주기와 겹치지 않도록 송신기들을 10개 구간에 나누어 송신한다.
+ */
+static void* TestChannelThread(void *notused)
+{
+    uint8_t mac[kDot3MacAddrSize] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    uint32_t slot = 0;
+
+    while (!g_ch.stop) {
+        for (uint32_t i = slot; i < g_ch.nodes; i += 10) {
+            mac[4] = (uint8_t)(i >> 8);
+            mac[5] = (uint8_t)i;
+            V2X_OBU_CcNotifyRx(TEST_IF, mac, g_ch.frame, TEST_NODE_DATARATE);
+        }
+        slot = (slot + 1) % 10;
+        usleep(1000000 / TEST_NODE_RATE / 10);
+    }
+    return NULL;
+}
+
+
+/**
+ * 송신쓰레드처럼 5msec 마다 송신을 요청하여 1초 동안 허용된 수와 마지막 송신파워를 구한다.
+ *
+ * @param psid      송신 PSID
+ * @param power     마지막으로 허용된 송신의 송신파워가 반환된다.
+ * @return          허용된 수
+ */
+static int TestAdmitCount(const Dot3Psid psid, Dot3Power *power)
+{
+    int admitted = 0;
+
+    for (int i = 0; i < 200; i++) {
+        Dot3Power p = g_mib.power;
+        if (V2X_OBU_CcAdmitTx(TEST_IF, psid, &p)) {
+            admitted++;
+            *power = p;
+        }
+        usleep(5000);
+    }
+    return admitted;
+}
+
+
+int main(void)
+{
+    pthread_t thread;
+    Dot3Power power = 0;
+    int admitted;
+
+    g_mib.dataRate = kDot3DataRate_24Mbps;
+    g_mib.power = IF0_POWER;
+    g_mib.cc_num = 1;
+    g_mib.cc[0].psid = TEST_PSID;
+    g_mib.cc[0].min_itt = TEST_MIN_ITT;
+    g_mib.cc[0].max_itt = TEST_MAX_ITT;
+    g_mib.cc[0].min_power = TEST_MIN_POWER;
+    g_mib.cc[0].max_power = TEST_MAX_POWER;
+    g_if[TEST_IF].enabled = true;
+
+    g_ch.nodes = TEST_QUIET_NODES;
+    g_ch.frame = TEST_QUIET_FRAME;
+    g_ch.cbr = 255 * 10 / 100;
+    TEST_CHECK(V2X_OBU_InitCc() == 0);
+    pthread_create(&thread, NULL, TestChannelThread, NULL);
+
+    /* 한산한 채널 - 최소 송신주기, 최대 송신파워 */
+    sleep(2);
+    admitted = TestAdmitCount(TEST_PSID, &power);
+    printf("quiet channel - %d tx/sec, power %d dBm\n", admitted, power);
+    TEST_CHECK((admitted >= 8) && (admitted <= 12));
+    TEST_CHECK(power == TEST_MAX_POWER);
+
+    /* 혼잡한 채널 - 송신기 밀도에 따라 송신주기가 늘어나고, CBR이 높아 최소 송신파워 */
+    g_ch.nodes = TEST_BUSY_NODES;
+    g_ch.frame = TEST_BUSY_FRAME;
+    g_ch.cbr = 255 * 90 / 100;
+    sleep(3);
+    admitted = TestAdmitCount(TEST_PSID, &power);
+    printf("busy channel - %d tx/sec, power %d dBm\n", admitted, power);
+    TEST_CHECK((admitted >= 1000 / TEST_MAX_ITT) && (admitted <= 6));
+    TEST_CHECK(power == TEST_MIN_POWER);
+
+    /* PAR 프로브와 혼잡제어 대상이 아닌 PSID는 제한되지 않고 송신파워도 바뀌지 않는다. */
+    for (int i = 0; i < 100; i++) {
+        power = g_mib.power;
+        TEST_CHECK(V2X_OBU_CcAdmitTx(TEST_IF, MSGQ_PSID_PAR, &power));
+        TEST_CHECK(power == g_mib.power);
+        TEST_CHECK(V2X_OBU_CcAdmitTx(TEST_IF, TEST_OTHER_PSID, &power));
+        TEST_CHECK(power == g_mib.power);
+    }
+
+    g_ch.stop = true;
+    pthread_join(thread, NULL);
+    V2X_OBU_ReportCc(TEST_IF);
+    return TEST_RESULT();
+}
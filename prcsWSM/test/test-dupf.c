@@ -0,0 +1,144 @@
+/**
+ * @file test-dupf.c
+ * @date 2026-10-19
+ * @brief 수신 중복프레임 필터 테스트
+ *
+ *  - 실제 수신 처리(V2X_OBU_ProcessRxMpdu())에 dot3 파싱 대체 구현으로 WSM을 넣는다. (MPDU = 페이로드)
+ *  - 기본 설정(필터 비활성화)에서는 같은 WSM이 모두 전달되어야 한다.
+ *  - 윈도우 시간 이내의 중복은 폐기되고 폐기 수(rx_dup_cnt)가 증가해야 하며,
+ *    세대가 두 번 전환된 후에는 다시 전달되어야 한다.
+ *  - 송신지 MAC 주소/PSID/페이로드 중 하나라도 다르면 중복이 아니며, PAR 프로브는 필터를 적용하지 않는다.
+ */
+
+#include <unistd.h>
+
+#include "v2x-obu.h"
+#include "test.h"
+
+#define TEST_IF (0)
+#define TEST_CHAN (172)
+#define TEST_PSID (32)
+#define TEST_OTHER_PSID (33)
+#define TEST_WINDOW (200) // 필터 윈도우 시간(msec)
+
+static uint8_t g_test_src_mac[kDot3MacAddrSize] = { 0x00, 0x49, 0x54, 0x45, 0xAA, 0x00 }; ///< 수신 WSM의 송신지 MAC 주소
+static Dot3Psid g_test_psid; ///< 수신 WSM의 PSID
+static uint32_t g_test_mq_cnt; ///< prcsJ2735 메시지큐로 전달된 수
+static uint32_t g_test_par_mq_cnt; ///< PAR 메시지큐로 전달된 수
+
+
+/**
+ * dot3 WSM MPDU 파싱 대체 구현 - MPDU 전체를 페이로드로 돌려주고 송신지 MAC 주소/PSID는 테스트 설정값을 쓴다.
+ */
+int Dot3_ParseWsmMpdu(const uint8_t *const mpdu, const Dot3PduSize mpdu_size, uint8_t *const outbuf,
+                      const Dot3PduSize outbuf_size, struct Dot3WsmMpduRxParams *const params, bool *const wsr_registered)
+{
+    if (mpdu_size > outbuf_size) {
+        return -1;
+    }
+    memset(params, 0, sizeof(*params));
+    memcpy(params->src_mac_addr, g_test_src_mac, kDot3MacAddrSize);
+    params->psid = g_test_psid;
+    *wsr_registered = true;
+    memcpy(outbuf, mpdu, mpdu_size);
+    return mpdu_size;
+}
+
+
+/**
+ * dot3 WSA 파싱 대체 구현 - 테스트는 WSA를 보내지 않는다.
+ */
+int Dot3_ParseWsa(const uint8_t *const encoded_wsa, const Dot3PduSize encoded_wsa_size, struct Dot3ParseWsaParams *const params)
+{
+    return -1;
+}
+
+
+/**
+ * 메시지큐 대체 구현 - 전달된 수를 센다.
+ */
+void sendMQ(uint8_t *pPkt, uint32_t len, const struct v2xtraceCtx_t *trace)
+{
+    g_test_mq_cnt++;
+}
+
+void PARsendMQ(uint8_t *pPkt, uint32_t len)
+{
+    g_test_par_mq_cnt++;
+}
+
+
+/**
+ * 송신지 MAC 주소 마지막 바이트, PSID, 페이로드를 지정하여 WSM 하나를 수신 처리한다.
+ */
+static void TestRx(const uint8_t mac_last, const Dot3Psid psid, const char *payload)
+{
+    g_test_src_mac[kDot3MacAddrSize - 1] = mac_last;
+    g_test_psid = psid;
+    V2X_OBU_ProcessRxMpdu(TEST_IF, TEST_CHAN, (const uint8_t *)payload, (uint16_t)strlen(payload), -60, 100, kDot3DataRate_6Mbps, 0);
+}
+
+
+int main(void)
+{
+    struct V2X_OBU_IfStats *stats = &g_if[TEST_IF].stats;
+    struct V2X_OBU_IfMetrics *m = &g_if[TEST_IF].metrics;
+    char name[V2XSTAT_METRIC_NAME_MAX];
+    uint32_t mq, dup;
+
+    m->rx_parse_fail = v2xstat_Counter(V2X_OBU_IfMetricName(name, TEST_IF, "rx_parse_fail"), "pkt");
+    m->rx_fwd = v2xstat_Counter(V2X_OBU_IfMetricName(name, TEST_IF, "rx_fwd"), "pkt");
+    m->rx_ignore = v2xstat_Counter(V2X_OBU_IfMetricName(name, TEST_IF, "rx_ignore"), "pkt");
+    m->rx_dup = v2xstat_Counter(V2X_OBU_IfMetricName(name, TEST_IF, "rx_dup"), "pkt");
+    g_mib.psid = TEST_PSID;
+
+    /* 기본 설정 - 필터 비활성화, 같은 WSM도 모두 전달된다. (동일 내용을 재송신하는 RTCM/SPaT) */
+    g_mib.dupWindow = DUPF_DEFAULT_WINDOW;
+    TestRx(1, TEST_PSID, "rtcm-A");
+    TestRx(1, TEST_PSID, "rtcm-A");
+    TEST_CHECK(g_test_mq_cnt == 2);
+    TEST_CHECK(stats->rx_dup_cnt == 0);
+
+    /* 윈도우 이내의 중복은 폐기되고 폐기 수가 증가한다. */
+    g_mib.dupWindow = TEST_WINDOW;
+    TestRx(1, TEST_PSID, "rtcm-A");
+    TestRx(1, TEST_PSID, "rtcm-A");
+    TEST_CHECK(g_test_mq_cnt == 3);
+    TEST_CHECK(stats->rx_dup_cnt == 1);
+
+    /* 송신지 MAC 주소, 페이로드, PSID가 다르면 중복이 아니다. (다른 PSID는 관심 PSID가 아니어서 무시된다) */
+    mq = g_test_mq_cnt;
+    TestRx(2, TEST_PSID, "rtcm-A");
+    TestRx(1, TEST_PSID, "rtcm-B");
+    TestRx(1, TEST_OTHER_PSID, "rtcm-A");
+    TEST_CHECK(g_test_mq_cnt == mq + 2);
+    TEST_CHECK(stats->rx_ignore_cnt == 1);
+    TEST_CHECK(stats->rx_dup_cnt == 1);
+
+    /* PAR 프로브는 필터를 적용하지 않는다. */
+    TestRx(1, MSGQ_PSID_PAR, "probe");
+    TestRx(1, MSGQ_PSID_PAR, "probe");
+    TEST_CHECK(g_test_par_mq_cnt == 2);
+    TEST_CHECK(stats->rx_dup_cnt == 1);
+
+    /* 세대 전환 한 번 - 이전 세대에 남아 있으므로 여전히 중복이다. */
+    mq = g_test_mq_cnt;
+    dup = stats->rx_dup_cnt;
+    usleep(TEST_WINDOW * 1000 * 5 / 4);
+    TestRx(1, TEST_PSID, "rtcm-A");
+    TEST_CHECK(g_test_mq_cnt == mq);
+    TEST_CHECK(stats->rx_dup_cnt == dup + 1);
+
+    /* 세대 전환 두 번 - 이전 세대까지 비워졌으므로 다시 전달된다. */
+    usleep(TEST_WINDOW * 1000 * 5 / 4);
+    TestRx(1, TEST_PSID, "rtcm-A");
+    TEST_CHECK(g_test_mq_cnt == mq + 1);
+    TEST_CHECK(stats->rx_dup_cnt == dup + 1);
+
+    /* 다시 등록되었으므로 바로 이어진 같은 WSM은 중복이다. */
+    TestRx(1, TEST_PSID, "rtcm-A");
+    TEST_CHECK(stats->rx_dup_cnt == dup + 2);
+
+    printf("fwd %u, dup %u, ignore %u, par %u\n", stats->rx_fwd_cnt, stats->rx_dup_cnt, stats->rx_ignore_cnt, g_test_par_mq_cnt);
+    return TEST_RESULT();
+}
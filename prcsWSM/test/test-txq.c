@@ -0,0 +1,192 @@
+/**
+ * @file test-txq.c
+ * @date 2026-10-19
+ * @brief 송신큐 유효기간 만료 폐기 테스트
+ *
+ *  - 가상 송신 백엔드(고정 송신속도의 채널)에 처리능력보다 많은 패킷을 넣어 송신큐가 밀리도록 한다.
+ *  - 유효기간이 있으면 만료된 패킷은 송신되지 않고 폐기(expire_cnt)되어야 하며,
+ *    유효기간이 없으면 같은 부하에서 오래된 패킷이 그대로 송신됨을 대조군으로 확인한다.
+ *  - 배포된 libwlanaccess(aarch64)는 MKx Expiry를 설정하지 않으므로 송신큐 폐기가 유일한 만료 처리이다.
+ */
+
+#include <time.h>
+
+#include "v2x-obu.h"
+#include "test.h"
+
+#define TEST_IF (0)
+#define TEST_PSID (32)
+#define TEST_OFFERED_INTERVAL (1000) // 입력 패킷 간격(usec) - 1kHz
+#define TEST_SERVICE_TIME (4000) // 가상 채널 패킷 당 송신시간(usec) - 250Hz
+#define TEST_DURATION (500000) // 입력 시간(usec)
+#define TEST_LIFETIME (20) // 유효기간(msec)
+
+/**
+ * 가상 채널 결과
+ */
+struct TestChannel
+{
+    volatile bool stop; ///< 입력 종료 여부
+    uint32_t tx_cnt; ///< 송신된 패킷 수
+    uint64_t max_age; ///< 송신된 패킷의 최대 대기시간(usec)
+    bool remain_ok; ///< 남은 유효기간이 항상 (0, 유효기간] 범위였는지 여부
+};
+
+
+/**
+ * CLOCK_MONOTONIC 현재시각(usec)
+ */
+static uint64_t TestNowUsec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+/**
+ * 가상 채널 쓰레드 - 송신큐에서 패킷을 꺼내 고정 송신시간 동안 채널을 점유한다.
+ *  - 페이로드에는 큐 삽입 시각이 들어 있다.
+ */
+static void* TestChannelThread(void *arg)
+{
+    struct TestChannel *ch = (struct TestChannel *)arg;
+    uint8_t pkt[kMpduMaxSize];
+    uint8_t priority;
+    Dot3Psid psid;
+    uint64_t remain, enq, age;
+    struct v2xtraceCtx_t trace;
+    int len;
+
+    while (1) {
+        len = V2X_OBU_DequeueTxq(TEST_IF, pkt, &priority, &psid, &remain, &trace, 50);
+        if (len == 0) {
+            if (ch->stop) {
+                break;
+            }
+            continue;
+        }
+        memcpy(&enq, pkt, sizeof(enq));
+        age = TestNowUsec() - enq;
+        if (age > ch->max_age) {
+            ch->max_age = age;
+        }
+        if (g_mib.txLifetime && ((remain == 0) || (remain > (uint64_t)g_mib.txLifetime * 1000))) {
+            ch->remain_ok = false;
+        }
+        ch->tx_cnt++;
+        usleep(TEST_SERVICE_TIME);
+    }
+    return NULL;
+}
+
+
+/**
+ * 처리능력을 넘는 부하를 가상 채널에 입력한다.
+ *
+ * @param lifetime  패킷 유효기간(msec), 0이면 만료되지 않음
+ * @param ch        가상 채널 결과가 반환된다.
+ * @param stats     송신큐 통계가 반환된다.
+ */
+static void TestOverload(const uint32_t lifetime, struct TestChannel *ch, struct V2X_OBU_TxqStats *stats)
+{
+    struct v2xtraceCtx_t trace;
+    pthread_t thread;
+    uint8_t pkt[100];
+    uint64_t start, next, now;
+
+    memset(ch, 0, sizeof(*ch));
+    memset(&trace, 0, sizeof(trace));
+    memset(pkt, 0, sizeof(pkt));
+    ch->remain_ok = true;
+    g_mib.txLifetime = lifetime;
+    TEST_CHECK(V2X_OBU_InitTxq(TEST_IF) == 0);
+    pthread_create(&thread, NULL, TestChannelThread, ch);
+
+    start = next = TestNowUsec();
+    while ((now = TestNowUsec()) - start < TEST_DURATION) {
+        if (now < next) {
+            usleep(next - now);
+            continue;
+        }
+        memcpy(pkt, &now, sizeof(now));
+        V2X_OBU_EnqueueTxq(TEST_IF, pkt, sizeof(pkt), 0, lifetime, TEST_PSID, &trace);
+        next += TEST_OFFERED_INTERVAL;
+    }
+    ch->stop = true;
+    pthread_join(thread, NULL);
+
+    V2X_OBU_GetTxqStats(TEST_IF, kTxAc_BE, stats);
+    V2X_OBU_ReleaseTxq(TEST_IF);
+    printf("lifetime %ums - enq %u tx %u drop %u expired %u, max queueing %llu usec\n",
+                  lifetime, stats->enq_cnt, ch->tx_cnt, stats->drop_cnt, stats->expire_cnt, (unsigned long long)ch->max_age);
+}
+
+
+/**
+ * 단일 패킷의 만료/남은 유효기간을 확인한다.
+ */
+static void TestSingle(void)
+{
+    struct v2xtraceCtx_t trace;
+    struct V2X_OBU_TxqStats stats;
+    uint8_t pkt[kMpduMaxSize] = { 0 };
+    uint8_t priority;
+    Dot3Psid psid;
+    uint64_t remain;
+
+    memset(&trace, 0, sizeof(trace));
+    TEST_CHECK(V2X_OBU_InitTxq(TEST_IF) == 0);
+
+    /* 유효기간이 지난 패킷은 꺼내지 않는다. */
+    TEST_CHECK(V2X_OBU_EnqueueTxq(TEST_IF, pkt, 10, 0, 10, TEST_PSID, &trace) == 0);
+    usleep(30000);
+    TEST_CHECK(V2X_OBU_DequeueTxq(TEST_IF, pkt, &priority, &psid, &remain, &trace, 10) == 0);
+    V2X_OBU_GetTxqStats(TEST_IF, kTxAc_BE, &stats);
+    TEST_CHECK(stats.expire_cnt == 1);
+    TEST_CHECK(stats.deq_cnt == 0);
+
+    /* 유효기간이 없으면 만료되지 않고 남은 유효기간은 0이다. */
+    TEST_CHECK(V2X_OBU_EnqueueTxq(TEST_IF, pkt, 10, 0, 0, TEST_PSID, &trace) == 0);
+    usleep(30000);
+    TEST_CHECK(V2X_OBU_DequeueTxq(TEST_IF, pkt, &priority, &psid, &remain, &trace, 10) == 10);
+    TEST_CHECK(remain == 0);
+    TEST_CHECK(psid == TEST_PSID);
+
+    /* 남은 유효기간은 큐잉지연만큼 줄어든다. */
+    TEST_CHECK(V2X_OBU_EnqueueTxq(TEST_IF, pkt, 10, 0, 100, TEST_PSID, &trace) == 0);
+    usleep(10000);
+    TEST_CHECK(V2X_OBU_DequeueTxq(TEST_IF, pkt, &priority, &psid, &remain, &trace, 10) == 10);
+    TEST_CHECK((remain > 0) && (remain <= 90000));
+
+    V2X_OBU_ReleaseTxq(TEST_IF);
+}
+
+
+int main(void)
+{
+    struct TestChannel ch;
+    struct V2X_OBU_TxqStats stats;
+
+    g_mib.txqDepth = TXQ_MAX_DEPTH;
+    g_mib.txqSched = kTxqSched_Strict;
+    g_if[TEST_IF].enabled = true;
+
+    TestSingle();
+
+    /* 대조군 - 유효기간이 없으면 밀린 패킷이 오래 대기한 뒤 송신된다. */
+    TestOverload(0, &ch, &stats);
+    TEST_CHECK(stats.expire_cnt == 0);
+    TEST_CHECK(ch.max_age > TEST_LIFETIME * 1000 * 10);
+
+    /* 유효기간이 있으면 만료된 패킷은 폐기되고 송신된 패킷은 모두 유효기간 내에 꺼내졌다. */
+    TestOverload(TEST_LIFETIME, &ch, &stats);
+    TEST_CHECK(stats.expire_cnt > stats.enq_cnt / 2);
+    TEST_CHECK(stats.drop_cnt == 0);
+    TEST_CHECK(stats.deq_cnt == ch.tx_cnt);
+    TEST_CHECK(stats.deq_cnt + stats.expire_cnt == stats.enq_cnt);
+    TEST_CHECK(ch.remain_ok);
+    TEST_CHECK(ch.max_age < (TEST_LIFETIME + 5) * 1000);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,28 @@
+/**
+ * @file test.h
+ * @date 2026-10-19
+ * @brief prcsWSM 호스트 테스트 공통 매크로
+ *
+ *  - 테스트는 호스트(gcc)에서 빌드하여 ctest로 실행한다. 액세스계층/dot3 라이브러리는 링크하지 않는다.
+ *  - TEST_CHECK()가 실패하면 위치를 출력하고 계속 진행하며, TEST_RESULT()가 종료코드를 반환한다.
+ */
+
+#ifndef V2X_OBU_TEST_H
+#define V2X_OBU_TEST_H
+
+#include <stdio.h>
+
+static int g_test_fail; ///< 실패한 검사 수
+
+#define TEST_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_test_fail++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() \
+    ((g_test_fail == 0) ? (printf("PASS\n"), 0) : (printf("FAIL (%d)\n", g_test_fail), 1))
+
+#endif //V2X_OBU_TEST_H
@@ -0,0 +1,375 @@
+/**********************************************************
+  [v2xlogdec]
+  V2XLOG() 바이너리 로그(v2xlog.h) 변환/제어 도구
+
+  - 로그 파일의 포맷 정의와 메시지 레코드를 합쳐 텍스트로 출력한다.
+  - 실행 중인 데몬의 기록 레벨을 바꾸거나 상태(기록/버림/syslog 대체 수)를 본다.
+
+  사용 예
+    v2xlogdec /tmp/prcsWSM.v2xlog.1 /tmp/prcsWSM.v2xlog
+    v2xlogdec -f /tmp/PAR.v2xlog
+    v2xlogdec -n prcsWSM -l debug
+    v2xlogdec -n prcsWSM -s
+ ************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <getopt.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/shm.h>
+#include "v2xlog.h"
+
+#define FOLLOW_WAIT_USEC 200000 //-f 모드 파일 끝 대기 시간
+
+/* 포맷 정의 */
+struct fmtEnt_t{
+	char *file;
+	char *fmt;
+	uint16_t line;
+	uint8_t pri;
+	uint8_t nargs;
+	uint8_t types[V2XLOG_MAX_ARGS];
+};
+
+static const char *g_levelName[] = { "emerg", "alert", "crit", "err", "warning", "notice", "info", "debug" };
+static struct fmtEnt_t *g_fmt;
+static uint32_t g_fmtNum;
+static uint64_t g_unknown;
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-f] <file>...\n", prog);
+	fprintf(stderr, "       %s -n <name> -s\n", prog);
+	fprintf(stderr, "       %s -n <name> -l <level>\n", prog);
+	fprintf(stderr, "  -f, --follow          keep reading the file as it grows (single file, follows rotation)\n");
+	fprintf(stderr, "  -n, --name <name>     daemon name given to v2xlog_Init() (prcsWSM, prcsJ2735, PAR, infor_broker)\n");
+	fprintf(stderr, "  -s, --status          print level and counters of the running daemon\n");
+	fprintf(stderr, "  -l, --level <level>   set record level of the running daemon (0~7 or emerg..debug)\n");
+}
+
+static int parseLevel(const char *s)
+{
+	char *end;
+	long v;
+
+	for(int i = 0; i < 8; i++)
+		if(strcasecmp(s, g_levelName[i]) == 0)
+			return i;
+	v = strtol(s, &end, 10);
+	if(*end != '\0' || v < LOG_EMERG || v > LOG_DEBUG)
+		return -1;
+	return (int)v;
+}
+
+/****************************************************************************************
+  제어 공유메모리
+ ****************************************************************************************/
+static struct v2xlogCtl_t *attachCtl(const char *name, bool rdonly)
+{
+	struct v2xlogCtl_t *ctl;
+	int shmid;
+
+	shmid = shmget(v2xlog_Key(name), sizeof(struct v2xlogCtl_t), 0);
+	if(shmid < 0){
+		fprintf(stderr, "v2xlogdec: %s is not running with v2xlog (%s)\n", name, strerror(errno));
+		return NULL;
+	}
+	ctl = (struct v2xlogCtl_t*)shmat(shmid, NULL, rdonly ? SHM_RDONLY : 0);
+	if(ctl == (void*)-1){
+		fprintf(stderr, "v2xlogdec: shmat() fail : %s\n", strerror(errno));
+		return NULL;
+	}
+	if(ctl->magic != V2XLOG_MAGIC){
+		fprintf(stderr, "v2xlogdec: invalid control shm for %s\n", name);
+		shmdt(ctl);
+		return NULL;
+	}
+	return ctl;
+}
+
+static int status(const char *name)
+{
+	struct v2xlogCtl_t *ctl = attachCtl(name, true);
+	int level;
+
+	if(ctl == NULL)
+		return -1;
+	level = __atomic_load_n(&ctl->level, __ATOMIC_RELAXED);
+	printf("name      : %s\n", ctl->name);
+	printf("pid       : %d\n", ctl->pid);
+	printf("level     : %d (%s)\n", level, (level >= 0 && level < 8) ? g_levelName[level] : "?");
+	printf("formats   : %u\n", ctl->sites);
+	printf("records   : %llu\n", (unsigned long long)ctl->records);
+	printf("bytes     : %llu\n", (unsigned long long)ctl->bytes);
+	printf("drops     : %llu\n", (unsigned long long)ctl->drops);
+	printf("fallbacks : %llu\n", (unsigned long long)ctl->fallbacks);
+	shmdt(ctl);
+	return 0;
+}
+
+static int setLevel(const char *name, int level)
+{
+	struct v2xlogCtl_t *ctl = attachCtl(name, false);
+	int old;
+
+	if(ctl == NULL)
+		return -1;
+	old = __atomic_exchange_n(&ctl->level, level, __ATOMIC_RELAXED);
+	printf("%s(pid %d) level %s -> %s\n", ctl->name, ctl->pid, g_levelName[old & 7], g_levelName[level]);
+	shmdt(ctl);
+	return 0;
+}
+
+/****************************************************************************************
+  로그 파일 변환
+ ****************************************************************************************/
+static void resetFmt(void)
+{
+	for(uint32_t i = 0; i < g_fmtNum; i++){
+		free(g_fmt[i].file);
+		free(g_fmt[i].fmt);
+	}
+	free(g_fmt);
+	g_fmt = NULL;
+	g_fmtNum = 0;
+}
+
+static int addFmt(const struct v2xlogRec_t *hdr, const uint8_t *body, uint32_t len)
+{
+	struct v2xlogFmt_t f;
+	struct fmtEnt_t *ent;
+	const char *file, *fmt;
+	uint32_t off = sizeof(f);
+
+	if(len < sizeof(f) || hdr->id == 0)
+		return -1;
+	memcpy(&f, body, sizeof(f));
+	if(f.nargs > V2XLOG_MAX_ARGS || off + f.nargs >= len)
+		return -1;
+	off += f.nargs;
+	file = (const char*)body + off;
+	off += strnlen(file, len - off) + 1;
+	if(off >= len)
+		return -1;
+	fmt = (const char*)body + off;
+	if(strnlen(fmt, len - off) == len - off)
+		return -1;
+
+	if(hdr->id > g_fmtNum){
+		ent = realloc(g_fmt, sizeof(struct fmtEnt_t) * hdr->id);
+		if(ent == NULL)
+			return -1;
+		memset(ent + g_fmtNum, 0, sizeof(struct fmtEnt_t) * (hdr->id - g_fmtNum));
+		g_fmt = ent;
+		g_fmtNum = hdr->id;
+	}
+	ent = &g_fmt[hdr->id - 1];
+	free(ent->file);
+	free(ent->fmt);
+	ent->file = strdup(file);
+	ent->fmt = strdup(fmt);
+	ent->line = f.line;
+	ent->pri = f.pri;
+	ent->nargs = f.nargs;
+	memcpy(ent->types, body + sizeof(f), f.nargs);
+	return 0;
+}
+
+static void printTime(uint64_t ts)
+{
+	time_t sec = ts / 1000000000ULL;
+	struct tm tm;
+	char buf[32];
+
+	localtime_r(&sec, &tm);
+	strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+	printf("%s.%06u", buf, (unsigned)(ts % 1000000000ULL / 1000));
+}
+
+static void printMsg(const struct v2xlogRec_t *hdr, const uint8_t *body, uint32_t len)
+{
+	const struct fmtEnt_t *ent;
+	char text[4096];
+	int n;
+
+	if(hdr->id == 0 || hdr->id > g_fmtNum || g_fmt[hdr->id - 1].fmt == NULL){
+		g_unknown++;
+		return;
+	}
+	ent = &g_fmt[hdr->id - 1];
+	n = v2xlog_Render(ent->fmt, ent->types, ent->nargs, body, len, text, sizeof(text));
+	if(n < 0){
+		printTime(hdr->ts);
+		printf(" [%u] <bad record for %s:%u>\n", hdr->tid, ent->file, ent->line);
+		return;
+	}
+	while(n > 0 && text[n - 1] == '\n')
+		text[--n] = '\0';
+
+	printTime(hdr->ts);
+	printf(" %-7s [%u] %s\n", g_levelName[LOG_PRI(ent->pri)], hdr->tid, text);
+}
+
+static FILE *openLog(const char *path, ino_t *ino)
+{
+	struct v2xlogFileHdr_t fh;
+	struct stat st;
+	FILE *fp;
+
+	fp = fopen(path, "rb");
+	if(fp == NULL){
+		fprintf(stderr, "v2xlogdec: %s : %s\n", path, strerror(errno));
+		return NULL;
+	}
+	if(fread(&fh, sizeof(fh), 1, fp) != 1 || fh.magic != V2XLOG_MAGIC || fh.version != V2XLOG_VERSION){
+		fprintf(stderr, "v2xlogdec: %s : not a v2xlog file\n", path);
+		fclose(fp);
+		return NULL;
+	}
+	fstat(fileno(fp), &st);
+	*ino = st.st_ino;
+	resetFmt();
+	return fp;
+}
+
+/**
+ * follow 모드에서 파일 끝에 도달했을 때 - 파일이 교체되었으면 이전 파일의 남은 레코드를 다 읽은 뒤 새 파일을 연다.
+ */
+static FILE *followWait(FILE *fp, const char *path, ino_t *ino, long pos)
+{
+	struct stat st, cur;
+
+	usleep(FOLLOW_WAIT_USEC);
+	if(stat(path, &st) == 0 && st.st_ino != *ino && fstat(fileno(fp), &cur) == 0 && cur.st_size <= pos){
+		FILE *nfp = openLog(path, ino);
+
+		if(nfp != NULL){
+			fclose(fp);
+			return nfp;
+		}
+	}
+	clearerr(fp);
+	fseek(fp, pos, SEEK_SET);
+	return fp;
+}
+
+static int decodeFile(const char *path, bool follow)
+{
+	static uint8_t body[65536];
+	struct v2xlogRec_t hdr;
+	uint32_t len;
+	ino_t ino;
+	long pos;
+	FILE *fp;
+
+	fp = openLog(path, &ino);
+	if(fp == NULL)
+		return -1;
+
+	while(1){
+		pos = ftell(fp);
+		if(fread(&hdr, sizeof(hdr), 1, fp) != 1){
+			if(!follow)
+				break;
+			if((fp = followWait(fp, path, &ino, pos)) == NULL)
+				return -1;
+			continue;
+		}
+		if(hdr.len < sizeof(hdr)){
+			fprintf(stderr, "v2xlogdec: %s : corrupted record at offset %ld\n", path, pos);
+			break;
+		}
+		len = hdr.len - sizeof(hdr);
+		if(len > 0 && fread(body, len, 1, fp) != 1){
+			if(!follow)
+				break;
+			if((fp = followWait(fp, path, &ino, pos)) == NULL)
+				return -1;
+			continue;
+		}
+
+		switch(hdr.type){
+			case v2xlogRecFmt:
+				if(addFmt(&hdr, body, len) < 0)
+					fprintf(stderr, "v2xlogdec: %s : invalid format record at offset %ld\n", path, pos);
+				break;
+			case v2xlogRecMsg:
+				printMsg(&hdr, body, len);
+				break;
+			case v2xlogRecDrop:
+				printTime(hdr.ts);
+				printf(" %-7s [%u] *** %u records dropped (ring full)\n", "warning", hdr.tid, hdr.arg);
+				break;
+		}
+		if(follow)
+			fflush(stdout);
+	}
+	fclose(fp);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option longOpts[] = {
+		{ "follow", no_argument, NULL, 'f' },
+		{ "name", required_argument, NULL, 'n' },
+		{ "status", no_argument, NULL, 's' },
+		{ "level", required_argument, NULL, 'l' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+	const char *name = NULL;
+	bool follow = false, stat = false;
+	int level = -1, c, ret = 0;
+
+	while((c = getopt_long(argc, argv, "fn:sl:h", longOpts, NULL)) != -1){
+		switch(c){
+			case 'f': follow = true; break;
+			case 'n': name = optarg; break;
+			case 's': stat = true; break;
+			case 'l':
+				level = parseLevel(optarg);
+				if(level < 0){
+					fprintf(stderr, "v2xlogdec: invalid level %s\n", optarg);
+					return -1;
+				}
+				break;
+			default:
+				usage(argv[0]);
+				return (c == 'h') ? 0 : -1;
+		}
+	}
+
+	if(stat || level >= 0){
+		if(name == NULL){
+			usage(argv[0]);
+			return -1;
+		}
+		if(level >= 0 && setLevel(name, level) < 0)
+			return -1;
+		if(stat && status(name) < 0)
+			return -1;
+		return 0;
+	}
+
+	if(optind >= argc || (follow && argc - optind != 1)){
+		usage(argv[0]);
+		return -1;
+	}
+	for(int i = optind; i < argc; i++)
+		if(decodeFile(argv[i], follow) < 0)
+			ret = -1;
+	if(g_unknown > 0)
+		fprintf(stderr, "v2xlogdec: %llu records with unknown format id\n", (unsigned long long)g_unknown);
+	resetFmt();
+	return ret;
+}
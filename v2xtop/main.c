@@ -0,0 +1,472 @@
+/**********************************************************
+  [v2xtop]
+  데몬 통계(v2xstat.h) 실시간 조회 도구
+
+  - 모든 통계 공유메모리를 찾아 데몬 별로 카운터의 초당 증가량, 게이지 현재값,
+    히스토그램의 초당 개수와 평균/p50/p90/p99를 주기적으로 보여 준다.
+    히스토그램 백분위수는 직전 출력 이후 구간 값이며, 그 사이 값이 없으면 누적값을 보여 준다.
+  - 메시지큐(1716, 1717, 1718 등)에 쌓인 메시지 수를 함께 보여 준다.
+  - -j로 JSON 스냅샷을 저장한다. (출력할 때마다 한 줄에 한 스냅샷)
+
+  사용 예
+    v2xtop                        1초마다 화면 갱신
+    v2xtop -n prcsWSM -i 5        prcsWSM만 5초마다
+    v2xtop -j - -c 1              현재 값을 JSON으로 한 번 출력
+    v2xtop -j /tmp/stat.json -i 10 -c 360    10초마다 한 시간 동안 저장
+ ************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <getopt.h>
+#include <errno.h>
+#include <sys/shm.h>
+#include <sys/msg.h>
+#include "v2xstat.h"
+
+#define SEG_MAX 32 //동시에 보는 데몬 수
+#define NAME_FILTER_MAX 8 //-n 최대 개수
+#define KEY_PREFIX 0x53000000 //v2xstat_Key() 상위 바이트
+
+/* 데몬 통계 공유메모리 */
+struct seg_t{
+	bool used;
+	bool seen; //이번 출력에서 찾았는지 여부
+	bool havePrev; //직전 값이 있는지 여부 (없으면 증가량은 시작 이후 평균)
+	key_t key;
+	int shmid;
+	const struct v2xstatShm_t *shm;
+	uint64_t start;
+	uint64_t prevTime; //직전 값을 읽은 시각 (nsec, CLOCK_MONOTONIC)
+	int64_t prev[V2XSTAT_CELL_MAX];
+	int64_t cur[V2XSTAT_CELL_MAX];
+};
+
+static struct seg_t g_seg[SEG_MAX];
+static const char *g_filter[NAME_FILTER_MAX];
+static int g_nfilter;
+static volatile sig_atomic_t g_stop;
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-n <name>]... [-i <sec>] [-c <count>] [-b] [-j <file>]\n", prog);
+	fprintf(stderr, "  -n, --name <name>     show daemons whose name starts with <name> (default: all)\n");
+	fprintf(stderr, "  -i, --interval <sec>  refresh interval (default: 1)\n");
+	fprintf(stderr, "  -c, --count <n>       exit after <n> refreshes\n");
+	fprintf(stderr, "  -b, --batch           do not clear the screen between refreshes\n");
+	fprintf(stderr, "  -j, --json <file>     append a JSON snapshot per refresh to <file> ('-' for stdout)\n");
+}
+
+static void sigHandler(int signo)
+{
+	g_stop = 1;
+}
+
+static uint64_t nowNs(clockid_t clk)
+{
+	struct timespec ts;
+
+	clock_gettime(clk, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static bool nameMatch(const char *name)
+{
+	if(g_nfilter == 0)
+		return true;
+	for(int i = 0; i < g_nfilter; i++){
+		if(strncmp(name, g_filter[i], strlen(g_filter[i])) == 0)
+			return true;
+	}
+	return false;
+}
+
+/****************************************************************************************
+  통계 공유메모리 찾기 - 모든 공유메모리 중 키와 크기, magic이 맞는 것
+ ****************************************************************************************/
+static struct seg_t *segFind(key_t key)
+{
+	struct seg_t *empty = NULL;
+
+	for(int i = 0; i < SEG_MAX; i++){
+		if(g_seg[i].used && g_seg[i].key == key)
+			return &g_seg[i];
+		if(!g_seg[i].used && empty == NULL)
+			empty = &g_seg[i];
+	}
+	return empty;
+}
+
+static void segDetach(struct seg_t *s)
+{
+	if(s->shm != NULL)
+		shmdt(s->shm);
+	s->shm = NULL;
+	s->used = false;
+}
+
+static void segScan(void)
+{
+	struct shm_info info;
+	struct shmid_ds ds;
+	struct seg_t *s;
+	const struct v2xstatShm_t *shm;
+	int max, shmid;
+	key_t key;
+
+	for(int i = 0; i < SEG_MAX; i++)
+		g_seg[i].seen = false;
+
+	max = shmctl(0, SHM_INFO, (struct shmid_ds*)&info);
+	for(int idx = 0; idx <= max; idx++){
+		shmid = shmctl(idx, SHM_STAT, &ds);
+		if(shmid < 0)
+			continue;
+		key = ds.shm_perm.__key;
+		if(((uint32_t)key & 0xff000000) != KEY_PREFIX || ds.shm_segsz != sizeof(struct v2xstatShm_t))
+			continue;
+		s = segFind(key);
+		if(s == NULL)
+			continue;
+		/* 데몬이 공유메모리를 다시 만들었다. */
+		if(s->used && s->shmid != shmid)
+			segDetach(s);
+		if(!s->used){
+			shm = (const struct v2xstatShm_t*)shmat(shmid, NULL, SHM_RDONLY);
+			if(shm == (void*)-1)
+				continue;
+			memset(s, 0, sizeof(*s));
+			s->used = true;
+			s->key = key;
+			s->shmid = shmid;
+			s->shm = shm;
+		}
+		shm = s->shm;
+		if(__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != V2XSTAT_MAGIC || shm->version != V2XSTAT_VERSION ||
+		   !nameMatch(shm->name))
+			continue;
+		s->seen = true;
+	}
+	for(int i = 0; i < SEG_MAX; i++){
+		if(g_seg[i].used && !g_seg[i].seen)
+			segDetach(&g_seg[i]);
+	}
+}
+
+/* 현재 값을 읽는다. 데몬이 다시 시작되었으면 직전 값을 버린다. */
+static uint32_t segRead(struct seg_t *s)
+{
+	const struct v2xstatShm_t *shm = s->shm;
+	uint32_t n = __atomic_load_n(&shm->nmetric, __ATOMIC_ACQUIRE);
+
+	if(shm->start != s->start){
+		s->start = shm->start;
+		s->havePrev = false;
+	}
+	for(uint32_t i = 0; i < n; i++){
+		const struct v2xstatDesc_t *d = &shm->desc[i];
+		int ncell = (d->type == v2xstatHist) ? d->nbounds + 2 : 1;
+		for(int c = 0; c < ncell; c++)
+			s->cur[d->cell + c] = v2xstat_Value(shm, d->cell + c);
+	}
+	return n;
+}
+
+/****************************************************************************************
+  히스토그램
+ ****************************************************************************************/
+/* 구간 별 개수 (h[0..nbounds]) - window이면 직전 값과의 차이 */
+static int64_t histCounts(const struct seg_t *s, const struct v2xstatDesc_t *d, bool window, int64_t *h, int64_t *sum)
+{
+	int64_t cnt = 0;
+
+	for(int b = 0; b <= d->nbounds; b++){
+		h[b] = s->cur[d->cell + b] - (window ? s->prev[d->cell + b] : 0);
+		cnt += h[b];
+	}
+	*sum = s->cur[d->cell + d->nbounds + 1] - (window ? s->prev[d->cell + d->nbounds + 1] : 0);
+	return cnt;
+}
+
+/**
+ * 백분위수 - 구간 안에서는 고르게 분포한다고 보고 보간한다.
+ * @param over  마지막 상한을 넘는 구간에 해당하면 true (값은 마지막 상한)
+ */
+static double histPct(const struct v2xstatDesc_t *d, const int64_t *h, int64_t cnt, double pct, bool *over)
+{
+	double rank = cnt * pct / 100.0, acc = 0, lo;
+
+	*over = false;
+	for(int b = 0; b <= d->nbounds; b++){
+		if(h[b] <= 0 || acc + h[b] < rank){
+			acc += h[b];
+			continue;
+		}
+		if(b == d->nbounds){
+			*over = true;
+			return (d->nbounds > 0) ? (double)d->bounds[d->nbounds - 1] : 0;
+		}
+		lo = (b == 0) ? ((d->bounds[0] > 0) ? 0 : (double)d->bounds[0]) : (double)d->bounds[b - 1];
+		return lo + (d->bounds[b] - lo) * (rank - acc) / h[b];
+	}
+	return 0;
+}
+
+static void fmtPct(char *buf, size_t size, const struct v2xstatDesc_t *d, const int64_t *h, int64_t cnt, double pct)
+{
+	bool over;
+	double v;
+
+	if(cnt <= 0){
+		snprintf(buf, size, "-");
+		return;
+	}
+	v = histPct(d, h, cnt, pct, &over);
+	snprintf(buf, size, "%s%.0f", over ? ">" : "", v);
+}
+
+/****************************************************************************************
+  화면 출력
+ ****************************************************************************************/
+static void printMsgq(FILE *fp)
+{
+	struct msginfo info;
+	struct msqid_ds ds;
+	int max, n = 0;
+
+	max = msgctl(0, MSG_INFO, (struct msqid_ds*)&info);
+	for(int idx = 0; idx <= max; idx++){
+		if(msgctl(idx, MSG_STAT, &ds) < 0)
+			continue;
+		fprintf(fp, "%s mq %d: %lu msgs, %lu/%lu bytes", (n++ == 0) ? "" : " |",
+		        (int)ds.msg_perm.__key, (unsigned long)ds.msg_qnum, (unsigned long)ds.__msg_cbytes, (unsigned long)ds.msg_qbytes);
+	}
+	if(n > 0)
+		fputc('\n', fp);
+}
+
+static void printSeg(struct seg_t *s, uint32_t n, double dt)
+{
+	const struct v2xstatShm_t *shm = s->shm;
+	uint64_t up = (nowNs(CLOCK_REALTIME) - shm->start) / 1000000000ULL;
+	int64_t h[V2XSTAT_BOUND_MAX + 1], total, cnt, sum;
+	char p50[24], p90[24], p99[24];
+	bool window;
+
+	printf("\n%s  pid %d%s  up %llu:%02llu:%02llu\n", shm->name, shm->pid, (shm->pid == 0) ? " (exited)" : "",
+	       (unsigned long long)(up / 3600), (unsigned long long)(up / 60 % 60), (unsigned long long)(up % 60));
+	printf("  %-32s %14s %12s %10s %10s %10s %10s  %s\n", "metric", "value", "rate/s", "avg", "p50", "p90", "p99", "unit");
+	for(uint32_t i = 0; i < n; i++){
+		const struct v2xstatDesc_t *d = &shm->desc[i];
+		int64_t v = s->cur[d->cell], dv = v - s->prev[d->cell];
+
+		switch(d->type){
+		case v2xstatCounter:
+			printf("  %-32s %14lld %12.1f %10s %10s %10s %10s  %s\n", d->name, (long long)v,
+			       (s->havePrev ? dv : v) / dt, "", "", "", "", d->unit);
+			break;
+		case v2xstatGauge:
+			printf("  %-32s %14lld %12s %10s %10s %10s %10s  %s\n", d->name, (long long)v, "", "", "", "", "", d->unit);
+			break;
+		case v2xstatHist:
+			/* 직전 출력 이후 값이 없으면 누적 분포를 보여 준다. */
+			total = histCounts(s, d, false, h, &sum);
+			window = s->havePrev && histCounts(s, d, true, h, &sum) > 0;
+			cnt = histCounts(s, d, window, h, &sum);
+			fmtPct(p50, sizeof(p50), d, h, cnt, 50);
+			fmtPct(p90, sizeof(p90), d, h, cnt, 90);
+			fmtPct(p99, sizeof(p99), d, h, cnt, 99);
+			printf("  %-32s %14lld %12.1f %10.0f %10s %10s %10s  %s%s\n", d->name,
+			       (long long)total, window ? cnt / dt : (s->havePrev ? 0.0 : total / dt),
+			       cnt ? (double)sum / cnt : 0.0, p50, p90, p99, d->unit, window ? "" : " (total)");
+			break;
+		}
+	}
+}
+
+/****************************************************************************************
+  JSON 스냅샷 - 누적 값과 증가량
+ ****************************************************************************************/
+static void jsonMsgq(FILE *fp)
+{
+	struct msginfo info;
+	struct msqid_ds ds;
+	int max, n = 0;
+
+	fprintf(fp, "\"msgq\":[");
+	max = msgctl(0, MSG_INFO, (struct msqid_ds*)&info);
+	for(int idx = 0; idx <= max; idx++){
+		if(msgctl(idx, MSG_STAT, &ds) < 0)
+			continue;
+		fprintf(fp, "%s{\"key\":%d,\"msgs\":%lu,\"bytes\":%lu,\"max_bytes\":%lu}", (n++ == 0) ? "" : ",",
+		        (int)ds.msg_perm.__key, (unsigned long)ds.msg_qnum, (unsigned long)ds.__msg_cbytes, (unsigned long)ds.msg_qbytes);
+	}
+	fprintf(fp, "]");
+}
+
+static void jsonSeg(FILE *fp, struct seg_t *s, uint32_t n, double dt)
+{
+	const struct v2xstatShm_t *shm = s->shm;
+	int64_t h[V2XSTAT_BOUND_MAX + 1], cnt, wcnt, sum, wsum;
+	bool over;
+
+	fprintf(fp, "{\"name\":\"%s\",\"pid\":%d,\"start\":%.3f,\"metrics\":{", shm->name, shm->pid, shm->start / 1e9);
+	for(uint32_t i = 0; i < n; i++){
+		const struct v2xstatDesc_t *d = &shm->desc[i];
+		int64_t v = s->cur[d->cell], dv = v - (s->havePrev ? s->prev[d->cell] : 0);
+
+		fprintf(fp, "%s\"%s\":{\"unit\":\"%s\",", i ? "," : "", d->name, d->unit);
+		switch(d->type){
+		case v2xstatCounter:
+			fprintf(fp, "\"type\":\"counter\",\"value\":%lld,\"rate\":%.3f}", (long long)v, dv / dt);
+			break;
+		case v2xstatGauge:
+			fprintf(fp, "\"type\":\"gauge\",\"value\":%lld}", (long long)v);
+			break;
+		case v2xstatHist:
+			wcnt = histCounts(s, d, s->havePrev, h, &wsum);
+			cnt = histCounts(s, d, false, h, &sum);
+			fprintf(fp, "\"type\":\"histogram\",\"count\":%lld,\"sum\":%lld,\"rate\":%.3f,\"bounds\":[",
+			        (long long)cnt, (long long)sum, wcnt / dt);
+			for(int b = 0; b < d->nbounds; b++)
+				fprintf(fp, "%s%lld", b ? "," : "", (long long)d->bounds[b]);
+			fprintf(fp, "],\"buckets\":[");
+			for(int b = 0; b <= d->nbounds; b++)
+				fprintf(fp, "%s%lld", b ? "," : "", (long long)h[b]);
+			fprintf(fp, "],\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f}", histPct(d, h, cnt, 50, &over),
+			        histPct(d, h, cnt, 90, &over), histPct(d, h, cnt, 99, &over));
+			break;
+		}
+	}
+	fprintf(fp, "}}");
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option options[] = {
+		{ "name", required_argument, 0, 'n' },
+		{ "interval", required_argument, 0, 'i' },
+		{ "count", required_argument, 0, 'c' },
+		{ "batch", no_argument, 0, 'b' },
+		{ "json", required_argument, 0, 'j' },
+		{ "help", no_argument, 0, 'h' },
+		{ 0, 0, 0, 0 }
+	};
+	int interval = 1, count = 0, iter = 0, c, nseg;
+	bool batch = false;
+	const char *json = NULL;
+	FILE *jfp = NULL;
+	uint64_t now;
+	double dt;
+	uint32_t n;
+
+	while((c = getopt_long(argc, argv, "n:i:c:bj:h", options, NULL)) != -1){
+		switch(c){
+		case 'n':
+			if(g_nfilter >= NAME_FILTER_MAX){
+				fprintf(stderr, "Too many names (max %d)\n", NAME_FILTER_MAX);
+				return 1;
+			}
+			g_filter[g_nfilter++] = optarg;
+			break;
+		case 'i':
+			interval = atoi(optarg);
+			if(interval <= 0)
+				interval = 1;
+			break;
+		case 'c':
+			count = atoi(optarg);
+			break;
+		case 'b':
+			batch = true;
+			break;
+		case 'j':
+			json = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if(json != NULL){
+		jfp = (strcmp(json, "-") == 0) ? stdout : fopen(json, "a");
+		if(jfp == NULL){
+			fprintf(stderr, "Fail to open %s : %s\n", json, strerror(errno));
+			return 1;
+		}
+	}
+
+	signal(SIGINT, sigHandler);
+	signal(SIGTERM, sigHandler);
+
+	while(!g_stop){
+		segScan();
+		now = nowNs(CLOCK_MONOTONIC);
+
+		if(jfp != NULL)
+			fprintf(jfp, "{\"time\":%.3f,", nowNs(CLOCK_REALTIME) / 1e9);
+		else{
+			if(!batch)
+				printf("\033[H\033[2J");
+			printMsgq(stdout);
+		}
+
+		nseg = 0;
+		for(int i = 0; i < SEG_MAX; i++){
+			struct seg_t *s = &g_seg[i];
+			if(!s->seen)
+				continue;
+			n = segRead(s);
+			/* 처음 읽으면 증가량은 시작 이후 평균 */
+			if(s->havePrev)
+				dt = (now - s->prevTime) / 1e9;
+			else
+				dt = (nowNs(CLOCK_REALTIME) - s->shm->start) / 1e9;
+			if(dt <= 0)
+				dt = 1;
+			if(jfp != NULL){
+				fprintf(jfp, "%s", (nseg == 0) ? "\"daemons\":[" : ",");
+				jsonSeg(jfp, s, n, dt);
+			}
+			else
+				printSeg(s, n, dt);
+			nseg++;
+			memcpy(s->prev, s->cur, sizeof(s->prev));
+			s->prevTime = now;
+			s->havePrev = true;
+		}
+
+		if(jfp != NULL){
+			fprintf(jfp, "%s", (nseg == 0) ? "\"daemons\":[]," : "],");
+			jsonMsgq(jfp);
+			fprintf(jfp, "}\n");
+			fflush(jfp);
+		}
+		else{
+			if(nseg == 0)
+				printf("\nNo v2xstat daemon found\n");
+			fflush(stdout);
+		}
+
+		if(count > 0 && ++iter >= count)
+			break;
+		for(int i = 0; i < interval * 10 && !g_stop; i++)
+			usleep(100000);
+	}
+
+	if(jfp != NULL && jfp != stdout)
+		fclose(jfp);
+	for(int i = 0; i < SEG_MAX; i++){
+		if(g_seg[i].used)
+			segDetach(&g_seg[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,574 @@
+/**********************************************************
+  [v2xtrace]
+  종단간 지연 추적(v2xtrace.h) 수집 도구
+
+  - 데몬들의 공유메모리 링에서 추적 이벤트를 읽어 추적 ID 별로 단계 시각을 합친다.
+  - 단계 별 지연(앞 단계부터 그 단계까지)과 전체 지연의 분포(min/avg/p50/p90/p99/max)를 출력한다.
+  - Chrome trace JSON(chrome://tracing, Perfetto)으로 추적 별 단계 구간을 출력한다.
+  - RSU와 OBU는 서로 다른 장치이므로 한쪽에서 -o로 이벤트를 저장하고 다른 쪽에서 파일로 함께 읽으면
+    무선구간 이후 단계까지 합쳐진다. (prcsWSM -T로 트레일러를 켠 시험 환경에서만 OBU 단계가 추적되며,
+    송신측 단계 시각도 트레일러로 OBU까지 전달되므로 OBU만으로도 radio 단계를 제외한 모든 단계를 볼 수 있다)
+
+  사용 예
+    v2xtrace                                  현재 링의 추적을 한 번 모아 출력
+    v2xtrace -i 10 -H                         10초마다 누적 분포와 히스토그램 출력
+    v2xtrace -o /tmp/rsu.v2xtrace             (RSU) 링 이벤트를 파일로 저장
+    v2xtrace -j /tmp/rtcm.json /tmp/rsu.v2xtrace   (OBU) RSU 이벤트와 합쳐 Chrome trace 출력
+ ************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <getopt.h>
+#include <errno.h>
+#include <sys/shm.h>
+#include "v2xtrace.h"
+
+#define RING_NAME_MAX 8 //-n 최대 개수
+#define TRACE_MAX 65536 //동시에 모으는 추적 수
+#define TRACE_HASH 4096
+#define TRACE_IDLE_SEC 2 //-i 모드 - 이 시간 동안 이벤트가 없으면 추적을 마감한다.
+#define HIST_SUB 8 //2의 거듭제곱 구간 당 세부 구간 수
+#define HIST_NUM (HIST_SUB + 29 * HIST_SUB) //usec 0 ~ 2^32
+#define DUMP_MAGIC 0x56325444 //"V2TD" - -o 저장 파일
+
+/* 추적 - 추적 ID와 시작시각으로 구분한다. */
+struct trace_t{
+	int next; //해시 체인 / 빈 목록
+	uint32_t id;
+	uint64_t origin;
+	uint16_t mask;
+	int32_t stamp[v2xtraceStage_Num];
+	uint64_t seen; //마지막 이벤트를 합친 시각 (CLOCK_MONOTONIC sec)
+};
+
+/* 지연 분포 */
+struct hist_t{
+	uint64_t cnt;
+	uint64_t neg; //시각이 거꾸로인 구간 수 (장치 간 시각 오차)
+	uint64_t sum;
+	uint32_t min;
+	uint32_t max;
+	uint64_t bin[HIST_NUM];
+};
+
+/* 공유메모리 링 */
+struct ring_t{
+	const char *name;
+	struct v2xtraceRing_t *ring;
+	int32_t pid;
+	uint64_t next; //다음에 읽을 순번
+};
+
+/* 저장 파일 헤더 - 뒤에 struct v2xtraceEvt_t가 이어진다. */
+struct dumpHdr_t{
+	uint32_t magic;
+	uint32_t evtSize;
+};
+
+/* 단계 구간의 Chrome trace 프로세스 - 단계를 기록하는 곳 (obuRx 구간은 무선구간) */
+static const int g_stageOwner[v2xtraceStage_Num] = { 1, 1, 1, 1, 2, 2, 2, 3, 4, 5, 5, 5 };
+static const char *g_ownerName[] = { "", "RSU prcsJ2735", "RSU prcsWSM", "air", "OBU prcsWSM", "OBU prcsJ2735" };
+
+static struct trace_t g_trace[TRACE_MAX];
+static int g_hash[TRACE_HASH];
+static int g_free = -1;
+static uint64_t g_overflow;
+static uint64_t g_traces;
+static uint64_t g_events;
+
+static struct hist_t g_hist[v2xtraceStage_Num];
+static struct hist_t g_total;
+
+static FILE *g_json;
+static bool g_jsonFirst = true;
+static volatile sig_atomic_t g_stop;
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-n <name>]... [-i <sec>] [-H] [-j <json>] [-o <dump>] [<dump>...]\n", prog);
+	fprintf(stderr, "  -n, --name <name>     read trace ring of daemon <name> (default: prcsJ2735 and prcsWSM)\n");
+	fprintf(stderr, "                          if only dump files are given, rings are not read\n");
+	fprintf(stderr, "  -i, --interval <sec>  keep reading rings and print cumulative latency every <sec>\n");
+	fprintf(stderr, "  -H, --hist            print per-stage latency histogram\n");
+	fprintf(stderr, "  -j, --json <file>     write Chrome trace JSON (chrome://tracing, ui.perfetto.dev)\n");
+	fprintf(stderr, "  -o, --output <file>   save ring events to <file> to merge with the other side's events\n");
+}
+
+static uint64_t monoSec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec;
+}
+
+static void sigHandler(int signo)
+{
+	g_stop = 1;
+}
+
+/****************************************************************************************
+  지연 분포 - 2의 거듭제곱 구간을 HIST_SUB개로 나눈다. (상대오차 1/HIST_SUB 이내)
+ ****************************************************************************************/
+static int histBin(uint32_t v)
+{
+	int e;
+
+	if(v < HIST_SUB)
+		return (int)v;
+	e = 31 - __builtin_clz(v); //v >= 8 이므로 e >= 3
+	return HIST_SUB + (e - 3) * HIST_SUB + (int)((v >> (e - 3)) & (HIST_SUB - 1));
+}
+
+/* 구간의 하한값 */
+static uint32_t histLow(int bin)
+{
+	int e;
+
+	if(bin < HIST_SUB)
+		return (uint32_t)bin;
+	e = (bin - HIST_SUB) / HIST_SUB + 3;
+	return (uint32_t)((HIST_SUB + (bin % HIST_SUB)) << (e - 3));
+}
+
+static void histAdd(struct hist_t *h, int64_t usec)
+{
+	uint32_t v;
+
+	if(usec < 0){
+		h->neg++;
+		return;
+	}
+	v = (usec > UINT32_MAX) ? UINT32_MAX : (uint32_t)usec;
+	if(h->cnt == 0 || v < h->min)
+		h->min = v;
+	if(v > h->max)
+		h->max = v;
+	h->cnt++;
+	h->sum += v;
+	h->bin[histBin(v)]++;
+}
+
+/* 백분위수 - 해당 구간의 중간값 (max를 넘지 않는다) */
+static uint32_t histPct(const struct hist_t *h, double pct)
+{
+	uint64_t rank = (uint64_t)(h->cnt * pct / 100.0 + 0.5), acc = 0;
+	uint32_t lo, hi;
+
+	if(rank == 0)
+		rank = 1;
+	for(int i = 0; i < HIST_NUM; i++){
+		acc += h->bin[i];
+		if(acc >= rank){
+			lo = histLow(i);
+			hi = (i + 1 < HIST_NUM) ? histLow(i + 1) : UINT32_MAX;
+			lo = lo + (hi - lo) / 2;
+			return (lo > h->max) ? h->max : (lo < h->min ? h->min : lo);
+		}
+	}
+	return h->max;
+}
+
+static void printRow(const char *name, const struct hist_t *h)
+{
+	if(h->cnt == 0 && h->neg == 0)
+		return;
+	printf("%-12s %8llu %9u %9llu %9u %9u %9u %9u %6llu\n", name, (unsigned long long)h->cnt,
+	       h->min, h->cnt ? (unsigned long long)(h->sum / h->cnt) : 0ULL,
+	       histPct(h, 50), histPct(h, 90), histPct(h, 99), h->max, (unsigned long long)h->neg);
+}
+
+static void printHist(const char *name, const struct hist_t *h)
+{
+	uint64_t pow2[33] = { 0 }, peak = 0;
+	int first = -1, last = -1, b;
+
+	if(h->cnt == 0)
+		return;
+	/* 출력은 2의 거듭제곱 구간으로 모은다. */
+	for(int i = 0; i < HIST_NUM; i++){
+		if(h->bin[i] == 0)
+			continue;
+		b = (histLow(i) == 0) ? 0 : 32 - __builtin_clz(histLow(i));
+		pow2[b] += h->bin[i];
+	}
+	for(int i = 0; i < 33; i++){
+		if(pow2[i] == 0)
+			continue;
+		if(first < 0)
+			first = i;
+		last = i;
+		if(pow2[i] > peak)
+			peak = pow2[i];
+	}
+	printf("%s (usec)\n", name);
+	for(int i = first; i <= last; i++){
+		int bar = (int)(pow2[i] * 40 / peak);
+		printf("  [%10llu, %10llu) %8llu ", (i == 0) ? 0ULL : 1ULL << (i - 1), 1ULL << i, (unsigned long long)pow2[i]);
+		for(int j = 0; j < bar; j++)
+			putchar('#');
+		putchar('\n');
+	}
+}
+
+static void report(bool hist)
+{
+	printf("\ntraces %llu, events %llu, overflow %llu\n", (unsigned long long)g_traces,
+	       (unsigned long long)g_events, (unsigned long long)g_overflow);
+	printf("%-12s %8s %9s %9s %9s %9s %9s %9s %6s  (usec, from previous stage)\n",
+	       "stage", "count", "min", "avg", "p50", "p90", "p99", "max", "neg");
+	for(int s = 1; s < v2xtraceStage_Num; s++)
+		printRow(v2xtrace_StageName(s), &g_hist[s]);
+	printRow("total", &g_total);
+	if(!hist)
+		return;
+	putchar('\n');
+	for(int s = 1; s < v2xtraceStage_Num; s++)
+		printHist(v2xtrace_StageName(s), &g_hist[s]);
+	printHist("total", &g_total);
+	fflush(stdout);
+}
+
+/****************************************************************************************
+  Chrome trace JSON
+ ****************************************************************************************/
+static int jsonOpen(const char *path)
+{
+	g_json = fopen(path, "w");
+	if(g_json == NULL){
+		fprintf(stderr, "Fail to open %s : %s\n", path, strerror(errno));
+		return -1;
+	}
+	fprintf(g_json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for(int p = 1; p <= 5; p++){
+		fprintf(g_json, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}",
+		        g_jsonFirst ? "" : ",\n", p, g_ownerName[p]);
+		fprintf(g_json, ",\n{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"sort_index\":%d}}", p, p);
+		g_jsonFirst = false;
+	}
+	return 0;
+}
+
+/* 추적 하나 - 기록된 단계마다 앞 단계부터의 구간 (pid: 단계를 기록한 곳, tid: 추적 ID) */
+static void jsonTrace(const struct trace_t *t)
+{
+	int prev = -1;
+	uint64_t base = t->origin / 1000;
+
+	for(int s = 0; s < v2xtraceStage_Num; s++){
+		if(!(t->mask & (1U << s)))
+			continue;
+		if(prev < 0)
+			fprintf(g_json, ",\n{\"name\":\"%s\",\"cat\":\"v2x\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu,\"pid\":%d,\"tid\":%u}",
+			        v2xtrace_StageName(s), (unsigned long long)(base + t->stamp[s]), g_stageOwner[s], t->id);
+		else if(t->stamp[s] >= t->stamp[prev])
+			fprintf(g_json, ",\n{\"name\":\"%s\",\"cat\":\"v2x\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%d,\"pid\":%d,\"tid\":%u,"
+			        "\"args\":{\"id\":%u,\"from\":\"%s\"}}",
+			        v2xtrace_StageName(s), (unsigned long long)(base + t->stamp[prev]), t->stamp[s] - t->stamp[prev],
+			        g_stageOwner[s], t->id, t->id, v2xtrace_StageName(prev));
+		prev = s;
+	}
+}
+
+static void jsonClose(void)
+{
+	if(g_json == NULL)
+		return;
+	fprintf(g_json, "\n]}\n");
+	fclose(g_json);
+	g_json = NULL;
+}
+
+/****************************************************************************************
+  추적 모으기
+ ****************************************************************************************/
+static void traceInit(void)
+{
+	for(int i = 0; i < TRACE_HASH; i++)
+		g_hash[i] = -1;
+	for(int i = TRACE_MAX - 1; i >= 0; i--){
+		g_trace[i].next = g_free;
+		g_free = i;
+	}
+}
+
+static uint32_t traceHash(uint32_t id, uint64_t origin)
+{
+	return (id ^ (uint32_t)(origin >> 10) ^ (uint32_t)(origin >> 40)) % TRACE_HASH;
+}
+
+static void traceMerge(const struct v2xtraceCtx_t *ctx)
+{
+	uint32_t h = traceHash(ctx->id, ctx->origin);
+	struct trace_t *t = NULL;
+	int i;
+
+	g_events++;
+	for(i = g_hash[h]; i >= 0; i = g_trace[i].next){
+		if(g_trace[i].id == ctx->id && g_trace[i].origin == ctx->origin){
+			t = &g_trace[i];
+			break;
+		}
+	}
+	if(t == NULL){
+		if(g_free < 0){
+			g_overflow++;
+			return;
+		}
+		i = g_free;
+		t = &g_trace[i];
+		g_free = t->next;
+		memset(t, 0, sizeof(*t));
+		t->id = ctx->id;
+		t->origin = ctx->origin;
+		t->next = g_hash[h];
+		g_hash[h] = i;
+	}
+	for(int s = 0; s < v2xtraceStage_Num; s++){
+		if(ctx->mask & (1U << s))
+			t->stamp[s] = ctx->stamp[s];
+	}
+	t->mask |= ctx->mask;
+	t->seen = monoSec();
+}
+
+/* 추적을 분포와 JSON에 반영한다. */
+static void traceFinish(const struct trace_t *t)
+{
+	int first = -1, prev = -1;
+
+	g_traces++;
+	for(int s = 0; s < v2xtraceStage_Num; s++){
+		if(!(t->mask & (1U << s)))
+			continue;
+		if(first < 0)
+			first = s;
+		else
+			histAdd(&g_hist[s], (int64_t)t->stamp[s] - t->stamp[prev]);
+		prev = s;
+	}
+	if(first >= 0 && prev > first)
+		histAdd(&g_total, (int64_t)t->stamp[prev] - t->stamp[first]);
+	if(g_json != NULL)
+		jsonTrace(t);
+}
+
+/**
+ * 추적을 마감한다.
+ * @param all   true이면 모두, false이면 마지막 단계까지 왔거나 TRACE_IDLE_SEC 동안 이벤트가 없던 추적만
+ */
+static void traceFlush(bool all)
+{
+	uint64_t now = monoSec();
+	int *link, i;
+
+	for(int h = 0; h < TRACE_HASH; h++){
+		link = &g_hash[h];
+		while((i = *link) >= 0){
+			struct trace_t *t = &g_trace[i];
+			if(all || (t->mask & (1U << v2xtraceStage_GpsdWrite)) || now - t->seen >= TRACE_IDLE_SEC){
+				traceFinish(t);
+				*link = t->next;
+				t->next = g_free;
+				g_free = i;
+			}
+			else
+				link = &t->next;
+		}
+	}
+}
+
+/****************************************************************************************
+  공유메모리 링 / 저장 파일
+ ****************************************************************************************/
+static int ringAttach(struct ring_t *r)
+{
+	int shmid;
+	void *p;
+
+	shmid = shmget(v2xtrace_Key(r->name), 0, 0);
+	if(shmid < 0 || (p = shmat(shmid, NULL, SHM_RDONLY)) == (void*)-1){
+		fprintf(stderr, "No trace ring for %s (not started?)\n", r->name);
+		return -1;
+	}
+	r->ring = (struct v2xtraceRing_t*)p;
+	if(r->ring->magic != V2XTRACE_MAGIC || r->ring->len != V2XTRACE_RING_LEN){
+		fprintf(stderr, "Trace ring for %s is not compatible\n", r->name);
+		shmdt(p);
+		r->ring = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * 링에서 아직 읽지 않은 이벤트를 읽는다. 덮어쓰였거나 기록 중인 이벤트는 건너뛴다.
+ * @param dump  NULL이 아니면 읽은 이벤트를 저장한다.
+ */
+static void ringRead(struct ring_t *r, FILE *dump)
+{
+	struct v2xtraceRing_t *ring = r->ring;
+	struct v2xtraceEvt_t e;
+	uint64_t head, seq, s1, s2;
+
+	head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	/* 데몬이 다시 시작되어 링이 초기화되었다. */
+	if(ring->pid != r->pid || head < r->next){
+		r->pid = ring->pid;
+		if(head < r->next)
+			r->next = 0;
+	}
+	if(head - r->next > V2XTRACE_RING_LEN)
+		r->next = head - V2XTRACE_RING_LEN;
+
+	for(seq = r->next; seq < head; seq++){
+		const struct v2xtraceEvt_t *src = &ring->evt[seq & (V2XTRACE_RING_LEN - 1)];
+		s1 = __atomic_load_n(&src->seq, __ATOMIC_ACQUIRE);
+		if(s1 != seq + 1)
+			continue;
+		memcpy(&e, src, sizeof(e));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		s2 = __atomic_load_n(&src->seq, __ATOMIC_RELAXED);
+		if(s2 != s1 || !V2XTRACE_VALID(&e.ctx))
+			continue;
+		traceMerge(&e.ctx);
+		if(dump != NULL)
+			fwrite(&e, sizeof(e), 1, dump);
+	}
+	r->next = head;
+}
+
+static int readDump(const char *path)
+{
+	struct dumpHdr_t hdr;
+	struct v2xtraceEvt_t e;
+	FILE *fp;
+
+	fp = fopen(path, "r");
+	if(fp == NULL){
+		fprintf(stderr, "Fail to open %s : %s\n", path, strerror(errno));
+		return -1;
+	}
+	if(fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != DUMP_MAGIC || hdr.evtSize != sizeof(e)){
+		fprintf(stderr, "%s : not a v2xtrace dump\n", path);
+		fclose(fp);
+		return -1;
+	}
+	while(fread(&e, sizeof(e), 1, fp) == 1){
+		if(V2XTRACE_VALID(&e.ctx))
+			traceMerge(&e.ctx);
+	}
+	fclose(fp);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option options[] = {
+		{ "name", required_argument, 0, 'n' },
+		{ "interval", required_argument, 0, 'i' },
+		{ "hist", no_argument, 0, 'H' },
+		{ "json", required_argument, 0, 'j' },
+		{ "output", required_argument, 0, 'o' },
+		{ "help", no_argument, 0, 'h' },
+		{ 0, 0, 0, 0 }
+	};
+	struct ring_t ring[RING_NAME_MAX];
+	int nring = 0, attached = 0, interval = 0, c;
+	bool hist = false;
+	const char *json = NULL, *output = NULL;
+	FILE *dump = NULL;
+
+	memset(ring, 0, sizeof(ring));
+	while((c = getopt_long(argc, argv, "n:i:Hj:o:h", options, NULL)) != -1){
+		switch(c){
+		case 'n':
+			if(nring >= RING_NAME_MAX){
+				fprintf(stderr, "Too many rings (max %d)\n", RING_NAME_MAX);
+				return 1;
+			}
+			ring[nring++].name = optarg;
+			break;
+		case 'i':
+			interval = atoi(optarg);
+			break;
+		case 'H':
+			hist = true;
+			break;
+		case 'j':
+			json = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if(nring == 0 && optind == argc){
+		ring[nring++].name = "prcsJ2735";
+		ring[nring++].name = "prcsWSM";
+	}
+
+	traceInit();
+	for(int i = 0; i < nring; i++){
+		if(ringAttach(&ring[i]) == 0)
+			attached++;
+	}
+	if(attached == 0 && optind == argc)
+		return 1;
+	for(int i = optind; i < argc; i++){
+		if(readDump(argv[i]) < 0)
+			return 1;
+	}
+
+	if(output != NULL){
+		struct dumpHdr_t hdr = { DUMP_MAGIC, sizeof(struct v2xtraceEvt_t) };
+		dump = fopen(output, "w");
+		if(dump == NULL || fwrite(&hdr, sizeof(hdr), 1, dump) != 1){
+			fprintf(stderr, "Fail to open %s : %s\n", output, strerror(errno));
+			return 1;
+		}
+	}
+	if(json != NULL && jsonOpen(json) < 0)
+		return 1;
+
+	signal(SIGINT, sigHandler);
+	signal(SIGTERM, sigHandler);
+
+	/* 링을 한 번 읽는다. -i이면 주기적으로 새 이벤트를 읽어 마감된 추적을 반영한다. */
+	do{
+		for(int i = 0; i < nring; i++){
+			if(ring[i].ring != NULL)
+				ringRead(&ring[i], dump);
+		}
+		if(interval <= 0)
+			break;
+		traceFlush(false);
+		report(hist);
+		for(int i = 0; i < interval * 10 && !g_stop; i++)
+			usleep(100000);
+	}while(!g_stop);
+
+	traceFlush(true);
+	report(hist);
+
+	if(dump != NULL)
+		fclose(dump);
+	jsonClose();
+	for(int i = 0; i < nring; i++){
+		if(ring[i].ring != NULL)
+			shmdt(ring[i].ring);
+	}
+	return 0;
+}